@@ -0,0 +1,175 @@
+/*!
+*****************************************************************
+* @file    bench_comp.c
+* @brief   BME280 compensation: batch API against the scalar
+*          routines, bit-exactness and throughput as JSON
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_hal.h"
+#include "bme280.h"
+#include "bench_util.h"
+
+static BME280_Dev bme; /*!< Only calibration, raw values and t_fine are used */
+
+/*=========================================================*/
+/*== SAMPLE SET ===========================================*/
+/*=========================================================*/
+
+typedef struct BenchSet
+{
+    size_t count;
+    int32_t *adcT;
+    int32_t *adcP;
+    int32_t *adcH;
+    int32_t *temperature;
+    uint32_t *pressure;
+    uint32_t *humidity;
+} BenchSet;
+
+/*!< Raw values over the full ADC range: 20 bit T/P, 16 bit H */
+static void bench_fill(BenchSet *set, size_t count)
+{
+    uint32_t seed = 0x2545F491u;
+
+    set->count = count;
+    set->adcT = malloc(count * sizeof(int32_t));
+    set->adcP = malloc(count * sizeof(int32_t));
+    set->adcH = malloc(count * sizeof(int32_t));
+    set->temperature = malloc(count * sizeof(int32_t));
+    set->pressure = malloc(count * sizeof(uint32_t));
+    set->humidity = malloc(count * sizeof(uint32_t));
+    if (!set->adcT || !set->adcP || !set->adcH || !set->temperature || !set->pressure || !set->humidity)
+    {
+        fprintf(stderr, "out of memory for %zu samples\n", count);
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        set->adcT[i] = (int32_t)(bench_rand(&seed) & 0xFFFFF);
+        set->adcP[i] = (int32_t)(bench_rand(&seed) & 0xFFFFF);
+        set->adcH[i] = (int32_t)(bench_rand(&seed) & 0xFFFF);
+    }
+}
+
+/*=========================================================*/
+/*== RUNNER FUNCTIONS =====================================*/
+/*=========================================================*/
+
+static void bench_scalar(const BenchSet *set)
+{
+    for (size_t i = 0; i < set->count; i++)
+    {
+        bme.temp = set->adcT[i];
+        bme.press = set->adcP[i];
+        bme.hum = set->adcH[i];
+        set->temperature[i] = BME280_COMP_TEMP(&bme);
+        set->pressure[i] = BME280_COMP_PRESSURE(&bme);
+        set->humidity[i] = BME280_COMP_HUM_INT32(&bme);
+    }
+}
+
+static void bench_batch(const BenchSet *set)
+{
+    BME280_COMP_BATCH(&bme.comp, set->adcT, set->adcP, set->adcH, set->count, set->temperature, set->pressure,
+                      set->humidity);
+}
+
+/*!< Best wall time of reps runs in ns per sample */
+static double bench_time(void (*run)(const BenchSet *), const BenchSet *set, uint32_t reps)
+{
+    uint64_t best = UINT64_MAX;
+    for (uint32_t r = 0; r < reps; r++)
+    {
+        uint64_t start = SIM_WALL_NS();
+        run(set);
+        uint64_t elapsed = SIM_WALL_NS() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    return (double)best / (double)set->count;
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = 1u << 20;
+    uint32_t reps = 5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+        {
+            reps = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            count = (size_t)strtoul(argv[i], NULL, 0);
+        }
+    }
+    if (count == 0 || reps == 0)
+    {
+        fprintf(stderr, "usage: bench_comp [samples] [--reps R]\n");
+        return EXIT_FAILURE;
+    }
+
+    BenchSet scalar;
+    BenchSet batch;
+    bench_calib(&bme.comp);
+    BME280_COMP_DERIVE(&bme.comp, &bme.derived);
+    bench_fill(&scalar, count);
+    bench_fill(&batch, count);
+
+    double scalarNs = bench_time(bench_scalar, &scalar, reps);
+    double batchNs = bench_time(bench_batch, &batch, reps);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (scalar.temperature[i] != batch.temperature[i] || scalar.pressure[i] != batch.pressure[i] ||
+            scalar.humidity[i] != batch.humidity[i])
+        {
+            if (mismatches == 0)
+            {
+                fprintf(stderr, "mismatch at %zu: adc T/P/H %d/%d/%d scalar %d/%u/%u batch %d/%u/%u\n", i,
+                        scalar.adcT[i], scalar.adcP[i], scalar.adcH[i], scalar.temperature[i], scalar.pressure[i],
+                        scalar.humidity[i], batch.temperature[i], batch.pressure[i], batch.humidity[i]);
+            }
+            mismatches++;
+        }
+    }
+
+    printf("{\n");
+    printf("  \"samples\": %zu,\n", count);
+    printf("  \"reps\": %u,\n", reps);
+    printf("  \"unit\": \"ns_per_sample\",\n");
+    printf("  \"scalar\": %.3f,\n", scalarNs);
+    printf("  \"batch\": %.3f,\n", batchNs);
+    printf("  \"speedup\": %.2f,\n", scalarNs / batchNs);
+    printf("  \"mismatches\": %zu\n", mismatches);
+    printf("}\n");
+
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
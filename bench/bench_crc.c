@@ -0,0 +1,251 @@
+/*!
+*****************************************************************
+* @file    bench_crc.c
+* @brief   DS18B20 CRC8: bitwise, nibble table and byte table
+*          against each other, plus the simulated bus time of
+*          clean and corrupted scratchpad reads, as JSON
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "pico/stdlib.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_hal.h"
+#include "ds18b20.h"
+#include "bench_util.h"
+
+/*=========================================================*/
+/*== BENCH MACROS =========================================*/
+/*=========================================================*/
+
+#define BENCH_BLOCKS        (1u << 16)  /*!< Random scratchpads per timed pass */
+#define BENCH_CHECK_LEN     64          /*!< Random blocks of 1..64 bytes are cross-checked */
+#define BENCH_BUS_PIN       16
+
+/*=========================================================*/
+/*== CRC VARIANTS =========================================*/
+/*=========================================================*/
+
+/*!< CRC as it was before the table, 8 shift/xor steps per byte */
+static __attribute__((noinline)) uint8_t legacy_crc8(const uint8_t *data, uint8_t len)
+{
+    uint8_t temp;
+    uint8_t databyte;
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < len; i++)
+    {
+        databyte = data[i];
+        for (uint8_t j = 0; j < 8; j++)
+        {
+            temp = (crc ^ databyte) & 0x01;
+            crc >>= 1;
+            if (temp)
+                crc ^= 0x8C;
+            databyte >>= 1;
+        }
+    }
+    return crc;
+}
+
+/*!< 16-entry tables, two lookups per byte: 32 bytes of flash instead of 256 */
+static const uint8_t nibbleLo[16] = {0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83,
+                                     0xC2, 0x9C, 0x7E, 0x20, 0xA3, 0xFD, 0x1F, 0x41};
+static const uint8_t nibbleHi[16] = {0x00, 0x9D, 0x23, 0xBE, 0x46, 0xDB, 0x65, 0xF8,
+                                     0x8C, 0x11, 0xAF, 0x32, 0xCA, 0x57, 0xE9, 0x74};
+
+static __attribute__((noinline)) uint8_t nibble_crc8(const uint8_t *data, uint8_t len)
+{
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < len; i++)
+    {
+        uint8_t x = crc ^ data[i];
+        crc = nibbleLo[x & 0x0F] ^ nibbleHi[x >> 4];
+    }
+    return crc;
+}
+
+static __attribute__((noinline)) uint8_t table_crc8(const uint8_t *data, uint8_t len)
+{
+    return DS18B20_CRC8_CHECK((uint8_t *)data, len);
+}
+
+typedef uint8_t (*BenchCrc)(const uint8_t *data, uint8_t len);
+
+/*=========================================================*/
+/*== RUNNER FUNCTIONS =====================================*/
+/*=========================================================*/
+
+static uint8_t timedPads[BENCH_BLOCKS][DS18B20_SCRATCHPAD_LEN];
+
+/*!< Best wall time of reps passes over the scratchpads, ns per scratchpad */
+static double bench_time(BenchCrc crc8, uint32_t reps)
+{
+    uint64_t best = UINT64_MAX;
+
+    for (uint32_t r = 0; r < reps; r++)
+    {
+        uint32_t acc = 0;
+        uint64_t start = SIM_WALL_NS();
+        for (uint32_t i = 0; i < BENCH_BLOCKS; i++)
+        {
+            acc += crc8(timedPads[i], DS18B20_SCRATCHPAD_LEN);
+        }
+        uint64_t elapsed = SIM_WALL_NS() - start;
+        benchSink = acc;
+        best = elapsed < best ? elapsed : best;
+    }
+    return (double)best / (double)BENCH_BLOCKS;
+}
+
+/*!< Bit-exactness of the three variants, and every scratchpad with its CRC byte checks to 0 */
+static uint64_t bench_check(uint32_t *seed, uint64_t *checked)
+{
+    uint64_t mismatches = 0;
+    uint8_t block[BENCH_CHECK_LEN];
+
+    for (uint32_t n = 0; n < BENCH_BLOCKS; n++)
+    {
+        uint8_t len = (uint8_t)(1 + n % BENCH_CHECK_LEN);
+        for (uint8_t i = 0; i < len; i++)
+        {
+            block[i] = (uint8_t)bench_rand(seed);
+        }
+        uint8_t ref = legacy_crc8(block, len);
+        if (nibble_crc8(block, len) != ref || table_crc8(block, len) != ref)
+        {
+            if (mismatches++ == 0)
+            {
+                fprintf(stderr, "crc mismatch on a %u byte block: legacy %02X\n", len, ref);
+            }
+        }
+        (*checked)++;
+    }
+    for (uint32_t i = 0; i < BENCH_BLOCKS; i++)
+    {
+        if (DS18B20_CRC8_CHECK(timedPads[i], DS18B20_SCRATCHPAD_LEN) != 0 && mismatches++ == 0)
+        {
+            fprintf(stderr, "scratchpad %u does not check to 0\n", i);
+        }
+        (*checked)++;
+    }
+    return mismatches;
+}
+
+typedef struct BenchRead
+{
+    const char *name;
+    uint8_t faultReads;
+    uint8_t faultByte;
+    uint8_t faultMask;
+    int32_t expect;
+} BenchRead;
+
+/*!< Virtual bus time of one MATCH ROM scratchpad read on the simulated 1-Wire bus */
+static bool bench_bus(FILE *out)
+{
+    static const BenchRead reads[] = {
+        {"clean", 0, 0, 0x00, 21 * 16},
+        {"config_byte_once", 1, 4, 0x80, 21 * 16},   /*!< Seen at byte 4 */
+        {"temperature_once", 1, 0, 0x04, 21 * 16},   /*!< Only the CRC sees it */
+        {"crc_byte_always", 3, 8, 0x01, DS18B20_E_CRC},
+    };
+    bool ok = true;
+
+    SIM_RESET();
+    SimDs18b20 *dev = SIM_DS18B20_ATTACH(BENCH_BUS_PIN, 0x00001234ABCDull);
+    SIM_DS18B20_SET_TEMP(dev, 21 * 16);
+    gpio_init(BENCH_BUS_PIN);
+    if (DS18B20_SEARCH(BENCH_BUS_PIN) != 1)
+    {
+        fprintf(stderr, "search did not find the device\n");
+        return false;
+    }
+    DS18B20_TEMP_READ(BENCH_BUS_PIN); /*!< Valid temperature register */
+    const uint8_t *rom = DS18B20_DEVICE_ROM(BENCH_BUS_PIN, 0);
+
+    fprintf(out, "  \"early_abort\": %u,\n", DS18B20_EARLY_ABORT);
+    fprintf(out, "  \"retries\": %u,\n", DS18B20_READ_RETRIES);
+    fprintf(out, "  \"bus_us\": {");
+    for (uint8_t i = 0; i < sizeof(reads) / sizeof(reads[0]); i++)
+    {
+        SIM_DS18B20_FAULT(dev, reads[i].faultReads, reads[i].faultByte, reads[i].faultMask);
+        uint64_t start = SIM_NOW_NS();
+        int32_t temperature = DS18B20_READ_TEMP(BENCH_BUS_PIN, rom);
+        uint64_t elapsed = SIM_NOW_NS() - start;
+        if (temperature != reads[i].expect)
+        {
+            fprintf(stderr, "%s read returned %d, expected %d\n", reads[i].name, temperature, reads[i].expect);
+            ok = false;
+        }
+        fprintf(out, "%s\"%s\": %.1f", i ? ", " : "", reads[i].name, elapsed / 1e3);
+    }
+    fprintf(out, "},\n");
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t reps = 5;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+        {
+            reps = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+    }
+    if (reps == 0)
+    {
+        fprintf(stderr, "usage: bench_crc [--reps R]\n");
+        return EXIT_FAILURE;
+    }
+    SIM_STDIO_QUIET(true);
+
+    uint32_t seed = 0x2C9277B5u;
+    for (uint32_t i = 0; i < BENCH_BLOCKS; i++)
+    {
+        for (uint8_t j = 0; j < DS18B20_SCRATCHPAD_LEN - 1; j++)
+        {
+            timedPads[i][j] = (uint8_t)bench_rand(&seed);
+        }
+        timedPads[i][DS18B20_SCRATCHPAD_LEN - 1] = legacy_crc8(timedPads[i], DS18B20_SCRATCHPAD_LEN - 1);
+    }
+
+    uint64_t checked = 0;
+    uint64_t mismatches = bench_check(&seed, &checked);
+    double legacyNs = bench_time(legacy_crc8, reps);
+    double nibbleNs = bench_time(nibble_crc8, reps);
+    double tableNs = bench_time(table_crc8, reps);
+
+    FILE *out = stdout;
+    fprintf(out, "{\n");
+    fprintf(out, "  \"checked\": %llu,\n", (unsigned long long)checked);
+    fprintf(out, "  \"mismatches\": %llu,\n", (unsigned long long)mismatches);
+    bool busOk = bench_bus(out);
+    fprintf(out, "  \"reps\": %u,\n", reps);
+    fprintf(out, "  \"unit\": \"ns_per_scratchpad\",\n");
+    fprintf(out, "  \"bitwise\": %.3f,\n", legacyNs);
+    fprintf(out, "  \"nibble\": %.3f,\n", nibbleNs);
+    fprintf(out, "  \"table\": %.3f\n", tableNs);
+    fprintf(out, "}\n");
+    return (mismatches == 0 && busOk) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
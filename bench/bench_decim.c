@@ -0,0 +1,277 @@
+/*!
+*****************************************************************
+* @file    bench_decim.c
+* @brief   Water level decimation: the former float average and
+*          single-sample paths against the integer boxcar and
+*          CIC decimators, samples/s and noise as JSON
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "pico/stdlib.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_hal.h"
+#include "waterlevel.h"
+#include "bench_util.h"
+
+/*=========================================================*/
+/*== BENCH MACROS =========================================*/
+/*=========================================================*/
+
+#define BENCH_SAMPLES       (1u << 20)
+#define BENCH_VOLTS         0.5         /*!< Level probe of the simulation scenario */
+#define BENCH_NOISE_VOLTS   0.010
+#define BENCH_VREF          3.3
+
+/*=========================================================*/
+/*== PATHS ================================================*/
+/*=========================================================*/
+
+static uint16_t samples[BENCH_SAMPLES];
+static int32_t levels[BENCH_SAMPLES];
+
+/*!< Level per output in um, returns the number of outputs */
+typedef uint32_t (*BenchPath)(const uint16_t *in, uint32_t count, int32_t *level);
+
+/*!< The former WATERLEVEL_RUN: float volts per sample, mean of ADC_SAMPLES, cm */
+static __attribute__((noinline)) uint32_t path_float(const uint16_t *in, uint32_t count, int32_t *level)
+{
+    const float32_t conversion_factor = 3.3f / (1 << 12);
+    uint32_t outputs = 0;
+
+    for (uint32_t i = 0; i + ADC_SAMPLES <= count; i += ADC_SAMPLES)
+    {
+        float32_t buff = 0;
+        for (uint32_t j = 0; j < ADC_SAMPLES; j++)
+        {
+            buff += in[i + j] * conversion_factor;
+        }
+        float32_t volts = buff / ADC_SAMPLES;
+        level[outputs++] = (int32_t)(((volts - 0.08f) / (0.92f - 0.08f)) * 4 * 10000);
+    }
+    return outputs;
+}
+
+/*!< What the loop used until the stream: one ADC code per reading */
+static __attribute__((noinline)) uint32_t path_single(const uint16_t *in, uint32_t count, int32_t *level)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        level[i] = WATERLEVEL_UV_TO_UM(WATERLEVEL_RAW_TO_UV(in[i]));
+    }
+    return count;
+}
+
+static uint8_t decimOrder;
+static uint8_t decimRateBits;
+
+static __attribute__((noinline)) uint32_t path_decim(const uint16_t *in, uint32_t count, int32_t *level)
+{
+    static uint32_t q[BENCH_SAMPLES];
+    WATERLEVEL_Decim decim;
+
+    WATERLEVEL_DECIM_INIT(&decim, decimOrder, decimRateBits);
+    uint32_t outputs = 0;
+    for (uint32_t i = 0; i < count; i += WATERLEVEL_BLOCK_SAMPLES)
+    {
+        uint32_t n = (count - i < WATERLEVEL_BLOCK_SAMPLES) ? count - i : WATERLEVEL_BLOCK_SAMPLES;
+        outputs += WATERLEVEL_DECIM_RUN(&decim, &in[i], n, 1, &q[outputs]);
+    }
+    for (uint32_t i = 0; i < outputs; i++)
+    {
+        level[i] = WATERLEVEL_UV_TO_UM(WATERLEVEL_Q_TO_UV(q[i]));
+    }
+    return outputs;
+}
+
+/*=========================================================*/
+/*== RUNNER FUNCTIONS =====================================*/
+/*=========================================================*/
+
+typedef struct BenchCase
+{
+    const char *name;
+    BenchPath path;
+    uint8_t order;
+    uint8_t rateBits;
+} BenchCase;
+
+typedef struct BenchResult
+{
+    double samplesPerS;
+    double noiseUm;     /*!< Standard deviation of the outputs */
+    double biasUm;      /*!< Mean output against the true level */
+    uint32_t outputs;
+} BenchResult;
+
+static BenchResult bench_case(const BenchCase *c, double trueUm, uint32_t reps)
+{
+    BenchResult r = {0};
+    uint64_t best = UINT64_MAX;
+
+    decimOrder = c->order;
+    decimRateBits = c->rateBits;
+    for (uint32_t i = 0; i < reps; i++)
+    {
+        uint64_t start = SIM_WALL_NS();
+        r.outputs = c->path(samples, BENCH_SAMPLES, levels);
+        uint64_t elapsed = SIM_WALL_NS() - start;
+        benchSink = (uint32_t)levels[0];
+        best = elapsed < best ? elapsed : best;
+    }
+    r.samplesPerS = (double)BENCH_SAMPLES * 1e9 / (double)best;
+
+    double sum = 0;
+    double sumSq = 0;
+    for (uint32_t i = 0; i < r.outputs; i++)
+    {
+        sum += levels[i];
+        sumSq += (double)levels[i] * levels[i];
+    }
+    double mean = sum / r.outputs;
+    r.noiseUm = sqrt(fmax(sumSq / r.outputs - mean * mean, 0));
+    r.biasUm = mean - trueUm;
+    return r;
+}
+
+/*!< A constant input must come out as the same code in Q.WATERLEVEL_DECIM_FRAC_BITS, the boxcar as the exact block mean */
+static uint32_t bench_check(void)
+{
+    uint32_t mismatches = 0;
+    uint16_t flat[4 * WATERLEVEL_BLOCK_SAMPLES];
+    uint32_t q[4 * WATERLEVEL_BLOCK_SAMPLES + 1];
+    WATERLEVEL_Decim decim;
+
+    for (uint8_t order = 1; order <= WATERLEVEL_DECIM_MAX_ORDER; order++)
+    {
+        for (uint8_t rateBits = 0; WATERLEVEL_ADC_BITS + order * rateBits <= 32; rateBits++)
+        {
+            uint32_t count = (1u << rateBits) * (order + 2);
+            if (count > sizeof(flat) / sizeof(flat[0]))
+            {
+                break;
+            }
+            for (uint32_t i = 0; i < count; i++)
+            {
+                flat[i] = 4095;
+            }
+            WATERLEVEL_DECIM_INIT(&decim, order, rateBits);
+            uint32_t outputs = WATERLEVEL_DECIM_RUN(&decim, flat, count, 1, q);
+            if (outputs != 3 || q[outputs - 1] != (4095u << WATERLEVEL_DECIM_FRAC_BITS))
+            {
+                if (mismatches++ == 0)
+                {
+                    fprintf(stderr, "order %u rate 2^%u: %u outputs, last %u\n", order, rateBits, outputs,
+                            outputs ? q[outputs - 1] : 0);
+                }
+            }
+        }
+    }
+
+    WATERLEVEL_DECIM_INIT(&decim, 1, WATERLEVEL_BLOCK_BITS);
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i += WATERLEVEL_BLOCK_SAMPLES)
+    {
+        uint32_t sum = 0;
+        for (uint32_t j = 0; j < WATERLEVEL_BLOCK_SAMPLES; j++)
+        {
+            sum += samples[i + j];
+        }
+        WATERLEVEL_DECIM_RUN(&decim, &samples[i], WATERLEVEL_BLOCK_SAMPLES, 1, NULL);
+        uint64_t expect = ((uint64_t)sum << WATERLEVEL_DECIM_FRAC_BITS) >> WATERLEVEL_BLOCK_BITS;
+        if (decim.out != expect && mismatches++ == 0)
+        {
+            fprintf(stderr, "boxcar block %u: %u, mean %llu\n", i, decim.out, (unsigned long long)expect);
+        }
+    }
+    return mismatches;
+}
+
+int main(int argc, char **argv)
+{
+    static const BenchCase cases[] = {
+        {"single_sample", path_single, 0, 0},
+        {"float_mean_100", path_float, 0, 0},
+        {"boxcar_r128", path_decim, 1, 7},
+        {"cic2_r128", path_decim, 2, 7},
+        {"cic3_r64", path_decim, 3, 6},
+    };
+    uint32_t reps = 5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+        {
+            reps = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+    }
+    if (reps == 0)
+    {
+        fprintf(stderr, "usage: bench_decim [--reps R]\n");
+        return EXIT_FAILURE;
+    }
+    SIM_STDIO_QUIET(true);
+
+    /*!< Same input model as the simulated ADC: uniform noise, rounded to 12 bit */
+    uint32_t seed = 0x6A09E667u;
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++)
+    {
+        double noise = ((double)(int32_t)bench_rand(&seed) / 2147483648.0) * BENCH_NOISE_VOLTS;
+        int32_t code = (int32_t)((BENCH_VOLTS + noise) * 4096.0 / BENCH_VREF + 0.5);
+        samples[i] = (uint16_t)(code < 0 ? 0 : (code > 4095 ? 4095 : code));
+    }
+    double trueUm = (BENCH_VOLTS * 1e6 - WATERLEVEL_OFFSET_UV) / WATERLEVEL_UV_PER_UM;
+
+    uint32_t mismatches = bench_check();
+    WATERLEVEL_Decim probe;
+    bool rejected = WATERLEVEL_DECIM_INIT(&probe, 3, 8) != 0; /*!< 36 bit output */
+
+    FILE *out = stdout;
+    fprintf(out, "{\n");
+    fprintf(out, "  \"samples\": %u,\n", BENCH_SAMPLES);
+    fprintf(out, "  \"reps\": %u,\n", reps);
+    fprintf(out, "  \"noise_volts\": %.3f,\n", BENCH_NOISE_VOLTS);
+    fprintf(out, "  \"mismatches\": %u,\n", mismatches);
+    fprintf(out, "  \"paths\": {\n");
+
+    BenchResult single = {0};
+    uint8_t shown = 0;
+    for (uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        BenchResult r = bench_case(&cases[i], trueUm, reps);
+        if (cases[i].path == path_single)
+        {
+            single = r;
+        }
+        fprintf(out, "%s    \"%s\": {\"msamples_per_s\": %.1f, \"outputs\": %u, \"noise_um\": %.2f, \"bias_um\": %.1f",
+                shown++ ? ",\n" : "", cases[i].name, r.samplesPerS / 1e6, r.outputs, r.noiseUm, r.biasUm);
+        if (single.noiseUm > 0 && cases[i].path != path_single)
+        {
+            fprintf(out, ", \"noise_reduction\": %.1f", single.noiseUm / fmax(r.noiseUm, 1e-9));
+        }
+        fprintf(out, "}");
+    }
+    fprintf(out, "\n  }\n");
+    fprintf(out, "}\n");
+    return (mismatches == 0 && rejected) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,328 @@
+/*!
+*****************************************************************
+* @file    bench_derive.c
+* @brief   BME280 compensation on the derived coefficient block
+*          against the former formulas on the raw calibration,
+*          bit-exactness and cost as JSON
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_hal.h"
+#include "bme280.h"
+#include "bench_util.h"
+
+/*=========================================================*/
+/*== BENCH MACROS =========================================*/
+/*=========================================================*/
+
+#define BENCH_CALIBRATIONS  4         /*!< Datasheet set and randomized sensor-like sets */
+#define BENCH_P_TEMPS       16        /*!< Temperatures of the full pressure sweep */
+#define BENCH_H_TEMPS       64        /*!< Temperatures of the full humidity sweep */
+#define BENCH_TIMED_CALLS   (1u << 20)
+
+static BME280_Dev bme; /*!< Only calibration, raw values and t_fine are used */
+
+/*=========================================================*/
+/*== FORMER FORMULAS ======================================*/
+/*=========================================================*/
+
+/*!< Compensation as it was before BME280_COMP_DERIVE, casts and
+ *   shifts of the dig_* bitfields on every call. Kept out of line
+ *   like the driver functions, which live in another unit */
+static __attribute__((noinline)) int32_t legacy_tfine(const struct CompData *comp, int32_t adc_T)
+{
+    int32_t var1;
+    int32_t var2;
+
+    var1 = (((adc_T >> 3) - ((int32_t)comp->dig_T1 << 1)) * ((int32_t)comp->dig_T2)) >> 11;
+    var2 = ((adc_T >> 4) - ((int32_t)comp->dig_T1));
+    var2 = (var2 * ((adc_T >> 4) - ((int32_t)comp->dig_T1)) >> 12);
+    var2 = (var2 * ((int32_t)comp->dig_T3)) >> 14;
+
+    return var1 + var2;
+}
+
+static __attribute__((noinline)) uint32_t legacy_press(const struct CompData *comp, int32_t tFine, int32_t adc_P)
+{
+    int32_t var1;
+    int32_t var2;
+    int32_t pressure;
+
+    var1 = (((int32_t)tFine) >> 1) - (int32_t)64000;
+    var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * ((int32_t)comp->dig_P6);
+    var2 = var2 + ((var1 * ((int32_t)comp->dig_P5)) << 1);
+    var2 = (var2 >> 2) + (((int32_t)comp->dig_P4) << 16);
+    var1 = (((comp->dig_P3 * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) + ((((int32_t)comp->dig_P2) * var1) >> 1)) >> 18;
+
+    var1 = ((((32768 + var1)) * ((int32_t)comp->dig_P1)) >> 15);
+    if (var1 == 0)
+    {
+        return 0;
+    }
+    pressure = (((uint32_t)(((int32_t)1048576) - adc_P) - (var2 >> 12))) * 3125;
+    if (pressure < 0x80000000)
+    {
+        pressure = ((uint32_t)pressure << 1) / ((uint32_t)var1);
+    }
+    else
+    {
+        pressure = (pressure / (uint32_t)var1) * 2;
+    }
+    var1 = (((int32_t)comp->dig_P9) * ((int32_t)(((pressure >> 3) * (pressure >> 3)) >> 13))) >> 12;
+    var2 = (((int32_t)(pressure >> 2)) * ((int32_t)comp->dig_P8)) >> 13;
+    pressure = (uint32_t)((int32_t)pressure + ((var1 + var2 + comp->dig_P7) >> 4));
+    return pressure;
+}
+
+static uint32_t legacy_press64(const struct CompData *comp, int32_t tFine, int32_t adc_P)
+{
+    int64_t var1;
+    int64_t var2;
+    int64_t pressure;
+
+    var1 = ((int64_t)tFine) - 128000;
+    var2 = var1 * var1 * (int64_t)comp->dig_P6;
+    var2 = var2 + ((var1 * (int64_t)comp->dig_P5) << 17);
+    var2 = var2 + (((int64_t)comp->dig_P4) << 35);
+    var1 = ((var1 * var1 * (int64_t)comp->dig_P3) >> 8) + ((var1 * (int64_t)comp->dig_P2) << 12);
+    var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)comp->dig_P1) >> 33;
+    if (var1 == 0)
+    {
+        return 0;
+    }
+    pressure = 1048576 - adc_P;
+    pressure = (((pressure << 31) - var2) * 3125) / var1;
+    var1 = (((int64_t)comp->dig_P9) * (pressure >> 13) * (pressure >> 13)) >> 25;
+    var2 = (((int64_t)comp->dig_P8) * pressure) >> 19;
+    pressure = ((pressure + var1 + var2) >> 8) + (((int64_t)comp->dig_P7) << 4);
+    return (uint32_t)pressure;
+}
+
+static __attribute__((noinline)) uint32_t legacy_hum(const struct CompData *comp, int32_t tFine, int32_t adc_H)
+{
+    int32_t var_H;
+
+    int32_t var_H3 = ((int32_t)comp->dig_H3);
+    int32_t var_H4 = ((int32_t)comp->dig_H4) << 20;
+    int32_t var_H5 = ((int32_t)comp->dig_H5);
+    int32_t var_H6 = ((int32_t)comp->dig_H6);
+
+    var_H = (tFine - ((int32_t)76800));
+    var_H = (((((adc_H << 14) - var_H4 - (var_H5 * var_H)) + ((int32_t)16384)) >> 15) *
+             (((((((var_H * var_H6) >> 10) * (((var_H * var_H3) >> 11) + ((int32_t)32768))) >> 10) +
+                ((int32_t)2097152)) * ((int32_t)comp->dig_H2) + 8192) >> 14));
+    var_H = (var_H - (((((var_H >> 15) * (var_H >> 15)) >> 7) * ((int32_t)comp->dig_H1)) >> 4));
+    var_H = (var_H < 0 ? 0 : var_H);
+    var_H = (var_H > 419430400 ? 419430400 : var_H);
+
+    return (uint32_t)(var_H >> 12);
+}
+
+/*=========================================================*/
+/*== CHECK FUNCTIONS ======================================*/
+/*=========================================================*/
+
+/*!< Spread of production parts around the datasheet values */
+static void bench_calib_random(struct CompData *comp, uint32_t *seed)
+{
+    memset(comp, 0, sizeof(*comp));
+    comp->dig_T1 = (uint16_t)(27000 + bench_rand(seed) % 1500);
+    comp->dig_T2 = (int16_t)(25500 + bench_rand(seed) % 1500);
+    comp->dig_T3 = (int16_t)(-1000 + (int32_t)(bench_rand(seed) % 1050));
+    comp->dig_P1 = (uint16_t)(36000 + bench_rand(seed) % 2000);
+    comp->dig_P2 = (int16_t)(-10800 + (int32_t)(bench_rand(seed) % 300));
+    comp->dig_P3 = (int16_t)(3000 + bench_rand(seed) % 300);
+    comp->dig_P4 = (int16_t)(2000 + bench_rand(seed) % 7000);
+    comp->dig_P5 = (int16_t)(-200 + (int32_t)(bench_rand(seed) % 400));
+    comp->dig_P6 = (int16_t)(-7 + (int32_t)(bench_rand(seed) % 8));
+    comp->dig_P7 = (int16_t)(9900 + bench_rand(seed) % 5600);
+    comp->dig_P8 = (int16_t)(-14600 + (int32_t)(bench_rand(seed) % 6600));
+    comp->dig_P9 = (int16_t)(4000 + bench_rand(seed) % 2000);
+    comp->dig_H1 = (uint8_t)(bench_rand(seed) % 100);
+    comp->dig_H2 = (int16_t)(300 + bench_rand(seed) % 100);
+    comp->dig_H3 = (uint8_t)(bench_rand(seed) % 4);
+    comp->dig_H4 = (int16_t)(280 + bench_rand(seed) % 70);
+    comp->dig_H5 = (int16_t)(bench_rand(seed) % 50);
+    comp->dig_H6 = (int8_t)(20 + bench_rand(seed) % 20);
+}
+
+typedef struct BenchCount
+{
+    uint64_t checked;
+    uint64_t mismatches;
+} BenchCount;
+
+static void bench_expect(BenchCount *count, const char *what, uint32_t adcT, uint32_t adcX, uint32_t legacy,
+                         uint32_t derived)
+{
+    count->checked++;
+    if (legacy != derived && count->mismatches++ == 0)
+    {
+        fprintf(stderr, "%s mismatch at adc T %u / %u: legacy %u derived %u\n", what, adcT, adcX, legacy, derived);
+    }
+}
+
+/*!< Every raw temperature, every raw pressure and humidity at spread temperatures */
+static void bench_check(BenchCount *count, uint32_t *seed)
+{
+    for (uint32_t adcT = 0; adcT < (1u << 20); adcT++)
+    {
+        bme.temp = (int32_t)adcT;
+        bme.press = (int32_t)(bench_rand(seed) & 0xFFFFF);
+        bme.hum = (int32_t)(bench_rand(seed) & 0xFFFF);
+        int32_t temperature = BME280_COMP_TEMP(&bme);
+        int32_t tFine = legacy_tfine(&bme.comp, bme.temp);
+
+        bench_expect(count, "t_fine", adcT, 0, (uint32_t)tFine, (uint32_t)bme.t_fine);
+        bench_expect(count, "pressure", adcT, bme.press, legacy_press(&bme.comp, tFine, bme.press),
+                     BME280_COMP_PRESSURE(&bme));
+        bench_expect(count, "pressure64", adcT, bme.press, legacy_press64(&bme.comp, tFine, bme.press),
+                     BME280_COMP_PRESSURE_INT64(&bme));
+        bench_expect(count, "humidity", adcT, bme.hum, legacy_hum(&bme.comp, tFine, bme.hum),
+                     BME280_COMP_HUM_INT32(&bme));
+        (void)temperature;
+    }
+    for (uint32_t i = 0; i < BENCH_P_TEMPS; i++)
+    {
+        bme.temp = (int32_t)(i * ((1u << 20) / BENCH_P_TEMPS));
+        BME280_COMP_TEMP(&bme);
+        for (uint32_t adcP = 0; adcP < (1u << 20); adcP++)
+        {
+            bme.press = (int32_t)adcP;
+            bench_expect(count, "pressure", bme.temp, adcP, legacy_press(&bme.comp, bme.t_fine, bme.press),
+                         BME280_COMP_PRESSURE(&bme));
+        }
+    }
+    for (uint32_t i = 0; i < BENCH_H_TEMPS; i++)
+    {
+        bme.temp = (int32_t)(i * ((1u << 20) / BENCH_H_TEMPS));
+        BME280_COMP_TEMP(&bme);
+        for (uint32_t adcH = 0; adcH < (1u << 16); adcH++)
+        {
+            bme.hum = (int32_t)adcH;
+            bench_expect(count, "humidity", bme.temp, adcH, legacy_hum(&bme.comp, bme.t_fine, bme.hum),
+                         BME280_COMP_HUM_INT32(&bme));
+        }
+    }
+}
+
+/*=========================================================*/
+/*== RUNNER FUNCTIONS =====================================*/
+/*=========================================================*/
+
+static int32_t timedAdcT[BENCH_TIMED_CALLS];
+static int32_t timedAdcP[BENCH_TIMED_CALLS];
+static int32_t timedAdcH[BENCH_TIMED_CALLS];
+
+/*!< Best wall time of reps passes of temperature, pressure and humidity, ns per sample */
+static double bench_time(bool derived, uint32_t reps)
+{
+    uint64_t best = UINT64_MAX;
+
+    for (uint32_t r = 0; r < reps; r++)
+    {
+        uint32_t acc = 0;
+        uint64_t start = SIM_WALL_NS();
+        for (uint32_t i = 0; i < BENCH_TIMED_CALLS; i++)
+        {
+            if (derived)
+            {
+                bme.temp = timedAdcT[i];
+                bme.press = timedAdcP[i];
+                bme.hum = timedAdcH[i];
+                acc += (uint32_t)BME280_COMP_TEMP(&bme) + BME280_COMP_PRESSURE(&bme) + BME280_COMP_HUM_INT32(&bme);
+            }
+            else
+            {
+                int32_t tFine = legacy_tfine(&bme.comp, timedAdcT[i]);
+                acc += (uint32_t)tFine + legacy_press(&bme.comp, tFine, timedAdcP[i]) +
+                       legacy_hum(&bme.comp, tFine, timedAdcH[i]);
+            }
+        }
+        uint64_t elapsed = SIM_WALL_NS() - start;
+        benchSink = acc;
+        best = elapsed < best ? elapsed : best;
+    }
+    return (double)best / (double)BENCH_TIMED_CALLS;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t reps = 5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+        {
+            reps = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+    }
+    if (reps == 0)
+    {
+        fprintf(stderr, "usage: bench_derive [--reps R]\n");
+        return EXIT_FAILURE;
+    }
+
+    BenchCount count = {0};
+    uint32_t seed = 0x165667B1u;
+    for (uint32_t c = 0; c < BENCH_CALIBRATIONS; c++)
+    {
+        if (c == 0)
+        {
+            bench_calib(&bme.comp);
+        }
+        else
+        {
+            bench_calib_random(&bme.comp, &seed);
+        }
+        BME280_COMP_DERIVE(&bme.comp, &bme.derived);
+        bench_check(&count, &seed);
+    }
+
+    bench_calib(&bme.comp);
+    BME280_COMP_DERIVE(&bme.comp, &bme.derived);
+    for (uint32_t i = 0; i < BENCH_TIMED_CALLS; i++)
+    {
+        timedAdcT[i] = (int32_t)(bench_rand(&seed) & 0xFFFFF);
+        timedAdcP[i] = (int32_t)(bench_rand(&seed) & 0xFFFFF);
+        timedAdcH[i] = (int32_t)(bench_rand(&seed) & 0xFFFF);
+    }
+    double legacyNs = bench_time(false, reps);
+    double derivedNs = bench_time(true, reps);
+
+    printf("{\n");
+    printf("  \"calibrations\": %u,\n", BENCH_CALIBRATIONS);
+    printf("  \"checked\": %llu,\n", (unsigned long long)count.checked);
+    printf("  \"mismatches\": %llu,\n", (unsigned long long)count.mismatches);
+    printf("  \"reps\": %u,\n", reps);
+    printf("  \"unit\": \"ns_per_sample\",\n");
+    printf("  \"legacy\": %.3f,\n", legacyNs);
+    printf("  \"derived\": %.3f\n", derivedNs);
+    printf("}\n");
+
+    return count.mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,271 @@
+/*!
+*****************************************************************
+* @file    bench_fixed.c
+* @brief   Loop tail from sensor values to telemetry frames: the
+*          former float pipeline against the fixed-point one,
+*          agreement and cost per loop as JSON
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/uart.h"
+#include "hardware/irq.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_hal.h"
+#include "bme280.h"
+#include "waterlevel.h"
+#include "measure.h"
+#include "hc05.h"
+#include "bench_util.h"
+
+/*=========================================================*/
+/*== BENCH MACROS =========================================*/
+/*=========================================================*/
+
+#define BENCH_LOOPS         (1u << 16)
+#define BENCH_FORMAT_CHECKS (1u << 20)
+#define BENCH_TOL_LEN       32
+
+/*=========================================================*/
+/*== SAMPLE SET ===========================================*/
+/*=========================================================*/
+
+/*!< What the drivers hand to the loop: BME280 integers, ADC code, DS18B20 Q12.4 */
+typedef struct BenchInput
+{
+    int32_t temperature;
+    uint32_t pressure;
+    uint32_t humidity;
+    uint16_t levelRaw;
+    int32_t waterTemp;
+} BenchInput;
+
+static BenchInput inputs[BENCH_LOOPS];
+
+static void bench_fill(void)
+{
+    uint32_t seed = 0x1B873593u;
+
+    for (uint32_t i = 0; i < BENCH_LOOPS; i++)
+    {
+        inputs[i].temperature = (int32_t)(bench_rand(&seed) % 5000) - 1000;
+        inputs[i].pressure = 90000 + bench_rand(&seed) % 30000;
+        inputs[i].humidity = bench_rand(&seed) % (100u << 10);
+        inputs[i].levelRaw = (uint16_t)(bench_rand(&seed) & 0xFFF);
+        inputs[i].waterTemp = (int32_t)(bench_rand(&seed) % 1600) - 160;
+    }
+}
+
+/*=========================================================*/
+/*== FLOAT PIPELINE =======================================*/
+/*=========================================================*/
+
+/*!< Former waterpipe.c/hc05.c path, with telemetry buffers large enough for gcvt */
+static uint8_t bench_float_loop(const BenchInput *in, uint8_t *frame, uint8_t *tol)
+{
+    const float32_t conversion_factor = 3.3f / (1 << 12);
+    float32_t hcTemp = in->temperature / 100.0f;
+    float32_t hcPress = in->pressure / 100.0f;
+    float32_t hcHum = in->humidity / 1024.0f;
+    float32_t waterLevel = (((in->levelRaw * conversion_factor) - 0.08f) / (0.92f - 0.08f)) * 4;
+    float32_t waterTemp = (float32_t)(in->waterTemp / 16.0f);
+    uint8_t alarms = 0;
+    uint8_t field[16];
+
+    snprintf((char *)tol, BENCH_TOL_LEN, "%f", 30.0f - hcTemp);
+    alarms |= (hcTemp >= 30.0f) ? MEASURE_ALARM_TEMP : 0;
+    snprintf((char *)tol, BENCH_TOL_LEN, "%f", 1100.0f - hcPress);
+    alarms |= (hcPress >= 1100.0f) ? MEASURE_ALARM_PRESS : 0;
+    snprintf((char *)tol, BENCH_TOL_LEN, "%f", 30.0f - hcHum);
+    alarms |= (hcHum >= 30.0f) ? MEASURE_ALARM_HUM : 0;
+    snprintf((char *)tol, BENCH_TOL_LEN, "%f", 3.5f - waterLevel);
+    alarms |= (waterLevel >= 3.5f) ? MEASURE_ALARM_LEVEL : 0;
+    snprintf((char *)tol, BENCH_TOL_LEN, "%f", 25.0f - waterTemp);
+    alarms |= (waterTemp >= 25.0f) ? MEASURE_ALARM_WTEMP : 0;
+
+    strcpy((char *)frame, "A:");
+    strcat((char *)frame, gcvt(hcTemp, 5, (char *)field));
+    strcat((char *)frame, HC05_FIELD_END "B:");
+    strcat((char *)frame, gcvt(hcPress, 7, (char *)field));
+    strcat((char *)frame, HC05_FIELD_END "C:");
+    strcat((char *)frame, gcvt(hcHum, 5, (char *)field));
+    strcat((char *)frame, HC05_FIELD_END "E:");
+    strcat((char *)frame, gcvt(waterLevel, 2, (char *)field));
+    strcat((char *)frame, HC05_FIELD_END "D:");
+    strcat((char *)frame, gcvt(waterTemp, 5, (char *)field));
+    strcat((char *)frame, HC05_FIELD_END);
+    return alarms;
+}
+
+/*=========================================================*/
+/*== FIXED-POINT PIPELINE =================================*/
+/*=========================================================*/
+
+static uint8_t bench_fixed_loop(const BenchInput *in, uint8_t *frame, uint8_t *tol)
+{
+    MeasureSample sample;
+    sample.temperature = in->temperature;
+    sample.pressure = in->pressure;
+    sample.humidity = in->humidity;
+    sample.waterLevel = WATERLEVEL_UV_TO_UM(WATERLEVEL_RAW_TO_UV(in->levelRaw));
+    sample.waterTemp = in->waterTemp;
+
+    uint8_t alarms = MEASURE_ALARMS(&sample);
+    MEASURE_FORMAT(tol, MEASURE_TEMP_MAX - sample.temperature, 2);
+    MEASURE_FORMAT(tol, (int32_t)MEASURE_PRESS_MAX - (int32_t)sample.pressure, 2);
+    MEASURE_FORMAT(tol, MEASURE_HUM_TO_MILLI((int32_t)MEASURE_HUM_MAX - (int32_t)sample.humidity), 3);
+    MEASURE_FORMAT(tol, MEASURE_LEVEL_TO_CENTI(MEASURE_LEVEL_MAX - sample.waterLevel), 2);
+    MEASURE_FORMAT(tol, MEASURE_WTEMP_TO_CENTI(MEASURE_WTEMP_MAX - sample.waterTemp), 2);
+
+    uint8_t len = HC05_ENCODE_BME280(frame, sample.temperature, sample.pressure, sample.humidity);
+    len += HC05_ENCODE_WATERLEVEL(&frame[len], sample.waterLevel);
+    HC05_ENCODE_DS18B20(&frame[len], sample.waterTemp);
+    return alarms;
+}
+
+/*=========================================================*/
+/*== RUNNER FUNCTIONS =====================================*/
+/*=========================================================*/
+
+/*!< Best wall time of reps passes over the inputs, ns per loop */
+static double bench_time(uint8_t (*loop)(const BenchInput *, uint8_t *, uint8_t *), uint32_t reps)
+{
+    uint8_t frame[2 * HC05_FRAME_LEN];
+    uint8_t tol[BENCH_TOL_LEN];
+    uint64_t best = UINT64_MAX;
+
+    for (uint32_t r = 0; r < reps; r++)
+    {
+        uint32_t acc = 0;
+        uint64_t start = SIM_WALL_NS();
+        for (uint32_t i = 0; i < BENCH_LOOPS; i++)
+        {
+            acc += loop(&inputs[i], frame, tol) + frame[2] + tol[0];
+        }
+        uint64_t elapsed = SIM_WALL_NS() - start;
+        benchSink = acc;
+        best = elapsed < best ? elapsed : best;
+    }
+    return (double)best / (double)BENCH_LOOPS;
+}
+
+/*!< MEASURE_FORMAT against printf on random values and all decimal counts in use */
+static uint32_t bench_check_format(void)
+{
+    static const int32_t edges[] = {0, -1, INT32_MIN, INT32_MAX};
+    uint32_t seed = 0x85EBCA6Bu;
+    uint32_t mismatches = 0;
+    uint8_t fixed[MEASURE_FORMAT_LEN + 1];
+    char reference[MEASURE_FORMAT_LEN + 2];
+
+    for (uint32_t i = 0; i < BENCH_FORMAT_CHECKS; i++)
+    {
+        int32_t value = (i < 4) ? edges[i] : (int32_t)bench_rand(&seed) >> (i % 31);
+        uint8_t decimals = (uint8_t)(i % 4);
+        int64_t magnitude = value < 0 ? -(int64_t)value : value;
+        int64_t scale = decimals == 0 ? 1 : decimals == 1 ? 10 : decimals == 2 ? 100 : 1000;
+
+        if (decimals == 0)
+        {
+            snprintf(reference, sizeof(reference), "%d", value);
+        }
+        else
+        {
+            snprintf(reference, sizeof(reference), "%s%lld.%0*lld", value < 0 ? "-" : "",
+                     (long long)(magnitude / scale), decimals, (long long)(magnitude % scale));
+        }
+        uint8_t len = MEASURE_FORMAT(fixed, value, decimals);
+        if (strcmp((const char *)fixed, reference) != 0 || len != strlen(reference))
+        {
+            if (mismatches == 0)
+            {
+                fprintf(stderr, "format mismatch: %d/%u fixed \"%s\" reference \"%s\"\n", value, decimals, fixed,
+                        reference);
+            }
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t reps = 5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+        {
+            reps = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+    }
+    if (reps == 0)
+    {
+        fprintf(stderr, "usage: bench_fixed [--reps R]\n");
+        return EXIT_FAILURE;
+    }
+
+    bench_fill();
+
+    /*!< Alarms must agree; the level may only differ where float and integer round across 3.5 cm */
+    uint32_t alarmMismatches = 0;
+    uint32_t levelFlips = 0;
+    int32_t levelMaxErr = 0;
+    for (uint32_t i = 0; i < BENCH_LOOPS; i++)
+    {
+        uint8_t frame[2 * HC05_FRAME_LEN];
+        uint8_t tol[BENCH_TOL_LEN];
+        uint8_t alarmsFloat = bench_float_loop(&inputs[i], frame, tol);
+        uint8_t alarmsFixed = bench_fixed_loop(&inputs[i], frame, tol);
+        uint8_t diff = alarmsFloat ^ alarmsFixed;
+
+        alarmMismatches += (diff & (uint8_t)~MEASURE_ALARM_LEVEL) != 0;
+        levelFlips += (diff & MEASURE_ALARM_LEVEL) != 0;
+
+        float32_t levelFloat = (((inputs[i].levelRaw * (3.3f / (1 << 12))) - 0.08f) / (0.92f - 0.08f)) * 4;
+        int32_t levelFixed = WATERLEVEL_UV_TO_UM(WATERLEVEL_RAW_TO_UV(inputs[i].levelRaw));
+        int32_t err = abs(levelFixed - (int32_t)(levelFloat * MEASURE_UM_PER_CM));
+        levelMaxErr = err > levelMaxErr ? err : levelMaxErr;
+    }
+    uint32_t formatMismatches = bench_check_format();
+
+    double floatNs = bench_time(bench_float_loop, reps);
+    double fixedNs = bench_time(bench_fixed_loop, reps);
+
+    printf("{\n");
+    printf("  \"loops\": %u,\n", BENCH_LOOPS);
+    printf("  \"reps\": %u,\n", reps);
+    printf("  \"unit\": \"ns_per_loop\",\n");
+    printf("  \"float\": %.3f,\n", floatNs);
+    printf("  \"fixed\": %.3f,\n", fixedNs);
+    printf("  \"speedup\": %.2f,\n", floatNs / fixedNs);
+    printf("  \"alarm_mismatches\": %u,\n", alarmMismatches);
+    printf("  \"level_alarm_flips\": %u,\n", levelFlips);
+    printf("  \"level_max_err_um\": %d,\n", levelMaxErr);
+    printf("  \"format_mismatches\": %u\n", formatMismatches);
+    printf("}\n");
+
+    return (alarmMismatches == 0 && formatMismatches == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,97 @@
+/*!
+*****************************************************************
+* @file    bench_heap.c
+* @brief   Asserts that steady-state main loop iterations do not
+*          touch the heap on either core
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_hal.h"
+
+/*!< waterpipe.c's main(), renamed by the host build */
+int waterpipe_main(void);
+
+/*=========================================================*/
+/*== RUNNER FUNCTIONS =====================================*/
+/*=========================================================*/
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = 20;
+    uint32_t warmup = 2;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+        {
+            warmup = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            iterations = (uint32_t)strtoul(argv[i], NULL, 0);
+        }
+    }
+    if (warmup + iterations > SIM_MAX_ITERATIONS)
+    {
+        fprintf(stderr, "at most %u iterations including warmup\n", SIM_MAX_ITERATIONS);
+        return EXIT_FAILURE;
+    }
+
+    SIM_RESET();
+    SIM_SCENARIO_DEFAULT();
+    SIM_STDIO_QUIET(true);
+
+    uint32_t done = (uint32_t)SIM_RUN_FIRMWARE(waterpipe_main, warmup + iterations);
+    FILE *out = SIM_REPORT_STREAM();
+    if (done != warmup + iterations)
+    {
+        fprintf(stderr, "firmware stopped after %u iterations\n", done);
+        return EXIT_FAILURE;
+    }
+
+    /*!< Start-up allocations (stdio buffers, warmup) are reported, not judged */
+    uint32_t startupAllocs = SIM_STATS(0)->heapAllocs + SIM_STATS(1)->heapAllocs;
+    uint32_t failed = 0;
+    uint32_t allocs = 0;
+    uint64_t bytes = 0;
+
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        const SimIteration *it = SIM_ITERATION(warmup + i);
+        uint32_t n = it->stats.heapAllocs + it->core1.heapAllocs;
+        startupAllocs -= n;
+        allocs += n;
+        bytes += it->stats.heapBytes + it->core1.heapBytes;
+        if (n != 0 || it->stats.heapFrees + it->core1.heapFrees != 0)
+        {
+            failed++;
+            fprintf(stderr, "iteration %u: %u allocations (%u core 1), %u frees\n", warmup + i, n,
+                    it->core1.heapAllocs, it->stats.heapFrees + it->core1.heapFrees);
+        }
+    }
+
+    fprintf(out, "{\n  \"iterations\": %u,\n  \"warmup\": %u,\n  \"startup_allocs\": %u,\n", iterations, warmup,
+            startupAllocs);
+    fprintf(out, "  \"steady_allocs\": %u,\n  \"steady_bytes\": %llu,\n  \"failed_iterations\": %u\n}\n", allocs,
+            (unsigned long long)bytes, failed);
+    fflush(out);
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,241 @@
+/*!
+*****************************************************************
+* @file    bench_hum.c
+* @brief   BME280 humidity compensation: int32 and precomputed
+*          coefficient paths against the double reference, error
+*          and cost as JSON
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_TSC() __rdtsc()
+#else
+#define BENCH_TSC() 0ull
+#endif
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_hal.h"
+#include "bme280.h"
+#include "bench_util.h"
+
+/*=========================================================*/
+/*== BENCH MACROS =========================================*/
+/*=========================================================*/
+
+#define BENCH_ADC_T_STEP    4096u /*!< 256 temperatures over the 20 bit range */
+#define BENCH_ADC_H_STEP    16u   /*!< 4096 humidities over the 16 bit range */
+#define BENCH_TIMED_CALLS   (1u << 20)
+
+enum
+{
+    BENCH_INT32,
+    BENCH_PRECOMP,
+    BENCH_PRECOMP_STEADY,
+    BENCH_DOUBLE,
+    BENCH_VARIANTS
+};
+
+static BME280_Dev bme; /*!< Only calibration, raw values and t_fine are used */
+
+/*=========================================================*/
+/*== REFERENCE ============================================*/
+/*=========================================================*/
+
+/*!< Floating point formula of the datasheet (8.1), formerly
+ *   BME280_COMP_HUM_DOUBLE of the driver, now host only. The
+ *   dig_H6/dig_H3 term takes t_fine - 76800 like the datasheet,
+ *   the driver version used the partial humidity there. */
+static double bench_hum_double(void)
+{
+    int32_t adc_H = bme.hum;
+    double var_T = (((double)bme.t_fine) - 76800.0);
+    double var_H;
+    var_H = (adc_H - (((double)bme.comp.dig_H4) * 64.0 + ((double)bme.comp.dig_H5) / 16384.0 * var_T));
+    var_H = var_H * (((double)bme.comp.dig_H2) / 65536.0);
+    var_H = var_H * (1.0 + ((double)bme.comp.dig_H6) / 67108864.0 * var_T * (1.0 + ((double)bme.comp.dig_H3) / 67108864.0 * var_T));
+    var_H = var_H * (1.0 - ((double)bme.comp.dig_H1) * var_H / 524288.0);
+
+    if (var_H > 100.0)
+    {
+        var_H = 100.0;
+    }
+    else if (var_H < 0.0)
+    {
+        var_H = 0.0;
+    }
+
+    return var_H;
+}
+
+/*=========================================================*/
+/*== RUNNER FUNCTIONS =====================================*/
+/*=========================================================*/
+
+static int32_t timedAdcH[BENCH_TIMED_CALLS];
+static int32_t timedFine[BENCH_TIMED_CALLS];
+
+typedef struct BenchCost
+{
+    double ns;
+    double tsc;
+} BenchCost;
+
+/*!< Best of reps passes over the timed inputs, per call */
+static BenchCost bench_time(int variant, uint32_t reps)
+{
+    uint64_t bestNs = UINT64_MAX;
+    uint64_t bestTsc = UINT64_MAX;
+
+    for (uint32_t r = 0; r < reps; r++)
+    {
+        uint32_t acc = 0;
+        double accD = 0.0;
+        uint64_t start = SIM_WALL_NS();
+        uint64_t startTsc = BENCH_TSC();
+        for (uint32_t i = 0; i < BENCH_TIMED_CALLS; i++)
+        {
+            bme.t_fine = (variant == BENCH_PRECOMP_STEADY) ? timedFine[0] : timedFine[i];
+            bme.hum = timedAdcH[i];
+            switch (variant)
+            {
+            case BENCH_INT32:
+                acc += BME280_COMP_HUM_INT32(&bme);
+                break;
+            case BENCH_PRECOMP:
+            case BENCH_PRECOMP_STEADY:
+                acc += BME280_COMP_HUM_PRECOMP(&bme);
+                break;
+            default:
+                accD += bench_hum_double();
+                break;
+            }
+        }
+        uint64_t elapsedTsc = BENCH_TSC() - startTsc;
+        uint64_t elapsed = SIM_WALL_NS() - start;
+        benchSink = acc + (uint32_t)accD;
+        bestNs = elapsed < bestNs ? elapsed : bestNs;
+        bestTsc = elapsedTsc < bestTsc ? elapsedTsc : bestTsc;
+    }
+    return (BenchCost){(double)bestNs / BENCH_TIMED_CALLS, (double)bestTsc / BENCH_TIMED_CALLS};
+}
+
+static void bench_print(const char *name, BenchCost cost, double maxErr, const char *tail)
+{
+    printf("  \"%s\": {\"ns_per_call\": %.3f, \"tsc_per_call\": %.1f", name, cost.ns, cost.tsc);
+    if (maxErr >= 0.0)
+    {
+        printf(", \"max_abs_err_rh\": %.5f", maxErr);
+    }
+    printf("}%s\n", tail);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t reps = 5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+        {
+            reps = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+    }
+    if (reps == 0)
+    {
+        fprintf(stderr, "usage: bench_hum [--reps R]\n");
+        return EXIT_FAILURE;
+    }
+
+    bench_calib(&bme.comp);
+    BME280_COMP_DERIVE(&bme.comp, &bme.derived);
+
+    /*!< Accuracy over the raw grid inside the -40..85 degC range, the precomputed path must be bit-exact */
+    double maxErr = 0.0;
+    double sumErr = 0.0;
+    uint64_t points = 0;
+    uint64_t mismatches = 0;
+
+    for (uint32_t adcT = 0; adcT < (1u << 20); adcT += BENCH_ADC_T_STEP)
+    {
+        bme.temp = (int32_t)adcT;
+        int32_t temperature = BME280_COMP_TEMP(&bme);
+        if (temperature <= -4000 || temperature >= 8500)
+        {
+            continue;
+        }
+        for (uint32_t adcH = 0; adcH < (1u << 16); adcH += BENCH_ADC_H_STEP)
+        {
+            bme.hum = (int32_t)adcH;
+            uint32_t h32 = BME280_COMP_HUM_INT32(&bme);
+            uint32_t hPre = BME280_COMP_HUM_PRECOMP(&bme);
+            double diff = fabs((double)h32 / 1024.0 - bench_hum_double());
+
+            if (hPre != h32 && mismatches++ == 0)
+            {
+                fprintf(stderr, "mismatch at adc T/H %u/%u: int32 %u precomp %u\n", adcT, adcH, h32, hPre);
+            }
+            maxErr = diff > maxErr ? diff : maxErr;
+            sumErr += diff;
+            points++;
+        }
+    }
+
+    /*!< Throughput on random readings inside the temperature range */
+    uint32_t seed = 0x27D4EB2Fu;
+    for (uint32_t i = 0; i < BENCH_TIMED_CALLS;)
+    {
+        bme.temp = (int32_t)(bench_rand(&seed) & 0xFFFFF);
+        int32_t temperature = BME280_COMP_TEMP(&bme);
+        if (temperature > -4000 && temperature < 8500)
+        {
+            timedFine[i] = bme.t_fine;
+            timedAdcH[i] = (int32_t)(bench_rand(&seed) & 0xFFFF);
+            i++;
+        }
+    }
+    BenchCost cost[BENCH_VARIANTS];
+    for (int v = 0; v < BENCH_VARIANTS; v++)
+    {
+        cost[v] = bench_time(v, reps);
+    }
+
+    printf("{\n");
+    printf("  \"grid\": {\"adc_t_step\": %u, \"adc_h_step\": %u, \"points\": %llu},\n", BENCH_ADC_T_STEP,
+           BENCH_ADC_H_STEP, (unsigned long long)points);
+    printf("  \"timed_calls\": %u,\n", BENCH_TIMED_CALLS);
+    printf("  \"reps\": %u,\n", reps);
+    printf("  \"mean_abs_err_rh\": %.5f,\n", sumErr / (double)points);
+    printf("  \"precomp_mismatches\": %llu,\n", (unsigned long long)mismatches);
+    bench_print("int32", cost[BENCH_INT32], maxErr, ",");
+    bench_print("precomp", cost[BENCH_PRECOMP], maxErr, ",");
+    bench_print("precomp_steady_t_fine", cost[BENCH_PRECOMP_STEADY], maxErr, ",");
+    bench_print("double", cost[BENCH_DOUBLE], 0.0, "");
+    printf("}\n");
+
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,187 @@
+/*!
+*****************************************************************
+* @file    bench_loop.c
+* @brief   Per-stage cycle budget of the main acquisition loop,
+*          reported as JSON on stdout
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_hal.h"
+
+/*!< waterpipe.c's main(), renamed by the host build */
+int waterpipe_main(void);
+
+/*=========================================================*/
+/*== STATISTIC FUNCTIONS ==================================*/
+/*=========================================================*/
+
+static uint64_t samples[SIM_MAX_ITERATIONS];
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/*!
+**************************************************************
+ * @brief Nearest-rank percentile of the first count samples,
+ * sorts the sample buffer in place
+**************************************************************
+ */
+static uint64_t percentile(uint32_t count, uint32_t pct)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    qsort(samples, count, sizeof(samples[0]), cmp_u64);
+    uint32_t rank = (pct * count + 99) / 100;
+    return samples[rank > 0 ? rank - 1 : 0];
+}
+
+static void print_dist(FILE *out, const char *key, uint32_t count, const char *tail)
+{
+    uint64_t min = percentile(count, 0);
+    uint64_t med = percentile(count, 50);
+    uint64_t p99 = percentile(count, 99);
+    fprintf(out, "\"%s\": {\"min\": %.3f, \"median\": %.3f, \"p99\": %.3f}%s", key, min / 1e3, med / 1e3,
+            p99 / 1e3, tail);
+}
+
+/*=========================================================*/
+/*== RUNNER FUNCTIONS =====================================*/
+/*=========================================================*/
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = 20;
+    uint32_t warmup = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+        {
+            warmup = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            iterations = (uint32_t)strtoul(argv[i], NULL, 0);
+        }
+    }
+    if (warmup + iterations > SIM_MAX_ITERATIONS)
+    {
+        fprintf(stderr, "at most %u iterations including warmup\n", SIM_MAX_ITERATIONS);
+        return EXIT_FAILURE;
+    }
+
+    SIM_RESET();
+    SIM_SCENARIO_DEFAULT();
+    SIM_STDIO_QUIET(true);
+
+    uint32_t done = (uint32_t)SIM_RUN_FIRMWARE(waterpipe_main, warmup + iterations);
+    FILE *out = SIM_REPORT_STREAM();
+    if (done != warmup + iterations)
+    {
+        fprintf(stderr, "firmware stopped after %u iterations\n", done);
+        return EXIT_FAILURE;
+    }
+
+    /*!< Whole loop */
+    uint64_t sleepNs = 0, workNs = 0;
+    uint64_t i2cTx = 0, i2cRx = 0, uartTx = 0, uartRx = 0, oneWire = 0, adc = 0, heap = 0;
+    fprintf(out, "{\n  \"iterations\": %u,\n  \"warmup\": %u,\n  \"unit\": \"us\",\n", iterations, warmup);
+    fprintf(out, "  \"loop\": {");
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        const SimIteration *it = SIM_ITERATION(warmup + i);
+        samples[i] = it->endNs - it->startNs;
+        sleepNs += it->stats.timeNs[SIM_TIME_SLEEP];
+        workNs += (it->endNs - it->startNs) - it->stats.timeNs[SIM_TIME_SLEEP];
+        i2cTx += it->stats.i2cTxBytes;
+        i2cRx += it->stats.i2cRxBytes;
+        uartTx += it->stats.uartTxBytes;
+        uartRx += it->stats.uartRxBytes;
+        oneWire += it->stats.oneWireSlots;
+        adc += it->stats.adcSamples;
+        heap += it->stats.heapAllocs + it->core1.heapAllocs;
+    }
+    print_dist(out, "virtual", iterations, ", ");
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        samples[i] = SIM_ITERATION(warmup + i)->wallNs;
+    }
+    print_dist(out, "wall", iterations, ", ");
+    fprintf(out, "\"sleep_us\": %.3f, \"working_us\": %.3f, ", sleepNs / 1e3 / iterations,
+            workNs / 1e3 / iterations);
+    fprintf(out, "\"i2c_tx_bytes\": %.1f, \"i2c_rx_bytes\": %.1f, \"uart_tx_bytes\": %.1f, "
+                 "\"uart_rx_bytes\": %.1f, \"onewire_slots\": %.1f, \"adc_samples\": %.1f, \"heap_allocs\": %.1f},\n",
+            (double)i2cTx / iterations, (double)i2cRx / iterations, (double)uartTx / iterations,
+            (double)uartRx / iterations, (double)oneWire / iterations, (double)adc / iterations,
+            (double)heap / iterations);
+
+    /*!< Per stage, averages of the bus counters per iteration */
+    fprintf(out, "  \"stages\": {\n");
+    for (uint8_t s = 0; s < SIM_STAGE_COUNT(); s++)
+    {
+        uint32_t count = 0;
+        uint64_t stageSleep = 0, stageI2cTx = 0, stageI2cRx = 0, stageUart = 0, stageOneWire = 0;
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            const SimStage *st = SIM_STAGE_RECORD(warmup + i, s);
+            if (st->seen)
+            {
+                samples[count++] = st->virtualNs;
+                stageSleep += st->stats.timeNs[SIM_TIME_SLEEP];
+                stageI2cTx += st->stats.i2cTxBytes;
+                stageI2cRx += st->stats.i2cRxBytes;
+                stageUart += st->stats.uartTxBytes;
+                stageOneWire += st->stats.oneWireSlots;
+            }
+        }
+        double n = count ? count : 1;
+        fprintf(out, "    \"%s\": {\"runs\": %u, ", SIM_STAGE_NAME(s), count);
+        print_dist(out, "virtual", count, ", ");
+        count = 0;
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            const SimStage *st = SIM_STAGE_RECORD(warmup + i, s);
+            if (st->seen)
+            {
+                samples[count++] = st->wallNs;
+            }
+        }
+        print_dist(out, "wall", count, ", ");
+        fprintf(out, "\"sleep_us\": %.3f, \"i2c_tx_bytes\": %.1f, \"i2c_rx_bytes\": %.1f, "
+                     "\"uart_tx_bytes\": %.1f, \"onewire_slots\": %.1f}%s\n",
+                stageSleep / 1e3 / n, stageI2cTx / n, stageI2cRx / n, stageUart / n, stageOneWire / n,
+                s + 1 < SIM_STAGE_COUNT() ? "," : "");
+    }
+    fprintf(out, "  },\n");
+
+    /*!< Core 1 serves the FIFO interrupt, 1-Wire traffic there means a blocking readout */
+    const SimStats *core1 = SIM_STATS(1);
+    fprintf(out, "  \"core1\": {\"sleep_us\": %.3f, \"onewire_resets\": %u, \"onewire_slots\": %u}\n}\n",
+            core1->timeNs[SIM_TIME_SLEEP] / 1e3, core1->oneWireResets, core1->oneWireSlots);
+    fflush(out);
+
+    return EXIT_SUCCESS;
+}
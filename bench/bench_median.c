@@ -0,0 +1,376 @@
+/*!
+*****************************************************************
+* @file    bench_median.c
+* @brief   Water level despiking: the running median of 5 ahead
+*          of the mean and the CIC decimator, against the plain
+*          paths, on captured-shape traces and a long spiky
+*          signal. Error and time per DMA block as JSON
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "pico/stdlib.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_hal.h"
+#include "waterlevel.h"
+#include "bench_util.h"
+
+/*=========================================================*/
+/*== BENCH MACROS =========================================*/
+/*=========================================================*/
+
+#define BENCH_SAMPLES       (1u << 20)
+#define BENCH_VOLTS         0.5         /*!< Level probe of the simulation scenario */
+#define BENCH_NOISE_VOLTS   0.010
+#define BENCH_VREF          3.3
+#define BENCH_SPIKE_PERMIL  20          /*!< Spike bursts per 1000 samples */
+#define BENCH_LANE_SAMPLES  (WATERLEVEL_BLOCK_SAMPLES >> WATERLEVEL_CHANNEL_BITS)
+#define BENCH_BLOCK_US      25600.0     /*!< DMA block period at WATERLEVEL_STREAM_CLKDIV */
+
+/*=========================================================*/
+/*== TEST VECTORS =========================================*/
+/*=========================================================*/
+
+/*!< Level lane, splashes: single and double spikes to full scale and a dropout */
+static const uint16_t traceSplash[] = {
+     619,  618,  620,  622,  617,  617,  623,  621,  617, 4095,  621,  617,  621,  618,  617,  617,
+     620,  620,  617,  618,  617,  621,  620, 3100, 3310,  621,  617,  618,  622,  622,  621,  617,
+     621,  621,  620,  617,  618,    0,  621,  623,  618,  619,  620,  618,  621,  617,  621,  619,
+     621,  623, 2870, 4095,  617,  621,  621,  622,  618,  619,  617,  621,  622,  617,  621,  617,
+};
+
+/*!< Level lane, pump vibration: one-sample kicks every 8 samples */
+static const uint16_t tracePump[] = {
+     621,  618,  620,  932,  621,  620,  623,  619,  620,  621,  620,  329,  619,  618,  623,  618,
+     622,  623,  618,  927,  621,  619,  621,  620,  619,  622,  620,  329,  621,  617,  617,  621,
+     620,  618,  623,  929,  618,  620,  620,  617,  622,  617,  623,  331,  621,  623,  623,  619,
+     619,  622,  619,  931,  620,  621,  623,  620,  617,  623,  617,  329,  620,  622,  622,  617,
+};
+
+/*!< Level lane, the level rises by 124 codes mid-trace, with a spike and a double dropout */
+static const uint16_t traceStep[] = {
+     617,  622,  622,  619,  622,  621,  622,  623,  620,  619,  622,  620, 4095,  619,  617,  620,
+     619,  618,  621,  617,  620,  617,  618,  623,  619,  618,  622,  618,  620,  620,  623,  620,
+     741,  742,  744,  744,  745,  743,  742,  747,    0,    0,  745,  743,  746,  744,  743,  746,
+     744,  742,  742,  741,  742,  742,  742,  746,  742,  741,  744,  747,  745,  742,  743,  743,
+};
+
+typedef struct BenchTrace
+{
+    const char *name;
+    const uint16_t *codes;
+    uint32_t count;
+    uint16_t lo;        /*!< Band of the clean signal, every despiked sample must stay inside */
+    uint16_t hi;
+} BenchTrace;
+
+/*=========================================================*/
+/*== CHECK FUNCTIONS ======================================*/
+/*=========================================================*/
+
+static int cmp_u16(const void *a, const void *b)
+{
+    return (int)*(const uint16_t *)a - (int)*(const uint16_t *)b;
+}
+
+/*!< Median of the last WATERLEVEL_MEDIAN_TAPS inputs by sorting, the first sample repeated before the start */
+static uint16_t ref_median(const uint16_t *in, uint32_t i)
+{
+    uint16_t win[WATERLEVEL_MEDIAN_TAPS];
+    for (uint32_t k = 0; k < WATERLEVEL_MEDIAN_TAPS; k++)
+    {
+        win[k] = (i + k >= WATERLEVEL_MEDIAN_TAPS - 1) ? in[i + k - (WATERLEVEL_MEDIAN_TAPS - 1)] : in[0];
+    }
+    qsort(win, WATERLEVEL_MEDIAN_TAPS, sizeof(win[0]), cmp_u16);
+    return win[WATERLEVEL_MEDIAN_TAPS >> 1];
+}
+
+/*!< Network against the sort, split into chunks so the window carries over between calls */
+static uint32_t check_network(const uint16_t *in, uint32_t count, uint8_t chunk)
+{
+    static uint16_t out[BENCH_SAMPLES];
+    WATERLEVEL_Median median;
+    uint32_t mismatches = 0;
+
+    WATERLEVEL_MEDIAN_INIT(&median);
+    for (uint32_t i = 0; i < count; i += chunk)
+    {
+        WATERLEVEL_MEDIAN_RUN(&median, &in[i], (count - i < chunk) ? count - i : chunk, 1, &out[i]);
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (out[i] != ref_median(in, i) && mismatches++ == 0)
+        {
+            fprintf(stderr, "median at %u: %u, sorted %u\n", i, out[i], ref_median(in, i));
+        }
+    }
+    return mismatches;
+}
+
+/*!< Every ordering of 5 distinct codes and of codes with ties */
+static uint32_t check_permutations(void)
+{
+    uint32_t mismatches = 0;
+    uint16_t in[WATERLEVEL_MEDIAN_TAPS];
+
+    for (uint32_t n = 0; n < 5 * 5 * 5 * 5 * 5; n++)
+    {
+        uint32_t v = n;
+        for (uint8_t k = 0; k < WATERLEVEL_MEDIAN_TAPS; k++)
+        {
+            in[k] = (uint16_t)(v % 5);
+            v /= 5;
+        }
+        WATERLEVEL_Median median;
+        uint16_t out[WATERLEVEL_MEDIAN_TAPS];
+        WATERLEVEL_MEDIAN_INIT(&median);
+        WATERLEVEL_MEDIAN_RUN(&median, in, WATERLEVEL_MEDIAN_TAPS, 1, out);
+        if (out[WATERLEVEL_MEDIAN_TAPS - 1] != ref_median(in, WATERLEVEL_MEDIAN_TAPS - 1) && mismatches++ == 0)
+        {
+            fprintf(stderr, "permutation %u: %u\n", n, out[WATERLEVEL_MEDIAN_TAPS - 1]);
+        }
+    }
+    return mismatches;
+}
+
+/*=========================================================*/
+/*== RUNNER FUNCTIONS =====================================*/
+/*=========================================================*/
+
+static uint16_t samples[BENCH_SAMPLES];
+static uint16_t despiked[BENCH_SAMPLES];
+
+typedef struct BenchError
+{
+    double noiseUm;     /*!< Standard deviation of the outputs */
+    double biasUm;      /*!< Mean output against the true level */
+    double maxUm;       /*!< Worst output */
+} BenchError;
+
+static int32_t code_q_to_um(uint32_t q)
+{
+    return WATERLEVEL_UV_TO_UM(WATERLEVEL_Q_TO_UV(q));
+}
+
+static void error_add(double um, double trueUm, double *sum, double *sumSq, double *maxUm)
+{
+    *sum += um;
+    *sumSq += um * um;
+    *maxUm = fmax(*maxUm, fabs(um - trueUm));
+}
+
+static BenchError error_end(double sum, double sumSq, double maxUm, uint32_t n, double trueUm)
+{
+    BenchError e;
+    double mean = sum / n;
+    e.noiseUm = sqrt(fmax(sumSq / n - mean * mean, 0));
+    e.biasUm = mean - trueUm;
+    e.maxUm = maxUm;
+    return e;
+}
+
+/*!< One-shot: mean of ADC_SAMPLES, as WATERLEVEL_RUN */
+static BenchError run_mean(const uint16_t *in, double trueUm)
+{
+    double sum = 0, sumSq = 0, maxUm = 0;
+    uint32_t n = 0;
+    for (uint32_t i = 0; i + ADC_SAMPLES <= BENCH_SAMPLES; i += ADC_SAMPLES, n++)
+    {
+        uint32_t acc = 0;
+        for (uint32_t j = 0; j < ADC_SAMPLES; j++)
+        {
+            acc += in[i + j];
+        }
+        error_add(code_q_to_um((acc << WATERLEVEL_DECIM_FRAC_BITS) / ADC_SAMPLES), trueUm, &sum, &sumSq, &maxUm);
+    }
+    return error_end(sum, sumSq, maxUm, n, trueUm);
+}
+
+/*!< Stream: level lane through the default decimator, one lane block per call */
+static BenchError run_cic(const uint16_t *in, double trueUm)
+{
+    static uint32_t q[BENCH_SAMPLES];
+    WATERLEVEL_Decim decim;
+    uint32_t outputs = 0;
+
+    WATERLEVEL_DECIM_INIT(&decim, WATERLEVEL_DECIM_ORDER, WATERLEVEL_DECIM_RATE_BITS);
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i += BENCH_LANE_SAMPLES)
+    {
+        outputs += WATERLEVEL_DECIM_RUN(&decim, &in[i], BENCH_LANE_SAMPLES, 1, &q[outputs]);
+    }
+    double sum = 0, sumSq = 0, maxUm = 0;
+    for (uint32_t i = 0; i < outputs; i++)
+    {
+        error_add(code_q_to_um(q[i]), trueUm, &sum, &sumSq, &maxUm);
+    }
+    return error_end(sum, sumSq, maxUm, outputs, trueUm);
+}
+
+/*!< Best wall time of the interrupt's per-block work over all blocks, us per block */
+static double time_block(bool withMedian, uint32_t reps)
+{
+    WATERLEVEL_Median median[WATERLEVEL_CHANNELS];
+    WATERLEVEL_Decim decim[WATERLEVEL_CHANNELS];
+    uint16_t lane[BENCH_LANE_SAMPLES];
+    uint64_t best = UINT64_MAX;
+
+    for (uint32_t r = 0; r < reps; r++)
+    {
+        for (uint8_t c = 0; c < WATERLEVEL_CHANNELS; c++)
+        {
+            WATERLEVEL_MEDIAN_INIT(&median[c]);
+            WATERLEVEL_DECIM_INIT(&decim[c], WATERLEVEL_DECIM_ORDER, WATERLEVEL_DECIM_RATE_BITS);
+        }
+        uint64_t start = SIM_WALL_NS();
+        for (uint32_t i = 0; i < BENCH_SAMPLES; i += WATERLEVEL_BLOCK_SAMPLES)
+        {
+            for (uint8_t c = 0; c < WATERLEVEL_CHANNELS; c++)
+            {
+                if (withMedian)
+                {
+                    WATERLEVEL_MEDIAN_RUN(&median[c], &samples[i + c], BENCH_LANE_SAMPLES, WATERLEVEL_CHANNELS, lane);
+                    WATERLEVEL_DECIM_RUN(&decim[c], lane, BENCH_LANE_SAMPLES, 1, NULL);
+                }
+                else
+                {
+                    WATERLEVEL_DECIM_RUN(&decim[c], &samples[i + c], BENCH_LANE_SAMPLES, WATERLEVEL_CHANNELS, NULL);
+                }
+            }
+        }
+        uint64_t elapsed = SIM_WALL_NS() - start;
+        benchSink = decim[0].out;
+        best = elapsed < best ? elapsed : best;
+    }
+    return (double)best / 1e3 / (BENCH_SAMPLES / WATERLEVEL_BLOCK_SAMPLES);
+}
+
+int main(int argc, char **argv)
+{
+    static const BenchTrace traces[] = {
+        {"splash", traceSplash, sizeof(traceSplash) / sizeof(traceSplash[0]), 617, 623},
+        {"pump", tracePump, sizeof(tracePump) / sizeof(tracePump[0]), 617, 623},
+        {"step", traceStep, sizeof(traceStep) / sizeof(traceStep[0]), 617, 747},
+    };
+    uint32_t reps = 5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+        {
+            reps = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+    }
+    if (reps == 0)
+    {
+        fprintf(stderr, "usage: bench_median [--reps R]\n");
+        return EXIT_FAILURE;
+    }
+    SIM_STDIO_QUIET(true);
+
+    /*!< Input model of bench_decim, plus bursts of 1..2 samples anywhere on the 12 bit range */
+    uint32_t seed = 0xBB67AE85u;
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++)
+    {
+        double noise = ((double)(int32_t)bench_rand(&seed) / 2147483648.0) * BENCH_NOISE_VOLTS;
+        int32_t code = (int32_t)((BENCH_VOLTS + noise) * 4096.0 / BENCH_VREF + 0.5);
+        samples[i] = (uint16_t)(code < 0 ? 0 : (code > 4095 ? 4095 : code));
+    }
+    for (uint32_t i = 0; i + 1 < BENCH_SAMPLES; i++)
+    {
+        if (bench_rand(&seed) % 1000 < BENCH_SPIKE_PERMIL)
+        {
+            samples[i] = (uint16_t)(bench_rand(&seed) & 0x0FFF);
+            if (bench_rand(&seed) & 1)
+            {
+                samples[++i] = (uint16_t)(bench_rand(&seed) & 0x0FFF);
+            }
+        }
+    }
+    double trueUm = (BENCH_VOLTS * 1e6 - WATERLEVEL_OFFSET_UV) / WATERLEVEL_UV_PER_UM;
+
+    uint32_t mismatches = check_permutations();
+    mismatches += check_network(samples, BENCH_SAMPLES, BENCH_LANE_SAMPLES);
+    mismatches += check_network(samples, 4099, 7); /*!< Chunks that do not divide the window */
+
+    FILE *out = stdout;
+    fprintf(out, "{\n");
+    fprintf(out, "  \"samples\": %u,\n", BENCH_SAMPLES);
+    fprintf(out, "  \"reps\": %u,\n", reps);
+    fprintf(out, "  \"spike_permil\": %u,\n", BENCH_SPIKE_PERMIL);
+    fprintf(out, "  \"traces\": {");
+    for (uint8_t t = 0; t < sizeof(traces) / sizeof(traces[0]); t++)
+    {
+        const BenchTrace *trace = &traces[t];
+        mismatches += check_network(trace->codes, trace->count, BENCH_LANE_SAMPLES);
+
+        WATERLEVEL_Median median;
+        WATERLEVEL_MEDIAN_INIT(&median);
+        WATERLEVEL_MEDIAN_RUN(&median, trace->codes, trace->count, 1, despiked);
+        uint16_t rawLo = 4095, rawHi = 0, lo = 4095, hi = 0;
+        for (uint32_t i = 0; i < trace->count; i++)
+        {
+            rawLo = trace->codes[i] < rawLo ? trace->codes[i] : rawLo;
+            rawHi = trace->codes[i] > rawHi ? trace->codes[i] : rawHi;
+            lo = despiked[i] < lo ? despiked[i] : lo;
+            hi = despiked[i] > hi ? despiked[i] : hi;
+        }
+        if ((lo < trace->lo || hi > trace->hi) && mismatches++ == 0)
+        {
+            fprintf(stderr, "%s: despiked %u..%u outside %u..%u\n", trace->name, lo, hi, trace->lo, trace->hi);
+        }
+        fprintf(out, "%s\n    \"%s\": {\"raw\": [%u, %u], \"despiked\": [%u, %u]}", t ? "," : "", trace->name, rawLo,
+                rawHi, lo, hi);
+    }
+    fprintf(out, "\n  },\n");
+
+    WATERLEVEL_Median median;
+    WATERLEVEL_MEDIAN_INIT(&median);
+    WATERLEVEL_MEDIAN_RUN(&median, samples, BENCH_SAMPLES, 1, despiked);
+    const struct
+    {
+        const char *name;
+        BenchError e;
+    } paths[] = {
+        {"mean_100", run_mean(samples, trueUm)},
+        {"median5_mean_100", run_mean(despiked, trueUm)},
+        {"cic2", run_cic(samples, trueUm)},
+        {"median5_cic2", run_cic(despiked, trueUm)},
+    };
+    fprintf(out, "  \"paths\": {");
+    for (uint8_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++)
+    {
+        fprintf(out, "%s\n    \"%s\": {\"noise_um\": %.2f, \"bias_um\": %.1f, \"max_err_um\": %.1f}", i ? "," : "",
+                paths[i].name, paths[i].e.noiseUm, paths[i].e.biasUm, paths[i].e.maxUm);
+    }
+    fprintf(out, "\n  },\n");
+
+    double plainUs = time_block(false, reps);
+    double medianUs = time_block(true, reps);
+    fprintf(out, "  \"block_us\": {\"budget\": %.1f, \"cic2\": %.3f, \"median5_cic2\": %.3f},\n", BENCH_BLOCK_US, plainUs,
+            medianUs);
+    fprintf(out, "  \"compare_exchanges_per_block\": %u,\n", 7u * WATERLEVEL_BLOCK_SAMPLES);
+    fprintf(out, "  \"mismatches\": %u\n", mismatches);
+    fprintf(out, "}\n");
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
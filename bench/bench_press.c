@@ -0,0 +1,227 @@
+/*!
+*****************************************************************
+* @file    bench_press.c
+* @brief   BME280 pressure compensation: 32 bit and 64 bit integer
+*          paths against a double reference, error and cost as JSON
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_hal.h"
+#include "bme280.h"
+#include "bench_util.h"
+
+/*=========================================================*/
+/*== BENCH MACROS =========================================*/
+/*=========================================================*/
+
+#define BENCH_ADC_T_STEP    4096u /*!< 256 temperatures over the 20 bit range */
+#define BENCH_ADC_P_STEP    64u   /*!< 16384 pressures over the 20 bit range */
+#define BENCH_P_MIN         30000.0  /*!< Operating range of the sensor in Pa */
+#define BENCH_P_MAX         110000.0
+#define BENCH_TIMED_CALLS   (1u << 20)
+
+static BME280_Dev bme; /*!< Only calibration, raw values and t_fine are used */
+
+/*=========================================================*/
+/*== REFERENCE ============================================*/
+/*=========================================================*/
+
+/*!< Floating point formula of the datasheet (8.1), on the integer t_fine */
+static double bench_press_double(void)
+{
+    double var1 = ((double)bme.t_fine / 2.0) - 64000.0;
+    double var2 = var1 * var1 * ((double)bme.comp.dig_P6) / 32768.0;
+    var2 = var2 + var1 * ((double)bme.comp.dig_P5) * 2.0;
+    var2 = (var2 / 4.0) + (((double)bme.comp.dig_P4) * 65536.0);
+    var1 = (((double)bme.comp.dig_P3) * var1 * var1 / 524288.0 + ((double)bme.comp.dig_P2) * var1) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * ((double)bme.comp.dig_P1);
+    if (var1 == 0.0)
+    {
+        return 0.0;
+    }
+    double pressure = 1048576.0 - (double)bme.press;
+    pressure = (pressure - (var2 / 4096.0)) * 6250.0 / var1;
+    var1 = ((double)bme.comp.dig_P9) * pressure * pressure / 2147483648.0;
+    var2 = pressure * ((double)bme.comp.dig_P8) / 32768.0;
+    return pressure + (var1 + var2 + ((double)bme.comp.dig_P7)) / 16.0;
+}
+
+/*=========================================================*/
+/*== STATISTIC FUNCTIONS ==================================*/
+/*=========================================================*/
+
+typedef struct BenchError
+{
+    double maxAbs;
+    double sumAbs;
+    double sumSq;
+} BenchError;
+
+static void bench_error_add(BenchError *err, double value, double reference)
+{
+    double diff = fabs(value - reference);
+    err->maxAbs = diff > err->maxAbs ? diff : err->maxAbs;
+    err->sumAbs += diff;
+    err->sumSq += diff * diff;
+}
+
+static void bench_print(const char *name, const BenchError *err, uint64_t points, double ns, const char *tail)
+{
+    printf("  \"%s\": {\"ns_per_call\": %.3f", name, ns);
+    if (err != NULL)
+    {
+        printf(", \"max_abs_err_pa\": %.4f, \"mean_abs_err_pa\": %.4f, \"rms_err_pa\": %.4f", err->maxAbs,
+               err->sumAbs / (double)points, sqrt(err->sumSq / (double)points));
+    }
+    printf("}%s\n", tail);
+}
+
+/*=========================================================*/
+/*== RUNNER FUNCTIONS =====================================*/
+/*=========================================================*/
+
+static int32_t timedAdcT[BENCH_TIMED_CALLS];
+static int32_t timedAdcP[BENCH_TIMED_CALLS];
+static int32_t timedFine[BENCH_TIMED_CALLS];
+
+/*!< Best wall time of reps passes over the timed inputs, ns per call */
+static double bench_time(int variant, uint32_t reps)
+{
+    uint64_t best = UINT64_MAX;
+    for (uint32_t r = 0; r < reps; r++)
+    {
+        uint32_t acc = 0;
+        double accD = 0.0;
+        uint64_t start = SIM_WALL_NS();
+        for (uint32_t i = 0; i < BENCH_TIMED_CALLS; i++)
+        {
+            bme.t_fine = timedFine[i];
+            bme.press = timedAdcP[i];
+            switch (variant)
+            {
+            case 0:
+                acc += BME280_COMP_PRESSURE(&bme);
+                break;
+            case 1:
+                acc += BME280_COMP_PRESSURE_INT64(&bme);
+                break;
+            default:
+                accD += bench_press_double();
+                break;
+            }
+        }
+        uint64_t elapsed = SIM_WALL_NS() - start;
+        benchSink = acc + (uint32_t)accD;
+        best = elapsed < best ? elapsed : best;
+    }
+    return (double)best / (double)BENCH_TIMED_CALLS;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t reps = 5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+        {
+            reps = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+    }
+    if (reps == 0)
+    {
+        fprintf(stderr, "usage: bench_press [--reps R]\n");
+        return EXIT_FAILURE;
+    }
+
+    bench_calib(&bme.comp);
+    BME280_COMP_DERIVE(&bme.comp, &bme.derived);
+
+    /*!< Accuracy over the full raw grid, judged where the reference is a valid reading */
+    BenchError err32 = {0};
+    BenchError err64 = {0};
+    uint64_t points = 0;
+    uint64_t inRange = 0;
+    uint64_t zero32 = 0;
+
+    for (uint32_t adcT = 0; adcT < (1u << 20); adcT += BENCH_ADC_T_STEP)
+    {
+        bme.temp = (int32_t)adcT;
+        int32_t temperature = BME280_COMP_TEMP(&bme);
+        for (uint32_t adcP = 0; adcP < (1u << 20); adcP += BENCH_ADC_P_STEP)
+        {
+            bme.press = (int32_t)adcP;
+            double reference = bench_press_double();
+            uint32_t p32 = BME280_COMP_PRESSURE(&bme);
+            uint32_t p64 = BME280_COMP_PRESSURE_INT64(&bme);
+
+            points++;
+            if (temperature <= -4000 || temperature >= 8500 || reference < BENCH_P_MIN || reference > BENCH_P_MAX)
+            {
+                continue;
+            }
+            inRange++;
+            zero32 += (p32 == 0);
+            bench_error_add(&err32, (double)p32, reference);
+            bench_error_add(&err64, (double)p64 / 256.0, reference);
+        }
+    }
+
+    /*!< Throughput on random readings inside the operating range */
+    uint32_t seed = 0x9E3779B9u;
+    for (uint32_t i = 0; i < BENCH_TIMED_CALLS;)
+    {
+        bme.temp = (int32_t)(bench_rand(&seed) & 0xFFFFF);
+        bme.press = (int32_t)(bench_rand(&seed) & 0xFFFFF);
+        int32_t temperature = BME280_COMP_TEMP(&bme);
+        double reference = bench_press_double();
+        if (temperature > -4000 && temperature < 8500 && reference >= BENCH_P_MIN && reference <= BENCH_P_MAX)
+        {
+            timedAdcT[i] = bme.temp;
+            timedAdcP[i] = bme.press;
+            timedFine[i] = bme.t_fine;
+            i++;
+        }
+    }
+    double ns32 = bench_time(0, reps);
+    double ns64 = bench_time(1, reps);
+    double nsDouble = bench_time(2, reps);
+
+    printf("{\n");
+    printf("  \"grid\": {\"adc_t_step\": %u, \"adc_p_step\": %u, \"points\": %llu, \"in_range\": %llu},\n",
+           BENCH_ADC_T_STEP, BENCH_ADC_P_STEP, (unsigned long long)points, (unsigned long long)inRange);
+    printf("  \"timed_calls\": %u,\n", BENCH_TIMED_CALLS);
+    printf("  \"reps\": %u,\n", reps);
+    bench_print("int32", &err32, inRange, ns32, ",");
+    printf("  \"int32_zero_results\": %llu,\n", (unsigned long long)zero32);
+    bench_print("int64_q24_8", &err64, inRange, ns64, ",");
+    bench_print("double", NULL, inRange, nsDouble, "");
+    printf("}\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,60 @@
+/*!
+*****************************************************************
+* @file    bench_util.h
+* @brief   Shared helpers of the host benchmarks: reference
+*          calibration, deterministic random inputs and timing
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+#ifndef BENCH_UTIL_H_
+#define BENCH_UTIL_H_
+
+/*=========================================================*/
+/*== BENCH FUNCTIONS ======================================*/
+/*=========================================================*/
+
+#ifdef BME280_H_
+/*!< Calibration of the Bosch datasheet example, same as the simulated sensor */
+static inline void bench_calib(struct CompData *comp)
+{
+    memset(comp, 0, sizeof(*comp));
+    comp->dig_T1 = 27504;
+    comp->dig_T2 = 26435;
+    comp->dig_T3 = -1000;
+    comp->dig_P1 = 36477;
+    comp->dig_P2 = -10685;
+    comp->dig_P3 = 3024;
+    comp->dig_P4 = 2855;
+    comp->dig_P5 = 140;
+    comp->dig_P6 = -7;
+    comp->dig_P7 = 15500;
+    comp->dig_P8 = -14600;
+    comp->dig_P9 = 6000;
+    comp->dig_H1 = 75;
+    comp->dig_H2 = 362;
+    comp->dig_H3 = 0;
+    comp->dig_H4 = 313;
+    comp->dig_H5 = 50;
+    comp->dig_H6 = 30;
+}
+#endif
+
+/*!< xorshift32, reproducible across runs and hosts */
+static inline uint32_t bench_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/*!< Keeps benchmarked results alive without a store per call */
+static volatile uint32_t benchSink;
+
+#endif
@@ -24,7 +24,10 @@
 /*== PICO INCLUDES ========================================*/
 /*=========================================================*/
 
+#include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
 
 /*=========================================================*/
 /*== PRIVATE INCLUDES =====================================*/
@@ -37,6 +40,21 @@
 /*== FUNCTION DEFINITION ==================================*/
 /*=========================================================*/
 
+static int8_t BME280_WRITE_SHADOW(BME280_Dev *dev, const uint8_t *pairs, size_t len)
+{
+    if (dev->configDeferred)
+    {
+        return 0; /*!< Written by BME280_APPLY_CONFIG */
+    }
+    if (i2c_write_blocking(dev->i2c, dev->addr, pairs, len, false) != (int)len)
+    {
+        LOG_ERROR("[X] Config write failed [X] ErrorCode: -4 [X] ");
+        return BME280_E_COMM_FAIL;
+    }
+    return 0;
+}
+
+
 /*!
 **************************************************************
  * @brief Attempt to read the chip-id number of BM*-280 device
@@ -57,33 +75,17 @@
  *
 **************************************************************
  */
-int8_t BME280_CHIPID(void)
+int8_t BME280_CHIPID(BME280_Dev *dev)
 {
     debugMsg("====================  BME280 CHIP INIT PROGRESS STARTED  ============= \r\n");
     size_t lenChipAddr = sizeof(BME280_CHIP_ID_ADDR);
     size_t lenChipID = sizeof(BME280_CHIP_ID);
-    uint8_t *ptrChipID = malloc(sizeof(*ptrChipID) * lenChipID);
-    uint8_t *ptrChipAddr = malloc(sizeof(*ptrChipID) * lenChipAddr);
-
-    /*== Check Memory ============================*/
-    if (ptrChipID == NULL) /*== FAIL, NO MEMORY ==*/
-    {
-        LOG_ERROR("[X] Fail, No Memory Allocation [X] ErrorCode: -8 [X] ");
-        debugVal("[X] Fail, No Memory Allocation [X] ErrorCode:%X [X] \r\n", BME280_E_MEMORY_ALLOC);
-    }
-    else if (ptrChipAddr == NULL)
-    {
-        LOG_ERROR("[X] Fail, No Memory Allocation [X] ErrorCode: -8 [X] ");
-        debugVal("[X] Fail, No Memory Allocation [X] ErrorCode:%X [X] \r\n", BME280_E_MEMORY_ALLOC);
-    }
-    else
-    {
-        __NOP();
-    }
+    uint8_t ptrChipID[sizeof(BME280_CHIP_ID)] = {0};
+    uint8_t ptrChipAddr[sizeof(BME280_CHIP_ID_ADDR)];
 
     *ptrChipAddr = BME280_CHIP_ID_ADDR;
 
-    if (i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrChipAddr, lenChipAddr, false) != lenChipAddr)
+    if (i2c_write_blocking(dev->i2c, dev->addr, ptrChipAddr, lenChipAddr, false) != lenChipAddr)
     {
         LOG_ERROR("[X] Device not found [X] ErrorCode: -2 [X] ");
         debugVal("[X] Device not found [X] ErrorCode:%X [X] \r\n", BME280_E_DEV_NOT_FOUND);
@@ -93,7 +95,7 @@ int8_t BME280_CHIPID(void)
         debugVal("[X] Writing to Address:0x%02X [X] \r\n", (*ptrChipAddr));
     }
 
-    if (i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrChipID, lenChipID, false) == lenChipID)
+    if (i2c_read_blocking(dev->i2c, dev->addr, ptrChipID, lenChipID, false) == lenChipID)
     {
         debugVal("[X] Reading Register:0x%02X [X] \r\n", (*ptrChipAddr));
     }
@@ -125,8 +127,6 @@ int8_t BME280_CHIPID(void)
         //PANIC FUNCTION !!!!
         return -1;
     }
-    free(ptrChipID);
-    free(ptrChipAddr);
 }
 
 /*!
@@ -145,46 +145,51 @@ int8_t BME280_CHIPID(void)
  * 
 **************************************************************
  */
-int8_t BME280_SOFT_RESET(void)
+int8_t BME280_SOFT_RESET(BME280_Dev *dev)
 {
     debugMsg("====================  BME280 SOFTRESET PROGRESS STARTED  ============= \r\n");
     size_t lenSoftRst = sizeof(BME280_SOFTRESET_ADDR) + sizeof(BME280_SOFTRESET_VALUE);
-    uint8_t *ptrSoftRst = malloc(sizeof(*ptrSoftRst) * lenSoftRst);
-
-    /*== MEMORY CHECK ============================*/
-    if (ptrSoftRst == NULL) /*== FAIL, NO MEMORY ==*/
-    {
-        LOG_ERROR("[X] Fail, No Memory Allocation [X] ErrorCode: -8 [X] ");
-        debugVal("[X] Fail, No Memory Allocation [X] ErrorCode:%X [X] \r\n", BME280_E_MEMORY_ALLOC);
-    }
-    else if (ptrSoftRst == NULL)
-    {
-        LOG_ERROR("[X] Fail, No Memory Allocation [X] ErrorCode: -8 [X] ");
-        debugVal("[X] Fail, No Memory Allocation [X] ErrorCode:%X [X] \r\n", BME280_E_MEMORY_ALLOC);
-    }
-    else
-    {
-        __NOP();
-    }
+    uint8_t ptrSoftRst[sizeof(BME280_SOFTRESET_ADDR) + sizeof(BME280_SOFTRESET_VALUE)];
 
     *ptrSoftRst = BME280_SOFTRESET_ADDR;
     *(ptrSoftRst + 1) = BME280_SOFTRESET_VALUE;
 
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrSoftRst, lenSoftRst, false);
-
-    if (i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrSoftRst, lenSoftRst, false) != lenSoftRst)
+    if (i2c_write_blocking(dev->i2c, dev->addr, ptrSoftRst, lenSoftRst, false) != lenSoftRst)
     {
-        LOG_ERROR("[X] Softreset failed [X] ErrorCode: -2 [X] ");
-        debugVal("[X] Softreset failed [X] ErrorCode:%X [X] \r\n", BME280_E_DEV_NOT_FOUND);
+        LOG_ERROR("[X] Softreset failed [X] ErrorCode: -4 [X] ");
+        debugVal("[X] Softreset failed [X] ErrorCode:%X [X] \r\n", BME280_E_COMM_FAIL);
+        return BME280_E_COMM_FAIL;
     }
     else
     {
         debug2Val("[X] Writing SoftReset:0x%02X with Value:0x%X [X] \r\n", ptrSoftRst[0], ptrSoftRst[1]);
     }
 
-    free(ptrSoftRst);
+    dev->shadowCtrlHum = 0x00; /*!< Reset values */
+    dev->shadowCtrlMeas = 0x00;
+    dev->shadowConfig = 0x00;
 
-    return 0;
+    /*!< Registers are valid again once the NVM copy has finished (t_startup 2 ms) */
+    for (uint8_t poll = 0; poll < BME280_STARTUP_POLLS; poll++)
+    {
+        uint8_t status = BME280_REGISTER_STATUS;
+        if (i2c_write_blocking(dev->i2c, dev->addr, &status, 1, true) != 1 ||
+            i2c_read_blocking(dev->i2c, dev->addr, &status, 1, false) != 1)
+        {
+            break; /*!< status would still hold the register address */
+        }
+        if (!(status & BME280_STATUS_IM_UPDATE))
+        {
+            return 0;
+        }
+        if (poll + 1 < BME280_STARTUP_POLLS)
+        {
+            sleep_us(BME280_STARTUP_POLL_US);
+        }
+    }
+
+    LOG_ERROR("[X] NVM copy not finished [X] ErrorCode: -4 [X] ");
+    return BME280_E_COMM_FAIL;
 }
 
 /*!
@@ -203,35 +208,15 @@ int8_t BME280_SOFT_RESET(void)
  * 
 **************************************************************
  */
-int8_t BME280_SET_MODE(uint8_t deviceMode)
+int8_t BME280_SET_MODE(BME280_Dev *dev, uint8_t deviceMode)
 {
     debugMsg("====================  BME280 MODE SETTING STARTED  ===================\r\n");
-    uint8_t ptrWrite[] = {BME280_CTRL_MEAS_ADDR};
-    uint8_t status = 0x00;
-    uint8_t mode = 0x00;
-    size_t lenWrite = sizeof(ptrWrite);
-    size_t lenRead = 1;
-    uint8_t ptrRead[1];
-
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrWrite, lenWrite, false);
-    sleep_ms(10);
-    debugVal("[X] Writing Mode Register:0x%02X [X] \r\n", (*ptrWrite));
-    i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrRead, lenRead, false);
-    sleep_ms(10);
-    debugVal("[X] Reading Mode Register:0x%02X [X] \r\n", (*ptrRead));
+    dev->shadowCtrlMeas = (dev->shadowCtrlMeas & ~BME280_MODE_MSK) | (deviceMode & BME280_MODE_MSK);
+    dev->measureMode = deviceMode;
+    debugVal("[X] Setting Mode:0x%02X [X] \r\n", dev->shadowCtrlMeas);
 
-    status = *ptrRead & ~(BME280_MODE_MSK);
-    status |= (deviceMode & BME280_MODE_MSK);
-
-    measureMode = deviceMode;
-
-    debugVal("[X] Setting Mode:0x%02X [X] \r\n", status);
-    mode = status;
-
-    uint8_t ptrWriteMode[] = {BME280_CTRL_MEAS_ADDR, mode};
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrWriteMode, 2, false);
-
-    return 0;
+    uint8_t ptrWriteMode[] = {BME280_CTRL_MEAS_ADDR, dev->shadowCtrlMeas};
+    return BME280_WRITE_SHADOW(dev, ptrWriteMode, sizeof(ptrWriteMode));
 }
 
 /*!
@@ -250,7 +235,7 @@ int8_t BME280_SET_MODE(uint8_t deviceMode)
  * 
 **************************************************************
  */
-int8_t BME280_READ_MODE(void)
+int8_t BME280_READ_MODE(BME280_Dev *dev)
 {
     debugMsg("====================  BME280 MODE STATUS STARTED  ================== \r\n");
     uint8_t ptrData[] = {BME280_CTRL_MEAS_ADDR};
@@ -258,10 +243,8 @@ int8_t BME280_READ_MODE(void)
     size_t lenWrite = sizeof(BME280_CTRL_MEAS_ADDR);
     size_t lenRead = sizeof(BME280_CTRL_MEAS_ADDR);
 
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, lenWrite, false);
-    sleep_ms(10);
-    i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, lenRead, false);
-    sleep_ms(10);
+    i2c_write_blocking(dev->i2c, dev->addr, ptrData, lenWrite, false);
+    i2c_read_blocking(dev->i2c, dev->addr, ptrData, lenRead, false);
     debugVal("[X] Reading Mode Register:0x%02X [X] \r\n", (*ptrData));
 
     return status;
@@ -282,17 +265,15 @@ int8_t BME280_READ_MODE(void)
  * 
 **************************************************************
  */
-int8_t BME280_READ_STATUS(void)
+int8_t BME280_READ_STATUS(BME280_Dev *dev)
 {
     debugMsg("====================  BME280 UPDATE STATUS STARTED  ==================\r\n");
     uint8_t ptrData[] = {BME280_REGISTER_STATUS};
     size_t lenWrite = sizeof(BME280_REGISTER_STATUS);
     size_t lenRead = sizeof(BME280_REGISTER_STATUS);
 
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, lenWrite, false);
-    sleep_ms(10);
-    i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, lenRead, false);
-    sleep_ms(10);
+    i2c_write_blocking(dev->i2c, dev->addr, ptrData, lenWrite, false);
+    i2c_read_blocking(dev->i2c, dev->addr, ptrData, lenRead, false);
     debugVal("[X] Reading Status Register:0x%02X [X] \r\n", (*ptrData));
     *ptrData &= ~(BME280_STATUS_MSK); /*!< clear unused or corrupt bits */
     switch (*ptrData)
@@ -335,20 +316,25 @@ int8_t BME280_READ_STATUS(void)
  * 
 **************************************************************
  */
-int8_t BME280_READ_COMP(void)
+int8_t BME280_READ_COMP(BME280_Dev *dev)
 {
     debugMsg("====================  BME280 COMP DATA READ STARTED  =================\r\n");
     /*== Table 16 : Compensation parameter storage, naming and data type ==*/
 
-    ptrComp = &Comp;
+    struct CompData *ptrComp = &dev->comp;
 
     uint8_t buffer[BME280_TEMP_PRESS_CALIB_DATA_LEN + BME280_HUMIDITY_CALIB_DATA_LEN] = {0};
-    uint8_t ptrData[] = {BME280_REGISTER_DIG_T1};
+    uint8_t dataLen = BME280_HUMIDITY_CALIB_DATA_LEN - 1;
+    BME280_Xfer compXfer[2] = {0};
 
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, 1, false);
-    sleep_ms(10);
-    i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, buffer, 25, true);
-    sleep_ms(10);
+    /*!< Both calibration blocks queued back to back, 0x88..0xA0 and 0xE1..0xE8 */
+    BME280_ASYNC_READ(dev, &compXfer[0], BME280_REGISTER_DIG_T1, buffer, 25, NULL);
+    BME280_ASYNC_READ(dev, &compXfer[1], BME280_REGISTER_DIG_H2, &buffer[25], dataLen, NULL);
+    BME280_ASYNC_DRAIN(dev);
+    if (compXfer[0].result != 0 || compXfer[1].result != 0)
+    {
+        return BME280_E_COMM_FAIL;
+    }
 
     ptrComp->dig_T1 = buffer[0] | (buffer[1] << 8);             /*!< 0x88 / 0x89 dig_T1 [7:0] / [15:8] uint8_t */
     ptrComp->dig_T2 = (int16_t)(buffer[2] | (buffer[3] << 8));  /*!< 0x8A / 0x8B dig_T2 [7:0] / [15:8] int16_t */
@@ -367,19 +353,13 @@ int8_t BME280_READ_COMP(void)
     /*!< This Same Register-> BME280_HUMIDITY_CALIB_DATA_LEN-1 */
     ptrComp->dig_H1 = buffer[24]; /*!< 0xA1 dig_H1 [7:0] uint8_t*/
 
-    *ptrData = BME280_REGISTER_DIG_H2;
-    uint8_t dataLen = BME280_HUMIDITY_CALIB_DATA_LEN - 1;
-
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, 1, false);
-    sleep_ms(10);
-    i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, &buffer[25], dataLen, true);
-    sleep_ms(10);
-
     ptrComp->dig_H2 = (int16_t)buffer[25] | (buffer[26] << 8);                      /*!< 0xE1 / 0xE2 dig_H2 [7:0] / [15:8] int16_t */
     ptrComp->dig_H3 = buffer[27];                                                   /*!< 0xE3 dig_H3 [7:0] uint8_t */
     ptrComp->dig_H4 = (int16_t)(buffer[28] << 4 | (((buffer[29]) & ~(0x78))));      /*!< 0xE4 / 0xE5[3:0] dig_H4 [11:4] / [3:0] int16_t */
     ptrComp->dig_H5 = (int16_t)(((buffer[30] & ~(0xF0)) >> 4) | (buffer[31] << 4)); /*!< 0xE5[7:4] / 0xE6 dig_H5 [3:0] / [11:4] int16_t */
     ptrComp->dig_H6 = (int8_t)(buffer[32]);                                         /*!< 0xE7 dig_H6 int8_t */
+    BME280_COMP_DERIVE(ptrComp, &dev->derived);
+    dev->humCoeffValid = false;
     memset(buffer, '\0', sizeof(buffer));
     BME280_PRINT_COMP(ptrComp);
 
@@ -438,29 +418,15 @@ void BME280_PRINT_COMP(struct CompData *ptrComp)
  * 
 **************************************************************
  */
-void BME280_SET_STANDBY(uint8_t tsb)
+void BME280_SET_STANDBY(BME280_Dev *dev, uint8_t tsb)
 {
-    uint8_t status = 0x00;
-    uint8_t mode = 0x00;
     debugMsg("====================  BME280 STANDBY STATUS STARTED  =================\r\n");
-    uint8_t ptrData[] = {BME280_CONFIG_ADDR};
-    size_t lenWrite = sizeof(BME280_CONFIG_ADDR);
-    size_t lenRead = sizeof(BME280_CONFIG_ADDR);
-
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, lenWrite, false);
-    sleep_ms(10);
-    debugVal("[X] Writing STANDBY Register:0x%02X [X] \r\n", (*ptrData));
-    i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, lenRead, false);
-    sleep_ms(10);
-    debugVal("[X] Reading STANDBY Register:0x%02X [X] \r\n", (*ptrData));
-
-    status = *ptrData & ~BME280_STBY_MSK;
-    status |= tsb & BME280_STBY_MSK;
-    mode = status;
-    debugVal("[X] Setting STANDBY:0x%02X [X] \r\n", status);
+    dev->shadowConfig = (dev->shadowConfig & ~BME280_STBY_MSK) | (tsb & BME280_STBY_MSK);
+    dev->stdBy = tsb;
+    debugVal("[X] Setting STANDBY:0x%02X [X] \r\n", dev->shadowConfig);
 
-    uint8_t ptrWriteMode[] = {BME280_CONFIG_ADDR, mode};
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrWriteMode, 2, false);
+    uint8_t ptrWriteMode[] = {BME280_CONFIG_ADDR, dev->shadowConfig};
+    BME280_WRITE_SHADOW(dev, ptrWriteMode, sizeof(ptrWriteMode));
 }
 /*!
 **************************************************************
@@ -478,7 +444,7 @@ void BME280_SET_STANDBY(uint8_t tsb)
  * 
 **************************************************************
  */
-void BME280_READ_STANDBY(void)
+void BME280_READ_STANDBY(BME280_Dev *dev)
 {
     debugMsg("====================  BME280 STANDBY STATUS STARTED  =================\r\n");
     uint8_t ptrData[] = {BME280_CONFIG_ADDR};
@@ -486,10 +452,8 @@ void BME280_READ_STANDBY(void)
     size_t lenWrite = sizeof(BME280_CONFIG_ADDR);
     size_t lenRead = sizeof(BME280_CONFIG_ADDR);
 
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, lenWrite, false);
-    sleep_ms(10);
-    i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrRead, lenRead, false);
-    sleep_ms(10);
+    i2c_write_blocking(dev->i2c, dev->addr, ptrData, lenWrite, false);
+    i2c_read_blocking(dev->i2c, dev->addr, ptrRead, lenRead, false);
     debugVal("[X] Reading STANDBY Register:0x%02X [X] \r\n", (*ptrRead));
 }
 /*!
@@ -508,32 +472,15 @@ void BME280_READ_STANDBY(void)
  * 
 **************************************************************
  */
-void BME280_SET_FILTER(uint8_t filter)
+void BME280_SET_FILTER(BME280_Dev *dev, uint8_t filter)
 {
-    uint8_t status = 0x00;
-    uint8_t mode = 0x00;
     debugMsg("====================  BME280 FILTER SETTING STARTED  =================\r\n");
-    uint8_t ptrData[] = {BME280_CONFIG_ADDR};
-    size_t lenWrite = sizeof(BME280_CONFIG_ADDR);
-    size_t lenRead = sizeof(BME280_CONFIG_ADDR);
-    uint8_t ptrRead[lenRead];
-
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, lenWrite, false);
-    sleep_ms(10);
-    debugVal("[X] Writing FILTER Register:0x%02X [X] \r\n", (*ptrData));
-    i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrRead, lenRead, false);
-    sleep_ms(10);
-    debugVal("[X] Reading FILTER Register:0x%02X [X] \r\n", (*ptrRead));
-
-    status = *ptrRead & ~BME280_FILTER_MSK;
-    status |= filter & BME280_FILTER_MSK;
-    mode = status;
-
-    filtCoeff = filter;
+    dev->shadowConfig = (dev->shadowConfig & ~BME280_FILTER_MSK) | (filter & BME280_FILTER_MSK);
+    dev->filtCoeff = filter;
+    debugVal("[X] Setting Mode:0x%02X [X] \r\n", dev->shadowConfig);
 
-    debugVal("[X] Setting Mode:0x%02X [X] \r\n", mode);
-    uint8_t ptrWriteMode[] = {BME280_CONFIG_ADDR, mode};
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrWriteMode, 2, false);
+    uint8_t ptrWriteMode[] = {BME280_CONFIG_ADDR, dev->shadowConfig};
+    BME280_WRITE_SHADOW(dev, ptrWriteMode, sizeof(ptrWriteMode));
 }
 /*!
 **************************************************************
@@ -551,7 +498,7 @@ void BME280_SET_FILTER(uint8_t filter)
  * 
 **************************************************************
  */
-void BME280_READ_FILTER(void)
+void BME280_READ_FILTER(BME280_Dev *dev)
 {
     debugMsg("====================  BME280 FILTER READING STARTED  =================\r\n");
     uint8_t ptrData[] = {BME280_CONFIG_ADDR};
@@ -559,10 +506,8 @@ void BME280_READ_FILTER(void)
     size_t lenRead = sizeof(BME280_CONFIG_ADDR);
     uint8_t ptrRead[lenRead];
 
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, lenWrite, false);
-    sleep_ms(10);
-    i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrRead, lenRead, false);
-    sleep_ms(10);
+    i2c_write_blocking(dev->i2c, dev->addr, ptrData, lenWrite, false);
+    i2c_read_blocking(dev->i2c, dev->addr, ptrRead, lenRead, false);
     debugVal("[X] Reading FILTER Register:0x%02X [X] \r\n", (*ptrRead));
 }
 /*!
@@ -582,29 +527,15 @@ void BME280_READ_FILTER(void)
  * 
 **************************************************************
  */
-void BBME280_SET_OSRS_T(uint8_t osrs_t)
+void BBME280_SET_OSRS_T(BME280_Dev *dev, uint8_t osrs_t)
 {
-    uint8_t status = 0x00;
-    uint8_t mode = 0x00;
     debugMsg("====================  BME280 OSRS_t SETTING STARTED  =================\r\n");
-    uint8_t ptrData[] = {BME280_CTRL_MEAS_ADDR};
-    size_t lenWrite = sizeof(BME280_CTRL_MEAS_ADDR);
-    size_t lenRead = sizeof(BME280_CTRL_MEAS_ADDR);
-    uint8_t ptrRead[lenRead];
+    dev->shadowCtrlMeas = (dev->shadowCtrlMeas & ~BME280_OSRS_T_MSK) | (osrs_t & BME280_OSRS_T_MSK);
+    dev->ovsTime = osrs_t;
+    debugVal("[X] Setting OSRS_t:0x%02X [X] \r\n", dev->shadowCtrlMeas);
 
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, lenWrite, false);
-    debugVal("[X] Writing OSRS_t Register:0x%02X [X] \r\n", (*ptrData));
-    i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrRead, lenRead, false);
-    debugVal("[X] Reading OSRS_t Register:0x%02X [X] \r\n", (*ptrRead));
-
-    status = *ptrRead & ~BME280_OSRS_T_MSK;
-    status |= osrs_t & BME280_OSRS_T_MSK;
-    mode = status;
-    ovsTime = osrs_t;
-
-    debugVal("[X] Setting OSRS_t:0x%02X [X] \r\n", mode);
-    uint8_t ptrWriteMode[] = {BME280_CTRL_MEAS_ADDR, mode};
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrWriteMode, 2, false);
+    uint8_t ptrWriteMode[] = {BME280_CTRL_MEAS_ADDR, dev->shadowCtrlMeas};
+    BME280_WRITE_SHADOW(dev, ptrWriteMode, sizeof(ptrWriteMode));
 }
 /*!
 **************************************************************
@@ -624,29 +555,15 @@ void BBME280_SET_OSRS_T(uint8_t osrs_t)
  * 
 **************************************************************
  */
-void BME280_SET_OSRS_P(uint8_t osrs_p)
+void BME280_SET_OSRS_P(BME280_Dev *dev, uint8_t osrs_p)
 {
-    uint8_t status = 0x00;
-    uint8_t mode = 0x00;
     debugMsg("====================  BME280 OSRS_p SETTING STARTED  =================\r\n");
-    uint8_t ptrData[] = {BME280_CTRL_MEAS_ADDR};
-    size_t lenWrite = sizeof(BME280_CTRL_MEAS_ADDR);
-    size_t lenRead = sizeof(BME280_CTRL_MEAS_ADDR);
-    uint8_t ptrRead[lenRead];
-
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, lenWrite, false);
-    debugVal("[X] Writing OSRS_p Register:0x%02X [X] \r\n", (*ptrData));
-    i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrRead, lenRead, false);
-    debugVal("[X] Reading OSRS_p Register:0x%02X [X] \r\n", (*ptrRead));
-
-    status = *ptrRead & ~BME280_OSRS_P_MSK;
-    status |= osrs_p & BME280_OSRS_P_MSK;
-    mode = status;
-    ovsPressure = osrs_p;
+    dev->shadowCtrlMeas = (dev->shadowCtrlMeas & ~BME280_OSRS_P_MSK) | (osrs_p & BME280_OSRS_P_MSK);
+    dev->ovsPressure = osrs_p;
+    debugVal("[X] Setting OSRS_p:0x%02X [X] \r\n", dev->shadowCtrlMeas);
 
-    debugVal("[X] Setting OSRS_p:0x%02X [X] \r\n", mode);
-    uint8_t ptrWriteMode[] = {BME280_CTRL_MEAS_ADDR, mode};
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrWriteMode, 2, false);
+    uint8_t ptrWriteMode[] = {BME280_CTRL_MEAS_ADDR, dev->shadowCtrlMeas};
+    BME280_WRITE_SHADOW(dev, ptrWriteMode, sizeof(ptrWriteMode));
 }
 
 /*!
@@ -667,43 +584,16 @@ void BME280_SET_OSRS_P(uint8_t osrs_p)
  * 
 **************************************************************
  */
-void BME280_SET_OSRS_H(uint8_t osrs_h)
+void BME280_SET_OSRS_H(BME280_Dev *dev, uint8_t osrs_h)
 {
-    uint8_t status = 0x00;
-    uint8_t mode = 0x00;
-
     debugMsg("====================  BME280 OSRS_h SETTING STARTED  =================\r\n");
-    uint8_t ptrData[] = {BME280_CTRL_HUM_ADDR};
-    size_t lenWrite = sizeof(BME280_CTRL_HUM_ADDR);
-    size_t lenRead = sizeof(BME280_CTRL_HUM_ADDR);
-    uint8_t ptrRead[lenRead];
-
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, lenWrite, false);
-    debugVal("[X] Writing OSRS_h Register:0x%02X [X] \r\n", (*ptrData));
-    i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrRead, lenRead, false);
-    debugVal("[X] Reading OSRS_h Register:0x%02X [X] \r\n", (*ptrRead));
-
-    status = *ptrRead & ~BME280_OSRS_H_MSK;
-    status |= osrs_h & BME280_OSRS_H_MSK;
-    mode = status;
-    ovsHumidity = osrs_h;
-
-    debugVal("[X] Setting OSRS_h:0x%02X [X] \r\n", mode);
-    uint8_t ptrWriteMode[] = {BME280_CTRL_HUM_ADDR, mode};
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrWriteMode, 2, false);
-
-    *ptrData = BME280_CTRL_MEAS_ADDR;
-    lenWrite = sizeof(BME280_CTRL_MEAS_ADDR);
-    lenRead = sizeof(BME280_CTRL_MEAS_ADDR);
-
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, lenWrite, false);
-    debugVal("[X] Writing CTRL_MEAS Register:0x%02X [X] \r\n", (*ptrData));
-    i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrRead, lenRead, false);
-    debugVal("[X] Reading CTRL_MEAS Register:0x%02X [X] \r\n", (*ptrRead));
+    dev->shadowCtrlHum = (dev->shadowCtrlHum & ~BME280_OSRS_H_MSK) | (osrs_h & BME280_OSRS_H_MSK);
+    dev->ovsHumidity = osrs_h;
+    debugVal("[X] Setting OSRS_h:0x%02X [X] \r\n", dev->shadowCtrlHum);
 
-    ptrWriteMode[0] = BME280_CTRL_MEAS_ADDR;
-    ptrWriteMode[0] = *ptrRead;
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrWriteMode, 2, false);
+    /*!< ctrl_hum is latched by the ctrl_meas write in the same transaction */
+    uint8_t ptrWriteMode[] = {BME280_CTRL_HUM_ADDR, dev->shadowCtrlHum, BME280_CTRL_MEAS_ADDR, dev->shadowCtrlMeas};
+    BME280_WRITE_SHADOW(dev, ptrWriteMode, sizeof(ptrWriteMode));
 }
 /*!
 **************************************************************
@@ -723,7 +613,7 @@ void BME280_SET_OSRS_H(uint8_t osrs_h)
  * 
 **************************************************************
  */
-void BME280_READ_OSRS_H(void)
+void BME280_READ_OSRS_H(BME280_Dev *dev)
 {
     debugMsg("====================  BME280 OSRS_h READING STARTED  =================\r\n");
     uint8_t ptrData[] = {BME280_CTRL_HUM_ADDR};
@@ -731,9 +621,9 @@ void BME280_READ_OSRS_H(void)
     size_t lenRead = sizeof(BME280_CTRL_HUM_ADDR);
     uint8_t ptrRead[lenRead];
 
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, lenWrite, false);
+    i2c_write_blocking(dev->i2c, dev->addr, ptrData, lenWrite, false);
     debugVal("[X] Writing OSRS_h Register:0x%02X [X] \r\n", (*ptrData));
-    i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrRead, lenRead, false);
+    i2c_read_blocking(dev->i2c, dev->addr, ptrRead, lenRead, false);
     debugVal("[X] Reading OSRS_h Register:0x%02X [X] \r\n", (*ptrRead));
 }
 
@@ -755,7 +645,7 @@ void BME280_READ_OSRS_H(void)
  * 
 **************************************************************
  */
-void BME280_READ_CTRL_MEAS(void)
+void BME280_READ_CTRL_MEAS(BME280_Dev *dev)
 {
     debugMsg("====================  BME280 CTRL_MEAS READING STARTED  ==============\r\n");
     uint8_t ptrData[] = {BME280_CTRL_MEAS_ADDR};
@@ -763,12 +653,74 @@ void BME280_READ_CTRL_MEAS(void)
     size_t lenRead = sizeof(BME280_CTRL_MEAS_ADDR);
     uint8_t ptrRead[lenRead];
 
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, lenWrite, false);
+    i2c_write_blocking(dev->i2c, dev->addr, ptrData, lenWrite, false);
     debugVal("[X] Writing CTRL_MEAS Register:0x%02X [X] \r\n", (*ptrData));
-    i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrRead, lenRead, false);
+    i2c_read_blocking(dev->i2c, dev->addr, ptrRead, lenRead, false);
     debugVal("[X] Reading CTRL_MEAS Register:0x%02X [X] \r\n", (*ptrRead));
 }
 /*!
+**************************************************************
+ * @brief Open a configuration batch: the BME280_SET_* calls
+ * that follow only update the shadow registers
+**************************************************************
+ */
+void BME280_CONFIG_BEGIN(BME280_Dev *dev)
+{
+    dev->configDeferred = true;
+}
+
+/*!
+**************************************************************
+ * @brief Write ctrl_hum, config and ctrl_meas from the shadow
+ * registers in one bus transaction and close the batch
+ *
+ * @note ctrl_meas goes last: it latches ctrl_hum and starts the
+ * selected mode, config is still writable before that
+ *
+ * @retval = 0 -> Success
+ * @retval < 0 -> Fail
+**************************************************************
+ */
+int8_t BME280_APPLY_CONFIG(BME280_Dev *dev)
+{
+    uint8_t ptrWrite[] = {BME280_CTRL_HUM_ADDR, dev->shadowCtrlHum,
+                          BME280_CONFIG_ADDR, dev->shadowConfig,
+                          BME280_CTRL_MEAS_ADDR, dev->shadowCtrlMeas};
+
+    debugMsg("====================  BME280 APPLY CONFIG STARTED  ===================\r\n");
+    debug2Val("[X] ctrl_hum:0x%02X config:0x%02X [X] \r\n", dev->shadowCtrlHum, dev->shadowConfig);
+    debugVal("[X] ctrl_meas:0x%02X [X] \r\n", dev->shadowCtrlMeas);
+    dev->configDeferred = false;
+
+    return BME280_WRITE_SHADOW(dev, ptrWrite, sizeof(ptrWrite));
+}
+
+/*!
+**************************************************************
+ * @brief Reload the shadow registers from 0xF2..0xF5 in one
+ * burst, e.g. when the device state is unknown after a brown-out
+ *
+ * @retval = 0 -> Success
+ * @retval < 0 -> Fail
+**************************************************************
+ */
+int8_t BME280_READ_CONFIG(BME280_Dev *dev)
+{
+    uint8_t ptrData[] = {BME280_CTRL_HUM_ADDR};
+    uint8_t ptrRead[BME280_CONFIG_ADDR - BME280_CTRL_HUM_ADDR + 1];
+
+    if (i2c_write_blocking(dev->i2c, dev->addr, ptrData, 1, true) != 1 ||
+        i2c_read_blocking(dev->i2c, dev->addr, ptrRead, sizeof(ptrRead), false) != sizeof(ptrRead))
+    {
+        return BME280_E_COMM_FAIL;
+    }
+
+    dev->shadowCtrlHum = ptrRead[0];
+    dev->shadowCtrlMeas = ptrRead[BME280_CTRL_MEAS_ADDR - BME280_CTRL_HUM_ADDR];
+    dev->shadowConfig = ptrRead[BME280_CONFIG_ADDR - BME280_CTRL_HUM_ADDR];
+    return 0;
+}
+/*!
 **************************************************************
  * @brief 
  * 
@@ -787,7 +739,7 @@ void BME280_READ_CTRL_MEAS(void)
 **************************************************************
  */
 
-void BME280_RAW_DATA(void)
+void BME280_RAW_DATA(BME280_Dev *dev)
 {
     uint8_t buffer[8];
 
@@ -796,98 +748,79 @@ void BME280_RAW_DATA(void)
     size_t lenWrite = sizeof(BME280_DATA_ADDR);
     size_t lenRead = sizeof(buffer);
 
-    i2c_write_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, ptrData, lenWrite, false);
-
-    i2c_read_blocking(i2c_default, BME280_I2C_ADDR_PRIMARY, buffer, lenRead, true);
+    i2c_write_blocking(dev->i2c, dev->addr, ptrData, lenWrite, false);
 
-    press = ((uint32_t)buffer[0] << 12) | ((uint32_t)buffer[1] << 4) | (buffer[2] >> 4);
-    temp = ((uint32_t)buffer[3] << 12) | ((uint32_t)buffer[4] << 4) | (buffer[5] >> 4);
-    hum = (uint32_t)buffer[6] << 8 | buffer[7];
+    i2c_read_blocking(dev->i2c, dev->addr, buffer, lenRead, true);
 
-    debugVal("[X] Temperature:%X \r\n", temp);
-    debugVal("[X] Pressure:%X  \r\n", press);
-    debugVal("[X] Humidity:%X  \r\n", hum);
+    BME280_RAW_PARSE(dev, buffer);
 }
 
 /*!
 **************************************************************
- * @brief 
- * 
- *
- *
- * @param[in]  deviceAddr Description
- * @param[out]   
- *
- * @return Result of 
- *
- * @retval = 0 -> Success
- * @retval > 0 -> Warning
- * @retval < 0 -> Fail
+ * @brief Unpack the 20 bit pressure/temperature and 16 bit
+ * humidity ADC values of a 0xF7..0xFE burst into the press, temp
+ * and hum fields of the context
  *
- * 
+ * @param[in]  buffer 8 data register bytes starting at 0xF7
 **************************************************************
  */
-int32_t BME280_COMP_TEMP(void)
+void BME280_RAW_PARSE(BME280_Dev *dev, const uint8_t *buffer)
+{
+    dev->press = ((uint32_t)buffer[0] << 12) | ((uint32_t)buffer[1] << 4) | (buffer[2] >> 4);
+    dev->temp = ((uint32_t)buffer[3] << 12) | ((uint32_t)buffer[4] << 4) | (buffer[5] >> 4);
+    dev->hum = (uint32_t)buffer[6] << 8 | buffer[7];
+
+    debugVal("[X] Temperature:%X \r\n", dev->temp);
+    debugVal("[X] Pressure:%X  \r\n", dev->press);
+    debugVal("[X] Humidity:%X  \r\n", dev->hum);
+}
+
+/*=========================================================*/
+/*== COMPENSATION KERNELS =================================*/
+/*=========================================================*/
+
+/*!< Bosch integer formulas (datasheet 4.2.3) on the derived
+ *   coefficients of BME280_COMP_DERIVE, shared by the scalar
+ *   functions below and BME280_COMP_BATCH so both are bit-identical */
+static inline int32_t BME280_TFINE_KERNEL(const struct CompCoeff *coeff, int32_t adc_T)
 {
-    int32_t adc_T = temp;
     int32_t var1;
     int32_t var2;
-    int32_t temperature;
-    int32_t temperature_min = -4000;
-    int32_t temperature_max = 8500;
 
-    var1 = (((adc_T >> 3) - ((int32_t)Comp.dig_T1 << 1)) * ((int32_t)Comp.dig_T2)) >> 11;
-    var2 = ((adc_T >> 4) - ((int32_t)Comp.dig_T1)); 
-    var2 = (var2 *((adc_T >> 4) - ((int32_t)Comp.dig_T1)) >> 12);
-    var2 = (var2 * ((int32_t)Comp.dig_T3)) >> 14;
+    var1 = (((adc_T >> 3) - coeff->t1x2) * coeff->t2) >> 11;
+    var2 = ((adc_T >> 4) - coeff->t1);
+    var2 = (var2 * var2) >> 12;
+    var2 = (var2 * coeff->t3) >> 14;
 
-    t_fine = var1 + var2;
-    temperature = (t_fine * 5 + 128) >> 8;
+    return var1 + var2;
+}
 
-    if (temperature < temperature_min)
-    {
-        temperature = temperature_min;
-    }
-    else if (temperature > temperature_max)
-    {
-        temperature = temperature_max;
-    }
+static inline int32_t BME280_TEMP_KERNEL(int32_t tFine)
+{
+    int32_t temperature_min = -4000;
+    int32_t temperature_max = 8500;
+    int32_t temperature = (tFine * 5 + 128) >> 8;
 
+    temperature = (temperature < temperature_min) ? temperature_min : temperature;
+    temperature = (temperature > temperature_max) ? temperature_max : temperature;
     return temperature;
 }
-/*!
-**************************************************************
- * @brief 
- * 
- *
- *
- * @param[in]  deviceAddr Description
- * @param[out]   
- *
- * @return Result of 
- *
- * @retval = 0 -> Success
- * @retval > 0 -> Warning
- * @retval < 0 -> Fail
- *
- * 
-**************************************************************
- */
-uint32_t BME280_COMP_PRESSURE(void)
+
+static inline uint32_t BME280_PRESS_KERNEL(const struct CompCoeff *coeff, int32_t tFine, int32_t adc_P)
 {
-    int32_t adc_P = press;
     int32_t var1;
     int32_t var2;
+    int32_t square;
     int32_t pressure;
 
-    var1 = (((int32_t)t_fine) >> 1) - (int32_t)64000;
-    var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * ((int32_t)Comp.dig_P6);
-    var2 = var2 + ((var1 * ((int32_t)Comp.dig_P5)) << 1);
-    var2 = (var2 >> 2) + (((int32_t)Comp.dig_P4) << 16);
-    var1 = ((Comp.dig_P3 * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3);
-    var1 = (var1 + ((((int32_t)Comp.dig_P2) * var1) >> 1)) >> 18;
+    var1 = (tFine >> 1) - (int32_t)64000;
+    square = (var1 >> 2) * (var1 >> 2);
+    var2 = (square >> 11) * coeff->p6;
+    var2 = var2 + var1 * coeff->p5x2;
+    var2 = (var2 >> 2) + coeff->p4s16;
+    var1 = (((coeff->p3 * (square >> 13)) >> 3) + ((coeff->p2 * var1) >> 1)) >> 18;
 
-    var1 = ((((32768 + var1)) * ((int32_t)Comp.dig_P1)) >> 15);
+    var1 = ((32768 + var1) * coeff->p1) >> 15;
     if (var1 == 0)
     {
         return 0; // avoid exception caused by division by zero
@@ -895,110 +828,280 @@ uint32_t BME280_COMP_PRESSURE(void)
     pressure = (((uint32_t)(((int32_t)1048576) - adc_P) - (var2 >> 12))) * 3125;
     if (pressure < 0x80000000)
     {
-        pressure = (pressure << 1) / ((uint32_t)var1);
+        pressure = ((uint32_t)pressure << 1) / ((uint32_t)var1);
     }
     else
     {
         pressure = (pressure / (uint32_t)var1) * 2;
     }
-    var1 = (((int32_t)Comp.dig_P9) * ((int32_t)(((pressure >> 3) * (pressure >> 3)) >> 13))) >> 12;
-    var2 = (((int32_t)(pressure >> 2)) * ((int32_t)Comp.dig_P8)) >> 13;
-    pressure = (uint32_t)((int32_t)pressure + ((var1 + var2 + Comp.dig_P7) >> 4));
+    var1 = (coeff->p9 * ((int32_t)(((pressure >> 3) * (pressure >> 3)) >> 13))) >> 12;
+    var2 = (((int32_t)(pressure >> 2)) * coeff->p8) >> 13;
+    pressure = (uint32_t)((int32_t)pressure + ((var1 + var2 + coeff->p7) >> 4));
     return pressure;
 }
-/*!
-**************************************************************
- * @brief 
- * 
- *
- *
- * @param[in]  deviceAddr Description
- * @param[out]   
- *
- * @return Result of 
- *
- * @retval = 0 -> Success
- * @retval > 0 -> Warning
- * @retval < 0 -> Fail
- *
- * 
-**************************************************************
- */
-double BME280_COMP_HUM_DOUBLE(void)
-{
-    int32_t adc_H = hum;
-    double var_H;
-    var_H = (((double)t_fine) - 76800.0);
-    var_H = (adc_H - (((double)Comp.dig_H4) * 64.0 + ((double)Comp.dig_H5) / 16384.0 * var_H));
-    var_H = var_H * (((double)Comp.dig_H2) / 65536.0);
-    var_H = var_H * (1.0 + ((double)Comp.dig_H6) / 67108864.0 * var_H * (1.0 + ((double)Comp.dig_H3) / 67108864.0 * var_H));
-    var_H = var_H * (1.0 - ((double)Comp.dig_H1) * var_H / 524288.0);
 
-    if (var_H > 100.0)
-    {
-        var_H = 100.0;
-    }
-    else if (var_H < 0.0)
+/*!< 64 bit variant (datasheet 8.2), Pa in Q24.8 */
+static inline uint32_t BME280_PRESS64_KERNEL(const struct CompCoeff *coeff, int32_t tFine, int32_t adc_P)
+{
+    int64_t var1;
+    int64_t var2;
+    int64_t pressure;
+
+    var1 = ((int64_t)tFine) - 128000;
+    var2 = var1 * var1 * (int64_t)coeff->p6;
+    var2 = var2 + ((var1 * (int64_t)coeff->p5x2) << 16);
+    var2 = var2 + (((int64_t)coeff->p4s16) << 19);
+    var1 = ((var1 * var1 * (int64_t)coeff->p3) >> 8) + ((var1 * (int64_t)coeff->p2) << 12);
+    var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)coeff->p1) >> 33;
+    if (var1 == 0)
     {
-        var_H = 0.0;
+        return 0; // avoid exception caused by division by zero
     }
+    pressure = 1048576 - adc_P;
+    pressure = (((pressure << 31) - var2) * 3125) / var1;
+    var1 = (((int64_t)coeff->p9) * (pressure >> 13) * (pressure >> 13)) >> 25;
+    var2 = (((int64_t)coeff->p8) * pressure) >> 19;
+    pressure = ((pressure + var1 + var2) >> 8) + (((int64_t)coeff->p7) << 4);
+    return (uint32_t)pressure;
+}
 
-    return var_H;
+/*!< Humidity formula split at adc_H: the offset and scale factors depend on t_fine only */
+static inline void BME280_HUM_COEFF_KERNEL(const struct CompCoeff *coeff, int32_t tFine, struct HumCoeff *hum)
+{
+    int32_t var_H = (tFine - ((int32_t)76800));
+
+    hum->tFine = tFine;
+    hum->offset = coeff->h4Offset - (coeff->h5 * var_H);
+    hum->scale = (((((((var_H * coeff->h6) >> 10) * (((var_H * coeff->h3) >> 11) + ((int32_t)32768))) >> 10) + \
+                 ((int32_t)2097152)) * coeff->h2 + 8192) >> 14);
+    hum->h1 = coeff->h1;
 }
 
-uint32_t BME280_COMP_HUM_INT32(void)
+static inline uint32_t BME280_HUM_APPLY_KERNEL(const struct HumCoeff *coeff, int32_t adc_H)
 {
-    int32_t adc_H = hum;
     int32_t var_H;
- 
-    int32_t var_H3 = ((int32_t)Comp.dig_H3); 
-    int32_t var_H4 = ((int32_t)Comp.dig_H4) << 20;
-    int32_t var_H5 = ((int32_t)Comp.dig_H5);
-    int32_t var_H6 = ((int32_t)Comp.dig_H6);
-
-    var_H = (t_fine - ((int32_t)76800));
-    var_H = (((((adc_H << 14) - var_H4 - (var_H5 * var_H)) + ((int32_t)16384)) >> 15) * \
-            (((((((var_H * var_H6) >> 10) * (((var_H * var_H3) >> 11) + ((int32_t)32768))) >> 10) + \
-            ((int32_t)2097152)) * ((int32_t)Comp.dig_H2) + 8192) >> 14));
-    var_H = (var_H - (((((var_H >> 15) * (var_H >> 15)) >> 7) * ((int32_t)Comp.dig_H1)) >> 4));
+
+    var_H = (((adc_H << 14) + coeff->offset) >> 15) * coeff->scale;
+    var_H = (var_H - (((((var_H >> 15) * (var_H >> 15)) >> 7) * coeff->h1) >> 4));
     var_H = (var_H < 0 ? 0 : var_H);
     var_H = (var_H > 419430400 ? 419430400 : var_H);
 
     return (uint32_t)(var_H >> 12);
 }
 
+static inline uint32_t BME280_HUM_KERNEL(const struct CompCoeff *coeff, int32_t tFine, int32_t adc_H)
+{
+    struct HumCoeff hum;
+
+    BME280_HUM_COEFF_KERNEL(coeff, tFine, &hum);
+    return BME280_HUM_APPLY_KERNEL(&hum, adc_H);
+}
+
 /*!
 **************************************************************
- * @brief 
- * 
+ * @brief Derive the pre-cast and pre-shifted coefficients the
+ * compensation kernels run on, once per calibration
+ *
+ * @param[in]  comp  Calibration as read from the device
+ * @param[out] coeff Derived coefficients
+**************************************************************
+ */
+void BME280_COMP_DERIVE(const struct CompData *comp, struct CompCoeff *coeff)
+{
+    coeff->t1 = (int32_t)comp->dig_T1;
+    coeff->t1x2 = (int32_t)comp->dig_T1 << 1;
+    coeff->t2 = (int32_t)comp->dig_T2;
+    coeff->t3 = (int32_t)comp->dig_T3;
+
+    coeff->p1 = (int32_t)comp->dig_P1;
+    coeff->p2 = (int32_t)comp->dig_P2;
+    coeff->p3 = (int32_t)comp->dig_P3;
+    coeff->p4s16 = (int32_t)comp->dig_P4 * 65536;
+    coeff->p5x2 = (int32_t)comp->dig_P5 * 2;
+    coeff->p6 = (int32_t)comp->dig_P6;
+    coeff->p7 = (int32_t)comp->dig_P7;
+    coeff->p8 = (int32_t)comp->dig_P8;
+    coeff->p9 = (int32_t)comp->dig_P9;
+
+    coeff->h1 = (int32_t)comp->dig_H1;
+    coeff->h2 = (int32_t)comp->dig_H2;
+    coeff->h3 = (int32_t)comp->dig_H3;
+    coeff->h4Offset = (int32_t)((uint32_t)16384 - ((uint32_t)(int32_t)comp->dig_H4 << 20));
+    coeff->h5 = (int32_t)comp->dig_H5;
+    coeff->h6 = (int32_t)comp->dig_H6;
+}
+
+/*!
+**************************************************************
+ * @brief Compensate the raw temperature in dev->temp, updates
+ * dev->t_fine
  *
+ * @return Temperature in 0.01 degC, clamped to -40..85 degC
+**************************************************************
+ */
+int32_t BME280_COMP_TEMP(BME280_Dev *dev)
+{
+    dev->t_fine = BME280_TFINE_KERNEL(&dev->derived, dev->temp);
+    return BME280_TEMP_KERNEL(dev->t_fine);
+}
+/*!
+**************************************************************
+ * @brief Compensate the raw pressure in dev->press, needs the t_fine
+ * of BME280_COMP_TEMP
  *
- * @param[in]  deviceAddr Description
- * @param[out]   
+ * @return Pressure in Pa, 0 on invalid calibration
+**************************************************************
+ */
+uint32_t BME280_COMP_PRESSURE(BME280_Dev *dev)
+{
+    return BME280_PRESS_KERNEL(&dev->derived, dev->t_fine, dev->press);
+}
+/*!
+**************************************************************
+ * @brief Compensate the raw pressure in dev->press with 64 bit
+ * intermediates, needs the t_fine of BME280_COMP_TEMP
  *
- * @return Result of 
+ * @note No rounding to whole Pa, but ~20 64 bit multiplies and
+ * a 64 bit division, all in software on the Cortex-M0+
+ *
+ * @return Pressure in Pa as Q24.8, 0 on invalid calibration
+**************************************************************
+ */
+uint32_t BME280_COMP_PRESSURE_INT64(BME280_Dev *dev)
+{
+    return BME280_PRESS64_KERNEL(&dev->derived, dev->t_fine, dev->press);
+}
+/*!
+**************************************************************
+ * @brief Compensate the raw humidity in dev->hum, needs the t_fine
+ * of BME280_COMP_TEMP
+ *
+ * @return Relative humidity in Q22.10 %RH
+**************************************************************
+ */
+uint32_t BME280_COMP_HUM_INT32(BME280_Dev *dev)
+{
+    return BME280_HUM_KERNEL(&dev->derived, dev->t_fine, dev->hum);
+}
+
+/*!
+**************************************************************
+ * @brief Compensate the raw humidity in dev->hum, needs the t_fine
+ * of BME280_COMP_TEMP
+ *
+ * @note Bit-identical to BME280_COMP_HUM_INT32. The t_fine
+ * dependent factors are kept and only rebuilt when t_fine
+ * changes, then a sample costs two multiplies and the square
+ * term.
+ *
+ * @return Relative humidity in Q22.10 %RH
+**************************************************************
+ */
+uint32_t BME280_COMP_HUM_PRECOMP(BME280_Dev *dev)
+{
+    if (!dev->humCoeffValid || dev->humCoeff.tFine != dev->t_fine)
+    {
+        BME280_HUM_COEFF_KERNEL(&dev->derived, dev->t_fine, &dev->humCoeff);
+        dev->humCoeffValid = true;
+    }
+    return BME280_HUM_APPLY_KERNEL(&dev->humCoeff, dev->hum);
+}
+
+/*!
+**************************************************************
+ * @brief Compensate a series of recorded raw samples without
+ * a device context
+ *
+ * @note Same integer formulas as BME280_COMP_TEMP/PRESSURE/
+ * HUM_INT32, so the results are bit-identical. The samples are
+ * processed in chunks of BME280_BATCH_CHUNK, one formula per
+ * pass, so the host compiler can vectorize each pass.
+ *
+ * @param[in]  comp        Calibration of the recording device
+ * @param[in]  adcT        Raw temperatures, count entries
+ * @param[in]  adcP        Raw pressures, may be NULL if pressure is NULL
+ * @param[in]  adcH        Raw humidities, may be NULL if humidity is NULL
+ * @param[in]  count       Number of samples
+ * @param[out] temperature 0.01 degC, may be NULL
+ * @param[out] pressure    Pa, may be NULL
+ * @param[out] humidity    Q22.10 %RH, may be NULL
  *
  * @retval = 0 -> Success
- * @retval > 0 -> Warning
  * @retval < 0 -> Fail
- *
- * 
 **************************************************************
  */
-void BME280_MEASUREMENT_TIME(void)
+int8_t BME280_COMP_BATCH(const struct CompData *comp, const int32_t *restrict adcT, const int32_t *restrict adcP,
+                         const int32_t *restrict adcH, size_t count, int32_t *restrict temperature,
+                         uint32_t *restrict pressure, uint32_t *restrict humidity)
 {
-    float32_t timeTyp;
-    float32_t timeMax;
-    uint8_t osTime;
-    uint8_t osHum;
-    uint8_t osPress;
-    float32_t stdByMode;
+    int32_t tFine[BME280_BATCH_CHUNK];
 
-    switch (ovsTime)
+    if (comp == NULL || adcT == NULL || (pressure != NULL && adcP == NULL) || (humidity != NULL && adcH == NULL))
     {
-    case BME280_OSRS_T_SKIP:
-        osTime = 0;
-        break;
+        return BME280_E_NULL_PTR;
+    }
+
+    /*!< Derived locally, the coefficients cannot alias the outputs */
+    struct CompCoeff c;
+    BME280_COMP_DERIVE(comp, &c);
+
+    for (size_t base = 0; base < count; base += BME280_BATCH_CHUNK)
+    {
+        size_t n = (count - base < BME280_BATCH_CHUNK) ? count - base : BME280_BATCH_CHUNK;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            tFine[i] = BME280_TFINE_KERNEL(&c, adcT[base + i]);
+        }
+        if (temperature != NULL)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                temperature[base + i] = BME280_TEMP_KERNEL(tFine[i]);
+            }
+        }
+        if (pressure != NULL)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                pressure[base + i] = BME280_PRESS_KERNEL(&c, tFine[i], adcP[base + i]);
+            }
+        }
+        if (humidity != NULL)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                humidity[base + i] = BME280_HUM_KERNEL(&c, tFine[i], adcH[base + i]);
+            }
+        }
+    }
+    return 0;
+}
+
+/*!
+**************************************************************
+ * @brief Measurement time, output data rate and IIR response
+ * of the current oversampling, standby and filter settings
+ * (datasheet 9.1 / 9.2)
+ *
+ * @return Maximum measurement time in us, the delay between a
+ * forced-mode trigger and valid data registers
+**************************************************************
+ */
+uint32_t BME280_MEASUREMENT_TIME(BME280_Dev *dev)
+{
+    uint32_t timeTypUs;
+    uint32_t timeMaxUs;
+    uint8_t osTime = 0;
+    uint8_t osHum = 0;
+    uint8_t osPress = 0;
+    uint32_t stdByUs = 0;
+
+    switch (dev->ovsTime)
+    {
+    case BME280_OSRS_T_SKIP:
+        osTime = 0;
+        break;
     case BME280_OSRS_T_x1:
         osTime = 1;
         break;
@@ -1019,7 +1122,7 @@ void BME280_MEASUREMENT_TIME(void)
         break;
     }
 
-    switch (ovsHumidity)
+    switch (dev->ovsHumidity)
     {
     case BME280_OSRS_H_SKIP:
         osHum = 0;
@@ -1044,7 +1147,7 @@ void BME280_MEASUREMENT_TIME(void)
         break;
     }
 
-    switch (ovsPressure)
+    switch (dev->ovsPressure)
     {
     case BME280_OSRS_P_SKIP:
         osPress = 0;
@@ -1069,57 +1172,50 @@ void BME280_MEASUREMENT_TIME(void)
         break;
     }
 
-    timeTyp = 1 + (2 * osTime) + (2 * osPress + 0.5) + (2 * osHum + 0.5);
-    timeMax = 1.25 + (2.3 * osTime) + (2.3 * osPress + 0.5) + (2.3 * osHum + 0.575);
+    /*!< Datasheet 9.1 in us, integer only: no soft-float or soft-double on the M0+ */
+    timeTypUs = 1000 + (2000 * osTime) + (2000 * osPress + 500) + (2000 * osHum + 500);
+    timeMaxUs = 1250 + (2300 * osTime) + (2300 * osPress + 575) + (2300 * osHum + 575);
 
-    switch (stdBy)
+    switch (dev->stdBy)
     {
     case BME280_STBY_0_5:
-        stdByMode = 0.5;
+        stdByUs = 500;
         break;
     case BME280_STBY_62_5:
-        stdByMode = 62.5;
+        stdByUs = 62500;
         break;
     case BME280_STBY_125:
-        stdByMode = 125;
+        stdByUs = 125000;
         break;
     case BME280_STBY_250:
-        stdByMode = 250;
+        stdByUs = 250000;
         break;
     case BME280_STBY_500:
-        stdByMode = 5;
+        stdByUs = 500000;
         break;
     case BME280_STBY_1000:
-        stdByMode = 1000;
+        stdByUs = 1000000;
         break;
     case BME280_STBY_10:
-        stdByMode = 10;
+        stdByUs = 10000;
         break;
     case BME280_STBY_20:
-        stdByMode = 20;
+        stdByUs = 20000;
         break;
 
     default:
         break;
     }
 
-    float32_t odrMs;
-    if (measureMode == BME280_NORMAL_MODE)
-    {
-        odrMs = 1000 / (timeMax + stdByMode);
-    }
-    else if (measureMode == BME280_FORCED_MODE)
-    {
-        odrMs = 1000 / (timeMax);
-    }
-    else
+    uint32_t periodUs = timeMaxUs; /*!< Forced mode: one conversion per trigger */
+    if (dev->measureMode == BME280_NORMAL_MODE)
     {
-        __NOP();
+        periodUs += stdByUs;
     }
 
     uint32_t stepRsp = 0;
 
-    switch (filtCoeff)
+    switch (dev->filtCoeff)
     {
     case BME280_FILTER_OFF:
         stepRsp = 1;
@@ -1141,11 +1237,13 @@ void BME280_MEASUREMENT_TIME(void)
         break;
     }
 
-    float32_t rspTimeIIR;
-    rspTimeIIR = 1000 * stepRsp / odrMs;
+    uint32_t odrMilliHz = 1000000000u / periodUs;
+    uint32_t rspTimeIirUs = stepRsp * periodUs;
     debugMsg("====================  BME280 RESPONSE TIMING STARTED =================\r\n");
-    debug2Val("[X] MeasurementRate: %f Hz\n[X] IIR-ResponseTime: %.2f ms\n", odrMs, rspTimeIIR);
-    debug2Val("[X] Typ. MeasurementTime: %f ms\n[X] Max. MeasurementTime: %.2f ms\n", timeTyp, timeMax);
+    debug2Val("[X] MeasurementRate: %u mHz\n[X] IIR-ResponseTime: %u us\n", odrMilliHz, rspTimeIirUs);
+    debug2Val("[X] Typ. MeasurementTime: %u us\n[X] Max. MeasurementTime: %u us\n", timeTypUs, timeMaxUs);
+
+    return timeMaxUs;
 }
 /*!
 **************************************************************
@@ -1165,21 +1263,81 @@ void BME280_MEASUREMENT_TIME(void)
  * 
 **************************************************************
  */
-void BME280_DATA_READ(int32_t temperature, uint32_t pressure, uint32_t humidity)
+void BME280_DATA_READ(BME280_Dev *dev, int32_t temperature, uint32_t pressure, uint32_t humidity)
 {
     debugMsg("====================  BME280 SENSOR DATA READING STARTED =============\r\n");
-    temperature = BME280_COMP_TEMP();
+    temperature = BME280_COMP_TEMP(dev);
     debugVal("[X] Temperature: %.2f °C \r\n", temperature / 100.0f);
-    pressure = BME280_COMP_PRESSURE();
+    pressure = BME280_COMP_PRESSURE(dev);
     debugVal("[X] Pressure: %.2f °hPa \r\n", pressure / 100.0f);
-    /* 
-    double humidity = BME280_COMP_HUM_DOUBLE();
-    debugVal("[X] Humidity: %lf \r\n", humidity); 
-    */
-    humidity = BME280_COMP_HUM_INT32();
+    humidity = BME280_COMP_HUM_INT32(dev);
     debugVal("[X] Humidity: %.2f %% \r\n", humidity / 1024.0f);
 }
 /*!
+**************************************************************
+ * @brief Bind a context to a sensor and bring the sensor up:
+ * calibration, soft reset and the acquisition settings
+ *
+ * @param[out] dev  Context, owned by the caller for the lifetime
+ *                  of the sensor
+ * @param[in]  i2c  Bus the sensor is wired to
+ * @param[in]  addr BME280_I2C_ADDR_PRIMARY (SDO low) or
+ *                  BME280_I2C_ADDR_SECONDARY (SDO high)
+ *
+ * @retval = 0 -> Success
+ * @retval < 0 -> Fail, no BME280 at this address, the
+ *                calibration or configuration transfer failed or
+ *                the NVM copy after the soft reset did not finish
+**************************************************************
+ */
+int8_t BME280_INIT(BME280_Dev *dev, i2c_inst_t *i2c, uint8_t addr)
+{
+    memset(dev, 0, sizeof(*dev));
+    dev->i2c = i2c;
+    dev->addr = addr;
+    dev->acqDone = true;
+
+    /*=========================================================*/
+    /*== BME280 SETTINGS ======================================*/
+    /*=========================================================*/
+    BME280_SET_DMA(dev);
+    if (BME280_CHIPID(dev) != 0)
+    {
+        return BME280_E_DEV_NOT_FOUND;
+    }
+    int8_t ret = BME280_READ_COMP(dev);
+    if (ret != 0)
+    {
+        return ret; /*!< Zeroed coefficients would compensate to garbage */
+    }
+    ret = BME280_SOFT_RESET(dev);
+    if (ret != 0)
+    {
+        return ret;
+    }
+    BME280_CONFIG_BEGIN(dev);
+    BME280_SET_STANDBY(dev, BME280_STBY_0_5);
+    BME280_SET_OSRS_H(dev, BME280_OSRS_H_x1);
+    BBME280_SET_OSRS_T(dev, BME280_OSRS_T_x2);
+    BME280_SET_OSRS_P(dev, BME280_OSRS_P_x16);
+#if BME280_FORCED_SCHED
+    /*!< Samples are one loop apart, an IIR filter would only add lag */
+    BME280_SET_FILTER(dev, BME280_FILTER_OFF);
+    BME280_SET_MODE(dev, BME280_SLEEP_MODE);
+    dev->measureMode = BME280_FORCED_MODE; /*!< Conversions are triggered by BME280_ASYNC_ACQUIRE */
+#else
+    BME280_SET_FILTER(dev, BME280_FILTER_16);
+    BME280_SET_MODE(dev, BME280_NORMAL_MODE);
+#endif
+    ret = BME280_APPLY_CONFIG(dev);
+    if (ret != 0)
+    {
+        return ret; /*!< The shadow registers do not match the device */
+    }
+    dev->measTimeMaxUs = BME280_MEASUREMENT_TIME(dev);
+    return 0;
+}
+/*!
 **************************************************************
  * @brief 
  * 
@@ -1197,20 +1355,12 @@ void BME280_DATA_READ(int32_t temperature, uint32_t pressure, uint32_t humidity)
  * 
 **************************************************************
  */
-void BME280_INIT(void)
+void BME280_READ_REGVALUE(BME280_Dev *dev)
 {
-    /*=========================================================*/
-    /*== BME280 SETTINGS ======================================*/
-    /*=========================================================*/
-    BME280_CHIPID();
-    BME280_READ_COMP();
-    BME280_SOFT_RESET();
-    BME280_SET_STANDBY(BME280_STBY_0_5);
-    BME280_SET_OSRS_H(BME280_OSRS_H_x1);
-    BME280_SET_FILTER(BME280_FILTER_16);
-    BBME280_SET_OSRS_T(BME280_OSRS_T_x2);
-    BME280_SET_OSRS_P(BME280_OSRS_P_x16);
-    BME280_SET_MODE(BME280_NORMAL_MODE);
+    BME280_READ_CTRL_MEAS(dev);
+    BME280_READ_MODE(dev);
+    BME280_READ_STANDBY(dev);
+    BME280_READ_OSRS_H(dev);
 }
 /*!
 **************************************************************
@@ -1230,34 +1380,797 @@ void BME280_INIT(void)
  * 
 **************************************************************
  */
-void BME280_READ_REGVALUE(void)
+void BME280_TEMP_READ(BME280_Dev *dev, int32_t bmeTemp, uint32_t bmePress, uint32_t bmeHum)
+{
+    BME280_RAW_DATA(dev);
+    BME280_DATA_READ(dev, bmeTemp, bmePress, bmeHum);
+    BME280_MEASUREMENT_TIME(dev);
+}
+
+/*=========================================================*/
+/*== BUS STATE ============================================*/
+/*=========================================================*/
+
+/*!< One transaction queue per bus: sensors on the same bus take
+ *   turns, separate buses run their transfers side by side */
+typedef struct BME280_Bus
+{
+    i2c_inst_t *i2c;                /*!< NULL until the first sensor on this bus */
+    BME280_Xfer *xferHead;          /*!< Transaction on the bus or next in line */
+    BME280_Xfer *xferTail;
+#if BME280_I2C_DMA
+    int dmaTxChannel;               /*!< Command words to IC_DATA_CMD, paced by the i2c TX DREQ */
+    int dmaRxChannel;               /*!< Received bytes from IC_DATA_CMD, paced by the i2c RX DREQ */
+    uint32_t dmaCmd[BME280_XFER_MAX_LEN + 1];
+    volatile bool dmaRxDone;
+#endif
+} BME280_Bus;
+
+static BME280_Bus busState[BME280_MAX_BUSES];
+
+static BME280_Bus *BME280_BUS(i2c_inst_t *i2c)
 {
-    BME280_READ_CTRL_MEAS();
-    BME280_READ_MODE();
-    BME280_READ_STANDBY();
-    BME280_READ_OSRS_H();
+    BME280_Bus *bus = &busState[i2c_hw_index(i2c)];
+
+    if (bus->i2c == NULL)
+    {
+        bus->i2c = i2c;
+#if BME280_I2C_DMA
+        bus->dmaTxChannel = -1;
+        bus->dmaRxChannel = -1;
+#endif
+    }
+    return bus;
+}
+
+/*=========================================================*/
+/*== DMA TRANSPORT ========================================*/
+/*=========================================================*/
+
+#if BME280_I2C_DMA
+
+static void BME280_DMA_IRQ_HANDLER(void)
+{
+    for (uint8_t i = 0; i < BME280_MAX_BUSES; i++)
+    {
+        BME280_Bus *bus = &busState[i];
+        if (bus->i2c != NULL && bus->dmaRxChannel >= 0 && dma_channel_get_irq1_status((uint)bus->dmaRxChannel))
+        {
+            dma_channel_acknowledge_irq1((uint)bus->dmaRxChannel);
+            bus->dmaRxDone = true;
+        }
+    }
 }
+
 /*!
 **************************************************************
- * @brief 
- * 
+ * @brief Claim the two channels of the DMA transport of the
+ * sensor's bus and hook the read completion into DMA_IRQ_1
+ * (shared), once per bus
  *
+ * @note Without free channels the queue keeps running on the
+ * CPU through i2c_*_blocking.
  *
- * @param[in]  deviceAddr Description
- * @param[out]   
+ * @retval = 0 -> Success
+ * @retval < 0 -> Fail
+**************************************************************
+ */
+int8_t BME280_SET_DMA(BME280_Dev *dev)
+{
+    BME280_Bus *bus = BME280_BUS(dev->i2c);
+
+    if (bus->dmaTxChannel >= 0)
+    {
+        return 0;
+    }
+
+    bus->dmaTxChannel = dma_claim_unused_channel(false);
+    bus->dmaRxChannel = dma_claim_unused_channel(false);
+    if (bus->dmaTxChannel < 0 || bus->dmaRxChannel < 0)
+    {
+        if (bus->dmaTxChannel >= 0)
+        {
+            dma_channel_unclaim((uint)bus->dmaTxChannel);
+        }
+        if (bus->dmaRxChannel >= 0)
+        {
+            dma_channel_unclaim((uint)bus->dmaRxChannel);
+        }
+        bus->dmaTxChannel = -1;
+        bus->dmaRxChannel = -1;
+        debugMsg("[X] BME280 no DMA channels, CPU transfers [X] \r\n");
+        return BME280_E_NO_DMA;
+    }
+
+    i2c_get_hw(dev->i2c)->dma_cr = I2C_IC_DMA_CR_TDMAE_BITS | I2C_IC_DMA_CR_RDMAE_BITS;
+
+    dma_channel_set_irq1_enabled((uint)bus->dmaRxChannel, true);
+    irq_add_shared_handler(DMA_IRQ_1, BME280_DMA_IRQ_HANDLER, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+
+    return 0;
+}
+
+/*!< Fill the command list and arm both channels, the controller takes it from there */
+static void BME280_DMA_START(BME280_Bus *bus, BME280_Xfer *xfer)
+{
+    i2c_hw_t *hw = i2c_get_hw(bus->i2c);
+    uint8_t count = 0;
+
+    if (hw->tar != xfer->dev->addr)
+    {
+        /*!< The bus is idle between transactions, the target may change */
+        hw->enable = 0;
+        hw->tar = xfer->dev->addr;
+        hw->enable = 1;
+    }
+    (void)hw->clr_tx_abrt; /*!< Read to clear */
+    (void)hw->clr_stop_det;
+    bus->dmaRxDone = false;
+
+    if (xfer->kind == BME280_XFER_READ)
+    {
+        bus->dmaCmd[count++] = xfer->reg;
+        for (uint8_t i = 0; i < xfer->len; i++)
+        {
+            bus->dmaCmd[count++] = I2C_IC_DATA_CMD_CMD_BITS | (i == 0 ? I2C_IC_DATA_CMD_RESTART_BITS : 0) |
+                                   (i == xfer->len - 1 ? I2C_IC_DATA_CMD_STOP_BITS : 0);
+        }
+
+        dma_channel_config rx = dma_channel_get_default_config((uint)bus->dmaRxChannel);
+        channel_config_set_transfer_data_size(&rx, DMA_SIZE_8);
+        channel_config_set_read_increment(&rx, false);
+        channel_config_set_write_increment(&rx, true);
+        channel_config_set_dreq(&rx, i2c_get_dreq(bus->i2c, false));
+        dma_channel_configure((uint)bus->dmaRxChannel, &rx, xfer->data, &hw->data_cmd, xfer->len, true);
+    }
+    else
+    {
+        for (uint8_t i = 0; i < xfer->len; i++)
+        {
+            bus->dmaCmd[count++] = xfer->data[i] | (i == xfer->len - 1 ? I2C_IC_DATA_CMD_STOP_BITS : 0);
+        }
+    }
+
+    dma_channel_config tx = dma_channel_get_default_config((uint)bus->dmaTxChannel);
+    channel_config_set_transfer_data_size(&tx, DMA_SIZE_32);
+    channel_config_set_read_increment(&tx, true);
+    channel_config_set_write_increment(&tx, false);
+    channel_config_set_dreq(&tx, i2c_get_dreq(bus->i2c, true));
+    dma_channel_configure((uint)bus->dmaTxChannel, &tx, &hw->data_cmd, bus->dmaCmd, count, true);
+}
+
+/*!
+**************************************************************
+ * @brief Start or check the DMA transfer of the queue head
  *
- * @return Result of 
+ * @note A write is done once all commands left the TX channel
+ * and the STOP went out, a read once the RX channel interrupt
+ * fired. A NAK aborts the controller (TX_ABRT).
+ *
+ * @retval = 0 -> Done
+ * @retval < 0 -> Fail, BME280_E_BUSY while on the bus
+**************************************************************
+ */
+static int8_t BME280_DMA_STEP(BME280_Bus *bus, BME280_Xfer *xfer)
+{
+    i2c_hw_t *hw = i2c_get_hw(bus->i2c);
+
+    if (xfer->state == BME280_XFER_QUEUED)
+    {
+        xfer->state = BME280_XFER_ACTIVE;
+        BME280_DMA_START(bus, xfer);
+    }
+
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)
+    {
+        dma_channel_abort((uint)bus->dmaTxChannel);
+        dma_channel_abort((uint)bus->dmaRxChannel);
+        (void)hw->clr_tx_abrt;
+        return BME280_E_COMM_FAIL;
+    }
+    if (xfer->kind == BME280_XFER_READ)
+    {
+        return bus->dmaRxDone ? 0 : BME280_E_BUSY;
+    }
+    if (dma_channel_is_busy((uint)bus->dmaTxChannel) || !(hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_STOP_DET_BITS))
+    {
+        return BME280_E_BUSY;
+    }
+    return 0;
+}
+
+#else
+
+int8_t BME280_SET_DMA(BME280_Dev *dev)
+{
+    (void)BME280_BUS(dev->i2c);
+    return BME280_E_NO_DMA;
+}
+
+#endif
+
+/*=========================================================*/
+/*== ASYNC TRANSACTION ====================================*/
+/*=========================================================*/
+
+static void BME280_ASYNC_SUBMIT(BME280_Dev *dev, BME280_Xfer *xfer)
+{
+    BME280_Bus *bus = BME280_BUS(dev->i2c);
+
+    xfer->dev = dev;
+    xfer->state = BME280_XFER_QUEUED;
+    xfer->result = 0;
+    xfer->next = NULL;
+    if (bus->xferTail == NULL)
+    {
+        bus->xferHead = xfer;
+    }
+    else
+    {
+        bus->xferTail->next = xfer;
+    }
+    bus->xferTail = xfer;
+}
+
+/*!
+**************************************************************
+ * @brief Queue a burst read of len registers starting at reg
+ *
+ * @param[in]  dev      Target sensor, the read joins the queue
+ *                      of its bus
+ * @param[in]  xfer     Caller owned transaction, untouched
+ *                      until its state is DONE
+ * @param[in]  reg      First register address
+ * @param[out] dst      Destination of len bytes
+ * @param[in]  len      Number of registers
+ * @param[in]  callback Called from BME280_ASYNC_POLL on
+ *                      completion, may be NULL
  *
  * @retval = 0 -> Success
- * @retval > 0 -> Warning
  * @retval < 0 -> Fail
+**************************************************************
+ */
+int8_t BME280_ASYNC_READ(BME280_Dev *dev, BME280_Xfer *xfer, uint8_t reg, uint8_t *dst, uint8_t len,
+                         BME280_Callback callback)
+{
+    if (dev == NULL || xfer == NULL || dst == NULL)
+    {
+        return BME280_E_NULL_PTR;
+    }
+    if (len == 0 || len > BME280_XFER_MAX_LEN)
+    {
+        return BME280_E_INVALID_LEN;
+    }
+    if (xfer->state == BME280_XFER_QUEUED || xfer->state == BME280_XFER_ACTIVE)
+    {
+        return BME280_E_BUSY;
+    }
+
+    xfer->kind = BME280_XFER_READ;
+    xfer->reg = reg;
+    xfer->data = dst;
+    xfer->len = len;
+    xfer->callback = callback;
+
+    BME280_ASYNC_SUBMIT(dev, xfer);
+
+    return 0;
+}
+
+/*!
+**************************************************************
+ * @brief Queue a write of (register, value) pairs, all pairs
+ * go out in one bus transaction
  *
- * 
+ * @param[in]  pairs    Register/value pairs, must stay valid
+ *                      until the transaction is DONE
+ * @param[in]  len      Number of bytes (2 per register)
+ *
+ * @retval = 0 -> Success
+ * @retval < 0 -> Fail
+**************************************************************
+ */
+int8_t BME280_ASYNC_WRITE(BME280_Dev *dev, BME280_Xfer *xfer, uint8_t *pairs, uint8_t len, BME280_Callback callback)
+{
+    if (dev == NULL || xfer == NULL || pairs == NULL)
+    {
+        return BME280_E_NULL_PTR;
+    }
+    if (len == 0 || (len & 0x01) != 0 || len > BME280_XFER_MAX_LEN)
+    {
+        return BME280_E_INVALID_LEN;
+    }
+    if (xfer->state == BME280_XFER_QUEUED || xfer->state == BME280_XFER_ACTIVE)
+    {
+        return BME280_E_BUSY;
+    }
+
+    xfer->kind = BME280_XFER_WRITE;
+    xfer->reg = pairs[0];
+    xfer->data = pairs;
+    xfer->len = len;
+    xfer->callback = callback;
+
+    BME280_ASYNC_SUBMIT(dev, xfer);
+
+    return 0;
+}
+
+/*!
+**************************************************************
+ * @brief Queue a bus pause, transactions behind it start
+ * waitUs after the previous one completed (soft reset, NVM copy)
+ *
+ * @retval = 0 -> Success
+ * @retval < 0 -> Fail
+**************************************************************
+ */
+int8_t BME280_ASYNC_WAIT(BME280_Dev *dev, BME280_Xfer *xfer, uint32_t waitUs, BME280_Callback callback)
+{
+    if (dev == NULL || xfer == NULL)
+    {
+        return BME280_E_NULL_PTR;
+    }
+    if (xfer->state == BME280_XFER_QUEUED || xfer->state == BME280_XFER_ACTIVE)
+    {
+        return BME280_E_BUSY;
+    }
+
+    xfer->kind = BME280_XFER_WAIT;
+    xfer->waitUs = waitUs;
+    xfer->len = 0;
+    xfer->callback = callback;
+
+    BME280_ASYNC_SUBMIT(dev, xfer);
+
+    return 0;
+}
+
+static void BME280_ASYNC_COMPLETE(BME280_Bus *bus, BME280_Xfer *xfer, int8_t result)
+{
+    bus->xferHead = xfer->next;
+    if (bus->xferHead == NULL)
+    {
+        bus->xferTail = NULL;
+    }
+    xfer->next = NULL;
+    xfer->result = result;
+    xfer->state = BME280_XFER_DONE;
+
+    if (result != 0)
+    {
+        debug2Val("[X] BME280 0x%02X transaction at 0x%02X failed [X] \r\n", xfer->dev->addr, xfer->reg);
+    }
+    if (xfer->callback != NULL)
+    {
+        xfer->callback(xfer); /*!< May queue follow-up transactions */
+    }
+}
+
+/*!< Take a transaction out of the queue before it reaches the bus, no callback */
+static void BME280_ASYNC_CANCEL(BME280_Xfer *xfer, int8_t result)
+{
+    if (xfer->state != BME280_XFER_QUEUED && !(xfer->kind == BME280_XFER_WAIT && xfer->state == BME280_XFER_ACTIVE))
+    {
+        return; /*!< Idle, done or on the bus */
+    }
+
+    BME280_Bus *bus = BME280_BUS(xfer->dev->i2c);
+    BME280_Xfer *prev = NULL;
+    for (BME280_Xfer *it = bus->xferHead; it != NULL; prev = it, it = it->next)
+    {
+        if (it == xfer)
+        {
+            if (prev == NULL)
+            {
+                bus->xferHead = it->next;
+            }
+            else
+            {
+                prev->next = it->next;
+            }
+            if (bus->xferTail == it)
+            {
+                bus->xferTail = prev;
+            }
+            break;
+        }
+    }
+    xfer->next = NULL;
+    xfer->result = result;
+    xfer->state = BME280_XFER_DONE;
+}
+
+/*!
+**************************************************************
+ * @brief Advance the transaction queue of the sensor's bus,
+ * never sleeps
+ *
+ * @note Runs every transaction phase that is due, for every
+ * sensor on the bus. A phase is one bus transfer of a few bytes;
+ * pauses (BME280_ASYNC_WAIT) return to the caller until their
+ * deadline is reached. With BME280_I2C_DMA the transfer is only
+ * started here and runs on while the caller does other work.
+ *
+ * @return Number of transactions still pending on the bus
+**************************************************************
+ */
+uint8_t BME280_ASYNC_POLL(BME280_Dev *dev)
+{
+    BME280_Bus *bus = BME280_BUS(dev->i2c);
+    bool waiting = false;
+    uint8_t pending = 0;
+
+    while (bus->xferHead != NULL && !waiting)
+    {
+        BME280_Xfer *xfer = bus->xferHead;
+        int ret;
+
+#if BME280_I2C_DMA
+        if (xfer->kind != BME280_XFER_WAIT && bus->dmaTxChannel >= 0)
+        {
+            ret = BME280_DMA_STEP(bus, xfer);
+            if (ret == BME280_E_BUSY)
+            {
+                waiting = true;
+            }
+            else
+            {
+                BME280_ASYNC_COMPLETE(bus, xfer, (int8_t)ret);
+            }
+            continue;
+        }
+#endif
+
+        switch (xfer->kind)
+        {
+        case BME280_XFER_WAIT:
+            if (xfer->state == BME280_XFER_QUEUED)
+            {
+                xfer->deadline = make_timeout_time_us(xfer->waitUs);
+                xfer->state = BME280_XFER_ACTIVE;
+            }
+            if (time_reached(xfer->deadline))
+            {
+                BME280_ASYNC_COMPLETE(bus, xfer, 0);
+            }
+            else
+            {
+                waiting = true;
+            }
+            break;
+
+        case BME280_XFER_WRITE:
+            xfer->state = BME280_XFER_ACTIVE;
+            ret = i2c_write_blocking(bus->i2c, xfer->dev->addr, xfer->data, xfer->len, false);
+            BME280_ASYNC_COMPLETE(bus, xfer, ret == xfer->len ? 0 : BME280_E_COMM_FAIL);
+            break;
+
+        case BME280_XFER_READ:
+        default:
+            /*!< Register pointer, the read follows with a repeated start */
+            xfer->state = BME280_XFER_ACTIVE;
+            if (i2c_write_blocking(bus->i2c, xfer->dev->addr, &xfer->reg, 1, true) != 1)
+            {
+                BME280_ASYNC_COMPLETE(bus, xfer, BME280_E_COMM_FAIL);
+                break;
+            }
+            ret = i2c_read_blocking(bus->i2c, xfer->dev->addr, xfer->data, xfer->len, false);
+            BME280_ASYNC_COMPLETE(bus, xfer, ret == xfer->len ? 0 : BME280_E_COMM_FAIL);
+            break;
+        }
+    }
+
+    for (BME280_Xfer *xfer = bus->xferHead; xfer != NULL; xfer = xfer->next)
+    {
+        pending++;
+    }
+    return pending;
+}
+
+/*!
+**************************************************************
+ * @brief Run the queue of the sensor's bus until every
+ * transaction is done
+ *
+ * @retval = 0 -> Success
+**************************************************************
+ */
+int8_t BME280_ASYNC_DRAIN(BME280_Dev *dev)
+{
+    while (BME280_ASYNC_POLL(dev) > 0)
+    {
+        tight_loop_contents();
+    }
+    return 0;
+}
+
+static void BME280_ACQ_BURST_DONE(BME280_Xfer *xfer)
+{
+    BME280_Dev *dev = xfer->dev;
+
+    if (xfer->result == 0 && (dev->acqBurst[0] & BME280_STATUS_IM_UPDATE))
+    {
+        /*!< NVM copy running, the data registers are not valid yet */
+        BME280_ASYNC_READ(dev, &dev->acqXfer, BME280_REGISTER_STATUS, dev->acqBurst, BME280_BURST_LEN,
+                          BME280_ACQ_BURST_DONE);
+        return;
+    }
+    dev->acqDone = true;
+}
+
+#if BME280_FORCED_SCHED
+/*!< The conversion runs from the trigger on: the pause is timed from
+ *   here, not from the moment it reaches the head of the queue */
+static void BME280_ACQ_TRIGGER_DONE(BME280_Xfer *xfer)
+{
+    BME280_Dev *dev = xfer->dev;
+
+    if (xfer->result != 0)
+    {
+        /*!< The sensor stays asleep, the burst would return the previous conversion */
+        BME280_ASYNC_CANCEL(&dev->acqWaitXfer, xfer->result);
+        BME280_ASYNC_CANCEL(&dev->acqXfer, xfer->result);
+        dev->acqDone = true;
+        return;
+    }
+    dev->acqWaitXfer.deadline = make_timeout_time_us(dev->acqWaitXfer.waitUs);
+    dev->acqWaitXfer.state = BME280_XFER_ACTIVE;
+}
+#endif
+
+/*!
+**************************************************************
+ * @brief Queue one acquisition of each sensor, interleaved: all
+ * FORCED triggers go out back to back, then every burst
+ * 0xF3..0xFE is read once its own conversion time has passed
+ * since its trigger. The compensated results are collected per
+ * sensor with BME280_ASYNC_ACQUIRE_RESULT().
+ *
+ * @note Sensors sharing a bus convert in parallel, one loop
+ * period costs the longest conversion plus the reads. Sensors on
+ * different buses run on separate queues. A burst is repeated
+ * while an NVM copy is running.
+ *
+ * @param[in]  devs  Initialized contexts
+ * @param[in]  count Number of contexts
+ *
+ * @retval = 0 -> Success
+ * @retval < 0 -> Fail
+**************************************************************
+ */
+int8_t BME280_ASYNC_ACQUIRE_ALL(BME280_Dev *const *devs, uint8_t count)
+{
+    int8_t ret = 0;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (devs[i] == NULL)
+        {
+            return BME280_E_NULL_PTR;
+        }
+        if (!devs[i]->acqDone)
+        {
+            return BME280_E_BUSY;
+        }
+    }
+
+#if BME280_FORCED_SCHED
+    for (uint8_t i = 0; i < count && ret == 0; i++)
+    {
+        BME280_Dev *dev = devs[i];
+        dev->acqTrigger[0] = BME280_CTRL_MEAS_ADDR;
+        dev->acqTrigger[1] = (dev->shadowCtrlMeas & ~BME280_MODE_MSK) | BME280_FORCED_MODE;
+        ret = BME280_ASYNC_WRITE(dev, &dev->acqTriggerXfer, dev->acqTrigger, sizeof(dev->acqTrigger),
+                                 BME280_ACQ_TRIGGER_DONE);
+    }
+#endif
+    for (uint8_t i = 0; i < count && ret == 0; i++)
+    {
+        BME280_Dev *dev = devs[i];
+        dev->acqDone = false;
+#if BME280_FORCED_SCHED
+        ret = BME280_ASYNC_WAIT(dev, &dev->acqWaitXfer, dev->measTimeMaxUs, NULL);
+        if (ret == 0)
+#endif
+        {
+            ret = BME280_ASYNC_READ(dev, &dev->acqXfer, BME280_REGISTER_STATUS, dev->acqBurst, BME280_BURST_LEN,
+                                    BME280_ACQ_BURST_DONE);
+        }
+    }
+    if (ret != 0)
+    {
+        /*!< Nothing reached the bus yet, take back what this call queued */
+        for (uint8_t i = 0; i < count; i++)
+        {
+#if BME280_FORCED_SCHED
+            BME280_ASYNC_CANCEL(&devs[i]->acqTriggerXfer, ret);
+            BME280_ASYNC_CANCEL(&devs[i]->acqWaitXfer, ret);
+#endif
+            BME280_ASYNC_CANCEL(&devs[i]->acqXfer, ret);
+            devs[i]->acqDone = true;
+        }
+        return ret;
+    }
+    for (uint8_t i = 0; i < count; i++)
+    {
+        BME280_ASYNC_POLL(devs[i]); /*!< Put the triggers on the bus now */
+    }
+    return 0;
+}
+
+/*!
+**************************************************************
+ * @brief Queue one acquisition of a single sensor, see
+ * BME280_ASYNC_ACQUIRE_ALL
+ *
+ * @note With BME280_FORCED_SCHED the burst is preceded by a
+ * FORCED ctrl_meas write and a pause of the maximum measurement
+ * time, so it reads the fresh conversion exactly once.
+ *
+ * @retval = 0 -> Success
+ * @retval < 0 -> Fail
+**************************************************************
+ */
+int8_t BME280_ASYNC_ACQUIRE(BME280_Dev *dev)
+{
+    return BME280_ASYNC_ACQUIRE_ALL(&dev, 1);
+}
+
+/*!
+**************************************************************
+ * @brief Poll the queue and decode the acquisition once done
+ *
+ * @param[out] temperature 0.01 degC
+ * @param[out] pressure    Pa
+ * @param[out] humidity    Q22.10 %RH
+ *
+ * @retval = 0 -> Success
+ * @retval > 0 -> Warning, see BME280_BURST_DECODE
+ * @retval < 0 -> Fail, BME280_E_BUSY while still on the bus
+**************************************************************
+ */
+int8_t BME280_ASYNC_ACQUIRE_RESULT(BME280_Dev *dev, int32_t *temperature, uint32_t *pressure, uint32_t *humidity)
+{
+    BME280_ASYNC_POLL(dev);
+    if (!dev->acqDone)
+    {
+        return BME280_E_BUSY;
+    }
+#if BME280_FORCED_SCHED
+    if (dev->acqTriggerXfer.result != 0)
+    {
+        return dev->acqTriggerXfer.result; /*!< No conversion ran */
+    }
+#endif
+    if (dev->acqXfer.result != 0)
+    {
+        return dev->acqXfer.result;
+    }
+    return BME280_BURST_DECODE(dev, dev->acqBurst, temperature, pressure, humidity);
+}
+
+/*!
+**************************************************************
+ * @brief Collect the acquisition, the CPU sleeps through the
+ * conversion pause and only polls while a transfer is on the bus
+ *
+ * @retval = 0 -> Success
+ * @retval > 0 -> Warning, see BME280_BURST_DECODE
+ * @retval < 0 -> Fail
+**************************************************************
+ */
+int8_t BME280_ASYNC_ACQUIRE_WAIT(BME280_Dev *dev, int32_t *temperature, uint32_t *pressure, uint32_t *humidity)
+{
+    BME280_Bus *bus = BME280_BUS(dev->i2c);
+    int8_t ret;
+
+    while ((ret = BME280_ASYNC_ACQUIRE_RESULT(dev, temperature, pressure, humidity)) == BME280_E_BUSY)
+    {
+        BME280_Xfer *xfer = bus->xferHead;
+        if (xfer != NULL && xfer->kind == BME280_XFER_WAIT && xfer->state == BME280_XFER_ACTIVE)
+        {
+            sleep_until(xfer->deadline);
+        }
+        else
+        {
+            tight_loop_contents();
+        }
+    }
+    return ret;
+}
+
+/*=========================================================*/
+/*== BURST ACQUISITION ====================================*/
+/*=========================================================*/
+
+/*!
+**************************************************************
+ * @brief Decide freshness from the status byte of a 0xF3..0xFE
+ * burst, unpack the ADC values and compensate them
+ *
+ * @note Data registers are shadowed while a conversion runs, so
+ * the burst is always consistent. Only an NVM copy or a missing
+ * first conversion make it unusable.
+ *
+ * @param[in]  burst       BME280_BURST_LEN bytes read at 0xF3
+ * @param[out] temperature 0.01 degC
+ * @param[out] pressure    Pa
+ * @param[out] humidity    Q22.10 %RH
+ *
+ * @retval = 0 -> Success
+ * @retval > 0 -> Warning, outputs untouched unless BME280_W_STALE
+ * @retval < 0 -> Fail
 **************************************************************
  */
-void BME280_TEMP_READ(int32_t bmeTemp, uint32_t bmePress, uint32_t bmeHum)
+int8_t BME280_BURST_DECODE(BME280_Dev *dev, const uint8_t *burst, int32_t *temperature, uint32_t *pressure,
+                           uint32_t *humidity)
 {
-    BME280_RAW_DATA();
-    BME280_DATA_READ(bmeTemp, bmePress, bmeHum);
-    BME280_MEASUREMENT_TIME();
+    const uint8_t *data = &burst[BME280_BURST_DATA_OFFSET];
+    uint8_t status = burst[0] & ~(BME280_STATUS_MSK);
+    uint8_t ctrlMeas = burst[BME280_CTRL_MEAS_ADDR - BME280_REGISTER_STATUS];
+    int8_t ret = 0;
+
+    if (temperature == NULL || pressure == NULL || humidity == NULL)
+    {
+        return BME280_E_NULL_PTR;
+    }
+    if (status & BME280_STATUS_IM_UPDATE)
+    {
+        return BME280_W_NVM_UPDATE;
+    }
+    if (data[3] == 0x80 && data[4] == 0x00 && (data[5] & 0xF0) == 0x00)
+    {
+        return BME280_W_NO_DATA; /*!< 0x80000 is the reset value of temp */
+    }
+    if ((status & BME280_STATUS_MEASURING) && (ctrlMeas & BME280_MODE_MSK) == BME280_FORCED_MODE)
+    {
+        ret = BME280_W_STALE;
+    }
+
+    BME280_RAW_PARSE(dev, data);
+    *temperature = BME280_COMP_TEMP(dev);
+#if BME280_PRESSURE_INT64
+    *pressure = (BME280_COMP_PRESSURE_INT64(dev) + 128) >> 8;
+#else
+    *pressure = BME280_COMP_PRESSURE(dev);
+#endif
+    *humidity = BME280_COMP_HUM_INT32(dev);
+
+    debugVal("[X] Temperature: %.2f °C \r\n", *temperature / 100.0f);
+    debugVal("[X] Pressure: %.2f °hPa \r\n", *pressure / 100.0f);
+    debugVal("[X] Humidity: %.2f %% \r\n", *humidity / 1024.0f);
+
+    return ret;
+}
+
+/*!
+**************************************************************
+ * @brief Blocking acquisition: status, control and data
+ * registers in one auto-incrementing read, then compensation
+ *
+ * @note Replaces BME280_READ_STATUS polling followed by
+ * BME280_RAW_DATA, two bus transactions instead of four
+ *
+ * @retval = 0 -> Success
+ * @retval > 0 -> Warning, see BME280_BURST_DECODE
+ * @retval < 0 -> Fail
+**************************************************************
+ */
+int8_t BME280_READ_BURST(BME280_Dev *dev, int32_t *temperature, uint32_t *pressure, uint32_t *humidity)
+{
+    uint8_t burst[BME280_BURST_LEN];
+    uint8_t ptrData[] = {BME280_REGISTER_STATUS};
+
+    if (i2c_write_blocking(dev->i2c, dev->addr, ptrData, 1, true) != 1)
+    {
+        return BME280_E_COMM_FAIL;
+    }
+    if (i2c_read_blocking(dev->i2c, dev->addr, burst, BME280_BURST_LEN, false) != BME280_BURST_LEN)
+    {
+        return BME280_E_COMM_FAIL;
+    }
+
+    return BME280_BURST_DECODE(dev, burst, temperature, pressure, humidity);
 }
@@ -58,6 +58,8 @@ typedef float float32_t;
 #define BME280_STATUS_MEASURING     (uint8_t) 0x08 //Running conversion
 #define BME280_STATUS_IM_UPDATE     (uint8_t) 0x01 //NVM data copying
 #define BME280_STATUS_MSK           (uint8_t) 0xF6 //Corrupt BitMask
+#define BME280_STARTUP_POLL_US      (uint32_t) 250 //NVM copy poll interval
+#define BME280_STARTUP_POLLS        (uint8_t) 9 //Status reads, 8 x 250 us between them = t_startup 2 ms
 
 /*=========================================================*/
 /*== STANDBY MACROS =======================================*/
@@ -80,6 +82,13 @@ typedef float float32_t;
 #define BME280_TEMP_PRESS_CALIB_DATA_LEN    (uint8_t) 24
 #define BME280_HUMIDITY_CALIB_DATA_LEN      (uint8_t) 9
 #define BME280_P_T_H_DATA_LEN               (uint8_t) 8
+#define BME280_BURST_LEN                    (uint8_t) 12 /*!< 0xF3 status .. 0xFE hum_lsb */
+#define BME280_BURST_DATA_OFFSET            (uint8_t) 4  /*!< 0xF7 press_msb within the burst */
+#define BME280_BATCH_CHUNK                  64           /*!< Samples per pass of BME280_COMP_BATCH */
+
+/*!< Pressure path of the acquisition: 1 = BME280_COMP_PRESSURE_INT64 rounded
+ *   to Pa, 0 = 32 bit BME280_COMP_PRESSURE (see bench/bench_press) */
+#define BME280_PRESSURE_INT64               0
 
 /*=========================================================*/
 /*== OPERATION MODES ======================================*/
@@ -116,6 +125,40 @@ typedef struct CompData
     int8_t      dig_H6 : 8;
 } BME280_Comp;
 
+/*!< Coefficients of the compensation kernels, derived from CompData
+ *   once per calibration by BME280_COMP_DERIVE */
+typedef struct CompCoeff
+{
+    int32_t     t1;
+    int32_t     t1x2;       /*!< dig_T1 << 1 */
+    int32_t     t2;
+    int32_t     t3;
+    int32_t     p1;
+    int32_t     p2;
+    int32_t     p3;
+    int32_t     p4s16;      /*!< dig_P4 << 16 */
+    int32_t     p5x2;       /*!< dig_P5 << 1 */
+    int32_t     p6;
+    int32_t     p7;
+    int32_t     p8;
+    int32_t     p9;
+    int32_t     h1;
+    int32_t     h2;
+    int32_t     h3;
+    int32_t     h4Offset;   /*!< 16384 - (dig_H4 << 20) */
+    int32_t     h5;
+    int32_t     h6;
+} BME280_CompCoeff;
+
+/*!< t_fine dependent humidity factors of BME280_COMP_HUM_PRECOMP */
+typedef struct HumCoeff
+{
+    int32_t     tFine;  /*!< t_fine the factors belong to */
+    int32_t     offset; /*!< 16384 - (dig_H4 << 20) - dig_H5 * (t_fine - 76800) */
+    int32_t     scale;  /*!< dig_H2, dig_H3 and dig_H6 term, Q14 */
+    int32_t     h1;
+} BME280_HumCoeff;
+
 /*=========================================================*/
 /*== COMPENSATION REGISTER ================================*/
 /*=========================================================*/
@@ -188,53 +231,156 @@ typedef struct CompData
 #define BME280_E_NVM_COPY_FAILED    (int8_t) -6
 #define BME280_E_INVALID_ID         (int8_t) -7
 #define BME280_E_MEMORY_ALLOC       (int8_t) -8
+#define BME280_E_BUSY               (int8_t) -9
+#define BME280_E_NO_DMA             (int8_t) -10
+
+#define BME280_W_NVM_UPDATE         (int8_t) 1 /*!< NVM copy running, values not updated */
+#define BME280_W_NO_DATA            (int8_t) 2 /*!< No conversion since reset, values not updated */
+#define BME280_W_STALE              (int8_t) 3 /*!< Forced conversion running, values are the previous ones */
 
 /*=========================================================*/
-/*== GLOBAL VARIABLES =====================================*/
+/*== ASYNC TRANSACTION ====================================*/
 /*=========================================================*/
 
-struct CompData Comp;
-struct CompData *ptrComp;
+#define BME280_XFER_READ        (uint8_t) 0x00 /*!< Register pointer write, repeated start, burst read */
+#define BME280_XFER_WRITE       (uint8_t) 0x01 /*!< (register, value) pairs in one write */
+#define BME280_XFER_WAIT        (uint8_t) 0x02 /*!< Bus stays idle for waitUs, e.g. NVM copy */
+
+#define BME280_XFER_IDLE        (uint8_t) 0x00
+#define BME280_XFER_QUEUED      (uint8_t) 0x01
+#define BME280_XFER_ACTIVE      (uint8_t) 0x02
+#define BME280_XFER_DONE        (uint8_t) 0x03
+
+#define BME280_XFER_MAX_LEN     (uint8_t) 32 /*!< Longest burst read, one data_cmd word per byte */
+
+/*!< 1: transfers are moved by two DMA channels paced by the i2c DREQs,
+ *   0: the CPU runs them with i2c_*_blocking from BME280_ASYNC_POLL */
+#define BME280_I2C_DMA          1
 
-uint8_t ovsTime;     /*! @brief Help variable for measurement time function */
-uint8_t ovsPressure; /*! @brief Help variable for measurement time function */
-uint8_t ovsHumidity; /*! @brief Help variable for measurement time function */
-uint8_t measureMode; /*! @brief Help variable for measurement time function */
-uint8_t stdBy;       /*! @brief Help variable for measurement time function */
-uint8_t filtCoeff;   /*! @brief Help variable for measurement time function */
+/*!< 1: every acquisition triggers one FORCED conversion, waits the maximum
+ *   measurement time and reads once; the sensor sleeps in between,
+ *   0: NORMAL mode with 0.5 ms standby and IIR filter 16 */
+#define BME280_FORCED_SCHED     1
 
-int32_t t_fine; /*! @brief t_fine carries fine temperature as global value*/
-int32_t press, temp, hum;
+#define BME280_MAX_BUSES        2 /*!< i2c0 and i2c1, one transaction queue each */
+
+struct BME280_Xfer;
+struct BME280_Dev;
+typedef void (*BME280_Callback)(struct BME280_Xfer *xfer);
+
+/*!< Caller owned transaction, stays linked in the queue of its bus until done */
+typedef struct BME280_Xfer
+{
+    uint8_t kind;
+    volatile uint8_t state;
+    int8_t result;          /*!< 0 or BME280_E_COMM_FAIL once state is DONE */
+    uint8_t reg;
+    uint8_t *data;          /*!< Read destination or write payload */
+    uint8_t len;
+    uint32_t waitUs;
+    absolute_time_t deadline;
+    BME280_Callback callback;
+    void *user;
+    struct BME280_Dev *dev; /*!< Target device, set when queued */
+    struct BME280_Xfer *next;
+} BME280_Xfer;
+
+/*=========================================================*/
+/*== DEVICE CONTEXT =======================================*/
+/*=========================================================*/
+
+/*!< State of one sensor, passed to every BME280_* call. Contexts
+ *   only share the transaction queue of their bus, so sensors on
+ *   different buses may be driven from different cores. */
+typedef struct BME280_Dev
+{
+    i2c_inst_t *i2c;
+    uint8_t addr;                   /*!< BME280_I2C_ADDR_PRIMARY or _SECONDARY */
+
+    struct CompData comp;
+    struct CompCoeff derived;       /*!< Derived from comp by BME280_READ_COMP */
+    struct HumCoeff humCoeff;       /*!< Humidity factors of the last t_fine */
+    bool humCoeffValid;
+
+    /*!< Shadow copies of ctrl_hum, ctrl_meas and config, equal to the
+     *   device registers unless a configuration batch is open */
+    uint8_t shadowCtrlHum;
+    uint8_t shadowCtrlMeas;
+    uint8_t shadowConfig;
+    bool configDeferred;
+
+    uint8_t ovsTime;                /*!< Settings for BME280_MEASUREMENT_TIME */
+    uint8_t ovsPressure;
+    uint8_t ovsHumidity;
+    uint8_t measureMode;
+    uint8_t stdBy;
+    uint8_t filtCoeff;
+    uint32_t measTimeMaxUs;         /*!< Forced conversion time of the applied settings */
+
+    int32_t t_fine;                 /*!< Fine temperature of the last BME280_COMP_TEMP */
+    int32_t press, temp, hum;       /*!< Raw ADC values of the last BME280_RAW_PARSE */
+
+    BME280_Xfer acqXfer;
+    uint8_t acqBurst[BME280_BURST_LEN];
+    volatile bool acqDone;
+#if BME280_FORCED_SCHED
+    BME280_Xfer acqTriggerXfer;
+    BME280_Xfer acqWaitXfer;
+    uint8_t acqTrigger[2];
+#endif
+} BME280_Dev;
 
 /*=========================================================*/
 /*== PROTOTYPE DECLARATION ================================*/
 /*=========================================================*/
 
-int8_t BME280_CHIPID(void);
-int8_t BME280_READ_STATUS(void);
-int8_t BME280_SOFT_RESET(void);
-int8_t BME280_SET_MODE(uint8_t deviceMode);
-int8_t BME280_READ_MODE(void);
-int8_t BME280_READ_COMP(void);
+int8_t BME280_CHIPID(BME280_Dev *dev);
+int8_t BME280_READ_STATUS(BME280_Dev *dev);
+int8_t BME280_SOFT_RESET(BME280_Dev *dev);
+int8_t BME280_SET_MODE(BME280_Dev *dev, uint8_t deviceMode);
+int8_t BME280_READ_MODE(BME280_Dev *dev);
+int8_t BME280_READ_COMP(BME280_Dev *dev);
 void BME280_PRINT_COMP(struct CompData *ptrComp);
-void BME280_SET_STANDBY(uint8_t tsb);
-void BME280_READ_STANDBY(void);
-void BME280_SET_FILTER(uint8_t filter);
-void BME280_READ_FILTER(void);
-void BME280_SET_OSRS_H(uint8_t osrs_h);
-void BME280_READ_OSRS_H(void);
-void BBME280_SET_OSRS_T(uint8_t osrs_t);
-void BME280_SET_OSRS_P(uint8_t osrs_p);
-void BME280_READ_CTRL_MEAS(void);
-void BME280_RAW_DATA(void);
-int32_t BME280_COMP_TEMP(void);
-void BME280_MEASUREMENT_TIME(void);
-uint32_t BME280_COMP_PRESSURE(void);
-double BME280_COMP_HUM_DOUBLE(void);
-uint32_t BME280_COMP_HUM_INT32(void);
-void BME280_DATA_READ(int32_t temperature, uint32_t pressure, uint32_t humidity);
-void BME280_INIT(void);
-void BME280_READ_REGVALUE(void);
-void BME280_TEMP_READ(int32_t bmeTemp, uint32_t bmePress, uint32_t bmeHum);
+void BME280_SET_STANDBY(BME280_Dev *dev, uint8_t tsb);
+void BME280_READ_STANDBY(BME280_Dev *dev);
+void BME280_SET_FILTER(BME280_Dev *dev, uint8_t filter);
+void BME280_READ_FILTER(BME280_Dev *dev);
+void BME280_SET_OSRS_H(BME280_Dev *dev, uint8_t osrs_h);
+void BME280_READ_OSRS_H(BME280_Dev *dev);
+void BBME280_SET_OSRS_T(BME280_Dev *dev, uint8_t osrs_t);
+void BME280_SET_OSRS_P(BME280_Dev *dev, uint8_t osrs_p);
+void BME280_READ_CTRL_MEAS(BME280_Dev *dev);
+void BME280_CONFIG_BEGIN(BME280_Dev *dev);
+int8_t BME280_APPLY_CONFIG(BME280_Dev *dev);
+int8_t BME280_READ_CONFIG(BME280_Dev *dev);
+void BME280_RAW_DATA(BME280_Dev *dev);
+void BME280_RAW_PARSE(BME280_Dev *dev, const uint8_t *buffer);
+int32_t BME280_COMP_TEMP(BME280_Dev *dev);
+uint32_t BME280_MEASUREMENT_TIME(BME280_Dev *dev);
+uint32_t BME280_COMP_PRESSURE(BME280_Dev *dev);
+uint32_t BME280_COMP_PRESSURE_INT64(BME280_Dev *dev);
+void BME280_COMP_DERIVE(const struct CompData *comp, struct CompCoeff *coeff);
+uint32_t BME280_COMP_HUM_INT32(BME280_Dev *dev);
+uint32_t BME280_COMP_HUM_PRECOMP(BME280_Dev *dev);
+int8_t BME280_COMP_BATCH(const struct CompData *comp, const int32_t *adcT, const int32_t *adcP, const int32_t *adcH,
+                         size_t count, int32_t *temperature, uint32_t *pressure, uint32_t *humidity);
+void BME280_DATA_READ(BME280_Dev *dev, int32_t temperature, uint32_t pressure, uint32_t humidity);
+int8_t BME280_INIT(BME280_Dev *dev, i2c_inst_t *i2c, uint8_t addr);
+void BME280_READ_REGVALUE(BME280_Dev *dev);
+void BME280_TEMP_READ(BME280_Dev *dev, int32_t bmeTemp, uint32_t bmePress, uint32_t bmeHum);
+int8_t BME280_ASYNC_READ(BME280_Dev *dev, BME280_Xfer *xfer, uint8_t reg, uint8_t *dst, uint8_t len,
+                         BME280_Callback callback);
+int8_t BME280_ASYNC_WRITE(BME280_Dev *dev, BME280_Xfer *xfer, uint8_t *pairs, uint8_t len, BME280_Callback callback);
+int8_t BME280_ASYNC_WAIT(BME280_Dev *dev, BME280_Xfer *xfer, uint32_t waitUs, BME280_Callback callback);
+uint8_t BME280_ASYNC_POLL(BME280_Dev *dev);
+int8_t BME280_ASYNC_DRAIN(BME280_Dev *dev);
+int8_t BME280_SET_DMA(BME280_Dev *dev);
+int8_t BME280_ASYNC_ACQUIRE(BME280_Dev *dev);
+int8_t BME280_ASYNC_ACQUIRE_ALL(BME280_Dev *const *devs, uint8_t count);
+int8_t BME280_ASYNC_ACQUIRE_RESULT(BME280_Dev *dev, int32_t *temperature, uint32_t *pressure, uint32_t *humidity);
+int8_t BME280_ASYNC_ACQUIRE_WAIT(BME280_Dev *dev, int32_t *temperature, uint32_t *pressure, uint32_t *humidity);
+int8_t BME280_BURST_DECODE(BME280_Dev *dev, const uint8_t *burst, int32_t *temperature, uint32_t *pressure,
+                           uint32_t *humidity);
+int8_t BME280_READ_BURST(BME280_Dev *dev, int32_t *temperature, uint32_t *pressure, uint32_t *humidity);
 
 #endif
\ No newline at end of file
@@ -14,6 +14,10 @@
 /*=========================================================*/
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/clocks.h"
 
 /*=========================================================*/
 /*== PRIVATE INCLUDES =====================================*/
@@ -23,177 +27,1365 @@
 #include "waterpipe.h" /* Insert for Error Log Function! */
 #include "ds18b20.h"
 
+/*=========================================================*/
+/*== 1-WIRE ENGINE ========================================*/
+/*=========================================================*/
+
+/*!
+**************************************************************
+ * PIO program, one cycle per microsecond. The pin output level
+ * is 0 and side-set drives the pin direction, so side 1 pulls
+ * the bus low and side 0 releases it to the pull-up.
+ *
+ * Every bit written from the TX FIFO is also a read slot: a
+ * written 1 releases the bus after 6 us and samples it at
+ * 13 us, a written 0 holds it low for the whole slot. The
+ * sampled bit enters the ISR as the last action of the slot,
+ * so a completed RX byte means the bus is idle again.
+ * Autopull/autopush at 8 bits move one byte per FIFO entry,
+ * LSB first, the byte sits in the top lane of the ISR.
+ *
+ * reset (exec'd jmp) pulls the bus low for 528 us, samples
+ * the presence pulse 80 us after the release and pushes it
+ * as one bit (0 = present) after 513 us of recovery.
+**************************************************************
+ */
+enum
+{
+    DS18B20_PIO_RESET = 0,
+    DS18B20_PIO_RESET_LOW = 1,
+    DS18B20_PIO_RESET_WAIT = 3,
+    DS18B20_PIO_RESET_REC = 6,
+    DS18B20_PIO_BIT = 9,
+    DS18B20_PIO_ZERO = 17,
+    DS18B20_PIO_WRAP = 21,
+    DS18B20_PIO_LEN = 22
+};
+
+#define DS18B20_PIO_LOW         pio_encode_sideset(1, 1)
+#define DS18B20_PIO_RELEASE     pio_encode_sideset(1, 0)
+
+static uint16_t ds18b20PioCode[DS18B20_PIO_LEN];
+static const pio_program_t ds18b20PioProgram = {
+    .instructions = ds18b20PioCode,
+    .length = DS18B20_PIO_LEN,
+    .origin = -1,
+};
+
+typedef struct DS18B20_Bus
+{
+    bool ready;
+    uint8_t pin;
+    PIO pio;
+    uint8_t sm;
+    uint8_t offset;
+    int8_t dmaTx;
+    int8_t dmaRx;
+    pio_sm_config byteCfg;
+    pio_sm_config bitCfg;
+    bool bitMode;
+    volatile bool busy;
+    bool reset;     /*!< Running transfer starts with reset/presence */
+    uint8_t len;
+    uint8_t *rx;
+    uint8_t rxBuf[1 + DS18B20_XFER_MAX]; /*!< Presence, then one byte per written byte */
+    uint8_t padTx[2 + DS18B20_ROM_LEN + DS18B20_SCRATCHPAD_LEN]; /*!< Addressing, then 0xFF per scratchpad byte */
+    uint8_t padAddrLen;         /*!< Addressing bytes ahead of the scratchpad */
+    uint8_t padSeen;            /*!< rxBuf bytes checked */
+    uint8_t padEnd;             /*!< rxBuf filled up to here when the RX DMA finishes */
+    uint8_t padCrc;             /*!< CRC of the scratchpad bytes checked so far */
+    uint8_t padAttempt;
+    int32_t padResult;          /*!< 0 or DS18B20_E_* of the finished scratchpad read */
+    volatile bool collecting;   /*!< Scratchpad reads of a collection running */
+    bool collected;             /*!< readTemp holds a collection not yet handed out */
+    bool readFull;              /*!< Collection reads every device */
+    uint32_t readMask;          /*!< Table entries read by the collection */
+    uint8_t readIndex;          /*!< Table entry being read */
+    int32_t readTemp[DS18B20_MAX_DEVICES]; /*!< Q12.4, DS18B20_E_SKIPPED or DS18B20_E_* per table entry */
+    uint8_t config;             /*!< Configuration register as last written, selects the conversion time */
+    bool converting;
+    absolute_time_t deadline;   /*!< Conversion done at the latest */
+    int8_t th;                  /*!< Alarm registers as last written */
+    int8_t tl;
+    bool alarmMixed;            /*!< Devices disagree on TH/TL or were not readable */
+    uint8_t calmCount;          /*!< Readings in a row without a reason for 9 bit */
+    uint8_t collectCount;       /*!< Collections since the last full read */
+    absolute_time_t lastAt[DS18B20_MAX_DEVICES];  /*!< Time of lastTemp */
+    int32_t lastTemp[DS18B20_MAX_DEVICES]; /*!< Previous reading per table entry, DS18B20_E_* if none */
+    uint8_t devCount;           /*!< Devices found by the last DS18B20_SEARCH */
+    uint8_t rom[DS18B20_MAX_DEVICES][DS18B20_ROM_LEN];
+} DS18B20_Bus;
+
+static DS18B20_Bus busState[DS18B20_MAX_BUSES];
+
+/*!< Encoded with the SDK encoders, JMP targets relative like pioasm emits them */
+static void DS18B20_PIO_ASSEMBLE(void)
+{
+    uint16_t *p = ds18b20PioCode;
+
+    p[0] = pio_encode_set(pio_x, 31) | DS18B20_PIO_LOW | pio_encode_delay(15);
+    p[1] = pio_encode_jmp_x_dec(DS18B20_PIO_RESET_LOW) | DS18B20_PIO_LOW | pio_encode_delay(15);
+    p[2] = pio_encode_set(pio_x, 6) | DS18B20_PIO_RELEASE | pio_encode_delay(9);
+    p[3] = pio_encode_jmp_x_dec(DS18B20_PIO_RESET_WAIT) | DS18B20_PIO_RELEASE | pio_encode_delay(9);
+    p[4] = pio_encode_mov(pio_y, pio_pins) | DS18B20_PIO_RELEASE;
+    p[5] = pio_encode_set(pio_x, 25) | DS18B20_PIO_RELEASE | pio_encode_delay(15);
+    p[6] = pio_encode_jmp_x_dec(DS18B20_PIO_RESET_REC) | DS18B20_PIO_RELEASE | pio_encode_delay(15);
+    p[7] = pio_encode_in(pio_y, 1) | DS18B20_PIO_RELEASE;
+    p[8] = pio_encode_push(false, true) | DS18B20_PIO_RELEASE;
+
+    p[9] = pio_encode_out(pio_x, 1) | DS18B20_PIO_RELEASE | pio_encode_delay(2);
+    p[10] = pio_encode_jmp_not_x(DS18B20_PIO_ZERO) | DS18B20_PIO_LOW | pio_encode_delay(5);
+    p[11] = pio_encode_nop() | DS18B20_PIO_RELEASE | pio_encode_delay(6);
+    p[12] = pio_encode_mov(pio_y, pio_pins) | DS18B20_PIO_RELEASE | pio_encode_delay(15);
+    p[13] = pio_encode_nop() | DS18B20_PIO_RELEASE | pio_encode_delay(15);
+    p[14] = pio_encode_nop() | DS18B20_PIO_RELEASE | pio_encode_delay(13);
+    p[15] = pio_encode_in(pio_y, 1) | DS18B20_PIO_RELEASE;
+    p[16] = pio_encode_jmp(DS18B20_PIO_BIT) | DS18B20_PIO_RELEASE;
+
+    p[17] = pio_encode_nop() | DS18B20_PIO_LOW | pio_encode_delay(15);
+    p[18] = pio_encode_nop() | DS18B20_PIO_LOW | pio_encode_delay(15);
+    p[19] = pio_encode_nop() | DS18B20_PIO_LOW | pio_encode_delay(15);
+    p[20] = pio_encode_nop() | DS18B20_PIO_LOW | pio_encode_delay(5);
+    p[21] = pio_encode_in(pio_null, 1) | DS18B20_PIO_LOW;
+}
+
+/*!< Claims a state machine and two DMA channels for pin, loads the program once per PIO */
+static bool DS18B20_PIO_SETUP(DS18B20_Bus *bus, uint8_t pin)
+{
+    static bool assembled;
+    static int8_t loaded[2] = {-1, -1};
+    PIO pios[2] = {pio0, pio1};
+
+    if (!assembled)
+    {
+        DS18B20_PIO_ASSEMBLE();
+        assembled = true;
+    }
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        if (loaded[i] < 0 && !pio_can_add_program(pios[i], &ds18b20PioProgram))
+        {
+            continue;
+        }
+        int sm = pio_claim_unused_sm(pios[i], false);
+        if (sm < 0)
+        {
+            continue;
+        }
+        int dmaTx = dma_claim_unused_channel(false);
+        int dmaRx = dma_claim_unused_channel(false);
+        if (dmaTx < 0 || dmaRx < 0)
+        {
+            if (dmaTx >= 0)
+            {
+                dma_channel_unclaim((uint)dmaTx);
+            }
+            pio_sm_unclaim(pios[i], (uint)sm);
+            return false;
+        }
+        if (loaded[i] < 0)
+        {
+            loaded[i] = (int8_t)pio_add_program(pios[i], &ds18b20PioProgram);
+        }
+
+        bus->pin = pin;
+        bus->pio = pios[i];
+        bus->sm = (uint8_t)sm;
+        bus->offset = (uint8_t)loaded[i];
+        bus->dmaTx = (int8_t)dmaTx;
+        bus->dmaRx = (int8_t)dmaRx;
+
+        pio_sm_config c = pio_get_default_sm_config();
+        sm_config_set_wrap(&c, bus->offset + DS18B20_PIO_BIT, bus->offset + DS18B20_PIO_WRAP);
+        sm_config_set_sideset(&c, 1, false, true);
+        sm_config_set_sideset_pins(&c, pin);
+        sm_config_set_in_pins(&c, pin);
+        sm_config_set_clkdiv_int_frac(&c, (uint16_t)(clock_get_hz(clk_sys) / DS18B20_PIO_HZ), 0);
+        sm_config_set_out_shift(&c, true, true, 8);
+        sm_config_set_in_shift(&c, true, true, 8);
+        bus->byteCfg = c;
+        sm_config_set_out_shift(&c, true, true, 1);
+        sm_config_set_in_shift(&c, true, true, 1);
+        bus->bitCfg = c;
+        bus->bitMode = false;
+        bus->config = THERM_CMD_12BIT_RES; /*!< Power-on default */
+        bus->converting = false;
+        bus->collecting = false;
+        bus->collected = false;
+        bus->devCount = 0;
+        bus->th = 0;
+        bus->tl = 0;
+        bus->alarmMixed = true;
+        bus->calmCount = 0;
+        bus->collectCount = DS18B20_BACKGROUND_READS - 1; /*!< First collection reads every device */
+        for (uint8_t dev = 0; dev < DS18B20_MAX_DEVICES; dev++)
+        {
+            bus->lastTemp[dev] = DS18B20_E_IDLE;
+        }
+
+        /*!< Output level stays 0, the bus starts released */
+        pio_sm_set_pins_with_mask(bus->pio, bus->sm, 0, 1u << pin);
+        pio_sm_set_pindirs_with_mask(bus->pio, bus->sm, 0, 1u << pin);
+        pio_gpio_init(bus->pio, pin);
+        pio_sm_init(bus->pio, bus->sm, bus->offset + DS18B20_PIO_BIT, &bus->byteCfg);
+        pio_sm_set_enabled(bus->pio, bus->sm, true);
+        bus->ready = true;
+        return true;
+    }
+    return false;
+}
+
+/*!< Engine of pin, set up on first use; NULL without a free state machine or DMA channel */
+static DS18B20_Bus *DS18B20_BUS(uint8_t pin)
+{
+    DS18B20_Bus *unused = NULL;
+
+    for (uint8_t i = 0; i < DS18B20_MAX_BUSES; i++)
+    {
+        if (busState[i].ready && busState[i].pin == pin)
+        {
+            return &busState[i];
+        }
+        if (!busState[i].ready && unused == NULL)
+        {
+            unused = &busState[i];
+        }
+    }
+    if (unused == NULL || !DS18B20_PIO_SETUP(unused, pin))
+    {
+        debugMsg("\n[X] No PIO state machine or DMA channel for 1-Wire ...");
+        return NULL;
+    }
+    return unused;
+}
+
+/*!< Bit transfers move one bit per FIFO entry, only switched while the machine idles */
+static void DS18B20_BUS_MODE(DS18B20_Bus *bus, bool bitMode)
+{
+    if (bus->bitMode != bitMode)
+    {
+        pio_sm_set_config(bus->pio, bus->sm, bitMode ? &bus->bitCfg : &bus->byteCfg);
+        pio_sm_restart(bus->pio, bus->sm); /*!< Shift counters follow the new thresholds */
+        bus->bitMode = bitMode;
+    }
+}
+
+/*!< Optional reset, then the bytes of tx by DMA, read bytes are left in the RX FIFO */
+static void DS18B20_BUS_TX(DS18B20_Bus *bus, const uint8_t *tx, uint8_t len, bool reset)
+{
+    /*!< Replaces the pull the machine stalls on, so no byte leaves before the reset */
+    if (reset)
+    {
+        pio_sm_exec(bus->pio, bus->sm, pio_encode_jmp(bus->offset + DS18B20_PIO_RESET));
+    }
+    if (len > 0)
+    {
+        dma_channel_config c = dma_channel_get_default_config(bus->dmaTx);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        channel_config_set_dreq(&c, pio_get_dreq(bus->pio, bus->sm, true));
+        dma_channel_configure(bus->dmaTx, &c, &bus->pio->txf[bus->sm], tx, len, true);
+    }
+}
+
+/*!< Drops the running transfer mid-byte, the bus is released and the machine waits for the next byte */
+static void DS18B20_BUS_ABORT(DS18B20_Bus *bus)
+{
+    dma_channel_abort(bus->dmaTx);
+    dma_channel_abort(bus->dmaRx);
+    dma_channel_acknowledge_irq1(bus->dmaRx); /*!< An abort may flag a completion */
+    pio_sm_set_enabled(bus->pio, bus->sm, false);
+    pio_sm_clear_fifos(bus->pio, bus->sm);
+    pio_sm_restart(bus->pio, bus->sm);
+    pio_sm_exec(bus->pio, bus->sm, pio_encode_jmp(bus->offset + DS18B20_PIO_BIT) | DS18B20_PIO_RELEASE);
+    pio_sm_set_enabled(bus->pio, bus->sm, true);
+    bus->busy = false;
+}
+
+static uint8_t DS18B20_BIT(uint8_t ds18b20_gpio_pin, uint8_t bitValue)
+{
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+    if (bus == NULL)
+    {
+        return 1;
+    }
+    DS18B20_BUS_MODE(bus, true);
+    pio_sm_put_blocking(bus->pio, bus->sm, bitValue & 0x01);
+    return (uint8_t)(pio_sm_get_blocking(bus->pio, bus->sm) >> 31);
+}
+
+/*!
+**************************************************************
+ * @brief Start a 1-Wire transfer on the PIO engine of the pin
+ *
+ * len bytes are written LSB first, each written byte returns
+ * the byte read in its slots: write 0xFF to read. DMA feeds
+ * the TX FIFO and drains the RX FIFO, the CPU is free until
+ * DS18B20_TRANSFER_WAIT.
+ *
+ * @param[in]  ds18b20_gpio_pin 1-Wire bus pin
+ * @param[in]  tx               Bytes to write, valid until the wait
+ * @param[out] rx               Bytes read, NULL to drop them
+ * @param[in]  len              Up to DS18B20_XFER_MAX bytes
+ * @param[in]  reset            Reset/presence before the bytes
+ *
+ * @return 0 if started, 1 if the engine is unavailable
+**************************************************************
+ */
+uint8_t DS18B20_TRANSFER_START(uint8_t ds18b20_gpio_pin, const uint8_t *tx, uint8_t *rx, uint8_t len, bool reset)
+{
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+    if (bus == NULL || bus->busy || len > DS18B20_XFER_MAX || (len == 0 && !reset))
+    {
+        return 1;
+    }
+    DS18B20_BUS_MODE(bus, false);
+    bus->rx = rx;
+    bus->len = len;
+    bus->reset = reset;
+    bus->busy = true;
+
+    dma_channel_config c = dma_channel_get_default_config(bus->dmaRx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, pio_get_dreq(bus->pio, bus->sm, false));
+    dma_channel_configure(bus->dmaRx, &c, bus->rxBuf, (const volatile uint8_t *)&bus->pio->rxf[bus->sm] + 3,
+                          len + (reset ? 1u : 0u), true);
+
+    DS18B20_BUS_TX(bus, tx, len, reset);
+    return 0;
+}
+
+/*!
+**************************************************************
+ * @brief Wait for the transfer of the pin, copy the read bytes
+ *
+ * @return 0 when done (device present if it started with a
+ *         reset), 1 without presence pulse or transfer
+**************************************************************
+ */
+uint8_t DS18B20_TRANSFER_WAIT(uint8_t ds18b20_gpio_pin)
+{
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+    if (bus == NULL || !bus->busy)
+    {
+        return 1;
+    }
+    dma_channel_wait_for_finish_blocking(bus->dmaRx);
+    bus->busy = false;
+
+    if (bus->rx != NULL)
+    {
+        memcpy(bus->rx, &bus->rxBuf[bus->reset ? 1 : 0], bus->len);
+    }
+    return (bus->reset && bus->rxBuf[0] != 0) ? 1 : 0;
+}
+
+uint8_t DS18B20_TRANSFER(uint8_t ds18b20_gpio_pin, const uint8_t *tx, uint8_t *rx, uint8_t len, bool reset)
+{
+    if (DS18B20_TRANSFER_START(ds18b20_gpio_pin, tx, rx, len, reset) != 0)
+    {
+        return 1;
+    }
+    return DS18B20_TRANSFER_WAIT(ds18b20_gpio_pin);
+}
+
 /*=========================================================*/
 /*== DS18B20 FUNCTIONS ====================================*/
 /*=========================================================*/
 
+/*!< 1 if no device answered with a presence pulse */
 uint8_t DS18B20_RESET(uint8_t ds18b20_gpio_pin)
 {
-    gpio_set_dir(ds18b20_gpio_pin, GPIO_OUT);
-    gpio_put(ds18b20_gpio_pin, 1);
-    sleep_ms(1);
-    gpio_put(ds18b20_gpio_pin, 0);
-    sleep_us(480);
-    gpio_set_dir(ds18b20_gpio_pin, GPIO_IN);
-    sleep_us(100);
-    uint8_t slaveResponse = gpio_get(ds18b20_gpio_pin);
-    sleep_us(400);
-    return slaveResponse;
+    return DS18B20_TRANSFER(ds18b20_gpio_pin, NULL, NULL, 0, true);
 }
 
 void DS18B20_WRITE_BIT(uint8_t ds18b20_gpio_pin, uint8_t bitValue)
 {
-    uint16_t delay1, delay2;
-    if (bitValue == 1)
+    DS18B20_BIT(ds18b20_gpio_pin, bitValue);
+}
+
+void DS18B20_WRITE_BYTE(uint8_t ds18b20_gpio_pin, uint8_t writeByte)
+{
+    DS18B20_TRANSFER(ds18b20_gpio_pin, &writeByte, NULL, 1, false);
+}
+
+uint8_t DS18B20_READ_BIT(uint8_t ds18b20_gpio_pin)
+{
+    return DS18B20_BIT(ds18b20_gpio_pin, 1);
+}
+
+uint8_t DS18B20_READ_BYTE(uint8_t ds18b20_gpio_pin)
+{
+    uint8_t readByte = 0xFF;
+    DS18B20_TRANSFER(ds18b20_gpio_pin, &readByte, &readByte, 1, false);
+    return readByte;
+}
+
+/*!< Maximum conversion time: 93.75 ms at 9 bit, doubling per extra bit */
+uint32_t DS18B20_CONV_TIME_US(uint8_t config)
+{
+    return DS18B20_CONV_TIME_9BIT_US << ((config >> 5) & 0x03);
+}
+
+/*!
+**************************************************************
+ * @brief Start a temperature conversion on all devices of the
+ * bus and return without waiting for it
+ *
+ * The deadline follows from the configured resolution. Collect
+ * the result with DS18B20_CONVERT_RESULT() or _WAIT(), the bus
+ * stays free for other transfers in between.
+ *
+ * @param[in]  ds18b20_gpio_pin 1-Wire bus pin
+ * @param[out] deadline         Conversion done at the latest, may be NULL
+ *
+ * @retval = 0 -> Conversion running
+ * @retval DS18B20_E_NO_DEVICE -> No presence pulse
+**************************************************************
+ */
+int32_t DS18B20_CONVERT_START(uint8_t ds18b20_gpio_pin, absolute_time_t *deadline)
+{
+    const uint8_t convert[] = {THERM_CMD_SKIPROM, THERM_CMD_CONVERTTEMP};
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+
+    if (bus == NULL || DS18B20_TRANSFER(ds18b20_gpio_pin, convert, NULL, sizeof(convert), true) == 1)
     {
-        delay1 = 15;
-        delay2 = 65;
+        return DS18B20_E_NO_DEVICE;
     }
-    else
+    bus->converting = true;
+    bus->deadline = make_timeout_time_us(DS18B20_CONV_TIME_US(bus->config));
+    if (deadline != NULL)
     {
-        delay1 = 60;
-        delay2 = 20;
+        *deadline = bus->deadline;
     }
-    gpio_set_dir(ds18b20_gpio_pin, GPIO_OUT);
-    gpio_put(ds18b20_gpio_pin, 0);
-    sleep_us(delay1);
-    gpio_set_dir(ds18b20_gpio_pin, GPIO_IN);
-    sleep_us(delay2);
+    return 0;
 }
 
-void DS18B20_WRITE_BYTE(uint8_t ds18b20_gpio_pin, uint8_t writeByte)
+/*!
+**************************************************************
+ * @brief Check the running conversion, all devices of the bus
+ * converted when the bus releases a read slot
+ *
+ * Costs one read slot, devices finishing before the deadline
+ * are seen early.
+ *
+ * @retval = 0 -> Done, the scratchpads are ready
+ * @retval DS18B20_E_BUSY, DS18B20_E_CONV_TIMEOUT, DS18B20_E_IDLE
+**************************************************************
+ */
+int32_t DS18B20_CONVERT_READY(uint8_t ds18b20_gpio_pin)
 {
-    for (size_t i = 0; i < 8; i++)
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+    if (bus == NULL || !bus->converting)
     {
-        if (writeByte & 0x01)
+        return DS18B20_E_IDLE;
+    }
+    if (!DS18B20_READ_BIT(ds18b20_gpio_pin))
+    {
+        if (!time_reached(bus->deadline))
         {
-            DS18B20_WRITE_BIT(ds18b20_gpio_pin, 1);
+            return DS18B20_E_BUSY;
         }
-        else
+        bus->converting = false;
+        debugMsg("\n[X] Max. Conversion time reached...");
+        return DS18B20_E_CONV_TIMEOUT;
+    }
+    bus->converting = false;
+    return 0;
+}
+
+/*!< Bytes of the scratchpad with a fixed value or fixed bits, a mismatch is a corrupted read */
+static bool DS18B20_PAD_PLAUSIBLE(uint8_t index, uint8_t value)
+{
+    switch (index)
+    {
+    case 4:
+        return (value & 0x9F) == 0x1F; /*!< Configuration, only R1/R0 vary */
+    case 5:
+        return value == 0xFF;
+    case 7:
+        return value == 0x10;
+    default:
+        return true;
+    }
+}
+
+/*!< Scratchpad bytes the RX DMA stops after to be checked, the last one ends the read */
+#if DS18B20_EARLY_ABORT
+static const uint8_t ds18b20PadChecks[] = {4, 5, 7, DS18B20_SCRATCHPAD_LEN - 1};
+#else
+static const uint8_t ds18b20PadChecks[] = {DS18B20_SCRATCHPAD_LEN - 1};
+#endif
+
+static bool ds18b20IrqHooked;
+
+/*!< One attempt: reset, addressing and read slots by TX DMA, the RX DMA first takes the presence byte */
+static void DS18B20_PAD_TRANSFER(DS18B20_Bus *bus)
+{
+    DS18B20_BUS_MODE(bus, false);
+    bus->busy = true;
+    bus->padSeen = 0;
+    bus->padEnd = 1;
+    bus->padCrc = 0;
+
+    dma_channel_config c = dma_channel_get_default_config(bus->dmaRx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, pio_get_dreq(bus->pio, bus->sm, false));
+    dma_channel_configure(bus->dmaRx, &c, bus->rxBuf, (const volatile uint8_t *)&bus->pio->rxf[bus->sm] + 3, 1, true);
+
+    DS18B20_BUS_TX(bus, bus->padTx, bus->padAddrLen + DS18B20_SCRATCHPAD_LEN, true);
+}
+
+/*!< Starts the scratchpad read of rom (NULL: SKIP ROM), the bus must be idle */
+static void DS18B20_PAD_START(DS18B20_Bus *bus, const uint8_t *rom)
+{
+    uint8_t len = 0;
+
+    if (rom != NULL)
+    {
+        bus->padTx[len++] = THERM_CMD_MATCHROM;
+        memcpy(&bus->padTx[len], rom, DS18B20_ROM_LEN);
+        len += DS18B20_ROM_LEN;
+    }
+    else
+    {
+        bus->padTx[len++] = THERM_CMD_SKIPROM;
+    }
+    bus->padTx[len++] = THERM_CMD_RSCRATCHPAD;
+    memset(&bus->padTx[len], 0xFF, DS18B20_SCRATCHPAD_LEN);
+    bus->padAddrLen = len;
+    bus->padAttempt = 0;
+
+    dma_channel_acknowledge_irq1(bus->dmaRx);
+    dma_channel_set_irq1_enabled(bus->dmaRx, true);
+    DS18B20_PAD_TRANSFER(bus);
+}
+
+/*!
+**************************************************************
+ * @brief Check the scratchpad bytes the RX DMA delivered, run
+ * from DMA_IRQ_1
+ *
+ * The RX DMA stops after the presence byte and after each byte
+ * of ds18b20PadChecks, the CRC is updated over the new bytes
+ * while the read slots of the next ones run. With
+ * DS18B20_EARLY_ABORT a byte with an impossible value ends the
+ * read at once: a device that dropped off or a shorted bus shows
+ * up at byte 4 instead of after the CRC byte. A corrupted read
+ * is repeated up to DS18B20_READ_RETRIES times.
+ *
+ * @return true when the read is finished, padResult is 0 or
+ *         DS18B20_E_NO_DEVICE, DS18B20_E_CRC
+**************************************************************
+ */
+static bool DS18B20_PAD_STEP(DS18B20_Bus *bus)
+{
+    uint8_t base = 1 + bus->padAddrLen; /*!< rxBuf index of scratchpad byte 0 */
+    uint8_t end = bus->padEnd;
+    bool corrupted = false;
+
+    if (end == 1 && bus->rxBuf[0] != 0)
+    {
+        DS18B20_BUS_ABORT(bus);
+        dma_channel_set_irq1_enabled(bus->dmaRx, false);
+        bus->padResult = DS18B20_E_NO_DEVICE;
+        return true;
+    }
+    for (uint8_t i = (bus->padSeen > base) ? bus->padSeen : base; i < end && !corrupted; i++)
+    {
+        bus->padCrc = DS18B20_CRC8_UPDATE(bus->padCrc, bus->rxBuf[i]);
+#if DS18B20_EARLY_ABORT
+        corrupted = !DS18B20_PAD_PLAUSIBLE(i - base, bus->rxBuf[i]);
+#endif
+    }
+    bus->padSeen = end;
+
+    if (!corrupted && end < base + DS18B20_SCRATCHPAD_LEN)
+    {
+        /*!< The machine keeps shifting into the RX FIFO meanwhile, nothing is lost */
+        uint8_t next = 0;
+        while (base + ds18b20PadChecks[next] < end)
         {
-            DS18B20_WRITE_BIT(ds18b20_gpio_pin, 0);
+            next++;
         }
-        writeByte >>= 1;
+        bus->padEnd = base + ds18b20PadChecks[next] + 1;
+        dma_channel_set_write_addr(bus->dmaRx, &bus->rxBuf[end], false);
+        dma_channel_set_trans_count(bus->dmaRx, bus->padEnd - end, true);
+        return false;
     }
+    if (corrupted)
+    {
+        DS18B20_BUS_ABORT(bus);
+    }
+    else if (bus->padCrc == 0)
+    {
+        bus->busy = false;
+        dma_channel_set_irq1_enabled(bus->dmaRx, false);
+        bus->padResult = 0;
+        return true;
+    }
+    if (++bus->padAttempt <= DS18B20_READ_RETRIES)
+    {
+        DS18B20_PAD_TRANSFER(bus);
+        return false;
+    }
+    bus->busy = false;
+    dma_channel_set_irq1_enabled(bus->dmaRx, false);
+    bus->padResult = DS18B20_E_CRC;
+    return true;
 }
-uint8_t DS18B20_READ_BIT(uint8_t ds18b20_gpio_pin)
+
+/*!< Temperature register of a checked scratchpad, Q12.4 as delivered by the sensor */
+static int32_t DS18B20_PAD_TEMP(const uint8_t *pad)
 {
-    gpio_set_dir(ds18b20_gpio_pin, GPIO_OUT);
-    gpio_put(ds18b20_gpio_pin, 0);
-    //sleep_us(8);
-    sleep_us(10);
-    gpio_set_dir(ds18b20_gpio_pin, GPIO_IN);
-    //sleep_us(2);
-    sleep_us(5);
-    uint8_t bitValue = gpio_get(ds18b20_gpio_pin);
-    sleep_us(60);
-    return bitValue;
+    int16_t temperature = (int16_t)(pad[1] << 8 | pad[0]);
+    temperature &= (int16_t)~DS18B20_UNDEFINED_BITS(pad[4]); /*!< Below the resolution of the conversion */
+    return temperature;
 }
-uint8_t DS18B20_READ_BYTE(uint8_t ds18b20_gpio_pin)
+
+/*!< Starts the scratchpad read of the next table entry in readMask, ends the collection after the last */
+static void DS18B20_COLLECT_NEXT(DS18B20_Bus *bus)
 {
-    uint8_t readByte = 0;
-    for (size_t i = 0; i < 8; i++)
+    for (; bus->readIndex < DS18B20_MAX_DEVICES; bus->readIndex++)
     {
-        readByte = readByte | DS18B20_READ_BIT(ds18b20_gpio_pin) << i;
-    };
-    return readByte;
+        if (bus->readMask & (1u << bus->readIndex))
+        {
+            DS18B20_PAD_START(bus, (bus->devCount > 0) ? bus->rom[bus->readIndex] : NULL);
+            return;
+        }
+    }
+    bus->collected = true;
+    bus->collecting = false;
 }
-uint16_t DS18B20_REQUEST_TEMP(uint8_t ds18b20_gpio_pin)
+
+/*!< Shared DMA_IRQ_1 handler: RX checkpoints of the scratchpad reads, a finished read moves the collection on */
+static void DS18B20_DMA_IRQ_HANDLER(void)
 {
-    uint16_t requestTime = 0;
-    DS18B20_WRITE_BYTE(ds18b20_gpio_pin, THERM_CMD_CONVERTTEMP);
-    while (!DS18B20_READ_BIT(ds18b20_gpio_pin))
+    for (uint8_t i = 0; i < DS18B20_MAX_BUSES; i++)
     {
-        sleep_ms(1);
-        requestTime++;
-        if (requestTime == 750)
+        DS18B20_Bus *bus = &busState[i];
+        if (!bus->ready || !dma_channel_get_irq1_status(bus->dmaRx))
         {
-            break;
-        } 
-        
+            continue;
+        }
+        dma_channel_acknowledge_irq1(bus->dmaRx);
+        if (DS18B20_PAD_STEP(bus) && bus->collecting)
+        {
+            bus->readTemp[bus->readIndex] = (bus->padResult != 0) ? bus->padResult
+                                            : DS18B20_PAD_TEMP(&bus->rxBuf[1 + bus->padAddrLen]);
+            bus->readIndex++;
+            DS18B20_COLLECT_NEXT(bus);
+        }
+    }
+}
+
+/*!< Hooks the scratchpad reads into DMA_IRQ_1 (shared) on first use, on the core that uses the bus */
+static void DS18B20_IRQ_HOOK(void)
+{
+    if (!ds18b20IrqHooked)
+    {
+        irq_add_shared_handler(DMA_IRQ_1, DS18B20_DMA_IRQ_HANDLER, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_1, true);
+        ds18b20IrqHooked = true;
+    }
+}
+
+/*!
+**************************************************************
+ * @brief Read the scratchpad of one device and wait for it
+ *
+ * Runs the DMA_IRQ_1 checked read of DS18B20_PAD_STEP, the CPU
+ * only idles until it is finished.
+ *
+ * @param[in]  ds18b20_gpio_pin 1-Wire bus pin
+ * @param[in]  rom              ROM code for MATCH ROM, NULL for SKIP ROM
+ * @param[out] pad              DS18B20_SCRATCHPAD_LEN bytes
+ *
+ * @retval = 0 -> Success
+ * @retval DS18B20_E_NO_DEVICE, DS18B20_E_CRC
+**************************************************************
+ */
+static int32_t DS18B20_SCRATCHPAD_READ(uint8_t ds18b20_gpio_pin, const uint8_t *rom, uint8_t *pad)
+{
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+
+    if (bus == NULL || bus->busy || bus->collecting)
+    {
+        return DS18B20_E_NO_DEVICE;
     }
-    return requestTime;
+    DS18B20_IRQ_HOOK();
+    DS18B20_PAD_START(bus, rom);
+    while (bus->busy)
+    {
+        tight_loop_contents();
+    }
+    if (bus->padResult == DS18B20_E_NO_DEVICE)
+    {
+        debugMsg("\n[X] NO DEVICE found ...");
+    }
+    else if (bus->padAttempt > 0)
+    {
+        debugVal("[X] DS18B20 scratchpad corrupted, %u retries\r\n", bus->padAttempt);
+    }
+    if (bus->padResult == 0)
+    {
+        memcpy(pad, &bus->rxBuf[1 + bus->padAddrLen], DS18B20_SCRATCHPAD_LEN);
+    }
+    return bus->padResult;
 }
 
+/*!
+**************************************************************
+ * @brief Read the temperature register of one device
+ *
+ * @param[in] ds18b20_gpio_pin 1-Wire bus pin
+ * @param[in] rom              ROM code for MATCH ROM, NULL for SKIP ROM
+ *                             with a single device on the bus
+ *
+ * @return Temperature Q12.4 or DS18B20_E_NO_DEVICE, DS18B20_E_CRC
+**************************************************************
+ */
+int32_t DS18B20_READ_TEMP(uint8_t ds18b20_gpio_pin, const uint8_t *rom)
+{
+    uint8_t memoryRead[DS18B20_SCRATCHPAD_LEN];
+    int32_t ret = DS18B20_SCRATCHPAD_READ(ds18b20_gpio_pin, rom, memoryRead);
+    if (ret != 0)
+    {
+        return ret;
+    }
+    int32_t temperature = DS18B20_PAD_TEMP(memoryRead);
+    debugVal("[X] DS18B20 Temperature: %d/16 °C\r\n", temperature);
 
+    return temperature; /*!< Q12.4 as delivered by the sensor */
+}
+
+/*!
+**************************************************************
+ * @brief Start the scratchpad reads of the table entries in
+ * mask, entry 0 is the SKIP ROM device without a table
+ *
+ * The reads follow each other from DMA_IRQ_1, collecting stays
+ * set until the last one is in readTemp.
+**************************************************************
+ */
+static void DS18B20_COLLECT_START(DS18B20_Bus *bus, uint32_t mask, bool full)
+{
+    for (uint8_t i = 0; i < DS18B20_MAX_DEVICES; i++)
+    {
+        bus->readTemp[i] = DS18B20_E_SKIPPED;
+    }
+    bus->readMask = mask;
+    bus->readFull = full;
+    bus->readIndex = 0;
+    bus->collected = false;
+    DS18B20_IRQ_HOOK();
+    bus->collecting = true;
+    DS18B20_COLLECT_NEXT(bus);
+}
 
-float32_t DS18B20_TEMP_READ(uint8_t ds18b20_gpio_pin)
+/*!< Hands a finished collection out once, the next poll checks the conversion again */
+static int32_t DS18B20_COLLECT_RESULT(DS18B20_Bus *bus, int32_t *temperatures)
+{
+    uint8_t count = (bus->devCount > 0) ? bus->devCount : 1;
+    memcpy(temperatures, bus->readTemp, count * sizeof(temperatures[0]));
+    bus->collected = false;
+    return count;
+}
+
+/*!
+**************************************************************
+ * @brief Collect the conversion of a single device bus if it is
+ * finished
+ *
+ * @return Temperature Q12.4, DS18B20_E_BUSY while converting or
+ *         one of the DS18B20_E_* errors
+**************************************************************
+ */
+int32_t DS18B20_CONVERT_RESULT(uint8_t ds18b20_gpio_pin)
+{
+    int32_t ret = DS18B20_CONVERT_READY(ds18b20_gpio_pin);
+    if (ret != 0)
+    {
+        return ret;
+    }
+    return DS18B20_READ_TEMP(ds18b20_gpio_pin, NULL);
+}
+
+/*!
+**************************************************************
+ * @brief Collect the broadcast conversion of every device in
+ * the table with one MATCH ROM read each
+ *
+ * Without a device table the bus is read as a single device.
+ * The reads run by DMA in the background, the poll that starts
+ * them and the ones during them return DS18B20_E_BUSY.
+ *
+ * @param[in]  ds18b20_gpio_pin 1-Wire bus pin
+ * @param[out] temperatures     Q12.4 or DS18B20_E_* per device,
+ *                              DS18B20_MAX_DEVICES entries
+ *
+ * @return Number of entries written, DS18B20_E_BUSY while
+ *         converting or reading or one of the DS18B20_E_* errors
+**************************************************************
+ */
+int32_t DS18B20_CONVERT_RESULT_ALL(uint8_t ds18b20_gpio_pin, int32_t *temperatures)
+{
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+    if (bus == NULL)
+    {
+        return DS18B20_E_IDLE;
+    }
+    if (bus->collecting)
+    {
+        return DS18B20_E_BUSY;
+    }
+    if (!bus->collected)
+    {
+        int32_t ret = DS18B20_CONVERT_READY(ds18b20_gpio_pin);
+        if (ret != 0)
+        {
+            return ret;
+        }
+        DS18B20_COLLECT_START(bus, (bus->devCount > 0) ? (1u << bus->devCount) - 1 : 1u, true);
+        if (bus->collecting)
+        {
+            return DS18B20_E_BUSY;
+        }
+    }
+    return DS18B20_COLLECT_RESULT(bus, temperatures);
+}
+
+/*!< Sleeps until the deadline of the running conversion, then collects it */
+int32_t DS18B20_CONVERT_WAIT(uint8_t ds18b20_gpio_pin)
+{
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+    if (bus == NULL || !bus->converting)
+    {
+        return DS18B20_E_IDLE;
+    }
+    sleep_until(bus->deadline);
+    return DS18B20_CONVERT_RESULT(ds18b20_gpio_pin);
+}
+
+int32_t DS18B20_TEMP_READ(uint8_t ds18b20_gpio_pin)
 {
     debugMsg("====================  DS18B20 SENSOR DATA READING STARTED  =========== \r\n");
-    if (DS18B20_RESET(DS18B20_PIN) == 1)
+    if (DS18B20_CONVERT_START(ds18b20_gpio_pin, NULL) != 0)
     {
         debugMsg("\n[X] NO DEVICE found ...");
-        return -1000;
+        return DS18B20_E_NO_DEVICE;
     }
-    DS18B20_WRITE_BYTE(DS18B20_PIN, THERM_CMD_SKIPROM);
-    uint16_t convTime;
-    if ((convTime = DS18B20_REQUEST_TEMP(DS18B20_PIN)) == 750)
+    return DS18B20_CONVERT_WAIT(ds18b20_gpio_pin);
+}
+
+/*!
+**************************************************************
+ * @brief Binary tree walk of SEARCH ROM or ALARM SEARCH
+ *
+ * Per ROM bit the devices answer the bit and its complement,
+ * the master writes the branch it follows. The path of the last
+ * 0-branch taken on a discrepancy is followed with a 1 on the
+ * next pass. Codes with a bad CRC or another family are skipped.
+ * The walk stops after max codes, more tells whether devices
+ * were left (may be NULL).
+ *
+ * @return Number of ROM codes written to roms
+**************************************************************
+ */
+static uint8_t DS18B20_ROM_SEARCH(uint8_t ds18b20_gpio_pin, uint8_t cmd, uint8_t (*roms)[DS18B20_ROM_LEN],
+                                  uint8_t max, bool *more)
+{
+    uint8_t rom[DS18B20_ROM_LEN] = {0};
+    int8_t lastDiscrepancy = -1; /*!< ROM bit where the previous pass took the 0-branch */
+    uint8_t count = 0;
+
+    do
     {
-        debugMsg("\n[X] Max. Conversion time reached...");
-        debugVal("[X] Conversion time: %d ms\r\n", convTime);
-        return -2000;
+        if (DS18B20_TRANSFER(ds18b20_gpio_pin, &cmd, NULL, 1, true) == 1)
+        {
+            break; /*!< No presence pulse */
+        }
+
+        int8_t lastZero = -1;
+        bool lost = false;
+        for (uint8_t bit = 0; bit < 8 * DS18B20_ROM_LEN; bit++)
+        {
+            uint8_t idBit = DS18B20_READ_BIT(ds18b20_gpio_pin);
+            uint8_t cmpBit = DS18B20_READ_BIT(ds18b20_gpio_pin);
+            uint8_t dir;
+
+            if (idBit && cmpBit)
+            {
+                lost = true; /*!< No device answered */
+                break;
+            }
+            if (idBit != cmpBit)
+            {
+                dir = idBit;
+            }
+            else if (bit < lastDiscrepancy)
+            {
+                dir = (rom[bit / 8] >> (bit % 8)) & 0x01;
+            }
+            else
+            {
+                dir = (bit == lastDiscrepancy);
+            }
+            if (idBit == cmpBit && dir == 0)
+            {
+                lastZero = (int8_t)bit;
+            }
+
+            if (dir)
+            {
+                rom[bit / 8] |= (uint8_t)(1u << (bit % 8));
+            }
+            else
+            {
+                rom[bit / 8] &= (uint8_t)~(1u << (bit % 8));
+            }
+            DS18B20_WRITE_BIT(ds18b20_gpio_pin, dir);
+        }
+        if (lost)
+        {
+            break;
+        }
+        lastDiscrepancy = lastZero;
+
+        if (DS18B20_CRC8_CHECK(rom, DS18B20_ROM_LEN) == 0 && rom[0] == DS18B20_FAMILY_CODE)
+        {
+            memcpy(roms[count++], rom, DS18B20_ROM_LEN);
+        }
+    } while (lastDiscrepancy >= 0 && count < max);
+
+    if (more != NULL)
+    {
+        *more = (lastDiscrepancy >= 0 && count == max);
     }
-    else
+    return count;
+}
+
+/*!
+**************************************************************
+ * @brief Enumerate the devices of the bus into its device table
+ *
+ * The table is kept until the next search, the next collection
+ * reads every device.
+ *
+ * @return Number of DS18B20 in the table
+**************************************************************
+ */
+uint8_t DS18B20_SEARCH(uint8_t ds18b20_gpio_pin)
+{
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+    if (bus == NULL)
+    {
+        return 0;
+    }
+    bus->devCount = DS18B20_ROM_SEARCH(ds18b20_gpio_pin, THERM_CMD_SEARCHROM, bus->rom, DS18B20_MAX_DEVICES, NULL);
+    bus->collectCount = DS18B20_BACKGROUND_READS - 1;
+    debugVal("[X] DS18B20 devices found: %u\r\n", bus->devCount);
+    return bus->devCount;
+}
+
+/*!< ALARM SEARCH for up to max devices as table bit mask, more as in DS18B20_ROM_SEARCH */
+static uint32_t DS18B20_ALARM_MASK(uint8_t ds18b20_gpio_pin, uint8_t max, bool *more)
+{
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+    uint8_t found[DS18B20_MAX_DEVICES][DS18B20_ROM_LEN];
+    uint32_t mask = 0;
+
+    uint8_t count = DS18B20_ROM_SEARCH(ds18b20_gpio_pin, THERM_CMD_ALARMSEARCH, found, max, more);
+    if (bus->devCount == 0)
+    {
+        return (count > 0) ? 1u : 0u;
+    }
+    for (uint8_t f = 0; f < count; f++)
+    {
+        for (uint8_t i = 0; i < bus->devCount; i++)
+        {
+            if (memcmp(found[f], bus->rom[i], DS18B20_ROM_LEN) == 0)
+            {
+                mask |= 1u << i;
+                break;
+            }
+        }
+    }
+    return mask;
+}
+
+/*!
+**************************************************************
+ * @brief Devices whose last conversion is outside their TH/TL
+ * window
+ *
+ * Without a device table bit 0 stands for any alarming device.
+ *
+ * @return Table entries in alarm as bit mask
+**************************************************************
+ */
+uint32_t DS18B20_ALARM_SEARCH(uint8_t ds18b20_gpio_pin)
+{
+    if (DS18B20_BUS(ds18b20_gpio_pin) == NULL)
+    {
+        return 0;
+    }
+    return DS18B20_ALARM_MASK(ds18b20_gpio_pin, DS18B20_MAX_DEVICES, NULL);
+}
+
+/*!
+**************************************************************
+ * @brief Collect the broadcast conversion, reading only the
+ * devices that flag an alarm
+ *
+ * ALARM SEARCH after the conversion lists the devices outside
+ * their TH/TL window (DS18B20_SET_ALARM), only these are read.
+ * Every DS18B20_BACKGROUND_READS collections all devices are
+ * read. With no alarm the collection costs one reset and a few
+ * slots instead of a scratchpad read per device. Each device
+ * found costs a 64 bit walk (about 1.25 reads) on top of its
+ * read, so when more than 2/5 of the table alarms the walk stops
+ * and all devices are read instead. The scratchpad reads run by
+ * DMA in the background as with DS18B20_CONVERT_RESULT_ALL, a
+ * later poll hands them out.
+ *
+ * @param[in]  ds18b20_gpio_pin 1-Wire bus pin
+ * @param[out] temperatures     Q12.4, DS18B20_E_SKIPPED or DS18B20_E_*
+ *                              per device, DS18B20_MAX_DEVICES entries
+ * @param[out] alarms           Table entries in alarm as bit mask, may be NULL
+ *
+ * @return Number of entries written, DS18B20_E_BUSY while
+ *         converting or reading or one of the DS18B20_E_* errors
+**************************************************************
+ */
+int32_t DS18B20_CONVERT_RESULT_ALARMED(uint8_t ds18b20_gpio_pin, int32_t *temperatures, uint32_t *alarms)
+{
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+    if (bus == NULL)
     {
-        debugVal("[X] Conversion time: %d ms\r\n", convTime);
+        return DS18B20_E_IDLE;
     }
+    if (bus->collecting)
+    {
+        return DS18B20_E_BUSY;
+    }
+    if (!bus->collected)
+    {
+        int32_t ret = DS18B20_CONVERT_READY(ds18b20_gpio_pin);
+        if (ret != 0)
+        {
+            return ret;
+        }
 
-    DS18B20_RESET(DS18B20_PIN);
-    DS18B20_WRITE_BYTE(DS18B20_PIN, THERM_CMD_SKIPROM);
-    DS18B20_WRITE_BYTE(DS18B20_PIN, THERM_CMD_RSCRATCHPAD);
-    uint8_t memoryRead[9];
-    for (size_t i = 0; i < 9; i++)
+        /*!< Without a device table (SKIP ROM) the one device is read anyway, no ALARM SEARCH */
+        bool full = (++bus->collectCount >= DS18B20_BACKGROUND_READS) || bus->devCount == 0;
+        uint32_t mask = 0;
+        if (!full)
+        {
+            uint8_t max = (uint8_t)(bus->devCount * 2 / 5);
+            mask = DS18B20_ALARM_MASK(ds18b20_gpio_pin, (max > 0) ? max : 1, &full);
+        }
+        if (full)
+        {
+            bus->collectCount = 0;
+            mask = (bus->devCount > 0) ? (1u << bus->devCount) - 1 : 1u;
+        }
+        DS18B20_COLLECT_START(bus, mask, full);
+        if (bus->collecting)
+        {
+            return DS18B20_E_BUSY;
+        }
+    }
+
+    int32_t ret = DS18B20_COLLECT_RESULT(bus, temperatures);
+    uint32_t mask = bus->readMask;
+    if (bus->readFull)
     {
-        memoryRead[i] = DS18B20_READ_BYTE(DS18B20_PIN);
+        /*!< Same compare as the devices, integer degC against TH/TL */
+        mask = 0;
+        for (int32_t i = 0; i < ret; i++)
+        {
+            int32_t degC = temperatures[i] >> 4;
+            if (temperatures[i] > DS18B20_E_NO_DEVICE && (degC >= bus->th || degC <= bus->tl))
+            {
+                mask |= 1u << i;
+            }
+        }
     }
-    uint8_t crc = DS18B20_CRC8_CHECK(memoryRead, 9);
-    if (crc != 0)
+    if (alarms != NULL)
     {
-        return -3000;
+        *alarms = mask;
     }
-    int16_t tempLSB = memoryRead[0];
-    int16_t tempMSB = memoryRead[1];
-    int16_t temperature = ((tempMSB << 8 | tempLSB));// for 9 Bits
-    float32_t temperatureFloat = (float32_t)(temperature / 16.0f);
-    debugVal("[X] DS18B20 Temperature: %.2f °C\r\n", temperatureFloat);
+    return ret;
+}
 
-    return temperatureFloat;
+uint8_t DS18B20_DEVICE_COUNT(uint8_t ds18b20_gpio_pin)
+{
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+    return (bus == NULL) ? 0 : bus->devCount;
+}
+
+/*!< ROM code of a table entry, NULL past the table */
+const uint8_t *DS18B20_DEVICE_ROM(uint8_t ds18b20_gpio_pin, uint8_t index)
+{
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+    if (bus == NULL || index >= bus->devCount)
+    {
+        return NULL;
+    }
+    return bus->rom[index];
+}
+
+/*!< Dallas/Maxim CRC8 (x^8 + x^5 + x^4 + 1, reflected 0x8C) of every byte value */
+static const uint8_t ds18b20Crc8Table[256] = {
+    0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83, 0xC2, 0x9C, 0x7E, 0x20, 0xA3, 0xFD, 0x1F, 0x41,
+    0x9D, 0xC3, 0x21, 0x7F, 0xFC, 0xA2, 0x40, 0x1E, 0x5F, 0x01, 0xE3, 0xBD, 0x3E, 0x60, 0x82, 0xDC,
+    0x23, 0x7D, 0x9F, 0xC1, 0x42, 0x1C, 0xFE, 0xA0, 0xE1, 0xBF, 0x5D, 0x03, 0x80, 0xDE, 0x3C, 0x62,
+    0xBE, 0xE0, 0x02, 0x5C, 0xDF, 0x81, 0x63, 0x3D, 0x7C, 0x22, 0xC0, 0x9E, 0x1D, 0x43, 0xA1, 0xFF,
+    0x46, 0x18, 0xFA, 0xA4, 0x27, 0x79, 0x9B, 0xC5, 0x84, 0xDA, 0x38, 0x66, 0xE5, 0xBB, 0x59, 0x07,
+    0xDB, 0x85, 0x67, 0x39, 0xBA, 0xE4, 0x06, 0x58, 0x19, 0x47, 0xA5, 0xFB, 0x78, 0x26, 0xC4, 0x9A,
+    0x65, 0x3B, 0xD9, 0x87, 0x04, 0x5A, 0xB8, 0xE6, 0xA7, 0xF9, 0x1B, 0x45, 0xC6, 0x98, 0x7A, 0x24,
+    0xF8, 0xA6, 0x44, 0x1A, 0x99, 0xC7, 0x25, 0x7B, 0x3A, 0x64, 0x86, 0xD8, 0x5B, 0x05, 0xE7, 0xB9,
+    0x8C, 0xD2, 0x30, 0x6E, 0xED, 0xB3, 0x51, 0x0F, 0x4E, 0x10, 0xF2, 0xAC, 0x2F, 0x71, 0x93, 0xCD,
+    0x11, 0x4F, 0xAD, 0xF3, 0x70, 0x2E, 0xCC, 0x92, 0xD3, 0x8D, 0x6F, 0x31, 0xB2, 0xEC, 0x0E, 0x50,
+    0xAF, 0xF1, 0x13, 0x4D, 0xCE, 0x90, 0x72, 0x2C, 0x6D, 0x33, 0xD1, 0x8F, 0x0C, 0x52, 0xB0, 0xEE,
+    0x32, 0x6C, 0x8E, 0xD0, 0x53, 0x0D, 0xEF, 0xB1, 0xF0, 0xAE, 0x4C, 0x12, 0x91, 0xCF, 0x2D, 0x73,
+    0xCA, 0x94, 0x76, 0x28, 0xAB, 0xF5, 0x17, 0x49, 0x08, 0x56, 0xB4, 0xEA, 0x69, 0x37, 0xD5, 0x8B,
+    0x57, 0x09, 0xEB, 0xB5, 0x36, 0x68, 0x8A, 0xD4, 0x95, 0xCB, 0x29, 0x77, 0xF4, 0xAA, 0x48, 0x16,
+    0xE9, 0xB7, 0x55, 0x0B, 0x88, 0xD6, 0x34, 0x6A, 0x2B, 0x75, 0x97, 0xC9, 0x4A, 0x14, 0xF6, 0xA8,
+    0x74, 0x2A, 0xC8, 0x96, 0x15, 0x4B, 0xA9, 0xF7, 0xB6, 0xE8, 0x0A, 0x54, 0xD7, 0x89, 0x6B, 0x35,
+};
+
+/*!< One byte into the running CRC, a block with its CRC byte ends at 0 */
+uint8_t DS18B20_CRC8_UPDATE(uint8_t crc, uint8_t data)
+{
+    return ds18b20Crc8Table[crc ^ data];
 }
 
 uint8_t DS18B20_CRC8_CHECK(uint8_t *data, uint8_t len)
 {
-    uint8_t temp;
-    uint8_t databyte;
     uint8_t crc = 0;
     for (uint8_t i = 0; i < len; i++)
     {
-        databyte = data[i];
-        for (uint8_t j = 0; j < 8; j++)
+        crc = DS18B20_CRC8_UPDATE(crc, data[i]);
+    }
+    return crc;
+}
+
+/*!< Broadcast WRITE SCRATCHPAD, every device of the bus gets the same TH, TL and configuration */
+static int32_t DS18B20_WRITE_SCRATCHPAD(uint8_t ds18b20_gpio_pin, int8_t th, int8_t tl, uint8_t config)
+{
+    const uint8_t setup[] = {THERM_CMD_SKIPROM, THERM_CMD_WSCRATCHPAD, (uint8_t)th, (uint8_t)tl, config};
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+
+    if (bus == NULL || DS18B20_TRANSFER(ds18b20_gpio_pin, setup, NULL, sizeof(setup), true) == 1)
+    {
+        return DS18B20_E_NO_DEVICE;
+    }
+    bus->th = th;
+    bus->tl = tl;
+    bus->config = config;
+    return 0;
+}
+
+/*!
+**************************************************************
+ * @brief Select the resolution of the following conversions,
+ * the scratchpads are only written when it changes
+ *
+ * @param[in] ds18b20_gpio_pin 1-Wire bus pin
+ * @param[in] config           THERM_CMD_9BIT_RES .. THERM_CMD_12BIT_RES
+ *
+ * @retval = 0 -> Success
+ * @retval DS18B20_E_BUSY while a conversion runs, DS18B20_E_NO_DEVICE
+**************************************************************
+ */
+int32_t DS18B20_SET_RESOLUTION(uint8_t ds18b20_gpio_pin, uint8_t config)
+{
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+    if (bus == NULL)
+    {
+        return DS18B20_E_NO_DEVICE;
+    }
+    if (bus->config == config)
+    {
+        return 0;
+    }
+    if (bus->converting)
+    {
+        return DS18B20_E_BUSY; /*!< Its deadline follows the old resolution */
+    }
+    debugVal("[X] DS18B20 resolution: %u bit\r\n", 9 + ((config >> 5) & 0x03));
+    return DS18B20_WRITE_SCRATCHPAD(ds18b20_gpio_pin, bus->th, bus->tl, config);
+}
+
+/*!
+**************************************************************
+ * @brief Resolution policy, run on each set of collected
+ * readings before the next conversion is started
+ *
+ * 9 bit (93.75 ms) while a probe moves by at least
+ * DS18B20_FAST_RATE or is within DS18B20_ALARM_MARGIN of the
+ * alarm. 12 bit (750 ms) again after DS18B20_CALM_READINGS calm
+ * readings in a row. A change below one step of the current
+ * resolution is not a movement, so the coarse steps of 9 bit
+ * readings do not keep the bus at 9 bit.
+ *
+ * @param[in] ds18b20_gpio_pin 1-Wire bus pin
+ * @param[in] temperatures     Q12.4 or DS18B20_E_* per table entry,
+ *                             skipped entries keep their last rate
+ * @param[in] count            Entries
+ * @param[in] alarm            Alarm threshold Q12.4
+ *
+ * @return Configuration in effect for the next conversion
+**************************************************************
+ */
+uint8_t DS18B20_ADAPT_RESOLUTION(uint8_t ds18b20_gpio_pin, const int32_t *temperatures, uint8_t count,
+                                 int32_t alarm)
+{
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+    if (bus == NULL)
+    {
+        return THERM_CMD_12BIT_RES;
+    }
+    absolute_time_t now = get_absolute_time();
+    int32_t step = DS18B20_UNDEFINED_BITS(bus->config) + 1;
+    bool fast = false;
+
+    for (uint8_t i = 0; i < count && i < DS18B20_MAX_DEVICES; i++)
+    {
+        int32_t t = temperatures[i];
+        if (t <= DS18B20_E_NO_DEVICE)
         {
-            temp = (crc ^ databyte) & 0x01;
-            crc >>= 1;
-            if (temp)
-                crc ^= 0x8C;
-            databyte >>= 1;
+            continue;
         }
+        if (abs(alarm - t) <= DS18B20_ALARM_MARGIN)
+        {
+            fast = true;
+        }
+        int64_t elapsedUs = absolute_time_diff_us(bus->lastAt[i], now);
+        if (bus->lastTemp[i] > DS18B20_E_NO_DEVICE && elapsedUs > 0)
+        {
+            int32_t delta = abs(t - bus->lastTemp[i]);
+            if (delta > step && (int64_t)delta * 1000000 >= (int64_t)DS18B20_FAST_RATE * elapsedUs)
+            {
+                fast = true;
+            }
+        }
+        bus->lastTemp[i] = t;
+        bus->lastAt[i] = now;
     }
-    return crc;
+
+    uint8_t config = bus->config;
+    if (fast)
+    {
+        bus->calmCount = 0;
+        config = THERM_CMD_9BIT_RES;
+    }
+    else if (config != THERM_CMD_12BIT_RES && ++bus->calmCount >= DS18B20_CALM_READINGS)
+    {
+        config = THERM_CMD_12BIT_RES;
+    }
+    DS18B20_SET_RESOLUTION(ds18b20_gpio_pin, config);
+    return bus->config;
+}
+
+/*!
+**************************************************************
+ * @brief Program the alarm window of every device and keep it
+ * in their EEPROM
+ *
+ * Broadcast WRITE SCRATCHPAD and COPY SCRATCHPAD, skipped when
+ * INIT found the same TH/TL in every device, so the EEPROM is
+ * not written on every start. A device alarms after a conversion
+ * at T >= TH or T <= TL (whole degC).
+ *
+ * @param[in] ds18b20_gpio_pin 1-Wire bus pin
+ * @param[in] th               Upper alarm degC
+ * @param[in] tl               Lower alarm degC
+ *
+ * @retval = 0 -> Success
+ * @retval DS18B20_E_BUSY while a conversion runs, DS18B20_E_NO_DEVICE
+**************************************************************
+ */
+int32_t DS18B20_SET_ALARM(uint8_t ds18b20_gpio_pin, int8_t th, int8_t tl)
+{
+    const uint8_t copy[] = {THERM_CMD_SKIPROM, THERM_CMD_CPYSCRATCHPAD};
+    DS18B20_Bus *bus = DS18B20_BUS(ds18b20_gpio_pin);
+
+    if (bus == NULL)
+    {
+        return DS18B20_E_NO_DEVICE;
+    }
+    if (!bus->alarmMixed && bus->th == th && bus->tl == tl)
+    {
+        return 0;
+    }
+    if (bus->converting)
+    {
+        return DS18B20_E_BUSY;
+    }
+    int32_t ret = DS18B20_WRITE_SCRATCHPAD(ds18b20_gpio_pin, th, tl, bus->config);
+    if (ret != 0)
+    {
+        return ret;
+    }
+    if (DS18B20_TRANSFER(ds18b20_gpio_pin, copy, NULL, sizeof(copy), true) == 1)
+    {
+        return DS18B20_E_NO_DEVICE;
+    }
+    sleep_ms(DS18B20_EEPROM_WRITE_MS); /*!< The bus stays idle while the EEPROM is written */
+    bus->alarmMixed = false;
+    debugVal("[X] DS18B20 alarm TH %d degC stored\r\n", th);
+    return 0;
 }
 
 int16_t DS18B20_INIT(void)
 {
-    if (DS18B20_RESET(DS18B20_PIN) == 1)
+    DS18B20_Bus *bus = DS18B20_BUS(DS18B20_PIN);
+    uint8_t pad[DS18B20_SCRATCHPAD_LEN];
+
+    if (bus == NULL || DS18B20_RESET(DS18B20_PIN) == 1)
     {
         debugMsg("\n[X] NO DEVICE found ...");
         return -1000;
     }
-    else
+    DS18B20_SEARCH(DS18B20_PIN);
+
+    /*!< After power-up the scratchpads hold TH/TL from the EEPROM */
+    int8_t th = bus->th;
+    int8_t tl = bus->tl;
+    bus->alarmMixed = false;
+    for (uint8_t i = 0; i < bus->devCount || i == 0; i++)
+    {
+        const uint8_t *rom = (bus->devCount > 0) ? bus->rom[i] : NULL;
+        if (DS18B20_SCRATCHPAD_READ(DS18B20_PIN, rom, pad) != 0)
+        {
+            bus->alarmMixed = true;
+        }
+        else if (i == 0)
+        {
+            th = (int8_t)pad[2];
+            tl = (int8_t)pad[3];
+        }
+        else if ((int8_t)pad[2] != th || (int8_t)pad[3] != tl)
+        {
+            bus->alarmMixed = true;
+        }
+    }
+
+    /*!< SKIP ROM, WRITE SCRATCHPAD: TH, TL and configuration */
+    if (DS18B20_WRITE_SCRATCHPAD(DS18B20_PIN, th, tl, THERM_CMD_12BIT_RES) != 0)
     {
-        debugMsg("\n[X] DSB18B20 is ready\n");
-        DS18B20_WRITE_BYTE(DS18B20_PIN, 0xCC);
-        DS18B20_WRITE_BYTE(DS18B20_PIN, 0x4E);
-        DS18B20_WRITE_BYTE(DS18B20_PIN, 0x00);
-        DS18B20_WRITE_BYTE(DS18B20_PIN, 0x00);
-        DS18B20_WRITE_BYTE(DS18B20_PIN, THERM_CMD_12BIT_RES);
+        debugMsg("\n[X] NO DEVICE found ...");
+        return -1000;
     }
-}
\ No newline at end of file
+    debugMsg("\n[X] DSB18B20 is ready\n");
+    return 0;
+}
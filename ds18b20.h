@@ -40,18 +40,92 @@ typedef float float32_t;
 #define THERM_CMD_11BIT_RES     (uint8_t) 0x5F
 #define THERM_CMD_12BIT_RES     (uint8_t) 0x7F
 
+/*=========================================================*/
+/*== 1-WIRE ENGINE MACROS =================================*/
+/*=========================================================*/
+
+#define DS18B20_MAX_BUSES       2       /*!< 1-Wire pins with their own PIO state machine */
+#define DS18B20_XFER_MAX        24      /*!< Bytes per transfer: MATCH ROM, command and scratchpad fit */
+#define DS18B20_SCRATCHPAD_LEN  9
+#define DS18B20_PIO_HZ          1000000u /*!< State machine clock, one cycle per microsecond */
+#define DS18B20_CONV_TIME_9BIT_US 93750u /*!< Maximum conversion time at 9 bit, doubles per bit */
+
+/*=========================================================*/
+/*== DEVICE TABLE MACROS ==================================*/
+/*=========================================================*/
+
+#define DS18B20_MAX_DEVICES     8       /*!< Sensors per bus kept in the device table */
+#define DS18B20_ROM_LEN         8       /*!< Family code, 48 bit serial, CRC */
+#define DS18B20_FAMILY_CODE     (uint8_t) 0x28
+
+/*=========================================================*/
+/*== SCRATCHPAD CHECK MACROS ==============================*/
+/*=========================================================*/
+
+/*!< 1: a scratchpad read ends at the first byte that cannot be valid
+ *   (configuration, reserved 0xFF/0x10), 0: full read and CRC only,
+ *   for clones with other reserved values */
+#define DS18B20_EARLY_ABORT     1
+#define DS18B20_READ_RETRIES    2       /*!< Repeats of a corrupted scratchpad read */
+
+/*=========================================================*/
+/*== RESOLUTION POLICY MACROS =============================*/
+/*=========================================================*/
+
+#define DS18B20_FAST_RATE       8       /*!< Q12.4 per second: 0.5 degC/s selects 9 bit */
+#define DS18B20_ALARM_MARGIN    16      /*!< Q12.4: within 1 degC of the alarm selects 9 bit */
+#define DS18B20_CALM_READINGS   4       /*!< Calm readings in a row before 12 bit again */
+
+/*=========================================================*/
+/*== ALARM MACROS =========================================*/
+/*=========================================================*/
+
+#define DS18B20_BACKGROUND_READS 8      /*!< Every n-th collection reads devices without alarm too */
+#define DS18B20_EEPROM_WRITE_MS 10      /*!< COPY SCRATCHPAD, tWR */
+#define DS18B20_TEMP_MIN_C      (int8_t) (-55) /*!< TL without a lower alarm */
+
+/*!< Temperature register bits without meaning at the resolution of config, Q12.4 */
+#define DS18B20_UNDEFINED_BITS(config)  ((1 << (3 - (((config) >> 5) & 0x03))) - 1)
+
+/*!< DS18B20_TEMP_READ and DS18B20_CONVERT_* errors, Q12.4 like the temperature and below the -55 degC range */
+#define DS18B20_E_NO_DEVICE     (int32_t) (-1000 * 16)
+#define DS18B20_E_CONV_TIMEOUT  (int32_t) (-2000 * 16)
+#define DS18B20_E_CRC           (int32_t) (-3000 * 16)
+#define DS18B20_E_BUSY          (int32_t) (-4000 * 16) /*!< Conversion still running */
+#define DS18B20_E_IDLE          (int32_t) (-5000 * 16) /*!< No conversion started */
+#define DS18B20_E_SKIPPED       (int32_t) (-6000 * 16) /*!< Not read, no alarm flagged */
+
 /*=========================================================*/
 /*== PROTOTYPE DECLARATION ================================*/
 /*=========================================================*/
 
+uint8_t DS18B20_TRANSFER_START(uint8_t ds18b20_gpio_pin, const uint8_t *tx, uint8_t *rx, uint8_t len, bool reset);
+uint8_t DS18B20_TRANSFER_WAIT(uint8_t ds18b20_gpio_pin);
+uint8_t DS18B20_TRANSFER(uint8_t ds18b20_gpio_pin, const uint8_t *tx, uint8_t *rx, uint8_t len, bool reset);
 uint8_t DS18B20_RESET(uint8_t ds18b20_gpio_pin);
 void DS18B20_WRITE_BIT(uint8_t ds18b20_gpio_pin, uint8_t bitValue);
 void DS18B20_WRITE_BYTE(uint8_t ds18b20_gpio_pin, uint8_t writeByte);
 uint8_t DS18B20_READ_BIT(uint8_t ds18b20_gpio_pin);
 uint8_t DS18B20_READ_BYTE(uint8_t ds18b20_gpio_pin);
-uint16_t DS18B20_REQUEST_TEMP(uint8_t ds18b20_gpio_pin);
+uint32_t DS18B20_CONV_TIME_US(uint8_t config);
+int32_t DS18B20_CONVERT_START(uint8_t ds18b20_gpio_pin, absolute_time_t *deadline);
+int32_t DS18B20_CONVERT_READY(uint8_t ds18b20_gpio_pin);
+int32_t DS18B20_READ_TEMP(uint8_t ds18b20_gpio_pin, const uint8_t *rom);
+int32_t DS18B20_CONVERT_RESULT(uint8_t ds18b20_gpio_pin);
+int32_t DS18B20_CONVERT_RESULT_ALL(uint8_t ds18b20_gpio_pin, int32_t *temperatures);
+int32_t DS18B20_CONVERT_RESULT_ALARMED(uint8_t ds18b20_gpio_pin, int32_t *temperatures, uint32_t *alarms);
+int32_t DS18B20_CONVERT_WAIT(uint8_t ds18b20_gpio_pin);
+int32_t DS18B20_SET_RESOLUTION(uint8_t ds18b20_gpio_pin, uint8_t config);
+uint8_t DS18B20_ADAPT_RESOLUTION(uint8_t ds18b20_gpio_pin, const int32_t *temperatures, uint8_t count,
+                                 int32_t alarm);
+int32_t DS18B20_SET_ALARM(uint8_t ds18b20_gpio_pin, int8_t th, int8_t tl);
+uint8_t DS18B20_SEARCH(uint8_t ds18b20_gpio_pin);
+uint32_t DS18B20_ALARM_SEARCH(uint8_t ds18b20_gpio_pin);
+uint8_t DS18B20_DEVICE_COUNT(uint8_t ds18b20_gpio_pin);
+const uint8_t *DS18B20_DEVICE_ROM(uint8_t ds18b20_gpio_pin, uint8_t index);
+uint8_t DS18B20_CRC8_UPDATE(uint8_t crc, uint8_t data);
 uint8_t DS18B20_CRC8_CHECK(uint8_t *data, uint8_t len);
-float32_t DS18B20_TEMP_READ(uint8_t ds18b20_gpio_pin);
+int32_t DS18B20_TEMP_READ(uint8_t ds18b20_gpio_pin);
 int16_t DS18B20_INIT(void);
 
 #endif
\ No newline at end of file
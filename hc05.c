@@ -37,6 +37,7 @@
 /*=========================================================*/
 
 #include "waterpipe.h" /*!< Insert for Error Log Function! */
+#include "measure.h"
 #include "hc05.h"
 
 /* void HC05_CHECK(uart_inst_t *uart, uint8_t *sendCommand)
@@ -221,79 +222,109 @@ void HC05_UART_RX_READ_MSG_IRQ(void)
 
 
 
-void HC05_TX_WATERLEVEL(float32_t adc)
+/*=========================================================*/
+/*== TELEMETRY ENCODING ===================================*/
+/*=========================================================*/
+
+/*!
+**************************************************************
+ * @brief Append one "<tag>:<value>ÿ" field, value is a
+ * fixed-point integer printed with decimals digits
+ *
+ * @return Field length
+**************************************************************
+ */
+uint8_t HC05_ENCODE_FIELD(uint8_t *dst, uint8_t tag, int32_t value, uint8_t decimals)
+{
+    uint8_t len = 0;
+
+    dst[len++] = tag;
+    dst[len++] = ':';
+    len += MEASURE_FORMAT(&dst[len], value, decimals);
+    memcpy(&dst[len], HC05_FIELD_END, sizeof(HC05_FIELD_END));
+    return len + sizeof(HC05_FIELD_END) - 1;
+}
+
+/*!< "A:<degC>ÿB:<hPa>ÿC:<%RH>ÿ" from 0.01 degC, Pa and Q22.10 %RH */
+uint8_t HC05_ENCODE_BME280(uint8_t *dst, int32_t temperature, uint32_t pressure, uint32_t humidity)
+{
+    uint8_t len = HC05_ENCODE_FIELD(dst, 'A', temperature, 2);
+    len += HC05_ENCODE_FIELD(&dst[len], 'B', (int32_t)pressure, 2);
+    len += HC05_ENCODE_FIELD(&dst[len], 'C', MEASURE_HUM_TO_MILLI(humidity), 3);
+    return len;
+}
+
+/*!< "E:<cm>ÿ" from um */
+uint8_t HC05_ENCODE_WATERLEVEL(uint8_t *dst, int32_t level)
+{
+    return HC05_ENCODE_FIELD(dst, 'E', MEASURE_LEVEL_TO_CENTI(level), 2);
+}
+
+/*!< "D:<degC>ÿ" from Q12.4 */
+uint8_t HC05_ENCODE_DS18B20(uint8_t *dst, int32_t temperature)
 {
-    uint8_t RecData[50];
-    uint8_t WTData[6];
-    /*!< ADC float to string */
-    gcvt(adc, 2, WTData);
+    return HC05_ENCODE_FIELD(dst, 'D', MEASURE_WTEMP_TO_CENTI(temperature), 2);
+}
+
+/*=========================================================*/
+/*== TELEMETRY TRANSMIT ===================================*/
+/*=========================================================*/
+
+void HC05_TX_WATERLEVEL(int32_t level)
+{
+    uint8_t RecData[HC05_FRAME_LEN];
+    uint8_t len = HC05_ENCODE_WATERLEVEL(RecData, level);
+
     debugMsg("====================  HC-05 WT SEND STARTED  ========================= \r\n");
-    debugVal("[X] Waterlevel:%s [X]\r\n",WTData);
+    debug2Val("[X] Waterlevel:%.*s [X]\r\n", len - HC05_FIELD_OVERHEAD, &RecData[2]);
 
     monitorMsg("====================  HC-05 WT SEND STARTED  ========================= \r\n");
-    monitorVal("[X] Waterlevel:%s [X]\r\n",WTData);
-
-    strcpy(RecData,"E:");
-    strncat(RecData,WTData,sizeof(WTData));
-    strncat(RecData,"ÿ",sizeof("ÿ"));
+    monitor2Val("[X] Waterlevel:%.*s [X]\r\n", len - HC05_FIELD_OVERHEAD, &RecData[2]);
 
     uart_puts(UART_ID0, RecData);
     //getCharRxCnt++;
 } 
  
-void HC05_TX_DS18B20(float32_t temperature)
+void HC05_TX_DS18B20(int32_t temperature)
 {
-    uint8_t RecData[100];
-    uint8_t TempData[5];
-    /*!< Temperature float to string */
-    gcvt(temperature,5,TempData);
-    strcpy(RecData,"D:");
-    strncat(RecData,TempData,sizeof(TempData));
-    strncat(RecData,"ÿ",sizeof("ÿ"));
-
+    uint8_t RecData[HC05_FRAME_LEN];
+    uint8_t len = HC05_ENCODE_DS18B20(RecData, temperature);
 
     debugMsg("====================  HC-05 DSB SEND STARTED  ======================== \r\n");
-    debugVal("[X] DS1820 Temperature %s [X]\r\n",TempData);
+    debug2Val("[X] DS1820 Temperature %.*s [X]\r\n", len - HC05_FIELD_OVERHEAD, &RecData[2]);
     monitorMsg("====================  HC-05 DSB SEND STARTED  ======================== \r\n");
-    monitorVal("[X] DS1820 Temperature %s [X]\r\n",TempData);
+    monitor2Val("[X] DS1820 Temperature %.*s [X]\r\n", len - HC05_FIELD_OVERHEAD, &RecData[2]);
     uart_puts(UART_ID0, RecData);
     //getCharRxCnt++;
 } 
 
-void HC05_TX_BME280(float32_t temperature, float32_t pressure, float32_t humidity)
+void HC05_TX_BME280(int32_t temperature, uint32_t pressure, uint32_t humidity)
 {
-    uint8_t RecData[100];
-    uint8_t TempData[5];
-    uint8_t HumData[5];
-    uint8_t PressData[7];
-
-    /*!< Temperature float to string */
-    gcvt(temperature,5,TempData);
-    strcpy(RecData,"A:");
-    strncat(RecData,TempData,sizeof(TempData));
-    strncat(RecData,"ÿ",sizeof("ÿ"));
-
-    /*!< Pressure float to string */
-    gcvt(pressure,7,PressData);
-    strncat(RecData,"B:",sizeof("B:"));
-    strncat(RecData,PressData,sizeof(PressData));
-    strncat(RecData,"ÿ",sizeof("ÿ"));
-
-    /*!< Humidity float to string */
-    gcvt(humidity,5,HumData);
-    strncat(RecData,"C:",sizeof("C:"));
-    strncat(RecData,HumData,sizeof(HumData));
-    strncat(RecData,"ÿ",sizeof("ÿ"));
+    uint8_t RecData[HC05_FRAME_LEN];
+    const uint8_t *field[3];
+    uint8_t fieldLen[3];
+
+    HC05_ENCODE_BME280(RecData, temperature, pressure, humidity);
+
+    /*!< Values of the A, B and C fields, for the log only */
+    const uint8_t *next = RecData;
+    for (uint8_t f = 0; f < 3; f++)
+    {
+        const uint8_t *end = (const uint8_t *)strstr((const char *)next, HC05_FIELD_END);
+        field[f] = next + 2;
+        fieldLen[f] = (uint8_t)(end - field[f]);
+        next = end + sizeof(HC05_FIELD_END) - 1;
+    }
 
     debugMsg("====================  HC-05 BME SEND STARTED  ======================== \r\n");
-    debugVal("[X] Temperature:%s [X]\r\n",TempData);
-    debugVal("[X] Pressure:%s [X]\r\n",PressData);
-    debugVal("[X] Humidity:%s [X]\r\n",HumData);
+    debug2Val("[X] Temperature:%.*s [X]\r\n", fieldLen[0], field[0]);
+    debug2Val("[X] Pressure:%.*s [X]\r\n", fieldLen[1], field[1]);
+    debug2Val("[X] Humidity:%.*s [X]\r\n", fieldLen[2], field[2]);
 
     monitorMsg("====================  HC-05 BME SEND STARTED  ======================== \r\n");
-    monitorVal("[X] Temperature:%s [X]\r\n",TempData);
-    monitorVal("[X] Pressure:%s [X]\r\n",PressData);
-    monitorVal("[X] Humidity:%s [X]\r\n",HumData);
+    monitor2Val("[X] Temperature:%.*s [X]\r\n", fieldLen[0], field[0]);
+    monitor2Val("[X] Pressure:%.*s [X]\r\n", fieldLen[1], field[1]);
+    monitor2Val("[X] Humidity:%.*s [X]\r\n", fieldLen[2], field[2]);
     uart_puts(UART_ID0, RecData);
     //getCharRxCnt++;
 } 
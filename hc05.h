@@ -45,6 +45,11 @@ typedef float float32_t;
 #define HC05_SET_PWD            "AT+PSWD=123456\r\n"
 #define HC05_SET_RESET          "AT+RESET\r\n"
 
+/*!< Telemetry frames "<tag>:<value>ÿ", values as fixed-point decimals */
+#define HC05_FIELD_END          "ÿ"
+#define HC05_FIELD_OVERHEAD     (uint8_t) (2 + sizeof(HC05_FIELD_END) - 1) /*!< Tag, colon and end mark */
+#define HC05_FRAME_LEN          64                                          /*!< Three fields incl. NUL */
+
 int32_t HC_MSG_COUNT;
 uint8_t MSGData[1024];
 
@@ -52,9 +57,13 @@ uint8_t HC05_PROG_SETUP(void);
 void HC05_CHECK(uart_inst_t *uart, uint8_t *sendCommand, uint8_t *ATCommand);
 void HC05_SET(uart_inst_t *uart, uint8_t *sendCommand, uint8_t *ATCommand);
 uint8_t HC05_PROG_FINISHED(void);
-void HC05_TX_DS18B20(float32_t temperature);
-void HC05_TX_BME280(float32_t temperature, float32_t pressure, float32_t humidity);
-void HC05_TX_WATERLEVEL(float32_t adc);
+uint8_t HC05_ENCODE_FIELD(uint8_t *dst, uint8_t tag, int32_t value, uint8_t decimals);
+uint8_t HC05_ENCODE_BME280(uint8_t *dst, int32_t temperature, uint32_t pressure, uint32_t humidity);
+uint8_t HC05_ENCODE_WATERLEVEL(uint8_t *dst, int32_t level);
+uint8_t HC05_ENCODE_DS18B20(uint8_t *dst, int32_t temperature);
+void HC05_TX_DS18B20(int32_t temperature);
+void HC05_TX_BME280(int32_t temperature, uint32_t pressure, uint32_t humidity);
+void HC05_TX_WATERLEVEL(int32_t level);
 uint8_t HC05_UART_RX_READ_IRQ(void);
 void HC05_UART_RX_READ_MSG_IRQ(void);
 void IRQ_SETUP_EN(irq_handler_t handler);
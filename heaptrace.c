@@ -0,0 +1,94 @@
+/*!
+*****************************************************************
+* @file    heaptrace.c
+* @brief   Heap allocation counter for debug builds. newlib's
+*          reentrant allocator entry points are wrapped at link
+*          time (-Wl,--wrap=_malloc_r,...), so allocations made
+*          inside newlib (printf, dtoa) are counted as well.
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "heaptrace.h"
+
+/*=========================================================*/
+/*== GLOBAL VARIABLES =====================================*/
+/*=========================================================*/
+
+static volatile uint32_t heapAllocs;
+static volatile uint32_t heapFrees;
+static volatile uint32_t heapBytes;
+
+/*=========================================================*/
+/*== NEWLIB ALLOCATOR =====================================*/
+/*=========================================================*/
+
+struct _reent;
+
+void *__real__malloc_r(struct _reent *reent, size_t size);
+void *__real__calloc_r(struct _reent *reent, size_t count, size_t size);
+void *__real__realloc_r(struct _reent *reent, void *ptr, size_t size);
+void __real__free_r(struct _reent *reent, void *ptr);
+
+void *__wrap__malloc_r(struct _reent *reent, size_t size)
+{
+    heapAllocs++;
+    heapBytes += size;
+    return __real__malloc_r(reent, size);
+}
+
+void *__wrap__calloc_r(struct _reent *reent, size_t count, size_t size)
+{
+    heapAllocs++;
+    heapBytes += count * size;
+    return __real__calloc_r(reent, count, size);
+}
+
+void *__wrap__realloc_r(struct _reent *reent, void *ptr, size_t size)
+{
+    heapAllocs++;
+    heapBytes += size;
+    return __real__realloc_r(reent, ptr, size);
+}
+
+void __wrap__free_r(struct _reent *reent, void *ptr)
+{
+    if (ptr != NULL)
+    {
+        heapFrees++;
+    }
+    __real__free_r(reent, ptr);
+}
+
+/*=========================================================*/
+/*== HEAPTRACE FUNCTIONS ==================================*/
+/*=========================================================*/
+
+uint32_t HEAPTRACE_ALLOCS(void)
+{
+    return heapAllocs;
+}
+
+uint32_t HEAPTRACE_FREES(void)
+{
+    return heapFrees;
+}
+
+uint32_t HEAPTRACE_BYTES(void)
+{
+    return heapBytes;
+}
@@ -0,0 +1,23 @@
+/*!
+**************************************************************
+* @file    heaptrace.h
+* @brief   Heap allocation counter for debug builds
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef HEAPTRACE_H_
+#define HEAPTRACE_H_
+
+/*=========================================================*/
+/*== PROTOTYPE DECLARATION ================================*/
+/*=========================================================*/
+
+uint32_t HEAPTRACE_ALLOCS(void);
+uint32_t HEAPTRACE_FREES(void);
+uint32_t HEAPTRACE_BYTES(void);
+
+#endif
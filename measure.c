@@ -0,0 +1,109 @@
+/*!
+*****************************************************************
+* @file    measure.c
+* @brief   Fixed-point measurement sample: alarm evaluation and
+*          integer to decimal string formatting
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "measure.h"
+
+/*=========================================================*/
+/*== MEASURE FUNCTIONS ====================================*/
+/*=========================================================*/
+
+/*!
+**************************************************************
+ * @brief Compare a sample against the alarm limits, integer
+ * compares only
+ *
+ * @param[in]  sample Fixed-point sample
+ *
+ * @return MEASURE_ALARM_* bits of the exceeded limits
+**************************************************************
+ */
+uint8_t MEASURE_ALARMS(const MeasureSample *sample)
+{
+    uint8_t alarms = 0;
+
+    if (sample->temperature >= MEASURE_TEMP_MAX)
+    {
+        alarms |= MEASURE_ALARM_TEMP;
+    }
+    if (sample->pressure >= MEASURE_PRESS_MAX)
+    {
+        alarms |= MEASURE_ALARM_PRESS;
+    }
+    if (sample->humidity >= MEASURE_HUM_MAX)
+    {
+        alarms |= MEASURE_ALARM_HUM;
+    }
+    if (sample->waterLevel >= MEASURE_LEVEL_MAX)
+    {
+        alarms |= MEASURE_ALARM_LEVEL;
+    }
+    if (sample->waterTemp >= MEASURE_WTEMP_MAX)
+    {
+        alarms |= MEASURE_ALARM_WTEMP;
+    }
+    return alarms;
+}
+
+/*!
+**************************************************************
+ * @brief Write value / 10^decimals as a decimal string,
+ * e.g. (2508, 2) -> "25.08", (-5, 2) -> "-0.05"
+ *
+ * @param[out] dst      At least MEASURE_FORMAT_LEN + 1 bytes
+ * @param[in]  value    Fixed-point value
+ * @param[in]  decimals Digits after the point, 0..9
+ *
+ * @return String length without NUL
+**************************************************************
+ */
+uint8_t MEASURE_FORMAT(uint8_t *dst, int32_t value, uint8_t decimals)
+{
+    uint8_t digits[MEASURE_FORMAT_LEN];
+    uint8_t count = 0;
+    uint8_t len = 0;
+    uint32_t magnitude = (value < 0) ? (uint32_t)0 - (uint32_t)value : (uint32_t)value;
+
+    /*!< Least significant digit first, at least one digit before the point */
+    do
+    {
+        digits[count++] = (uint8_t)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0 || count <= decimals);
+
+    if (value < 0)
+    {
+        dst[len++] = '-';
+    }
+    while (count > 0)
+    {
+        if (count == decimals)
+        {
+            dst[len++] = '.';
+        }
+        dst[len++] = digits[--count];
+    }
+    dst[len] = '\0';
+    return len;
+}
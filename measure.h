@@ -0,0 +1,68 @@
+/*!
+**************************************************************
+* @file    measure.h
+* @brief   Fixed-point measurement sample, alarm limits and
+*          integer formatting Header file
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef MEASURE_H_
+#define MEASURE_H_
+
+/*=========================================================*/
+/*== SAMPLE UNITS =========================================*/
+/*=========================================================*/
+
+/*!< Every value keeps the native integer unit of its sensor, floats only appear in debug output */
+#define MEASURE_HUM_FRAC_BITS       10    /*!< BME280 humidity Q22.10 %RH */
+#define MEASURE_WTEMP_FRAC_BITS     4     /*!< DS18B20 temperature Q12.4 degC */
+#define MEASURE_UM_PER_CM           10000 /*!< Water level in um */
+
+#define MEASURE_HUM_TO_MILLI(q10)   (((int32_t)(q10) * 1000) / (1 << MEASURE_HUM_FRAC_BITS))   /*!< 0.001 %RH */
+#define MEASURE_WTEMP_TO_CENTI(q4)  (((int32_t)(q4) * 100) / (1 << MEASURE_WTEMP_FRAC_BITS))   /*!< 0.01 degC */
+#define MEASURE_LEVEL_TO_CENTI(um)  ((int32_t)(um) / (MEASURE_UM_PER_CM / 100))               /*!< 0.01 cm */
+
+/*=========================================================*/
+/*== ALARM LIMITS =========================================*/
+/*=========================================================*/
+
+#define MEASURE_TEMP_MAX    (int32_t) 3000                             /*!< 30 degC in 0.01 degC */
+#define MEASURE_PRESS_MAX   (uint32_t) 110000                          /*!< 1100 hPa in Pa */
+#define MEASURE_HUM_MAX     (uint32_t) (30 << MEASURE_HUM_FRAC_BITS)   /*!< 30 %RH */
+#define MEASURE_LEVEL_MAX   (int32_t) 35000                            /*!< 3.5 cm in um */
+#define MEASURE_WTEMP_MAX   (int32_t) (25 << MEASURE_WTEMP_FRAC_BITS)  /*!< 25 degC */
+#define MEASURE_FSR_MAX     (uint32_t) 1650000                         /*!< FSR divider at half supply, uV */
+
+#define MEASURE_ALARM_TEMP  (uint8_t) 0x01
+#define MEASURE_ALARM_PRESS (uint8_t) 0x02
+#define MEASURE_ALARM_HUM   (uint8_t) 0x04
+#define MEASURE_ALARM_LEVEL (uint8_t) 0x08
+#define MEASURE_ALARM_WTEMP (uint8_t) 0x10
+
+#define MEASURE_FORMAT_LEN  12 /*!< Sign, 10 digits and the point of an int32_t, without NUL */
+
+/*=========================================================*/
+/*== SAMPLE ===============================================*/
+/*=========================================================*/
+
+typedef struct MeasureSample
+{
+    int32_t temperature; /*!< BME280, 0.01 degC */
+    uint32_t pressure;   /*!< BME280, Pa */
+    uint32_t humidity;   /*!< BME280, Q22.10 %RH */
+    int32_t waterLevel;  /*!< Water level sensor, um */
+    int32_t waterTemp;   /*!< DS18B20, Q12.4 degC */
+} MeasureSample;
+
+/*=========================================================*/
+/*== PROTOTYPE DECLARATION ================================*/
+/*=========================================================*/
+
+uint8_t MEASURE_ALARMS(const MeasureSample *sample);
+uint8_t MEASURE_FORMAT(uint8_t *dst, int32_t value, uint8_t decimals);
+
+#endif
@@ -0,0 +1,62 @@
+/*!
+**************************************************************
+* @file    hardware/adc.h
+* @brief   Host simulation of the RP2040 ADC with scripted
+*          input signals
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef SIM_HARDWARE_ADC_H_
+#define SIM_HARDWARE_ADC_H_
+
+#include "pico/types.h"
+
+/*=========================================================*/
+/*== ADC REGISTER BLOCK ===================================*/
+/*=========================================================*/
+
+typedef struct
+{
+    io_rw_32 cs;
+    io_rw_32 result;
+    io_rw_32 fcs;
+    io_rw_32 fifo;
+    io_rw_32 div;
+    io_rw_32 intr;
+    io_rw_32 inte;
+    io_rw_32 intf;
+    io_rw_32 ints;
+} adc_hw_t;
+
+extern adc_hw_t sim_adc_hw;
+
+#define adc_hw (&sim_adc_hw)
+
+#define NUM_ADC_CHANNELS 5
+
+/*=========================================================*/
+/*== PROTOTYPE DECLARATION ================================*/
+/*=========================================================*/
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+uint adc_get_selected_input(void);
+void adc_set_round_robin(uint input_mask);
+void adc_set_temp_sensor_enabled(bool enable);
+uint16_t adc_read(void);
+void adc_run(bool run);
+void adc_set_clkdiv(float clkdiv);
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+bool adc_fifo_is_empty(void);
+uint8_t adc_fifo_get_level(void);
+uint16_t adc_fifo_get(void);
+uint16_t adc_fifo_get_blocking(void);
+void adc_fifo_drain(void);
+void adc_irq_set_enabled(bool enabled);
+
+#endif
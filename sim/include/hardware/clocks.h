@@ -0,0 +1,43 @@
+/*!
+**************************************************************
+* @file    hardware/clocks.h
+* @brief   Host simulation of the RP2040 clock tree, fixed at
+*          the pico-sdk defaults
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef SIM_HARDWARE_CLOCKS_H_
+#define SIM_HARDWARE_CLOCKS_H_
+
+#include "pico/types.h"
+
+/*=========================================================*/
+/*== CLOCK MACROS =========================================*/
+/*=========================================================*/
+
+enum clock_index
+{
+    clk_gpout0 = 0,
+    clk_gpout1,
+    clk_gpout2,
+    clk_gpout3,
+    clk_ref,
+    clk_sys,
+    clk_peri,
+    clk_usb,
+    clk_adc,
+    clk_rtc,
+    CLK_COUNT
+};
+
+/*=========================================================*/
+/*== PROTOTYPE DECLARATION ================================*/
+/*=========================================================*/
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+
+#endif
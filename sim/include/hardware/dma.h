@@ -0,0 +1,120 @@
+/*!
+**************************************************************
+* @file    hardware/dma.h
+* @brief   Host simulation of the RP2040 DMA controller
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef SIM_HARDWARE_DMA_H_
+#define SIM_HARDWARE_DMA_H_
+
+#include "pico/types.h"
+
+/*=========================================================*/
+/*== DMA MACROS ===========================================*/
+/*=========================================================*/
+
+#define NUM_DMA_CHANNELS 12
+
+enum dma_channel_transfer_size
+{
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+/*!< DREQ numbers (RP2040 dreq.h) */
+#define DREQ_PIO0_TX0   0
+#define DREQ_PIO0_TX1   1
+#define DREQ_PIO0_TX2   2
+#define DREQ_PIO0_TX3   3
+#define DREQ_PIO0_RX0   4
+#define DREQ_PIO0_RX1   5
+#define DREQ_PIO0_RX2   6
+#define DREQ_PIO0_RX3   7
+#define DREQ_PIO1_TX0   8
+#define DREQ_PIO1_TX1   9
+#define DREQ_PIO1_TX2   10
+#define DREQ_PIO1_TX3   11
+#define DREQ_PIO1_RX0   12
+#define DREQ_PIO1_RX1   13
+#define DREQ_PIO1_RX2   14
+#define DREQ_PIO1_RX3   15
+#define DREQ_SPI0_TX    16
+#define DREQ_SPI0_RX    17
+#define DREQ_SPI1_TX    18
+#define DREQ_SPI1_RX    19
+#define DREQ_UART0_TX   20
+#define DREQ_UART0_RX   21
+#define DREQ_UART1_TX   22
+#define DREQ_UART1_RX   23
+#define DREQ_I2C0_TX    32
+#define DREQ_I2C0_RX    33
+#define DREQ_I2C1_TX    34
+#define DREQ_I2C1_RX    35
+#define DREQ_ADC        36
+#define DREQ_FORCE      0x3f
+
+/*=========================================================*/
+/*== TYPEDEF MACROS =======================================*/
+/*=========================================================*/
+
+typedef struct
+{
+    uint8_t dataSize;
+    bool readIncr;
+    bool writeIncr;
+    uint8_t dreq;
+    uint8_t chainTo;
+    uint8_t ringBits;
+    bool ringWrite;
+    bool irqQuiet;
+    bool enable;
+    bool byteSwap;
+} dma_channel_config;
+
+/*=========================================================*/
+/*== PROTOTYPE DECLARATION ================================*/
+/*=========================================================*/
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_claim(uint channel);
+void dma_channel_unclaim(uint channel);
+bool dma_channel_is_claimed(uint channel);
+dma_channel_config dma_channel_get_default_config(uint channel);
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+void channel_config_set_dreq(dma_channel_config *c, uint dreq);
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to);
+void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits);
+void channel_config_set_irq_quiet(dma_channel_config *c, bool irq_quiet);
+void channel_config_set_enable(dma_channel_config *c, bool enable);
+void channel_config_set_bswap(dma_channel_config *c, bool bswap);
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger);
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger);
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+void dma_channel_start(uint channel);
+void dma_start_channel_mask(uint32_t chan_mask);
+void dma_channel_abort(uint channel);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+uint32_t dma_channel_get_trans_count(uint channel);
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+void dma_channel_set_irq1_enabled(uint channel, bool enabled);
+bool dma_channel_get_irq0_status(uint channel);
+bool dma_channel_get_irq1_status(uint channel);
+void dma_channel_acknowledge_irq0(uint channel);
+void dma_channel_acknowledge_irq1(uint channel);
+
+#endif
@@ -0,0 +1,53 @@
+/*!
+**************************************************************
+* @file    hardware/i2c.h
+* @brief   Host simulation of the RP2040 I2C controller
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef SIM_HARDWARE_I2C_H_
+#define SIM_HARDWARE_I2C_H_
+
+#include "pico/types.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "hardware/structs/i2c.h"
+
+/*=========================================================*/
+/*== TYPEDEF MACROS =======================================*/
+/*=========================================================*/
+
+typedef struct i2c_inst i2c_inst_t;
+
+extern i2c_inst_t sim_i2c0_inst;
+extern i2c_inst_t sim_i2c1_inst;
+
+#define i2c0 (&sim_i2c0_inst)
+#define i2c1 (&sim_i2c1_inst)
+
+#if defined(PICO_DEFAULT_I2C) && PICO_DEFAULT_I2C == 0
+#define i2c_default i2c0
+#else
+#define i2c_default i2c1
+#endif
+
+/*=========================================================*/
+/*== PROTOTYPE DECLARATION ================================*/
+/*=========================================================*/
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+void i2c_deinit(i2c_inst_t *i2c);
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate);
+uint i2c_hw_index(i2c_inst_t *i2c);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c);
+uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx);
+size_t i2c_get_write_available(i2c_inst_t *i2c);
+size_t i2c_get_read_available(i2c_inst_t *i2c);
+
+#endif
@@ -0,0 +1,71 @@
+/*!
+**************************************************************
+* @file    hardware/irq.h
+* @brief   Host simulation of the RP2040 NVIC interface
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef SIM_HARDWARE_IRQ_H_
+#define SIM_HARDWARE_IRQ_H_
+
+#include "pico/types.h"
+
+/*=========================================================*/
+/*== IRQ NUMBERS (RP2040 intctrl.h) =======================*/
+/*=========================================================*/
+
+#define TIMER_IRQ_0     0
+#define TIMER_IRQ_1     1
+#define TIMER_IRQ_2     2
+#define TIMER_IRQ_3     3
+#define PWM_IRQ_WRAP    4
+#define USBCTRL_IRQ     5
+#define XIP_IRQ         6
+#define PIO0_IRQ_0      7
+#define PIO0_IRQ_1      8
+#define PIO1_IRQ_0      9
+#define PIO1_IRQ_1      10
+#define DMA_IRQ_0       11
+#define DMA_IRQ_1       12
+#define IO_IRQ_BANK0    13
+#define IO_IRQ_QSPI     14
+#define SIO_IRQ_PROC0   15
+#define SIO_IRQ_PROC1   16
+#define CLOCKS_IRQ      17
+#define SPI0_IRQ        18
+#define SPI1_IRQ        19
+#define UART0_IRQ       20
+#define UART1_IRQ       21
+#define ADC_IRQ_FIFO    22
+#define I2C0_IRQ        23
+#define I2C1_IRQ        24
+#define RTC_IRQ         25
+
+#define NUM_IRQS        32
+
+/*=========================================================*/
+/*== TYPEDEF MACROS =======================================*/
+/*=========================================================*/
+
+typedef void (*irq_handler_t)(void);
+
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+/*=========================================================*/
+/*== PROTOTYPE DECLARATION ================================*/
+/*=========================================================*/
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_remove_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+bool irq_is_enabled(uint num);
+void irq_set_priority(uint num, uint8_t hardware_priority);
+void irq_clear(uint num);
+void irq_set_pending(uint num);
+
+#endif
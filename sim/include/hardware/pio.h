@@ -0,0 +1,160 @@
+/*!
+**************************************************************
+* @file    hardware/pio.h
+* @brief   Host simulation of the RP2040 PIO blocks: program
+*          memory, state machine configuration and FIFOs. The
+*          FIFO registers are reachable by the DMA engine.
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef SIM_HARDWARE_PIO_H_
+#define SIM_HARDWARE_PIO_H_
+
+#include "pico/types.h"
+#include "hardware/gpio.h"
+#include "hardware/pio_instructions.h"
+
+/*=========================================================*/
+/*== PIO MACROS ===========================================*/
+/*=========================================================*/
+
+#define NUM_PIOS                    2
+#define NUM_PIO_STATE_MACHINES      4
+#define PIO_INSTRUCTION_COUNT       32
+
+enum pio_fifo_join
+{
+    PIO_FIFO_JOIN_NONE = 0,
+    PIO_FIFO_JOIN_TX = 1,
+    PIO_FIFO_JOIN_RX = 2,
+};
+
+enum pio_mov_status_type
+{
+    STATUS_TX_LESSTHAN = 0,
+    STATUS_RX_LESSTHAN = 1
+};
+
+/*=========================================================*/
+/*== TYPEDEF MACROS =======================================*/
+/*=========================================================*/
+
+/*!< Register block, only the FIFO ports are used by the model */
+typedef struct
+{
+    io_rw_32 ctrl;
+    io_ro_32 fstat;
+    io_rw_32 fdebug;
+    io_ro_32 flevel;
+    io_wo_32 txf[NUM_PIO_STATE_MACHINES];
+    io_ro_32 rxf[NUM_PIO_STATE_MACHINES];
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+extern pio_hw_t sim_pio0_hw;
+extern pio_hw_t sim_pio1_hw;
+
+#define pio0 (&sim_pio0_hw)
+#define pio1 (&sim_pio1_hw)
+
+typedef struct pio_program
+{
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin; /*!< Required load address or -1 */
+} pio_program_t;
+
+typedef struct
+{
+    uint32_t clkdivInt;
+    uint8_t clkdivFrac;
+    uint8_t wrapTarget;
+    uint8_t wrap;
+    uint8_t sidesetCount; /*!< Including the enable bit */
+    bool sidesetOpt;
+    bool sidesetPindirs;
+    uint8_t sidesetBase;
+    uint8_t outBase;
+    uint8_t outCount;
+    uint8_t setBase;
+    uint8_t setCount;
+    uint8_t inBase;
+    uint8_t jmpPin;
+    bool inShiftRight;
+    bool autopush;
+    uint8_t pushThreshold; /*!< 0 means 32 */
+    bool outShiftRight;
+    bool autopull;
+    uint8_t pullThreshold; /*!< 0 means 32 */
+    enum pio_fifo_join join;
+    bool outSticky;
+    enum pio_mov_status_type statusSel;
+    uint8_t statusN;
+} pio_sm_config;
+
+/*=========================================================*/
+/*== PROTOTYPE DECLARATION ================================*/
+/*=========================================================*/
+
+/*!< Program memory */
+bool pio_can_add_program(PIO pio, const pio_program_t *program);
+uint pio_add_program(PIO pio, const pio_program_t *program);
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset);
+void pio_clear_instruction_memory(PIO pio);
+
+/*!< State machine configuration */
+pio_sm_config pio_get_default_sm_config(void);
+void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count);
+void sm_config_set_set_pins(pio_sm_config *c, uint set_base, uint set_count);
+void sm_config_set_in_pins(pio_sm_config *c, uint in_base);
+void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base);
+void sm_config_set_sideset(pio_sm_config *c, uint bit_count, bool optional, bool pindirs);
+void sm_config_set_clkdiv_int_frac(pio_sm_config *c, uint16_t div_int, uint8_t div_frac);
+void sm_config_set_clkdiv(pio_sm_config *c, float div);
+void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap);
+void sm_config_set_jmp_pin(pio_sm_config *c, uint pin);
+void sm_config_set_in_shift(pio_sm_config *c, bool shift_right, bool autopush, uint push_threshold);
+void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold);
+void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join);
+void sm_config_set_out_special(pio_sm_config *c, bool sticky, bool has_enable_pin, uint enable_pin_index);
+void sm_config_set_mov_status(pio_sm_config *c, enum pio_mov_status_type status_sel, uint status_n);
+
+/*!< State machine control */
+void pio_sm_claim(PIO pio, uint sm);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_unclaim(PIO pio, uint sm);
+bool pio_sm_is_claimed(PIO pio, uint sm);
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config);
+void pio_sm_set_config(PIO pio, uint sm, const pio_sm_config *config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_restart(PIO pio, uint sm);
+void pio_sm_clkdiv_restart(PIO pio, uint sm);
+void pio_sm_exec(PIO pio, uint sm, uint instr);
+uint8_t pio_sm_get_pc(PIO pio, uint sm);
+void pio_gpio_init(PIO pio, uint pin);
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask);
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask);
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+uint pio_get_index(PIO pio);
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx);
+
+/*!< FIFOs */
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_full(PIO pio, uint sm);
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm);
+void pio_sm_put(PIO pio, uint sm, uint32_t data);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get(PIO pio, uint sm);
+uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+void pio_sm_clear_fifos(PIO pio, uint sm);
+void pio_sm_drain_tx_fifo(PIO pio, uint sm);
+
+#endif
@@ -0,0 +1,33 @@
+/*!
+**************************************************************
+* @file    hardware/regs/i2c.h
+* @brief   Host simulation: RP2040 I2C (DW_apb_i2c) register bits
+*          used by the firmware and the simulated controller
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef SIM_HARDWARE_REGS_I2C_H_
+#define SIM_HARDWARE_REGS_I2C_H_
+
+#define I2C_IC_DATA_CMD_DAT_BITS                        0x000000ff
+#define I2C_IC_DATA_CMD_CMD_BITS                        0x00000100
+#define I2C_IC_DATA_CMD_STOP_BITS                       0x00000200
+#define I2C_IC_DATA_CMD_RESTART_BITS                    0x00000400
+
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS               0x00000040
+#define I2C_IC_RAW_INTR_STAT_STOP_DET_BITS              0x00000200
+
+#define I2C_IC_ENABLE_ENABLE_BITS                       0x00000001
+#define I2C_IC_STATUS_ACTIVITY_BITS                     0x00000001
+
+#define I2C_IC_TX_ABRT_SOURCE_ABRT_7B_ADDR_NOACK_BITS   0x00000001
+#define I2C_IC_TX_ABRT_SOURCE_ABRT_TXDATA_NOACK_BITS    0x00000008
+
+#define I2C_IC_DMA_CR_RDMAE_BITS                        0x00000001
+#define I2C_IC_DMA_CR_TDMAE_BITS                        0x00000002
+
+#endif
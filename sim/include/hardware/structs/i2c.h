@@ -0,0 +1,66 @@
+/*!
+**************************************************************
+* @file    hardware/structs/i2c.h
+* @brief   Host simulation: RP2040 I2C register block. Plain
+*          stores (tar, enable, dma_cr) are sampled by the model,
+*          data_cmd is only reachable through the DMA engine.
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef SIM_HARDWARE_STRUCTS_I2C_H_
+#define SIM_HARDWARE_STRUCTS_I2C_H_
+
+#include "pico/types.h"
+#include "hardware/regs/i2c.h"
+
+typedef struct
+{
+    io_rw_32 con;
+    io_rw_32 tar;
+    io_rw_32 sar;
+    uint32_t _pad0;
+    io_rw_32 data_cmd;
+    io_rw_32 ss_scl_hcnt;
+    io_rw_32 ss_scl_lcnt;
+    io_rw_32 fs_scl_hcnt;
+    io_rw_32 fs_scl_lcnt;
+    uint32_t _pad1[2];
+    io_ro_32 intr_stat;
+    io_rw_32 intr_mask;
+    io_ro_32 raw_intr_stat;
+    io_rw_32 rx_tl;
+    io_rw_32 tx_tl;
+    io_ro_32 clr_intr;
+    io_ro_32 clr_rx_under;
+    io_ro_32 clr_rx_over;
+    io_ro_32 clr_tx_over;
+    io_ro_32 clr_rd_req;
+    io_ro_32 clr_tx_abrt;
+    io_ro_32 clr_rx_done;
+    io_ro_32 clr_activity;
+    io_ro_32 clr_stop_det;
+    io_ro_32 clr_start_det;
+    io_ro_32 clr_gen_call;
+    io_rw_32 enable;
+    io_ro_32 status;
+    io_ro_32 txflr;
+    io_ro_32 rxflr;
+    io_rw_32 sda_hold;
+    io_ro_32 tx_abrt_source;
+    io_rw_32 slv_data_nack_only;
+    io_rw_32 dma_cr;
+    io_rw_32 dma_tdlr;
+    io_rw_32 dma_rdlr;
+    io_rw_32 sda_setup;
+    io_rw_32 ack_general_call;
+    io_ro_32 enable_status;
+    io_rw_32 fs_spklen;
+    uint32_t _pad2;
+    io_ro_32 clr_restart_det;
+} i2c_hw_t;
+
+#endif
@@ -0,0 +1,54 @@
+/*!
+**************************************************************
+* @file    hardware/uart.h
+* @brief   Host simulation of the RP2040 UART (PL011)
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef SIM_HARDWARE_UART_H_
+#define SIM_HARDWARE_UART_H_
+
+#include "pico/types.h"
+
+/*=========================================================*/
+/*== TYPEDEF MACROS =======================================*/
+/*=========================================================*/
+
+typedef struct uart_inst uart_inst_t;
+
+extern uart_inst_t sim_uart0_inst;
+extern uart_inst_t sim_uart1_inst;
+
+#define uart0 (&sim_uart0_inst)
+#define uart1 (&sim_uart1_inst)
+
+typedef enum
+{
+    UART_PARITY_NONE,
+    UART_PARITY_EVEN,
+    UART_PARITY_ODD
+} uart_parity_t;
+
+/*=========================================================*/
+/*== PROTOTYPE DECLARATION ================================*/
+/*=========================================================*/
+
+uint uart_init(uart_inst_t *uart, uint baudrate);
+void uart_deinit(uart_inst_t *uart);
+uint uart_set_baudrate(uart_inst_t *uart, uint baudrate);
+void uart_set_hw_flow(uart_inst_t *uart, bool cts, bool rts);
+void uart_set_format(uart_inst_t *uart, uint data_bits, uint stop_bits, uart_parity_t parity);
+void uart_set_fifo_enabled(uart_inst_t *uart, bool enabled);
+void uart_set_irq_enables(uart_inst_t *uart, bool rx_has_data, bool tx_needs_data);
+bool uart_is_writable(uart_inst_t *uart);
+bool uart_is_readable(uart_inst_t *uart);
+void uart_putc_raw(uart_inst_t *uart, char c);
+void uart_putc(uart_inst_t *uart, char c);
+void uart_puts(uart_inst_t *uart, const char *s);
+char uart_getc(uart_inst_t *uart);
+
+#endif
@@ -0,0 +1,19 @@
+/*!
+**************************************************************
+* @file    pico/binary_info.h
+* @brief   Host simulation of the pico-sdk binary info macros
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef SIM_PICO_BINARY_INFO_H_
+#define SIM_PICO_BINARY_INFO_H_
+
+/*!< Binary info only exists in the flash image, nothing to record on the host */
+#define bi_decl(_decl)
+#define bi_2pins_with_func(p0, p1, func)
+
+#endif
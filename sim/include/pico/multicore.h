@@ -0,0 +1,30 @@
+/*!
+**************************************************************
+* @file    pico/multicore.h
+* @brief   Host simulation of the pico-sdk multicore API
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef SIM_PICO_MULTICORE_H_
+#define SIM_PICO_MULTICORE_H_
+
+#include "pico/types.h"
+
+/*=========================================================*/
+/*== PROTOTYPE DECLARATION ================================*/
+/*=========================================================*/
+
+void multicore_launch_core1(void (*entry)(void));
+void multicore_fifo_clear_irq(void);
+bool multicore_fifo_wready(void);
+bool multicore_fifo_rvalid(void);
+void multicore_fifo_push_blocking(uint32_t data);
+uint32_t multicore_fifo_pop_blocking(void);
+void multicore_fifo_drain(void);
+uint get_core_num(void);
+
+#endif
@@ -0,0 +1,33 @@
+/*!
+**************************************************************
+* @file    pico/stdlib.h
+* @brief   Host simulation of the pico-sdk standard library
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef SIM_PICO_STDLIB_H_
+#define SIM_PICO_STDLIB_H_
+
+#include "pico/types.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "hardware/uart.h"
+
+/*=========================================================*/
+/*== PROTOTYPE DECLARATION ================================*/
+/*=========================================================*/
+
+bool stdio_init_all(void);
+void sim_tight_loop(void);
+
+/*!< On core 1 the simulation treats a tight loop as wait-for-event */
+static inline void tight_loop_contents(void)
+{
+    sim_tight_loop();
+}
+
+#endif
@@ -0,0 +1,43 @@
+/*!
+**************************************************************
+* @file    pico/time.h
+* @brief   Host simulation of the pico-sdk time API on top of
+*          the virtual clock
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef SIM_PICO_TIME_H_
+#define SIM_PICO_TIME_H_
+
+#include "pico/types.h"
+
+/*=========================================================*/
+/*== PROTOTYPE DECLARATION ================================*/
+/*=========================================================*/
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void busy_wait_us(uint64_t us);
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+absolute_time_t get_absolute_time(void);
+absolute_time_t make_timeout_time_us(uint64_t us);
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to);
+void sleep_until(absolute_time_t target);
+
+static inline uint64_t to_us_since_boot(absolute_time_t t)
+{
+    return t;
+}
+
+static inline bool time_reached(absolute_time_t t)
+{
+    return time_us_64() >= t;
+}
+
+#endif
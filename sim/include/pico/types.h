@@ -0,0 +1,49 @@
+/*!
+**************************************************************
+* @file    pico/types.h
+* @brief   Host simulation of the pico-sdk base types
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef SIM_PICO_TYPES_H_
+#define SIM_PICO_TYPES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*=========================================================*/
+/*== TYPEDEF MACROS =======================================*/
+/*=========================================================*/
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+typedef volatile uint32_t io_rw_32;
+typedef const volatile uint32_t io_ro_32;
+typedef volatile uint32_t io_wo_32;
+
+/*=========================================================*/
+/*== ERROR CODES ==========================================*/
+/*=========================================================*/
+
+#define PICO_OK                 0
+#define PICO_ERROR_NONE         0
+#define PICO_ERROR_TIMEOUT      -1
+#define PICO_ERROR_GENERIC      -2
+#define PICO_ERROR_NO_DATA      -3
+
+/*=========================================================*/
+/*== BOARD MACROS (pico.h) ================================*/
+/*=========================================================*/
+
+#define PICO_DEFAULT_LED_PIN        25
+#define PICO_DEFAULT_I2C            0
+#define PICO_DEFAULT_I2C_SDA_PIN    4
+#define PICO_DEFAULT_I2C_SCL_PIN    5
+
+#endif
@@ -0,0 +1,155 @@
+/*!
+**************************************************************
+* @file    sim_hal.h
+* @brief   Host simulation control API (virtual clock, bus
+*          accounting, scripted devices, loop hooks)
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef SIM_HAL_H_
+#define SIM_HAL_H_
+
+#include <stdio.h>
+#include "pico/types.h"
+#include "hardware/i2c.h"
+#include "hardware/uart.h"
+
+/*=========================================================*/
+/*== SIMULATION MACROS ====================================*/
+/*=========================================================*/
+
+#define SIM_MAX_ITERATIONS      4096
+#define SIM_MAX_STAGES          12
+#define SIM_CORES               2
+
+/*!< Categories of virtual time spent by a core */
+typedef enum SimTimeKind
+{
+    SIM_TIME_SLEEP = 0, /*!< sleep_us/sleep_ms/busy_wait */
+    SIM_TIME_I2C,       /*!< blocking I2C transfers */
+    SIM_TIME_UART,      /*!< blocking UART transmission */
+    SIM_TIME_DMA_WAIT,  /*!< waiting for DMA/ADC completion */
+    SIM_TIME_FIFO_WAIT, /*!< waiting on the inter-core FIFO */
+    SIM_TIME_IRQ,       /*!< time spent inside interrupt handlers */
+    SIM_TIME_POLL,      /*!< tight_loop_contents() polling on core 0 */
+    SIM_TIME_KINDS
+} SimTimeKind;
+
+/*=========================================================*/
+/*== ACCOUNTING ===========================================*/
+/*=========================================================*/
+
+typedef struct SimStats
+{
+    uint64_t timeNs[SIM_TIME_KINDS];
+    uint32_t i2cTransactions;
+    uint32_t i2cTxBytes;
+    uint32_t i2cRxBytes;
+    uint32_t i2cNaks;
+    uint32_t oneWireResets;
+    uint32_t oneWireSlots;
+    uint32_t uartTxBytes;
+    uint32_t uartRxBytes;
+    uint32_t adcSamples;
+    uint32_t adcOverflows;
+    uint32_t dmaTransfers;
+    uint32_t irqCount;
+    uint32_t fifoPushes;
+    uint32_t heapAllocs; /*!< malloc/calloc/realloc calls, libc internals included */
+    uint32_t heapFrees;
+    uint64_t heapBytes;
+} SimStats;
+
+typedef struct SimIteration
+{
+    uint64_t startNs;
+    uint64_t endNs;
+    uint64_t wallNs; /*!< Host time the simulation needed for it */
+    SimStats stats;  /*!< Core 0 accounting delta of this iteration */
+    SimStats core1;  /*!< Core 1 accounting delta over the same span */
+} SimIteration;
+
+/*!< One named section of the main loop inside one iteration */
+typedef struct SimStage
+{
+    bool seen;
+    uint64_t virtualNs;
+    uint64_t wallNs;
+    SimStats stats;
+} SimStage;
+
+/*=========================================================*/
+/*== DEVICE MODELS ========================================*/
+/*=========================================================*/
+
+typedef struct SimI2cDevice
+{
+    uint8_t addr;
+    void *ctx;
+    int (*write)(void *ctx, const uint8_t *src, size_t len, uint64_t nowNs);
+    int (*read)(void *ctx, uint8_t *dst, size_t len, uint64_t nowNs);
+} SimI2cDevice;
+
+typedef struct SimBme280 SimBme280;
+typedef struct SimDs18b20 SimDs18b20;
+
+/*!< Scripted analog source, returns the pin voltage in volts */
+typedef float (*SimAdcSource)(uint8_t channel, uint64_t nowNs, void *ctx);
+
+/*=========================================================*/
+/*== PROTOTYPE DECLARATION ================================*/
+/*=========================================================*/
+
+/*!< Clock and accounting */
+void SIM_RESET(void);
+uint64_t SIM_NOW_NS(void);
+uint64_t SIM_CORE_NOW_NS(uint8_t core);
+uint8_t SIM_CORE_CURRENT(void);
+void SIM_ADVANCE_NS(uint64_t ns, SimTimeKind kind);
+void SIM_ADVANCE_TO_NS(uint64_t targetNs, SimTimeKind kind);
+const SimStats *SIM_STATS(uint8_t core);
+void SIM_STATS_DIFF(const SimStats *now, const SimStats *before, SimStats *delta);
+
+/*!< Firmware execution */
+int SIM_RUN_FIRMWARE(int (*entry)(void), uint32_t iterations);
+void SIM_LOOP_MARK(void);
+void SIM_STAGE(const char *name);
+uint32_t SIM_ITERATION_COUNT(void);
+const SimIteration *SIM_ITERATION(uint32_t index);
+uint8_t SIM_STAGE_COUNT(void);
+const char *SIM_STAGE_NAME(uint8_t stage);
+const SimStage *SIM_STAGE_RECORD(uint32_t iteration, uint8_t stage);
+uint64_t SIM_WALL_NS(void);
+
+/*!< Firmware console */
+void SIM_STDIO_QUIET(bool quiet);
+FILE *SIM_REPORT_STREAM(void);
+
+/*!< I2C bus */
+int8_t SIM_I2C_ATTACH(i2c_inst_t *i2c, SimI2cDevice *device);
+uint32_t SIM_I2C_BAUDRATE(i2c_inst_t *i2c);
+
+/*!< BME280 model */
+SimBme280 *SIM_BME280_ATTACH(i2c_inst_t *i2c, uint8_t addr);
+void SIM_BME280_SET_RAW(SimBme280 *dev, int32_t adcT, int32_t adcP, int32_t adcH);
+
+/*!< DS18B20 model */
+SimDs18b20 *SIM_DS18B20_ATTACH(uint8_t gpio, uint64_t rom);
+void SIM_DS18B20_SET_TEMP(SimDs18b20 *dev, int16_t tempX16);
+void SIM_DS18B20_FAULT(SimDs18b20 *dev, uint8_t reads, uint8_t byte, uint8_t mask);
+
+/*!< ADC inputs */
+void SIM_ADC_SET_SOURCE(uint8_t channel, SimAdcSource source, void *ctx);
+void SIM_ADC_SET_VOLTAGE(uint8_t channel, float volts, float noiseVolts);
+
+/*!< UART peer */
+void SIM_UART_INJECT(uart_inst_t *uart, uint64_t atNs, const char *msg);
+
+/*!< Default bench setup: BME280 @0x76 and @0x77 on i2c0, DS18B20 on GPIO16, level probe on ADC0 */
+void SIM_SCENARIO_DEFAULT(void);
+
+#endif
@@ -0,0 +1,334 @@
+/*!
+*****************************************************************
+* @file    sim_adc.c
+* @brief   RP2040 ADC model of the host simulation: 96 cycle
+*          conversions at 48 MHz, round robin, 4 deep FIFO with
+*          DREQ towards the DMA, scripted input voltages
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_internal.h"
+
+/*=========================================================*/
+/*== ADC MACROS ===========================================*/
+/*=========================================================*/
+
+#define SIM_ADC_FIFO_DEPTH      4
+#define SIM_ADC_CONV_CYCLES     96u
+#define SIM_ADC_CLOCK_MHZ       48u
+#define SIM_ADC_VREF            3.3f
+
+/*=========================================================*/
+/*== GLOBAL VARIABLES =====================================*/
+/*=========================================================*/
+
+adc_hw_t sim_adc_hw;
+
+typedef struct SimAdcInput
+{
+    SimAdcSource source;
+    void *ctx;
+    float volts;
+    float noise;
+} SimAdcInput;
+
+typedef struct SimAdc
+{
+    SimAdcInput input[NUM_ADC_CHANNELS];
+    uint8_t selected;
+    uint8_t roundRobin;
+    uint32_t divCycles;
+    bool running;
+    uint64_t nextSampleNs;
+    bool fifoEn;
+    bool dreqEn;
+    uint16_t dreqThresh;
+    bool errInFifo;
+    bool byteShift;
+    bool irqEn;
+    uint16_t fifo[SIM_ADC_FIFO_DEPTH];
+    uint8_t fifoHead;
+    uint8_t fifoLevel;
+    uint32_t noiseState;
+} SimAdc;
+
+static SimAdc simAdc;
+
+/*=========================================================*/
+/*== MODEL FUNCTIONS ======================================*/
+/*=========================================================*/
+
+static uint64_t sim_adc_period_ns(void)
+{
+    uint32_t cycles = simAdc.divCycles > SIM_ADC_CONV_CYCLES ? simAdc.divCycles : SIM_ADC_CONV_CYCLES;
+    return (uint64_t)cycles * 1000u / SIM_ADC_CLOCK_MHZ;
+}
+
+/*!< Deterministic noise in [-1, 1) */
+static float sim_adc_noise(void)
+{
+    simAdc.noiseState = simAdc.noiseState * 1664525u + 1013904223u;
+    return (float)(int32_t)simAdc.noiseState / 2147483648.0f;
+}
+
+static uint16_t sim_adc_convert(uint8_t channel, uint64_t nowNs)
+{
+    SimAdcInput *in = &simAdc.input[channel];
+    float volts;
+
+    if (in->source != NULL)
+    {
+        volts = in->source(channel, nowNs, in->ctx);
+    }
+    else
+    {
+        volts = in->volts + in->noise * sim_adc_noise();
+    }
+
+    int32_t code = (int32_t)(volts * 4096.0f / SIM_ADC_VREF + 0.5f);
+    code = code < 0 ? 0 : (code > 4095 ? 4095 : code);
+    SIM_STATS_MUT()->adcSamples++;
+    return (uint16_t)code;
+}
+
+static void sim_adc_next_channel(void)
+{
+    if (simAdc.roundRobin == 0)
+    {
+        return;
+    }
+    for (uint8_t i = 1; i <= NUM_ADC_CHANNELS; i++)
+    {
+        uint8_t ch = (uint8_t)((simAdc.selected + i) % NUM_ADC_CHANNELS);
+        if (simAdc.roundRobin & (1u << ch))
+        {
+            simAdc.selected = ch;
+            return;
+        }
+    }
+}
+
+static uint16_t sim_adc_fifo_pop(void)
+{
+    if (simAdc.fifoLevel == 0)
+    {
+        return 0;
+    }
+    uint16_t value = simAdc.fifo[simAdc.fifoHead];
+    simAdc.fifoHead = (uint8_t)((simAdc.fifoHead + 1) % SIM_ADC_FIFO_DEPTH);
+    simAdc.fifoLevel--;
+    return value;
+}
+
+static void sim_adc_fifo_push(uint16_t value)
+{
+    if (simAdc.fifoLevel == SIM_ADC_FIFO_DEPTH)
+    {
+        SIM_STATS_MUT()->adcOverflows++;
+        return;
+    }
+    if (simAdc.byteShift)
+    {
+        value >>= 4;
+    }
+    simAdc.fifo[(simAdc.fifoHead + simAdc.fifoLevel) % SIM_ADC_FIFO_DEPTH] = value;
+    simAdc.fifoLevel++;
+}
+
+static void sim_adc_service_fifo(uint64_t atNs)
+{
+    if (simAdc.dreqEn)
+    {
+        while (simAdc.fifoLevel > 0 && simAdc.fifoLevel >= simAdc.dreqThresh && SIM_DMA_DREQ(DREQ_ADC, atNs))
+        {
+        }
+    }
+    if (simAdc.irqEn && simAdc.fifoLevel > 0 && simAdc.fifoLevel >= simAdc.dreqThresh)
+    {
+        SIM_IRQ_RAISE(ADC_IRQ_FIFO);
+    }
+}
+
+static uint64_t sim_adc_next(void)
+{
+    return simAdc.running ? simAdc.nextSampleNs : SIM_NEVER;
+}
+
+static void sim_adc_fire(uint64_t atNs)
+{
+    uint16_t value = sim_adc_convert(simAdc.selected, atNs);
+    sim_adc_next_channel();
+    simAdc.nextSampleNs = atNs + sim_adc_period_ns();
+    if (simAdc.fifoEn)
+    {
+        sim_adc_fifo_push(value);
+        sim_adc_service_fifo(atNs);
+    }
+}
+
+static uint32_t sim_adc_fifo_reg_read(void)
+{
+    return sim_adc_fifo_pop();
+}
+
+void sim_adc_reset(void)
+{
+    memset(&simAdc, 0, sizeof(simAdc));
+    memset(&sim_adc_hw, 0, sizeof(sim_adc_hw));
+    simAdc.noiseState = 0x2545F491u;
+    simAdc.dreqThresh = 1;
+    SIM_EVENT_REGISTER(sim_adc_next, sim_adc_fire);
+    SIM_REG_MAP(&sim_adc_hw.fifo, sim_adc_fifo_reg_read, NULL);
+}
+
+void SIM_ADC_SET_SOURCE(uint8_t channel, SimAdcSource source, void *ctx)
+{
+    simAdc.input[channel].source = source;
+    simAdc.input[channel].ctx = ctx;
+}
+
+void SIM_ADC_SET_VOLTAGE(uint8_t channel, float volts, float noiseVolts)
+{
+    simAdc.input[channel].source = NULL;
+    simAdc.input[channel].volts = volts;
+    simAdc.input[channel].noise = noiseVolts;
+}
+
+/*=========================================================*/
+/*== PICO ADC API =========================================*/
+/*=========================================================*/
+
+void adc_init(void)
+{
+    simAdc.running = false;
+    simAdc.fifoLevel = 0;
+    simAdc.selected = 0;
+    simAdc.roundRobin = 0;
+    /*!< On-die temperature sensor reads ~0.706 V at 27 degC */
+    if (simAdc.input[4].source == NULL && simAdc.input[4].volts == 0.0f)
+    {
+        simAdc.input[4].volts = 0.706f;
+    }
+}
+
+void adc_gpio_init(uint gpio)
+{
+    gpio_set_function(gpio, GPIO_FUNC_NULL);
+    gpio_disable_pulls(gpio);
+}
+
+void adc_select_input(uint input)
+{
+    simAdc.selected = (uint8_t)input;
+}
+
+uint adc_get_selected_input(void)
+{
+    return simAdc.selected;
+}
+
+void adc_set_round_robin(uint input_mask)
+{
+    simAdc.roundRobin = (uint8_t)input_mask;
+}
+
+void adc_set_temp_sensor_enabled(bool enable)
+{
+    (void)enable;
+}
+
+uint16_t adc_read(void)
+{
+    uint64_t convNs = (uint64_t)SIM_ADC_CONV_CYCLES * 1000u / SIM_ADC_CLOCK_MHZ;
+    SIM_ADVANCE_NS(convNs, SIM_TIME_DMA_WAIT);
+    uint16_t value = sim_adc_convert(simAdc.selected, SIM_NOW_NS());
+    sim_adc_next_channel();
+    if (simAdc.fifoEn)
+    {
+        sim_adc_fifo_push(value);
+        sim_adc_service_fifo(SIM_NOW_NS());
+    }
+    return value;
+}
+
+void adc_run(bool run)
+{
+    if (run && !simAdc.running)
+    {
+        simAdc.nextSampleNs = SIM_NOW_NS() + sim_adc_period_ns();
+    }
+    simAdc.running = run;
+}
+
+void adc_set_clkdiv(float clkdiv)
+{
+    simAdc.divCycles = 1u + (uint32_t)clkdiv;
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift)
+{
+    simAdc.fifoEn = en;
+    simAdc.dreqEn = dreq_en;
+    simAdc.dreqThresh = dreq_thresh == 0 ? 1 : dreq_thresh;
+    simAdc.errInFifo = err_in_fifo;
+    simAdc.byteShift = byte_shift;
+}
+
+bool adc_fifo_is_empty(void)
+{
+    return simAdc.fifoLevel == 0;
+}
+
+uint8_t adc_fifo_get_level(void)
+{
+    return simAdc.fifoLevel;
+}
+
+uint16_t adc_fifo_get(void)
+{
+    return sim_adc_fifo_pop();
+}
+
+uint16_t adc_fifo_get_blocking(void)
+{
+    while (simAdc.fifoLevel == 0 && simAdc.running)
+    {
+        SIM_ADVANCE_TO_NS(simAdc.nextSampleNs, SIM_TIME_DMA_WAIT);
+    }
+    return sim_adc_fifo_pop();
+}
+
+void adc_fifo_drain(void)
+{
+    simAdc.fifoLevel = 0;
+    simAdc.fifoHead = 0;
+}
+
+void adc_irq_set_enabled(bool enabled)
+{
+    simAdc.irqEn = enabled;
+}
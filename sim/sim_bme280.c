@@ -0,0 +1,305 @@
+/*!
+*****************************************************************
+* @file    sim_bme280.c
+* @brief   BME280 register model for the simulated I2C bus
+*          (calibration NVM, ctrl/config latching, normal/forced
+*          measurement cycles with datasheet timing)
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_internal.h"
+
+/*=========================================================*/
+/*== REGISTER MACROS ======================================*/
+/*=========================================================*/
+
+#define SIM_BME_CHIP_ID         0x60
+#define SIM_BME_REG_CALIB00     0x88
+#define SIM_BME_REG_ID          0xD0
+#define SIM_BME_REG_RESET       0xE0
+#define SIM_BME_REG_CALIB26     0xE1
+#define SIM_BME_REG_CTRL_HUM    0xF2
+#define SIM_BME_REG_STATUS      0xF3
+#define SIM_BME_REG_CTRL_MEAS   0xF4
+#define SIM_BME_REG_CONFIG      0xF5
+#define SIM_BME_REG_DATA        0xF7
+
+#define SIM_BME_NVM_COPY_NS     (2 * SIM_NS_PER_MS)
+#define SIM_BME_MAX_DEVICES     4
+
+/*=========================================================*/
+/*== GLOBAL VARIABLES =====================================*/
+/*=========================================================*/
+
+struct SimBme280
+{
+    SimI2cDevice bus;
+    uint8_t regs[256];
+    uint8_t pointer;
+    uint8_t ctrlHumLatched;
+    int32_t adcT;
+    int32_t adcP;
+    int32_t adcH;
+    uint64_t nvmBusyUntil;
+    uint64_t cycleStart;  /*!< Start of the first measurement of the current mode */
+    uint64_t lastLatched; /*!< Index + 1 of the last measurement copied to the data registers */
+};
+
+static SimBme280 simBme[SIM_BME_MAX_DEVICES];
+static uint8_t simBmeCount;
+
+/*!< Calibration of the Bosch datasheet example plus typical humidity trimming */
+static const uint16_t simBmeCalibTP[12] = {27504, 26435, (uint16_t)-1000, 36477, (uint16_t)-10685, 3024,
+                                           2855, 140, (uint16_t)-7, 15500, (uint16_t)-14600, 6000};
+static const uint8_t simBmeCalibH1 = 75;
+static const int16_t simBmeCalibH2 = 362;
+static const uint8_t simBmeCalibH3 = 0;
+static const int16_t simBmeCalibH4 = 313;
+static const int16_t simBmeCalibH5 = 50;
+static const int8_t simBmeCalibH6 = 30;
+
+/*=========================================================*/
+/*== MODEL FUNCTIONS ======================================*/
+/*=========================================================*/
+
+void sim_bme280_reset(void)
+{
+    memset(simBme, 0, sizeof(simBme));
+    simBmeCount = 0;
+}
+
+static uint8_t sim_bme280_osrs(uint8_t code)
+{
+    static const uint8_t factor[8] = {0, 1, 2, 4, 8, 16, 16, 16};
+    return factor[code & 0x07];
+}
+
+/*!< Typical measurement time (datasheet 9.1) in ns */
+static uint64_t sim_bme280_measure_ns(const SimBme280 *dev)
+{
+    uint8_t osT = sim_bme280_osrs(dev->regs[SIM_BME_REG_CTRL_MEAS] >> 5);
+    uint8_t osP = sim_bme280_osrs(dev->regs[SIM_BME_REG_CTRL_MEAS] >> 2);
+    uint8_t osH = sim_bme280_osrs(dev->ctrlHumLatched);
+    uint64_t us = 1000u + 2000u * osT;
+
+    if (osP != 0)
+    {
+        us += 2000u * osP + 500u;
+    }
+    if (osH != 0)
+    {
+        us += 2000u * osH + 500u;
+    }
+    return us * SIM_NS_PER_US;
+}
+
+static uint64_t sim_bme280_standby_ns(const SimBme280 *dev)
+{
+    static const uint32_t standbyUs[8] = {500, 62500, 125000, 250000, 500000, 1000000, 10000, 20000};
+    return standbyUs[dev->regs[SIM_BME_REG_CONFIG] >> 5] * SIM_NS_PER_US;
+}
+
+static void sim_bme280_latch(SimBme280 *dev)
+{
+    uint8_t ctrlMeas = dev->regs[SIM_BME_REG_CTRL_MEAS];
+    int32_t adcP = ((ctrlMeas >> 2) & 0x07) ? dev->adcP : 0x80000;
+    int32_t adcT = ((ctrlMeas >> 5) & 0x07) ? dev->adcT : 0x80000;
+    int32_t adcH = (dev->ctrlHumLatched & 0x07) ? dev->adcH : 0x8000;
+    uint8_t *data = &dev->regs[SIM_BME_REG_DATA];
+
+    data[0] = (uint8_t)(adcP >> 12);
+    data[1] = (uint8_t)(adcP >> 4);
+    data[2] = (uint8_t)((adcP & 0x0F) << 4);
+    data[3] = (uint8_t)(adcT >> 12);
+    data[4] = (uint8_t)(adcT >> 4);
+    data[5] = (uint8_t)((adcT & 0x0F) << 4);
+    data[6] = (uint8_t)(adcH >> 8);
+    data[7] = (uint8_t)adcH;
+}
+
+/*!
+**************************************************************
+ * @brief Bring status and data registers up to nowNs
+**************************************************************
+ */
+static void sim_bme280_update(SimBme280 *dev, uint64_t nowNs)
+{
+    uint8_t mode = dev->regs[SIM_BME_REG_CTRL_MEAS] & 0x03;
+    uint8_t status = 0;
+
+    if (nowNs < dev->nvmBusyUntil)
+    {
+        status |= 0x01;
+    }
+
+    if (mode != 0x00 && nowNs >= dev->cycleStart)
+    {
+        uint64_t measure = sim_bme280_measure_ns(dev);
+        uint64_t period = measure + ((mode == 0x03) ? sim_bme280_standby_ns(dev) : 0);
+        uint64_t elapsed = nowNs - dev->cycleStart;
+        uint64_t index = elapsed / period;
+        uint64_t phase = elapsed % period;
+        uint64_t completed = index + (phase >= measure ? 1 : 0);
+
+        if (mode != 0x03)
+        {
+            /*!< Forced mode: a single measurement, then back to sleep */
+            if (completed >= 1)
+            {
+                completed = 1;
+                dev->regs[SIM_BME_REG_CTRL_MEAS] &= (uint8_t)~0x03;
+            }
+            else
+            {
+                status |= 0x08;
+            }
+        }
+        else if (phase < measure)
+        {
+            status |= 0x08;
+        }
+
+        if (completed > dev->lastLatched)
+        {
+            sim_bme280_latch(dev);
+            dev->lastLatched = completed;
+        }
+    }
+
+    dev->regs[SIM_BME_REG_STATUS] = status;
+}
+
+static void sim_bme280_soft_reset(SimBme280 *dev, uint64_t nowNs)
+{
+    dev->regs[SIM_BME_REG_CTRL_HUM] = 0;
+    dev->regs[SIM_BME_REG_CTRL_MEAS] = 0;
+    dev->regs[SIM_BME_REG_CONFIG] = 0;
+    dev->ctrlHumLatched = 0;
+    memset(&dev->regs[SIM_BME_REG_DATA], 0, 8);
+    dev->regs[SIM_BME_REG_DATA + 0] = 0x80;
+    dev->regs[SIM_BME_REG_DATA + 3] = 0x80;
+    dev->regs[SIM_BME_REG_DATA + 6] = 0x80;
+    dev->nvmBusyUntil = nowNs + SIM_BME_NVM_COPY_NS;
+}
+
+static int sim_bme280_write(void *ctx, const uint8_t *src, size_t len, uint64_t nowNs)
+{
+    SimBme280 *dev = ctx;
+
+    sim_bme280_update(dev, nowNs);
+    if (len >= 1)
+    {
+        dev->pointer = src[0];
+    }
+
+    /*!< I2C writes are (register, value) pairs without auto-increment */
+    for (size_t i = 0; i + 1 < len; i += 2)
+    {
+        uint8_t reg = src[i];
+        uint8_t value = src[i + 1];
+        switch (reg)
+        {
+        case SIM_BME_REG_RESET:
+            if (value == 0xB6)
+            {
+                sim_bme280_soft_reset(dev, nowNs);
+            }
+            break;
+        case SIM_BME_REG_CTRL_HUM:
+            dev->regs[reg] = value & 0x07;
+            break;
+        case SIM_BME_REG_CTRL_MEAS:
+            /*!< ctrl_hum only becomes effective with a ctrl_meas write */
+            dev->ctrlHumLatched = dev->regs[SIM_BME_REG_CTRL_HUM];
+            if ((value & 0x03) != 0x00 && ((dev->regs[reg] & 0x03) != (value & 0x03) || (value & 0x03) != 0x03))
+            {
+                dev->cycleStart = nowNs;
+                dev->lastLatched = 0;
+            }
+            dev->regs[reg] = value;
+            break;
+        case SIM_BME_REG_CONFIG:
+            dev->regs[reg] = value & 0xFD;
+            break;
+        default:
+            break;
+        }
+    }
+    return (int)len;
+}
+
+static int sim_bme280_read(void *ctx, uint8_t *dst, size_t len, uint64_t nowNs)
+{
+    SimBme280 *dev = ctx;
+
+    sim_bme280_update(dev, nowNs);
+    for (size_t i = 0; i < len; i++)
+    {
+        dst[i] = dev->regs[(uint8_t)(dev->pointer + i)];
+    }
+    dev->pointer = (uint8_t)(dev->pointer + len);
+    return (int)len;
+}
+
+SimBme280 *SIM_BME280_ATTACH(i2c_inst_t *i2c, uint8_t addr)
+{
+    if (simBmeCount >= SIM_BME_MAX_DEVICES)
+    {
+        return NULL;
+    }
+    SimBme280 *dev = &simBme[simBmeCount++];
+    memset(dev, 0, sizeof(*dev));
+
+    dev->bus.addr = addr;
+    dev->bus.ctx = dev;
+    dev->bus.write = sim_bme280_write;
+    dev->bus.read = sim_bme280_read;
+
+    for (uint8_t i = 0; i < 12; i++)
+    {
+        dev->regs[SIM_BME_REG_CALIB00 + 2 * i] = (uint8_t)simBmeCalibTP[i];
+        dev->regs[SIM_BME_REG_CALIB00 + 2 * i + 1] = (uint8_t)(simBmeCalibTP[i] >> 8);
+    }
+    dev->regs[0xA1] = simBmeCalibH1;
+    dev->regs[SIM_BME_REG_CALIB26 + 0] = (uint8_t)simBmeCalibH2;
+    dev->regs[SIM_BME_REG_CALIB26 + 1] = (uint8_t)(simBmeCalibH2 >> 8);
+    dev->regs[SIM_BME_REG_CALIB26 + 2] = simBmeCalibH3;
+    dev->regs[SIM_BME_REG_CALIB26 + 3] = (uint8_t)(simBmeCalibH4 >> 4);
+    dev->regs[SIM_BME_REG_CALIB26 + 4] = (uint8_t)((simBmeCalibH4 & 0x0F) | ((simBmeCalibH5 & 0x0F) << 4));
+    dev->regs[SIM_BME_REG_CALIB26 + 5] = (uint8_t)(simBmeCalibH5 >> 4);
+    dev->regs[SIM_BME_REG_CALIB26 + 6] = (uint8_t)simBmeCalibH6;
+    dev->regs[SIM_BME_REG_ID] = SIM_BME_CHIP_ID;
+
+    /*!< Datasheet example values: 25.08 degC, 1006.53 hPa, ~40 %RH */
+    dev->adcT = 519888;
+    dev->adcP = 415148;
+    dev->adcH = 28000;
+
+    sim_bme280_soft_reset(dev, SIM_NOW_NS());
+    dev->nvmBusyUntil = 0;
+    SIM_I2C_ATTACH(i2c, &dev->bus);
+    return dev;
+}
+
+void SIM_BME280_SET_RAW(SimBme280 *dev, int32_t adcT, int32_t adcP, int32_t adcH)
+{
+    dev->adcT = adcT;
+    dev->adcP = adcP;
+    dev->adcH = adcH;
+}
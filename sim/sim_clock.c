@@ -0,0 +1,655 @@
+/*!
+*****************************************************************
+* @file    sim_clock.c
+* @brief   Virtual clock, event scheduling, accounting and loop
+*          hooks of the host simulation
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <time.h>
+#include <unistd.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_internal.h"
+
+/*=========================================================*/
+/*== GLOBAL VARIABLES =====================================*/
+/*=========================================================*/
+
+typedef struct SimEventSource
+{
+    uint64_t (*next)(void);
+    void (*fire)(uint64_t atNs);
+    bool anyCore; /*!< Also runs on core 1's clock while core 1 waits for it */
+} SimEventSource;
+
+static uint64_t simNow[SIM_CORES];
+static uint8_t simCore;
+static bool simInIrq;
+static SimStats simStats[SIM_CORES];
+
+static SimEventSource simSources[SIM_MAX_EVENT_SOURCES];
+static uint8_t simSourceCount;
+
+static SimIteration simIterations[SIM_MAX_ITERATIONS];
+static uint32_t simMarks;
+static uint32_t simIterationLimit;
+static uint64_t simLastMarkNs;
+static uint64_t simLastMarkWallNs;
+static SimStats simLastMarkStats;
+static SimStats simLastMarkCore1Stats;
+
+static SimStage simStages[SIM_MAX_ITERATIONS][SIM_MAX_STAGES];
+static const char *simStageNames[SIM_MAX_STAGES];
+static uint8_t simStageCount;
+static int8_t simStageOpen;
+static uint64_t simStageStartNs;
+static uint64_t simStageStartWallNs;
+static SimStats simStageStartStats;
+static jmp_buf simExitJmp;
+static bool simRunning;
+
+static FILE *simReport;
+static bool simQuiet;
+
+typedef struct SimReg
+{
+    const volatile void *addr;
+    uint32_t (*read)(void);
+    void (*write)(uint32_t value);
+} SimReg;
+
+static SimReg simRegs[SIM_MAX_REGS];
+static uint8_t simRegCount;
+
+/*=========================================================*/
+/*== CLOCK FUNCTIONS ======================================*/
+/*=========================================================*/
+
+void SIM_RESET(void)
+{
+    memset(simNow, 0, sizeof(simNow));
+    memset(simStats, 0, sizeof(simStats));
+    simCore = 0;
+    simInIrq = false;
+    simSourceCount = 0;
+    simMarks = 0;
+    simIterationLimit = 0;
+    simRegCount = 0;
+    simStageCount = 0;
+    simStageOpen = -1;
+    memset(simStages, 0, sizeof(simStages));
+
+    sim_heap_reset();
+    sim_irq_reset();
+    sim_gpio_reset();
+    sim_i2c_reset();
+    sim_bme280_reset();
+    sim_ds18b20_reset();
+    sim_adc_reset();
+    sim_dma_reset();
+    sim_pio_reset();
+    sim_uart_reset();
+    sim_multicore_reset();
+}
+
+uint64_t SIM_NOW_NS(void)
+{
+    return simNow[simCore];
+}
+
+uint64_t SIM_CORE_NOW_NS(uint8_t core)
+{
+    return simNow[core];
+}
+
+uint8_t SIM_CORE_CURRENT(void)
+{
+    return simCore;
+}
+
+void sim_core_switch(uint8_t core)
+{
+    simCore = core;
+}
+
+void sim_core_set_now(uint8_t core, uint64_t nowNs)
+{
+    simNow[core] = nowNs;
+}
+
+SimStats *SIM_STATS_MUT(void)
+{
+    return &simStats[simCore];
+}
+
+const SimStats *SIM_STATS(uint8_t core)
+{
+    return &simStats[core];
+}
+
+bool SIM_IN_IRQ(void)
+{
+    return simInIrq;
+}
+
+void sim_irq_enter(bool enter)
+{
+    simInIrq = enter;
+}
+
+static void sim_event_add(uint64_t (*next)(void), void (*fire)(uint64_t atNs), bool anyCore)
+{
+    if (simSourceCount < SIM_MAX_EVENT_SOURCES)
+    {
+        simSources[simSourceCount].next = next;
+        simSources[simSourceCount].fire = fire;
+        simSources[simSourceCount].anyCore = anyCore;
+        simSourceCount++;
+    }
+}
+
+void SIM_EVENT_REGISTER(uint64_t (*next)(void), void (*fire)(uint64_t atNs))
+{
+    sim_event_add(next, fire, false);
+}
+
+/*!< Sources serving a single core (PIO state machines) may also be
+ *   driven from core 1, which runs ahead of core 0 in its handlers */
+void SIM_EVENT_REGISTER_ANY_CORE(uint64_t (*next)(void), void (*fire)(uint64_t atNs))
+{
+    sim_event_add(next, fire, true);
+}
+
+static void sim_account(SimTimeKind kind, uint64_t ns)
+{
+    simStats[simCore].timeNs[simInIrq ? SIM_TIME_IRQ : kind] += ns;
+}
+
+/*!
+**************************************************************
+ * @brief Move the clock of the running core to targetNs
+ *
+ * On core 0 every event source (ADC conversions, UART
+ * reception, DMA pacing ...) due before the target is fired in
+ * time order and pending interrupts are dispatched in between.
+ * Core 1 only moves its own clock and yields back to core 0
+ * once it got ahead of it.
+ *
+ * @param[in]  targetNs Absolute virtual time in nanoseconds
+ * @param[in]  kind     Accounting category of the elapsed time
+ *
+**************************************************************
+ */
+void SIM_ADVANCE_TO_NS(uint64_t targetNs, SimTimeKind kind)
+{
+    if (simCore == 0)
+    {
+        for (;;)
+        {
+            uint64_t next = SIM_NEVER;
+            int8_t source = -1;
+            for (uint8_t i = 0; i < simSourceCount; i++)
+            {
+                uint64_t t = simSources[i].next();
+                if (t < next)
+                {
+                    next = t;
+                    source = (int8_t)i;
+                }
+            }
+            if (source < 0 || next > targetNs)
+            {
+                break;
+            }
+            if (next > simNow[0])
+            {
+                sim_account(kind, next - simNow[0]);
+                simNow[0] = next;
+            }
+            simSources[source].fire(next);
+            SIM_IRQ_DISPATCH();
+        }
+        if (targetNs > simNow[0])
+        {
+            sim_account(kind, targetNs - simNow[0]);
+            simNow[0] = targetNs;
+        }
+        SIM_CORE1_SYNC();
+    }
+    else
+    {
+        if (targetNs > simNow[1])
+        {
+            sim_account(kind, targetNs - simNow[1]);
+            simNow[1] = targetNs;
+        }
+        SIM_CORE1_WAIT();
+    }
+}
+
+void SIM_ADVANCE_NS(uint64_t ns, SimTimeKind kind)
+{
+    SIM_ADVANCE_TO_NS(simNow[simCore] + ns, kind);
+}
+
+void SIM_STATS_DIFF(const SimStats *now, const SimStats *before, SimStats *delta)
+{
+    for (uint8_t i = 0; i < SIM_TIME_KINDS; i++)
+    {
+        delta->timeNs[i] = now->timeNs[i] - before->timeNs[i];
+    }
+    delta->i2cTransactions = now->i2cTransactions - before->i2cTransactions;
+    delta->i2cTxBytes = now->i2cTxBytes - before->i2cTxBytes;
+    delta->i2cRxBytes = now->i2cRxBytes - before->i2cRxBytes;
+    delta->i2cNaks = now->i2cNaks - before->i2cNaks;
+    delta->oneWireResets = now->oneWireResets - before->oneWireResets;
+    delta->oneWireSlots = now->oneWireSlots - before->oneWireSlots;
+    delta->uartTxBytes = now->uartTxBytes - before->uartTxBytes;
+    delta->uartRxBytes = now->uartRxBytes - before->uartRxBytes;
+    delta->adcSamples = now->adcSamples - before->adcSamples;
+    delta->adcOverflows = now->adcOverflows - before->adcOverflows;
+    delta->dmaTransfers = now->dmaTransfers - before->dmaTransfers;
+    delta->irqCount = now->irqCount - before->irqCount;
+    delta->fifoPushes = now->fifoPushes - before->fifoPushes;
+    delta->heapAllocs = now->heapAllocs - before->heapAllocs;
+    delta->heapFrees = now->heapFrees - before->heapFrees;
+    delta->heapBytes = now->heapBytes - before->heapBytes;
+}
+
+static void sim_stats_add(SimStats *sum, const SimStats *delta)
+{
+    for (uint8_t i = 0; i < SIM_TIME_KINDS; i++)
+    {
+        sum->timeNs[i] += delta->timeNs[i];
+    }
+    sum->i2cTransactions += delta->i2cTransactions;
+    sum->i2cTxBytes += delta->i2cTxBytes;
+    sum->i2cRxBytes += delta->i2cRxBytes;
+    sum->i2cNaks += delta->i2cNaks;
+    sum->oneWireResets += delta->oneWireResets;
+    sum->oneWireSlots += delta->oneWireSlots;
+    sum->uartTxBytes += delta->uartTxBytes;
+    sum->uartRxBytes += delta->uartRxBytes;
+    sum->adcSamples += delta->adcSamples;
+    sum->adcOverflows += delta->adcOverflows;
+    sum->dmaTransfers += delta->dmaTransfers;
+    sum->irqCount += delta->irqCount;
+    sum->fifoPushes += delta->fifoPushes;
+    sum->heapAllocs += delta->heapAllocs;
+    sum->heapFrees += delta->heapFrees;
+    sum->heapBytes += delta->heapBytes;
+}
+
+/*=========================================================*/
+/*== REGISTER MAP =========================================*/
+/*=========================================================*/
+
+void SIM_REG_MAP(const volatile void *addr, uint32_t (*read)(void), void (*write)(uint32_t value))
+{
+    if (simRegCount < SIM_MAX_REGS)
+    {
+        simRegs[simRegCount].addr = addr;
+        simRegs[simRegCount].read = read;
+        simRegs[simRegCount].write = write;
+        simRegCount++;
+    }
+}
+
+bool SIM_REG_READ(const volatile void *addr, uint32_t *value)
+{
+    for (uint8_t i = 0; i < simRegCount; i++)
+    {
+        if (simRegs[i].addr == addr && simRegs[i].read != NULL)
+        {
+            *value = simRegs[i].read();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SIM_REG_WRITE(const volatile void *addr, uint32_t value)
+{
+    for (uint8_t i = 0; i < simRegCount; i++)
+    {
+        if (simRegs[i].addr == addr && simRegs[i].write != NULL)
+        {
+            simRegs[i].write(value);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+**************************************************************
+ * @brief Block the running core until the next scheduled event
+ * happened. Core 1 only waits for sources registered with
+ * SIM_EVENT_REGISTER_ANY_CORE.
+ *
+ * @return false if nothing is scheduled anymore (deadlock)
+**************************************************************
+ */
+bool SIM_WAIT_EVENT(SimTimeKind kind)
+{
+    uint64_t next = SIM_NEVER;
+    int8_t source = -1;
+    for (uint8_t i = 0; i < simSourceCount; i++)
+    {
+        uint64_t t = simSources[i].next();
+        if (t < next && (simCore == 0 || simSources[i].anyCore))
+        {
+            next = t;
+            source = (int8_t)i;
+        }
+    }
+    if (next == SIM_NEVER)
+    {
+        return false;
+    }
+    if (simCore == 0)
+    {
+        SIM_ADVANCE_TO_NS(next > simNow[0] ? next : simNow[0], kind);
+        return true;
+    }
+
+    /*!< Core 1 fires the source on its own clock */
+    if (next > simNow[1])
+    {
+        sim_account(kind, next - simNow[1]);
+        simNow[1] = next;
+    }
+    simSources[source].fire(simNow[1]);
+    return true;
+}
+
+/*=========================================================*/
+/*== PICO TIME API ========================================*/
+/*=========================================================*/
+
+void sleep_us(uint64_t us)
+{
+    SIM_ADVANCE_NS(us * SIM_NS_PER_US, SIM_TIME_SLEEP);
+}
+
+void sleep_ms(uint32_t ms)
+{
+    SIM_ADVANCE_NS(ms * SIM_NS_PER_MS, SIM_TIME_SLEEP);
+}
+
+void busy_wait_us(uint64_t us)
+{
+    SIM_ADVANCE_NS(us * SIM_NS_PER_US, SIM_TIME_SLEEP);
+}
+
+void sleep_until(absolute_time_t target)
+{
+    SIM_ADVANCE_TO_NS(target * SIM_NS_PER_US, SIM_TIME_SLEEP);
+}
+
+uint64_t time_us_64(void)
+{
+    return simNow[simCore] / SIM_NS_PER_US;
+}
+
+uint32_t time_us_32(void)
+{
+    return (uint32_t)time_us_64();
+}
+
+absolute_time_t get_absolute_time(void)
+{
+    return time_us_64();
+}
+
+absolute_time_t make_timeout_time_us(uint64_t us)
+{
+    return time_us_64() + us;
+}
+
+absolute_time_t make_timeout_time_ms(uint32_t ms)
+{
+    return time_us_64() + (uint64_t)ms * 1000u;
+}
+
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to)
+{
+    return (int64_t)(to - from);
+}
+
+uint32_t clock_get_hz(enum clock_index clk_index)
+{
+    switch (clk_index)
+    {
+    case clk_sys:
+        return SIM_CLK_SYS_HZ;
+    case clk_usb:
+    case clk_adc:
+        return 48000000u;
+    case clk_rtc:
+        return 46875u;
+    case clk_peri:
+        return SIM_CLK_SYS_HZ;
+    default:
+        return 12000000u;
+    }
+}
+
+/*=========================================================*/
+/*== FIRMWARE EXECUTION ===================================*/
+/*=========================================================*/
+
+/*!
+**************************************************************
+ * @brief Run the firmware entry until it passed the main loop
+ * head iterations + 1 times
+ *
+ * @param[in]  entry      Renamed firmware main()
+ * @param[in]  iterations Number of complete loop iterations
+ *
+ * @return Number of recorded iterations
+ *
+**************************************************************
+ */
+int SIM_RUN_FIRMWARE(int (*entry)(void), uint32_t iterations)
+{
+    if (iterations > SIM_MAX_ITERATIONS)
+    {
+        iterations = SIM_MAX_ITERATIONS;
+    }
+    simIterationLimit = iterations;
+    simMarks = 0;
+    simStageOpen = -1;
+    memset(simStages, 0, sizeof(simStages));
+    simRunning = true;
+
+    if (setjmp(simExitJmp) == 0)
+    {
+        entry();
+    }
+    simRunning = false;
+    fflush(stdout);
+
+    return (int)(simMarks > 0 ? simMarks - 1 : 0);
+}
+
+uint64_t SIM_WALL_NS(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void sim_stage_close(uint64_t nowNs, uint64_t wallNs)
+{
+    if (simStageOpen < 0 || simMarks == 0)
+    {
+        simStageOpen = -1;
+        return;
+    }
+
+    SimStage *stage = &simStages[simMarks - 1][simStageOpen];
+    SimStats delta;
+    SIM_STATS_DIFF(&simStats[0], &simStageStartStats, &delta);
+
+    /*!< A stage may be entered several times per iteration, accumulate */
+    stage->seen = true;
+    stage->virtualNs += nowNs - simStageStartNs;
+    stage->wallNs += wallNs - simStageStartWallNs;
+    sim_stats_add(&stage->stats, &delta);
+    simStageOpen = -1;
+}
+
+/*!
+**************************************************************
+ * @brief Main loop head marker, records the previous iteration
+ * and leaves the firmware once the iteration budget is spent
+**************************************************************
+ */
+void SIM_LOOP_MARK(void)
+{
+    uint64_t now = simNow[0];
+    uint64_t wall = SIM_WALL_NS();
+
+    sim_stage_close(now, wall);
+    if (simMarks > 0)
+    {
+        SimIteration *it = &simIterations[simMarks - 1];
+        it->startNs = simLastMarkNs;
+        it->endNs = now;
+        it->wallNs = wall - simLastMarkWallNs;
+        SIM_STATS_DIFF(&simStats[0], &simLastMarkStats, &it->stats);
+        SIM_STATS_DIFF(&simStats[1], &simLastMarkCore1Stats, &it->core1);
+    }
+
+    if (simRunning && simMarks >= simIterationLimit)
+    {
+        simMarks++;
+        longjmp(simExitJmp, 1);
+    }
+
+    simMarks++;
+    simLastMarkNs = now;
+    simLastMarkStats = simStats[0];
+    simLastMarkCore1Stats = simStats[1];
+    simLastMarkWallNs = SIM_WALL_NS();
+}
+
+/*!
+**************************************************************
+ * @brief Start the named stage of the current loop iteration,
+ * the previous stage ends here
+ *
+ * @param[in]  name Stage name, must be a string literal
+**************************************************************
+ */
+void SIM_STAGE(const char *name)
+{
+    uint64_t wall = SIM_WALL_NS();
+    int8_t index = -1;
+
+    sim_stage_close(simNow[0], wall);
+    for (uint8_t i = 0; i < simStageCount; i++)
+    {
+        if (simStageNames[i] == name || strcmp(simStageNames[i], name) == 0)
+        {
+            index = (int8_t)i;
+            break;
+        }
+    }
+    if (index < 0)
+    {
+        if (simStageCount == SIM_MAX_STAGES)
+        {
+            return;
+        }
+        index = (int8_t)simStageCount;
+        simStageNames[simStageCount++] = name;
+    }
+
+    simStageOpen = index;
+    simStageStartNs = simNow[0];
+    simStageStartStats = simStats[0];
+    simStageStartWallNs = SIM_WALL_NS();
+}
+
+uint8_t SIM_STAGE_COUNT(void)
+{
+    return simStageCount;
+}
+
+const char *SIM_STAGE_NAME(uint8_t stage)
+{
+    return simStageNames[stage];
+}
+
+const SimStage *SIM_STAGE_RECORD(uint32_t iteration, uint8_t stage)
+{
+    return &simStages[iteration][stage];
+}
+
+uint32_t SIM_ITERATION_COUNT(void)
+{
+    return simMarks > 0 ? simMarks - 1 : 0;
+}
+
+const SimIteration *SIM_ITERATION(uint32_t index)
+{
+    return &simIterations[index];
+}
+
+/*=========================================================*/
+/*== FIRMWARE CONSOLE =====================================*/
+/*=========================================================*/
+
+void SIM_STDIO_QUIET(bool quiet)
+{
+    simQuiet = quiet;
+}
+
+FILE *SIM_REPORT_STREAM(void)
+{
+    if (simReport == NULL)
+    {
+        simReport = fdopen(dup(fileno(stdout)), "w");
+    }
+    return simReport;
+}
+
+bool stdio_init_all(void)
+{
+    if (simQuiet)
+    {
+        SIM_REPORT_STREAM();
+        fflush(stdout);
+        if (freopen("/dev/null", "w", stdout) == NULL)
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,434 @@
+/*!
+*****************************************************************
+* @file    sim_dma.c
+* @brief   RP2040 DMA model of the host simulation: DREQ paced
+*          transfers, chaining, address rings and IRQ0/IRQ1
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_internal.h"
+
+/*=========================================================*/
+/*== GLOBAL VARIABLES =====================================*/
+/*=========================================================*/
+
+typedef struct SimDmaChannel
+{
+    bool claimed;
+    bool busy;
+    dma_channel_config config;
+    uintptr_t readAddr;
+    uintptr_t writeAddr;
+    uint32_t transCount;
+    uint32_t remaining;
+    bool irq0En;
+    bool irq1En;
+    bool irq0Status;
+    bool irq1Status;
+} SimDmaChannel;
+
+static SimDmaChannel simDma[NUM_DMA_CHANNELS];
+
+/*=========================================================*/
+/*== MODEL FUNCTIONS ======================================*/
+/*=========================================================*/
+
+void sim_dma_reset(void)
+{
+    memset(simDma, 0, sizeof(simDma));
+}
+
+static uintptr_t sim_dma_ring(uintptr_t base, uintptr_t next, uint8_t ringBits)
+{
+    uintptr_t mask = ((uintptr_t)1 << ringBits) - 1;
+    return (base & ~mask) | (next & mask);
+}
+
+static uint32_t sim_dma_load(uintptr_t addr, uint8_t size)
+{
+    uint32_t value = 0;
+    if (SIM_REG_READ((const volatile void *)addr, &value))
+    {
+        return value;
+    }
+    switch (size)
+    {
+    case 1:
+        return *(const volatile uint8_t *)addr;
+    case 2:
+        return *(const volatile uint16_t *)addr;
+    default:
+        return *(const volatile uint32_t *)addr;
+    }
+}
+
+static void sim_dma_store(uintptr_t addr, uint8_t size, uint32_t value)
+{
+    if (SIM_REG_WRITE((const volatile void *)addr, value))
+    {
+        return;
+    }
+    switch (size)
+    {
+    case 1:
+        *(volatile uint8_t *)addr = (uint8_t)value;
+        break;
+    case 2:
+        *(volatile uint16_t *)addr = (uint16_t)value;
+        break;
+    default:
+        *(volatile uint32_t *)addr = value;
+        break;
+    }
+}
+
+static void sim_dma_complete(uint channel, uint64_t atNs);
+
+/*!< Move one element of channel, returns true when the channel finished */
+static bool sim_dma_transfer(uint channel, uint64_t atNs)
+{
+    SimDmaChannel *ch = &simDma[channel];
+    const dma_channel_config *c = &ch->config;
+    uint8_t size = (uint8_t)(1u << c->dataSize);
+
+    sim_dma_store(ch->writeAddr, size, sim_dma_load(ch->readAddr, size));
+    SIM_STATS_MUT()->dmaTransfers++;
+
+    if (c->readIncr)
+    {
+        uintptr_t next = ch->readAddr + size;
+        ch->readAddr = (c->ringBits && !c->ringWrite) ? sim_dma_ring(ch->readAddr, next, c->ringBits) : next;
+    }
+    if (c->writeIncr)
+    {
+        uintptr_t next = ch->writeAddr + size;
+        ch->writeAddr = (c->ringBits && c->ringWrite) ? sim_dma_ring(ch->writeAddr, next, c->ringBits) : next;
+    }
+
+    if (--ch->remaining == 0)
+    {
+        sim_dma_complete(channel, atNs);
+        return true;
+    }
+    return false;
+}
+
+static void sim_dma_trigger(uint channel, uint64_t atNs)
+{
+    SimDmaChannel *ch = &simDma[channel];
+
+    if (!ch->config.enable)
+    {
+        return;
+    }
+    ch->remaining = ch->transCount;
+    ch->busy = ch->remaining > 0;
+    if (!ch->busy)
+    {
+        sim_dma_complete(channel, atNs);
+        return;
+    }
+    if (ch->config.dreq == DREQ_FORCE)
+    {
+        /*!< Unpaced transfers run at bus speed, far below the simulated resolution */
+        while (!sim_dma_transfer(channel, atNs))
+        {
+        }
+    }
+}
+
+static void sim_dma_complete(uint channel, uint64_t atNs)
+{
+    SimDmaChannel *ch = &simDma[channel];
+
+    ch->busy = false;
+    if (!ch->config.irqQuiet)
+    {
+        if (ch->irq0En)
+        {
+            ch->irq0Status = true;
+            SIM_IRQ_RAISE(DMA_IRQ_0);
+        }
+        if (ch->irq1En)
+        {
+            ch->irq1Status = true;
+            SIM_IRQ_RAISE(DMA_IRQ_1);
+        }
+    }
+    if (ch->config.chainTo != channel)
+    {
+        sim_dma_trigger(ch->config.chainTo, atNs);
+    }
+}
+
+/*!
+**************************************************************
+ * @brief A peripheral asserts dreq once, the lowest busy channel
+ * paced by it moves one element
+ *
+ * @return true if a channel took the element
+**************************************************************
+ */
+bool SIM_DMA_DREQ(uint dreq, uint64_t atNs)
+{
+    for (uint channel = 0; channel < NUM_DMA_CHANNELS; channel++)
+    {
+        if (simDma[channel].busy && simDma[channel].config.dreq == dreq)
+        {
+            sim_dma_transfer(channel, atNs);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!< Level-sensitive peripherals (I2C FIFOs) ask before asserting */
+bool SIM_DMA_DREQ_PENDING(uint dreq)
+{
+    for (uint channel = 0; channel < NUM_DMA_CHANNELS; channel++)
+    {
+        if (simDma[channel].busy && simDma[channel].config.dreq == dreq)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*=========================================================*/
+/*== PICO DMA API =========================================*/
+/*=========================================================*/
+
+int dma_claim_unused_channel(bool required)
+{
+    for (uint channel = 0; channel < NUM_DMA_CHANNELS; channel++)
+    {
+        if (!simDma[channel].claimed)
+        {
+            simDma[channel].claimed = true;
+            return (int)channel;
+        }
+    }
+    if (required)
+    {
+        fprintf(stderr, "sim: no DMA channels available\n");
+    }
+    return -1;
+}
+
+void dma_channel_claim(uint channel)
+{
+    simDma[channel].claimed = true;
+}
+
+void dma_channel_unclaim(uint channel)
+{
+    simDma[channel].claimed = false;
+}
+
+bool dma_channel_is_claimed(uint channel)
+{
+    return simDma[channel].claimed;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+    dma_channel_config c;
+    memset(&c, 0, sizeof(c));
+    c.dataSize = DMA_SIZE_32;
+    c.readIncr = true;
+    c.writeIncr = false;
+    c.dreq = DREQ_FORCE;
+    c.chainTo = (uint8_t)channel;
+    c.enable = true;
+    return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size)
+{
+    c->dataSize = (uint8_t)size;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr)
+{
+    c->readIncr = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr)
+{
+    c->writeIncr = incr;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq)
+{
+    c->dreq = (uint8_t)dreq;
+}
+
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to)
+{
+    c->chainTo = (uint8_t)chain_to;
+}
+
+void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits)
+{
+    c->ringWrite = write;
+    c->ringBits = (uint8_t)size_bits;
+}
+
+void channel_config_set_irq_quiet(dma_channel_config *c, bool irq_quiet)
+{
+    c->irqQuiet = irq_quiet;
+}
+
+void channel_config_set_enable(dma_channel_config *c, bool enable)
+{
+    c->enable = enable;
+}
+
+void channel_config_set_bswap(dma_channel_config *c, bool bswap)
+{
+    c->byteSwap = bswap;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+    dma_channel_set_read_addr(channel, read_addr, false);
+    dma_channel_set_write_addr(channel, write_addr, false);
+    dma_channel_set_trans_count(channel, transfer_count, false);
+    dma_channel_set_config(channel, config, trigger);
+}
+
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger)
+{
+    simDma[channel].config = *config;
+    if (trigger)
+    {
+        dma_channel_start(channel);
+    }
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger)
+{
+    simDma[channel].readAddr = (uintptr_t)read_addr;
+    if (trigger)
+    {
+        dma_channel_start(channel);
+    }
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger)
+{
+    simDma[channel].writeAddr = (uintptr_t)write_addr;
+    if (trigger)
+    {
+        dma_channel_start(channel);
+    }
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger)
+{
+    simDma[channel].transCount = trans_count;
+    if (trigger)
+    {
+        dma_channel_start(channel);
+    }
+}
+
+void dma_channel_start(uint channel)
+{
+    sim_dma_trigger(channel, SIM_NOW_NS());
+    SIM_IRQ_DISPATCH();
+}
+
+void dma_start_channel_mask(uint32_t chan_mask)
+{
+    for (uint channel = 0; channel < NUM_DMA_CHANNELS; channel++)
+    {
+        if (chan_mask & (1u << channel))
+        {
+            sim_dma_trigger(channel, SIM_NOW_NS());
+        }
+    }
+    SIM_IRQ_DISPATCH();
+}
+
+void dma_channel_abort(uint channel)
+{
+    simDma[channel].busy = false;
+}
+
+bool dma_channel_is_busy(uint channel)
+{
+    return simDma[channel].busy;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel)
+{
+    while (simDma[channel].busy)
+    {
+        if (!SIM_WAIT_EVENT(SIM_TIME_DMA_WAIT))
+        {
+            fprintf(stderr, "sim: DMA channel %u never finishes (no DREQ source running)\n", channel);
+            simDma[channel].busy = false;
+        }
+    }
+}
+
+uint32_t dma_channel_get_trans_count(uint channel)
+{
+    return simDma[channel].busy ? simDma[channel].remaining : 0;
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled)
+{
+    simDma[channel].irq0En = enabled;
+}
+
+void dma_channel_set_irq1_enabled(uint channel, bool enabled)
+{
+    simDma[channel].irq1En = enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel)
+{
+    return simDma[channel].irq0Status;
+}
+
+bool dma_channel_get_irq1_status(uint channel)
+{
+    return simDma[channel].irq1Status;
+}
+
+void dma_channel_acknowledge_irq0(uint channel)
+{
+    simDma[channel].irq0Status = false;
+}
+
+void dma_channel_acknowledge_irq1(uint channel)
+{
+    simDma[channel].irq1Status = false;
+}
@@ -0,0 +1,501 @@
+/*!
+*****************************************************************
+* @file    sim_ds18b20.c
+* @brief   1-Wire bus and DS18B20 device model of the host
+*          simulation. The model follows the master's line edges
+*          on the GPIO and answers with datasheet slot timing.
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_internal.h"
+
+/*=========================================================*/
+/*== 1-WIRE MACROS ========================================*/
+/*=========================================================*/
+
+#define SIM_OW_MAX_DEVICES      16
+#define SIM_OW_GLITCH_NS        (1 * SIM_NS_PER_US)
+#define SIM_OW_RESET_NS         (480 * SIM_NS_PER_US)
+#define SIM_OW_SAMPLE_NS        (30 * SIM_NS_PER_US)  /*!< Slave samples a write slot here */
+#define SIM_OW_HOLD_NS          (45 * SIM_NS_PER_US)  /*!< Slave holds a read-0 this long */
+#define SIM_OW_PRESENCE_WAIT_NS (30 * SIM_NS_PER_US)
+#define SIM_OW_PRESENCE_NS      (120 * SIM_NS_PER_US)
+
+typedef enum SimOwState
+{
+    OW_IDLE,    /*!< Not addressed, waits for reset */
+    OW_ROM_CMD,
+    OW_MATCH,
+    OW_SEARCH,
+    OW_FUNC,
+    OW_WRITE_SP,
+    OW_TX,
+    OW_CONVERT,
+    OW_RECALL
+} SimOwState;
+
+/*=========================================================*/
+/*== GLOBAL VARIABLES =====================================*/
+/*=========================================================*/
+
+struct SimDs18b20
+{
+    uint8_t gpio;
+    uint8_t rom[8];
+    int16_t tempX16;   /*!< Scripted die temperature */
+    int16_t tempReg;   /*!< Temperature register */
+    int8_t th;
+    int8_t tl;
+    uint8_t config;
+    int8_t eeTh;
+    int8_t eeTl;
+    uint8_t eeConfig;
+    bool converting;
+    uint64_t convertUntil;
+    uint8_t faultReads;  /*!< Scratchpad reads still corrupted */
+    uint8_t faultByte;
+    uint8_t faultMask;
+
+    SimOwState state;
+    uint8_t rxByte;
+    uint8_t rxBits;
+    uint8_t rxCount;
+    uint8_t rxBuf[8];
+    uint8_t txBuf[9];
+    uint8_t txLen;
+    uint8_t txBit;
+    uint8_t searchBit;
+    uint8_t searchPhase;
+    bool readSlot;
+
+    uint64_t holdStart;
+    uint64_t holdUntil;
+};
+
+typedef struct SimOwBus
+{
+    uint8_t gpio;
+    uint64_t lowStart;
+} SimOwBus;
+
+static SimDs18b20 simDs[SIM_OW_MAX_DEVICES];
+static uint8_t simDsCount;
+static SimOwBus simBus[SIM_OW_MAX_DEVICES];
+static uint8_t simBusCount;
+
+/*=========================================================*/
+/*== MODEL FUNCTIONS ======================================*/
+/*=========================================================*/
+
+void sim_ds18b20_reset(void)
+{
+    memset(simDs, 0, sizeof(simDs));
+    memset(simBus, 0, sizeof(simBus));
+    simDsCount = 0;
+    simBusCount = 0;
+}
+
+static uint8_t sim_ow_crc8(const uint8_t *data, uint8_t len)
+{
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < len; i++)
+    {
+        uint8_t b = data[i];
+        for (uint8_t j = 0; j < 8; j++)
+        {
+            uint8_t mix = (crc ^ b) & 0x01;
+            crc >>= 1;
+            if (mix)
+            {
+                crc ^= 0x8C;
+            }
+            b >>= 1;
+        }
+    }
+    return crc;
+}
+
+static SimOwBus *sim_ow_bus(uint8_t gpio)
+{
+    for (uint8_t i = 0; i < simBusCount; i++)
+    {
+        if (simBus[i].gpio == gpio)
+        {
+            return &simBus[i];
+        }
+    }
+    return NULL;
+}
+
+static uint8_t sim_ds18b20_resolution(const SimDs18b20 *dev)
+{
+    return (uint8_t)(9 + ((dev->config >> 5) & 0x03));
+}
+
+static uint64_t sim_ds18b20_conversion_ns(const SimDs18b20 *dev)
+{
+    /*!< 93.75 ms at 9 bit, doubling per extra bit */
+    return (93750ull * SIM_NS_PER_US) << (sim_ds18b20_resolution(dev) - 9);
+}
+
+static void sim_ds18b20_settle(SimDs18b20 *dev, uint64_t nowNs)
+{
+    if (dev->converting && nowNs >= dev->convertUntil)
+    {
+        uint8_t drop = (uint8_t)(12 - sim_ds18b20_resolution(dev));
+        dev->tempReg = (int16_t)(dev->tempX16 & ~((1 << drop) - 1));
+        dev->converting = false;
+    }
+}
+
+static bool sim_ds18b20_alarm(const SimDs18b20 *dev)
+{
+    int8_t t = (int8_t)(dev->tempReg >> 4);
+    return t >= dev->th || t <= dev->tl;
+}
+
+static void sim_ds18b20_tx(SimDs18b20 *dev, const uint8_t *data, uint8_t len)
+{
+    memcpy(dev->txBuf, data, len);
+    dev->txLen = len;
+    dev->txBit = 0;
+    dev->state = OW_TX;
+}
+
+static void sim_ds18b20_function(SimDs18b20 *dev, uint8_t cmd, uint64_t nowNs)
+{
+    uint8_t pad[9];
+
+    switch (cmd)
+    {
+    case 0x44: /*!< CONVERT T */
+        dev->converting = true;
+        dev->convertUntil = nowNs + sim_ds18b20_conversion_ns(dev);
+        dev->state = OW_CONVERT;
+        break;
+    case 0xBE: /*!< READ SCRATCHPAD */
+        pad[0] = (uint8_t)dev->tempReg;
+        pad[1] = (uint8_t)(dev->tempReg >> 8);
+        pad[2] = (uint8_t)dev->th;
+        pad[3] = (uint8_t)dev->tl;
+        pad[4] = dev->config;
+        pad[5] = 0xFF;
+        pad[6] = 0x0C;
+        pad[7] = 0x10;
+        pad[8] = sim_ow_crc8(pad, 8);
+        if (dev->faultReads > 0)
+        {
+            pad[dev->faultByte] ^= dev->faultMask;
+            dev->faultReads--;
+        }
+        sim_ds18b20_tx(dev, pad, 9);
+        break;
+    case 0x4E: /*!< WRITE SCRATCHPAD */
+        dev->state = OW_WRITE_SP;
+        dev->rxCount = 0;
+        break;
+    case 0x48: /*!< COPY SCRATCHPAD */
+        dev->eeTh = dev->th;
+        dev->eeTl = dev->tl;
+        dev->eeConfig = dev->config;
+        dev->state = OW_IDLE;
+        break;
+    case 0xB8: /*!< RECALL E2 */
+        dev->th = dev->eeTh;
+        dev->tl = dev->eeTl;
+        dev->config = dev->eeConfig;
+        dev->state = OW_RECALL;
+        break;
+    case 0xB4: /*!< READ POWER SUPPLY, externally powered */
+        pad[0] = 0xFF;
+        sim_ds18b20_tx(dev, pad, 1);
+        break;
+    default:
+        dev->state = OW_IDLE;
+        break;
+    }
+}
+
+static void sim_ds18b20_rom_command(SimDs18b20 *dev, uint8_t cmd)
+{
+    switch (cmd)
+    {
+    case 0xCC: /*!< SKIP ROM */
+        dev->state = OW_FUNC;
+        break;
+    case 0x55: /*!< MATCH ROM */
+        dev->state = OW_MATCH;
+        dev->rxCount = 0;
+        break;
+    case 0x33: /*!< READ ROM */
+        sim_ds18b20_tx(dev, dev->rom, 8);
+        break;
+    case 0xF0: /*!< SEARCH ROM */
+        dev->state = OW_SEARCH;
+        dev->searchBit = 0;
+        dev->searchPhase = 0;
+        break;
+    case 0xEC: /*!< ALARM SEARCH */
+        dev->state = sim_ds18b20_alarm(dev) ? OW_SEARCH : OW_IDLE;
+        dev->searchBit = 0;
+        dev->searchPhase = 0;
+        break;
+    default:
+        dev->state = OW_IDLE;
+        break;
+    }
+}
+
+/*!< A byte arrived in one of the receiving states */
+static void sim_ds18b20_byte(SimDs18b20 *dev, uint8_t value, uint64_t nowNs)
+{
+    switch (dev->state)
+    {
+    case OW_ROM_CMD:
+        sim_ds18b20_rom_command(dev, value);
+        break;
+    case OW_MATCH:
+        dev->rxBuf[dev->rxCount++] = value;
+        if (dev->rxCount == 8)
+        {
+            dev->state = (memcmp(dev->rxBuf, dev->rom, 8) == 0) ? OW_FUNC : OW_IDLE;
+        }
+        break;
+    case OW_FUNC:
+        sim_ds18b20_function(dev, value, nowNs);
+        break;
+    case OW_WRITE_SP:
+        dev->rxBuf[dev->rxCount++] = value;
+        if (dev->rxCount == 3)
+        {
+            dev->th = (int8_t)dev->rxBuf[0];
+            dev->tl = (int8_t)dev->rxBuf[1];
+            dev->config = (uint8_t)((dev->rxBuf[2] & 0x60) | 0x1F);
+            dev->state = OW_IDLE;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/*!< Bit the slave puts on the line in a read slot, 1 = released */
+static bool sim_ds18b20_tx_bit(SimDs18b20 *dev, uint64_t nowNs)
+{
+    bool bit = true;
+
+    switch (dev->state)
+    {
+    case OW_TX:
+        if (dev->txBit < dev->txLen * 8)
+        {
+            bit = (dev->txBuf[dev->txBit / 8] >> (dev->txBit % 8)) & 0x01;
+            dev->txBit++;
+        }
+        break;
+    case OW_CONVERT:
+        sim_ds18b20_settle(dev, nowNs);
+        bit = !dev->converting;
+        break;
+    case OW_SEARCH:
+        bit = (dev->rom[dev->searchBit / 8] >> (dev->searchBit % 8)) & 0x01;
+        if (dev->searchPhase == 1)
+        {
+            bit = !bit;
+        }
+        dev->searchPhase++;
+        break;
+    default:
+        break;
+    }
+    return bit;
+}
+
+static bool sim_ds18b20_transmitting(const SimDs18b20 *dev)
+{
+    return dev->state == OW_TX || dev->state == OW_CONVERT || dev->state == OW_RECALL ||
+           (dev->state == OW_SEARCH && dev->searchPhase < 2);
+}
+
+static void sim_ds18b20_rx_bit(SimDs18b20 *dev, bool bit, uint64_t nowNs)
+{
+    if (dev->state == OW_SEARCH)
+    {
+        /*!< Master's direction bit, devices that do not match drop out */
+        bool own = (dev->rom[dev->searchBit / 8] >> (dev->searchBit % 8)) & 0x01;
+        dev->searchPhase = 0;
+        if (own != bit)
+        {
+            dev->state = OW_IDLE;
+            return;
+        }
+        if (++dev->searchBit == 64)
+        {
+            dev->state = OW_FUNC;
+        }
+        return;
+    }
+
+    dev->rxByte = (uint8_t)((dev->rxByte >> 1) | (bit ? 0x80 : 0x00));
+    if (++dev->rxBits == 8)
+    {
+        dev->rxBits = 0;
+        sim_ds18b20_byte(dev, dev->rxByte, nowNs);
+    }
+}
+
+/*=========================================================*/
+/*== BUS FUNCTIONS ========================================*/
+/*=========================================================*/
+
+bool SIM_ONEWIRE_PRESENT(uint8_t gpio)
+{
+    return sim_ow_bus(gpio) != NULL;
+}
+
+/*!
+**************************************************************
+ * @brief Master changed the line drive on gpio
+ *
+ * Falling edges start a slot: slaves that are transmitting
+ * decide here whether they hold the line low. Rising edges end
+ * it and the low time decides between reset, write-0 and
+ * write-1 for every slave that is listening.
+**************************************************************
+ */
+void SIM_ONEWIRE_MASTER(uint8_t gpio, bool low, uint64_t nowNs)
+{
+    SimOwBus *bus = sim_ow_bus(gpio);
+
+    if (low)
+    {
+        bus->lowStart = nowNs;
+        for (uint8_t i = 0; i < simDsCount; i++)
+        {
+            SimDs18b20 *dev = &simDs[i];
+            if (dev->gpio != gpio)
+            {
+                continue;
+            }
+            dev->readSlot = sim_ds18b20_transmitting(dev);
+            if (dev->readSlot && !sim_ds18b20_tx_bit(dev, nowNs))
+            {
+                dev->holdStart = nowNs;
+                dev->holdUntil = nowNs + SIM_OW_HOLD_NS;
+            }
+        }
+        return;
+    }
+
+    uint64_t lowNs = nowNs - bus->lowStart;
+    if (lowNs < SIM_OW_GLITCH_NS)
+    {
+        return;
+    }
+
+    SimStats *stats = SIM_STATS_MUT();
+    if (lowNs >= SIM_OW_RESET_NS)
+    {
+        stats->oneWireResets++;
+    }
+    else
+    {
+        stats->oneWireSlots++;
+    }
+
+    for (uint8_t i = 0; i < simDsCount; i++)
+    {
+        SimDs18b20 *dev = &simDs[i];
+        if (dev->gpio != gpio)
+        {
+            continue;
+        }
+        sim_ds18b20_settle(dev, nowNs);
+        if (lowNs >= SIM_OW_RESET_NS)
+        {
+            dev->state = OW_ROM_CMD;
+            dev->rxBits = 0;
+            dev->rxCount = 0;
+            dev->holdStart = nowNs + SIM_OW_PRESENCE_WAIT_NS;
+            dev->holdUntil = dev->holdStart + SIM_OW_PRESENCE_NS;
+        }
+        else if (!dev->readSlot)
+        {
+            sim_ds18b20_rx_bit(dev, lowNs < SIM_OW_SAMPLE_NS, nowNs);
+        }
+    }
+}
+
+bool SIM_ONEWIRE_LINE(uint8_t gpio, uint64_t nowNs)
+{
+    for (uint8_t i = 0; i < simDsCount; i++)
+    {
+        const SimDs18b20 *dev = &simDs[i];
+        if (dev->gpio == gpio && nowNs >= dev->holdStart && nowNs < dev->holdUntil)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+SimDs18b20 *SIM_DS18B20_ATTACH(uint8_t gpio, uint64_t rom)
+{
+    if (simDsCount >= SIM_OW_MAX_DEVICES)
+    {
+        return NULL;
+    }
+    if (sim_ow_bus(gpio) == NULL)
+    {
+        simBus[simBusCount++].gpio = gpio;
+    }
+
+    SimDs18b20 *dev = &simDs[simDsCount++];
+    memset(dev, 0, sizeof(*dev));
+    dev->gpio = gpio;
+
+    /*!< Family code 0x28, 48 bit serial, CRC */
+    dev->rom[0] = 0x28;
+    for (uint8_t i = 0; i < 6; i++)
+    {
+        dev->rom[1 + i] = (uint8_t)(rom >> (8 * i));
+    }
+    dev->rom[7] = sim_ow_crc8(dev->rom, 7);
+
+    dev->tempReg = 0x0550; /*!< +85 degC power-on value */
+    dev->tempX16 = 20 * 16;
+    dev->eeTh = dev->th = 75;
+    dev->eeTl = dev->tl = 70;
+    dev->eeConfig = dev->config = 0x7F;
+    dev->state = OW_IDLE;
+    return dev;
+}
+
+void SIM_DS18B20_SET_TEMP(SimDs18b20 *dev, int16_t tempX16)
+{
+    dev->tempX16 = tempX16;
+}
+
+/*!< The next scratchpad reads (count: reads) arrive with byte ^ mask, as after a bit error on the line */
+void SIM_DS18B20_FAULT(SimDs18b20 *dev, uint8_t reads, uint8_t byte, uint8_t mask)
+{
+    dev->faultReads = reads;
+    dev->faultByte = (uint8_t)(byte % 9);
+    dev->faultMask = mask;
+}
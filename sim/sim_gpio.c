@@ -0,0 +1,170 @@
+/*!
+*****************************************************************
+* @file    sim_gpio.c
+* @brief   GPIO block of the host simulation, open-drain 1-Wire
+*          lines are resolved against the attached device models.
+*          Pins on GPIO_FUNC_PIO0/1 follow the PIO outputs.
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "hardware/gpio.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_internal.h"
+
+/*=========================================================*/
+/*== GLOBAL VARIABLES =====================================*/
+/*=========================================================*/
+
+typedef struct SimGpio
+{
+    bool out;
+    bool value;
+    bool pullUp;
+    bool pullDown;
+    bool masterLow;
+    bool pioOe;
+    bool pioValue;
+    enum gpio_function function;
+} SimGpio;
+
+static SimGpio simGpio[NUM_BANK0_GPIOS];
+
+/*=========================================================*/
+/*== GPIO FUNCTIONS =======================================*/
+/*=========================================================*/
+
+void sim_gpio_reset(void)
+{
+    memset(simGpio, 0, sizeof(simGpio));
+    for (uint8_t i = 0; i < NUM_BANK0_GPIOS; i++)
+    {
+        simGpio[i].function = GPIO_FUNC_NULL;
+    }
+}
+
+static bool sim_gpio_is_pio(uint gpio)
+{
+    return simGpio[gpio].function == GPIO_FUNC_PIO0 || simGpio[gpio].function == GPIO_FUNC_PIO1;
+}
+
+static void sim_gpio_update(uint gpio, uint64_t nowNs)
+{
+    bool low = sim_gpio_is_pio(gpio) ? (simGpio[gpio].pioOe && !simGpio[gpio].pioValue)
+                                     : (simGpio[gpio].out && !simGpio[gpio].value);
+    if (low != simGpio[gpio].masterLow)
+    {
+        simGpio[gpio].masterLow = low;
+        if (SIM_ONEWIRE_PRESENT((uint8_t)gpio))
+        {
+            SIM_ONEWIRE_MASTER((uint8_t)gpio, low, nowNs);
+        }
+    }
+}
+
+/*!< A PIO state machine changed its output enable or level at atNs */
+void SIM_GPIO_PIO_DRIVE(uint gpio, bool oe, bool value, uint64_t atNs)
+{
+    simGpio[gpio].pioOe = oe;
+    simGpio[gpio].pioValue = value;
+    if (sim_gpio_is_pio(gpio))
+    {
+        sim_gpio_update(gpio, atNs);
+    }
+}
+
+/*!< Input level of gpio at atNs, as seen by SIO and the PIO blocks */
+bool SIM_GPIO_LEVEL(uint gpio, uint64_t atNs)
+{
+    if (SIM_ONEWIRE_PRESENT((uint8_t)gpio))
+    {
+        return !simGpio[gpio].masterLow && SIM_ONEWIRE_LINE((uint8_t)gpio, atNs);
+    }
+    if (sim_gpio_is_pio(gpio) && simGpio[gpio].pioOe)
+    {
+        return simGpio[gpio].pioValue;
+    }
+    if (simGpio[gpio].out)
+    {
+        return simGpio[gpio].value;
+    }
+    return simGpio[gpio].pullUp;
+}
+
+void gpio_init(uint gpio)
+{
+    simGpio[gpio].out = false;
+    simGpio[gpio].value = false;
+    simGpio[gpio].function = GPIO_FUNC_SIO;
+    sim_gpio_update(gpio, SIM_NOW_NS());
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn)
+{
+    simGpio[gpio].function = fn;
+    sim_gpio_update(gpio, SIM_NOW_NS());
+}
+
+void gpio_set_dir(uint gpio, bool out)
+{
+    simGpio[gpio].out = out;
+    sim_gpio_update(gpio, SIM_NOW_NS());
+}
+
+void gpio_put(uint gpio, bool value)
+{
+    simGpio[gpio].value = value;
+    sim_gpio_update(gpio, SIM_NOW_NS());
+}
+
+bool gpio_get(uint gpio)
+{
+    return SIM_GPIO_LEVEL(gpio, SIM_NOW_NS());
+}
+
+bool gpio_is_dir_out(uint gpio)
+{
+    return simGpio[gpio].out;
+}
+
+bool gpio_get_out_level(uint gpio)
+{
+    return simGpio[gpio].value;
+}
+
+void gpio_pull_up(uint gpio)
+{
+    simGpio[gpio].pullUp = true;
+    simGpio[gpio].pullDown = false;
+}
+
+void gpio_pull_down(uint gpio)
+{
+    simGpio[gpio].pullUp = false;
+    simGpio[gpio].pullDown = true;
+}
+
+void gpio_disable_pulls(uint gpio)
+{
+    simGpio[gpio].pullUp = false;
+    simGpio[gpio].pullDown = false;
+}
@@ -0,0 +1,77 @@
+/*!
+*****************************************************************
+* @file    sim_heap.c
+* @brief   Heap allocation counter of the host simulation: malloc
+*          and friends are interposed and forwarded to glibc, every
+*          call is booked on the core that made it
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_internal.h"
+
+/*=========================================================*/
+/*== GLIBC ALLOCATOR ======================================*/
+/*=========================================================*/
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+
+/*=========================================================*/
+/*== HEAP FUNCTIONS =======================================*/
+/*=========================================================*/
+
+/*!< Referenced from SIM_RESET so the interposing object is always linked */
+void sim_heap_reset(void)
+{
+}
+
+static void sim_heap_alloc(size_t size)
+{
+    SimStats *stats = SIM_STATS_MUT();
+    stats->heapAllocs++;
+    stats->heapBytes += size;
+}
+
+void *malloc(size_t size)
+{
+    sim_heap_alloc(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    sim_heap_alloc(count * size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    sim_heap_alloc(size);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    if (ptr != NULL)
+    {
+        SIM_STATS_MUT()->heapFrees++;
+    }
+    __libc_free(ptr);
+}
@@ -0,0 +1,450 @@
+/*!
+*****************************************************************
+* @file    sim_i2c.c
+* @brief   I2C controllers of the host simulation with bit-time
+*          accurate transfer accounting
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "hardware/i2c.h"
+#include "hardware/dma.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_internal.h"
+
+/*=========================================================*/
+/*== GLOBAL VARIABLES =====================================*/
+/*=========================================================*/
+
+#define SIM_I2C_MAX_DEVICES     4
+#define SIM_I2C_BITS_PER_BYTE   9u /*!< 8 data bits + ACK */
+#define SIM_I2C_FIFO_DEPTH      16
+#define SIM_I2C_SEGMENT_MAX     64 /*!< Write bytes collected until STOP/RESTART */
+
+/*!< Read-only hardware fields are written by the model only */
+#define SIM_I2C_HW_SET(field, value) (*(volatile uint32_t *)&(field) = (uint32_t)(value))
+
+/*!< Command engine behind data_cmd, fed by DMA (TX/RX DREQ) */
+typedef struct SimI2cCtrl
+{
+    uint16_t txFifo[SIM_I2C_FIFO_DEPTH];
+    uint8_t txHead;
+    uint8_t txCount;
+    uint8_t rxFifo[SIM_I2C_FIFO_DEPTH];
+    uint8_t rxHead;
+    uint8_t rxCount;
+
+    bool active;  /*!< START sent, segment open */
+    bool reading; /*!< Direction of the open segment */
+    SimI2cDevice *dev;
+    uint8_t wrBuf[SIM_I2C_SEGMENT_MAX];
+    uint8_t wrLen;
+    uint8_t rdBuf[SIM_I2C_SEGMENT_MAX]; /*!< A read segment is one device access (burst shadowing) */
+    uint8_t rdPos;
+    uint8_t rdLen;
+
+    uint16_t cmd;      /*!< Command on the bus */
+    uint64_t doneNs;   /*!< SIM_NEVER while the bus is idle */
+} SimI2cCtrl;
+
+struct i2c_inst
+{
+    uint8_t index;
+    uint32_t baudrate;
+    SimI2cDevice *devices[SIM_I2C_MAX_DEVICES];
+    uint8_t deviceCount;
+    i2c_hw_t hw;
+    SimI2cCtrl ctrl;
+};
+
+i2c_inst_t sim_i2c0_inst = {.index = 0};
+i2c_inst_t sim_i2c1_inst = {.index = 1};
+
+static uint64_t sim_i2c_next(void);
+static void sim_i2c_fire(uint64_t atNs);
+static uint32_t sim_i2c0_data_read(void);
+static void sim_i2c0_data_write(uint32_t value);
+static uint32_t sim_i2c1_data_read(void);
+static void sim_i2c1_data_write(uint32_t value);
+
+/*=========================================================*/
+/*== I2C FUNCTIONS ========================================*/
+/*=========================================================*/
+
+void sim_i2c_reset(void)
+{
+    i2c_inst_t *bus[] = {i2c0, i2c1};
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        bus[i]->baudrate = 100000;
+        bus[i]->deviceCount = 0;
+        memset(bus[i]->devices, 0, sizeof(bus[i]->devices));
+        memset(&bus[i]->hw, 0, sizeof(bus[i]->hw));
+        memset(&bus[i]->ctrl, 0, sizeof(bus[i]->ctrl));
+        bus[i]->ctrl.doneNs = SIM_NEVER;
+    }
+    SIM_EVENT_REGISTER(sim_i2c_next, sim_i2c_fire);
+    SIM_REG_MAP(&sim_i2c0_inst.hw.data_cmd, sim_i2c0_data_read, sim_i2c0_data_write);
+    SIM_REG_MAP(&sim_i2c1_inst.hw.data_cmd, sim_i2c1_data_read, sim_i2c1_data_write);
+}
+
+int8_t SIM_I2C_ATTACH(i2c_inst_t *i2c, SimI2cDevice *device)
+{
+    if (i2c->deviceCount >= SIM_I2C_MAX_DEVICES)
+    {
+        return -1;
+    }
+    i2c->devices[i2c->deviceCount++] = device;
+    return 0;
+}
+
+uint32_t SIM_I2C_BAUDRATE(i2c_inst_t *i2c)
+{
+    return i2c->baudrate;
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate)
+{
+    /*!< Like the SDK: controller enabled, DREQ signalling always on */
+    i2c->hw.enable = I2C_IC_ENABLE_ENABLE_BITS;
+    i2c->hw.dma_cr = I2C_IC_DMA_CR_TDMAE_BITS | I2C_IC_DMA_CR_RDMAE_BITS;
+    return i2c_set_baudrate(i2c, baudrate);
+}
+
+void i2c_deinit(i2c_inst_t *i2c)
+{
+    i2c->hw.enable = 0;
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate)
+{
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+uint i2c_hw_index(i2c_inst_t *i2c)
+{
+    return i2c->index;
+}
+
+static SimI2cDevice *sim_i2c_find(i2c_inst_t *i2c, uint8_t addr)
+{
+    for (uint8_t i = 0; i < i2c->deviceCount; i++)
+    {
+        if (i2c->devices[i]->addr == addr)
+        {
+            return i2c->devices[i];
+        }
+    }
+    return NULL;
+}
+
+/*!
+**************************************************************
+ * @brief Bus time of one transfer: START, address byte, payload
+ * and STOP (or the repeated START that replaces it)
+**************************************************************
+ */
+uint64_t sim_i2c_transfer_ns(i2c_inst_t *i2c, size_t len)
+{
+    uint64_t bits = 2u + SIM_I2C_BITS_PER_BYTE * (1u + len);
+    return bits * 1000000000ull / i2c->baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    SimI2cDevice *dev = sim_i2c_find(i2c, addr);
+    SimStats *stats = SIM_STATS_MUT();
+    (void)nostop;
+
+    i2c->hw.tar = addr;
+    stats->i2cTransactions++;
+    if (dev == NULL)
+    {
+        stats->i2cNaks++;
+        SIM_ADVANCE_NS(sim_i2c_transfer_ns(i2c, 0), SIM_TIME_I2C);
+        return PICO_ERROR_GENERIC;
+    }
+
+    int ret = dev->write(dev->ctx, src, len, SIM_NOW_NS());
+    stats->i2cTxBytes += (uint32_t)len;
+    SIM_ADVANCE_NS(sim_i2c_transfer_ns(i2c, len), SIM_TIME_I2C);
+    return ret;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop)
+{
+    SimI2cDevice *dev = sim_i2c_find(i2c, addr);
+    SimStats *stats = SIM_STATS_MUT();
+    (void)nostop;
+
+    i2c->hw.tar = addr;
+    stats->i2cTransactions++;
+    if (dev == NULL)
+    {
+        stats->i2cNaks++;
+        SIM_ADVANCE_NS(sim_i2c_transfer_ns(i2c, 0), SIM_TIME_I2C);
+        return PICO_ERROR_GENERIC;
+    }
+
+    int ret = dev->read(dev->ctx, dst, len, SIM_NOW_NS());
+    stats->i2cRxBytes += (uint32_t)len;
+    SIM_ADVANCE_NS(sim_i2c_transfer_ns(i2c, len), SIM_TIME_I2C);
+    return ret;
+}
+
+/*=========================================================*/
+/*== CONTROLLER MODEL =====================================*/
+/*=========================================================*/
+
+static void sim_i2c_levels(i2c_inst_t *i2c)
+{
+    SimI2cCtrl *c = &i2c->ctrl;
+    SIM_I2C_HW_SET(i2c->hw.txflr, c->txCount);
+    SIM_I2C_HW_SET(i2c->hw.rxflr, c->rxCount);
+    SIM_I2C_HW_SET(i2c->hw.status, (c->active || c->doneNs != SIM_NEVER) ? I2C_IC_STATUS_ACTIVITY_BITS : 0);
+}
+
+static void sim_i2c_data_write(i2c_inst_t *i2c, uint32_t value)
+{
+    SimI2cCtrl *c = &i2c->ctrl;
+    if (c->txCount == SIM_I2C_FIFO_DEPTH)
+    {
+        return; /*!< TX_OVER, the command is lost */
+    }
+    c->txFifo[(c->txHead + c->txCount) % SIM_I2C_FIFO_DEPTH] = (uint16_t)value;
+    c->txCount++;
+    sim_i2c_levels(i2c);
+}
+
+static uint32_t sim_i2c_data_read(i2c_inst_t *i2c)
+{
+    SimI2cCtrl *c = &i2c->ctrl;
+    uint8_t value = 0;
+    if (c->rxCount > 0)
+    {
+        value = c->rxFifo[c->rxHead];
+        c->rxHead = (c->rxHead + 1) % SIM_I2C_FIFO_DEPTH;
+        c->rxCount--;
+    }
+    sim_i2c_levels(i2c);
+    return value;
+}
+
+static uint32_t sim_i2c0_data_read(void)
+{
+    return sim_i2c_data_read(i2c0);
+}
+
+static void sim_i2c0_data_write(uint32_t value)
+{
+    sim_i2c_data_write(i2c0, value);
+}
+
+static uint32_t sim_i2c1_data_read(void)
+{
+    return sim_i2c_data_read(i2c1);
+}
+
+static void sim_i2c1_data_write(uint32_t value)
+{
+    sim_i2c_data_write(i2c1, value);
+}
+
+/*!< Close the open segment: collected write bytes reach the device */
+static void sim_i2c_segment_end(i2c_inst_t *i2c, uint64_t atNs)
+{
+    SimI2cCtrl *c = &i2c->ctrl;
+    if (c->active && !c->reading && c->dev != NULL && c->wrLen > 0)
+    {
+        c->dev->write(c->dev->ctx, c->wrBuf, c->wrLen, atNs);
+    }
+    c->active = false;
+    c->wrLen = 0;
+    c->rdPos = 0;
+    c->rdLen = 0;
+}
+
+/*!< Next TX command may start: bus idle, controller enabled, RX space for reads */
+static bool sim_i2c_can_start(i2c_inst_t *i2c)
+{
+    SimI2cCtrl *c = &i2c->ctrl;
+    if (c->doneNs != SIM_NEVER || c->txCount == 0 || !(i2c->hw.enable & I2C_IC_ENABLE_ENABLE_BITS))
+    {
+        return false;
+    }
+    uint16_t cmd = c->txFifo[c->txHead];
+    return !(cmd & I2C_IC_DATA_CMD_CMD_BITS) || c->rxCount < SIM_I2C_FIFO_DEPTH;
+}
+
+static bool sim_i2c_dreq_due(i2c_inst_t *i2c)
+{
+    SimI2cCtrl *c = &i2c->ctrl;
+    uint dma = i2c->hw.dma_cr;
+    return ((dma & I2C_IC_DMA_CR_TDMAE_BITS) && c->txCount < SIM_I2C_FIFO_DEPTH &&
+            SIM_DMA_DREQ_PENDING(i2c_get_dreq(i2c, true))) ||
+           ((dma & I2C_IC_DMA_CR_RDMAE_BITS) && c->rxCount > 0 && SIM_DMA_DREQ_PENDING(i2c_get_dreq(i2c, false)));
+}
+
+static void sim_i2c_start(i2c_inst_t *i2c, uint64_t atNs)
+{
+    SimI2cCtrl *c = &i2c->ctrl;
+    SimStats *stats = SIM_STATS_MUT();
+    uint16_t cmd = c->txFifo[c->txHead];
+    bool read = (cmd & I2C_IC_DATA_CMD_CMD_BITS) != 0;
+    uint32_t bits = SIM_I2C_BITS_PER_BYTE;
+
+    c->txHead = (c->txHead + 1) % SIM_I2C_FIFO_DEPTH;
+    c->txCount--;
+
+    if (!c->active || (cmd & I2C_IC_DATA_CMD_RESTART_BITS) || read != c->reading)
+    {
+        /*!< (Repeated) START and address byte */
+        sim_i2c_segment_end(i2c, atNs);
+        SIM_I2C_HW_SET(i2c->hw.raw_intr_stat, 0);
+        c->dev = sim_i2c_find(i2c, (uint8_t)(i2c->hw.tar & 0x7F));
+        stats->i2cTransactions++;
+        bits += 1 + SIM_I2C_BITS_PER_BYTE;
+        if (c->dev == NULL)
+        {
+            /*!< Address NAK: abort, flush TX */
+            stats->i2cNaks++;
+            c->txCount = 0;
+            SIM_I2C_HW_SET(i2c->hw.tx_abrt_source, I2C_IC_TX_ABRT_SOURCE_ABRT_7B_ADDR_NOACK_BITS);
+            SIM_I2C_HW_SET(i2c->hw.raw_intr_stat, I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS);
+            sim_i2c_levels(i2c);
+            return;
+        }
+        c->active = true;
+        c->reading = read;
+    }
+    if (cmd & I2C_IC_DATA_CMD_STOP_BITS)
+    {
+        bits += 1;
+    }
+
+    c->cmd = cmd;
+    c->doneNs = atNs + (uint64_t)bits * 1000000000ull / i2c->baudrate;
+    sim_i2c_levels(i2c);
+}
+
+static void sim_i2c_complete(i2c_inst_t *i2c, uint64_t atNs)
+{
+    SimI2cCtrl *c = &i2c->ctrl;
+    SimStats *stats = SIM_STATS_MUT();
+
+    if (c->reading)
+    {
+        if (c->rdPos == c->rdLen)
+        {
+            c->dev->read(c->dev->ctx, c->rdBuf, sizeof(c->rdBuf), atNs);
+            c->rdPos = 0;
+            c->rdLen = sizeof(c->rdBuf);
+        }
+        c->rxFifo[(c->rxHead + c->rxCount) % SIM_I2C_FIFO_DEPTH] = c->rdBuf[c->rdPos++];
+        c->rxCount++;
+        stats->i2cRxBytes++;
+    }
+    else
+    {
+        if (c->wrLen < SIM_I2C_SEGMENT_MAX)
+        {
+            c->wrBuf[c->wrLen++] = (uint8_t)(c->cmd & I2C_IC_DATA_CMD_DAT_BITS);
+        }
+        stats->i2cTxBytes++;
+    }
+
+    c->doneNs = SIM_NEVER;
+    if (c->cmd & I2C_IC_DATA_CMD_STOP_BITS)
+    {
+        sim_i2c_segment_end(i2c, atNs);
+        SIM_I2C_HW_SET(i2c->hw.raw_intr_stat, i2c->hw.raw_intr_stat | I2C_IC_RAW_INTR_STAT_STOP_DET_BITS);
+    }
+    sim_i2c_levels(i2c);
+}
+
+static uint64_t sim_i2c_next(void)
+{
+    i2c_inst_t *bus[] = {i2c0, i2c1};
+    uint64_t next = SIM_NEVER;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        SimI2cCtrl *c = &bus[i]->ctrl;
+        if (c->doneNs < next)
+        {
+            next = c->doneNs;
+        }
+        if (sim_i2c_can_start(bus[i]) || sim_i2c_dreq_due(bus[i]))
+        {
+            next = SIM_NOW_NS();
+        }
+    }
+    return next;
+}
+
+static void sim_i2c_fire(uint64_t atNs)
+{
+    i2c_inst_t *bus[] = {i2c0, i2c1};
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        i2c_inst_t *i2c = bus[i];
+        SimI2cCtrl *c = &i2c->ctrl;
+
+        if (c->doneNs <= atNs)
+        {
+            sim_i2c_complete(i2c, atNs);
+        }
+        /*!< DMA keeps the TX FIFO filled and the RX FIFO drained */
+        while ((i2c->hw.dma_cr & I2C_IC_DMA_CR_RDMAE_BITS) && c->rxCount > 0 &&
+               SIM_DMA_DREQ(i2c_get_dreq(i2c, false), atNs))
+        {
+        }
+        while ((i2c->hw.dma_cr & I2C_IC_DMA_CR_TDMAE_BITS) && c->txCount < SIM_I2C_FIFO_DEPTH &&
+               SIM_DMA_DREQ(i2c_get_dreq(i2c, true), atNs))
+        {
+        }
+        if (sim_i2c_can_start(i2c))
+        {
+            sim_i2c_start(i2c, atNs);
+        }
+    }
+}
+
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c)
+{
+    return &i2c->hw;
+}
+
+uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx)
+{
+    return DREQ_I2C0_TX + i2c->index * 2u + (is_tx ? 0u : 1u);
+}
+
+size_t i2c_get_write_available(i2c_inst_t *i2c)
+{
+    return SIM_I2C_FIFO_DEPTH - i2c->ctrl.txCount;
+}
+
+size_t i2c_get_read_available(i2c_inst_t *i2c)
+{
+    return i2c->ctrl.rxCount;
+}
@@ -0,0 +1,82 @@
+/*!
+**************************************************************
+* @file    sim_internal.h
+* @brief   Shared internals of the host simulation modules
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+**************************************************************
+*/
+
+#ifndef SIM_INTERNAL_H_
+#define SIM_INTERNAL_H_
+
+#include "sim_hal.h"
+#include "hardware/irq.h"
+
+/*=========================================================*/
+/*== SIMULATION MACROS ====================================*/
+/*=========================================================*/
+
+#define SIM_NEVER               UINT64_MAX
+#define SIM_MAX_EVENT_SOURCES   16
+#define SIM_MAX_REGS            64
+
+#define SIM_NS_PER_US           1000ull
+#define SIM_NS_PER_MS           1000000ull
+#define SIM_CLK_SYS_HZ          125000000u
+
+/*=========================================================*/
+/*== PROTOTYPE DECLARATION ================================*/
+/*=========================================================*/
+
+/*!< Event sources drive everything that happens "by itself" on core 0's timeline */
+void SIM_EVENT_REGISTER(uint64_t (*next)(void), void (*fire)(uint64_t atNs));
+void SIM_EVENT_REGISTER_ANY_CORE(uint64_t (*next)(void), void (*fire)(uint64_t atNs));
+bool SIM_WAIT_EVENT(SimTimeKind kind);
+SimStats *SIM_STATS_MUT(void);
+bool SIM_IN_IRQ(void);
+
+/*!< Interrupt controller */
+void SIM_IRQ_RAISE(uint num);
+void SIM_IRQ_DISPATCH(void);
+irq_handler_t SIM_IRQ_HANDLER(uint8_t core, uint num);
+bool SIM_IRQ_ENABLED(uint8_t core, uint num);
+
+/*!< Peripheral register map used by the DMA engine */
+void SIM_REG_MAP(const volatile void *addr, uint32_t (*read)(void), void (*write)(uint32_t value));
+bool SIM_REG_READ(const volatile void *addr, uint32_t *value);
+bool SIM_REG_WRITE(const volatile void *addr, uint32_t value);
+
+/*!< DMA pacing: a peripheral asserts its DREQ once per available/needed element */
+bool SIM_DMA_DREQ(uint dreq, uint64_t atNs);
+bool SIM_DMA_DREQ_PENDING(uint dreq);
+
+/*!< 1-Wire bus glue between the GPIO block and device models */
+void SIM_ONEWIRE_MASTER(uint8_t gpio, bool low, uint64_t nowNs);
+bool SIM_ONEWIRE_PRESENT(uint8_t gpio);
+bool SIM_ONEWIRE_LINE(uint8_t gpio, uint64_t nowNs);
+
+/*!< PIO pin outputs and inputs, resolved by the GPIO block */
+void SIM_GPIO_PIO_DRIVE(uint gpio, bool oe, bool value, uint64_t atNs);
+bool SIM_GPIO_LEVEL(uint gpio, uint64_t atNs);
+
+/*!< Core 1 coroutine */
+void SIM_CORE1_SYNC(void);
+void SIM_CORE1_WAIT(void);
+
+/*!< Module reset hooks called from SIM_RESET */
+void sim_heap_reset(void);
+void sim_irq_reset(void);
+void sim_gpio_reset(void);
+void sim_i2c_reset(void);
+void sim_bme280_reset(void);
+void sim_ds18b20_reset(void);
+void sim_pio_reset(void);
+void sim_adc_reset(void);
+void sim_dma_reset(void);
+void sim_uart_reset(void);
+void sim_multicore_reset(void);
+
+#endif
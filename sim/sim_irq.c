@@ -0,0 +1,171 @@
+/*!
+*****************************************************************
+* @file    sim_irq.c
+* @brief   Interrupt controller of the host simulation
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "hardware/irq.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_internal.h"
+
+void sim_irq_enter(bool enter);
+
+/*=========================================================*/
+/*== GLOBAL VARIABLES =====================================*/
+/*=========================================================*/
+
+#define SIM_MAX_SHARED_HANDLERS 4
+
+static irq_handler_t simHandlers[SIM_CORES][NUM_IRQS][SIM_MAX_SHARED_HANDLERS];
+static bool simEnabled[SIM_CORES][NUM_IRQS];
+static uint32_t simPending;
+
+/*=========================================================*/
+/*== IRQ FUNCTIONS ========================================*/
+/*=========================================================*/
+
+void sim_irq_reset(void)
+{
+    memset(simHandlers, 0, sizeof(simHandlers));
+    memset(simEnabled, 0, sizeof(simEnabled));
+    simPending = 0;
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler)
+{
+    uint8_t core = SIM_CORE_CURRENT();
+    memset(simHandlers[core][num], 0, sizeof(simHandlers[core][num]));
+    simHandlers[core][num][0] = handler;
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority)
+{
+    uint8_t core = SIM_CORE_CURRENT();
+    (void)order_priority;
+    for (uint8_t i = 0; i < SIM_MAX_SHARED_HANDLERS; i++)
+    {
+        if (simHandlers[core][num][i] == NULL)
+        {
+            simHandlers[core][num][i] = handler;
+            return;
+        }
+    }
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler)
+{
+    uint8_t core = SIM_CORE_CURRENT();
+    for (uint8_t i = 0; i < SIM_MAX_SHARED_HANDLERS; i++)
+    {
+        if (simHandlers[core][num][i] == handler)
+        {
+            simHandlers[core][num][i] = NULL;
+        }
+    }
+}
+
+void irq_set_enabled(uint num, bool enabled)
+{
+    simEnabled[SIM_CORE_CURRENT()][num] = enabled;
+    if (enabled)
+    {
+        SIM_IRQ_DISPATCH();
+    }
+}
+
+bool irq_is_enabled(uint num)
+{
+    return simEnabled[SIM_CORE_CURRENT()][num];
+}
+
+void irq_set_priority(uint num, uint8_t hardware_priority)
+{
+    (void)num;
+    (void)hardware_priority;
+}
+
+void irq_clear(uint num)
+{
+    simPending &= ~(1u << num);
+}
+
+void irq_set_pending(uint num)
+{
+    SIM_IRQ_RAISE(num);
+    SIM_IRQ_DISPATCH();
+}
+
+irq_handler_t SIM_IRQ_HANDLER(uint8_t core, uint num)
+{
+    return simHandlers[core][num][0];
+}
+
+bool SIM_IRQ_ENABLED(uint8_t core, uint num)
+{
+    return simEnabled[core][num] && simHandlers[core][num][0] != NULL;
+}
+
+void SIM_IRQ_RAISE(uint num)
+{
+    simPending |= 1u << num;
+}
+
+/*!
+**************************************************************
+ * @brief Run the core 0 handlers of all pending and enabled
+ * interrupts. Handlers do not nest, interrupts raised inside
+ * a handler are taken when it returns.
+**************************************************************
+ */
+void SIM_IRQ_DISPATCH(void)
+{
+    if (SIM_IN_IRQ() || SIM_CORE_CURRENT() != 0)
+    {
+        return;
+    }
+
+    bool taken = true;
+    while (taken)
+    {
+        taken = false;
+        for (uint num = 0; num < NUM_IRQS; num++)
+        {
+            if ((simPending & (1u << num)) && simEnabled[0][num])
+            {
+                simPending &= ~(1u << num);
+                SIM_STATS_MUT()->irqCount++;
+                sim_irq_enter(true);
+                for (uint8_t i = 0; i < SIM_MAX_SHARED_HANDLERS; i++)
+                {
+                    if (simHandlers[0][num][i] != NULL)
+                    {
+                        simHandlers[0][num][i]();
+                    }
+                }
+                sim_irq_enter(false);
+                taken = true;
+            }
+        }
+    }
+}
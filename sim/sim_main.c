@@ -0,0 +1,81 @@
+/*!
+*****************************************************************
+* @file    sim_main.c
+* @brief   Host runner: executes the firmware main() against the
+*          simulated HAL and reports the virtual latency of every
+*          main loop iteration
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_hal.h"
+
+/*!< waterpipe.c's main(), renamed by the host build */
+int waterpipe_main(void);
+
+/*=========================================================*/
+/*== RUNNER FUNCTIONS =====================================*/
+/*=========================================================*/
+
+static double ms(uint64_t ns)
+{
+    return ns / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = 5;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-v") == 0)
+        {
+            verbose = true;
+        }
+        else
+        {
+            iterations = (uint32_t)strtoul(argv[i], NULL, 0);
+        }
+    }
+
+    SIM_RESET();
+    SIM_SCENARIO_DEFAULT();
+    SIM_STDIO_QUIET(!verbose);
+
+    int done = SIM_RUN_FIRMWARE(waterpipe_main, iterations);
+    FILE *out = SIM_REPORT_STREAM();
+
+    fprintf(out, "iter  latency[ms]  sleep[ms]  i2c[ms]  uart[ms]  dma[ms]  fifo[ms]  irq[ms]  i2c tx/rx[B]  1w slots\n");
+    for (int i = 0; i < done; i++)
+    {
+        const SimIteration *it = SIM_ITERATION((uint32_t)i);
+        const SimStats *s = &it->stats;
+        fprintf(out, "%4d  %11.3f  %9.3f  %7.3f  %8.3f  %7.3f  %8.3f  %7.3f  %6u/%-6u  %8u\n", i,
+                ms(it->endNs - it->startNs), ms(s->timeNs[SIM_TIME_SLEEP]), ms(s->timeNs[SIM_TIME_I2C]),
+                ms(s->timeNs[SIM_TIME_UART]), ms(s->timeNs[SIM_TIME_DMA_WAIT]), ms(s->timeNs[SIM_TIME_FIFO_WAIT]),
+                ms(s->timeNs[SIM_TIME_IRQ]), s->i2cTxBytes, s->i2cRxBytes, s->oneWireSlots);
+    }
+    const SimStats *core1 = SIM_STATS(1);
+    fprintf(out, "core1: sleep %.3f ms, 1-Wire %u resets / %u slots\n", ms(core1->timeNs[SIM_TIME_SLEEP]),
+            core1->oneWireResets, core1->oneWireSlots);
+    fflush(out);
+
+    return done == (int)iterations ? EXIT_SUCCESS : EXIT_FAILURE;
+}
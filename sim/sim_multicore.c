@@ -0,0 +1,290 @@
+/*!
+*****************************************************************
+* @file    sim_multicore.c
+* @brief   Second core and inter-core FIFOs of the host simulation.
+*          Core 1 runs as a coroutine on its own virtual clock,
+*          FIFO words carry the time they were pushed.
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <ucontext.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "pico/multicore.h"
+#include "hardware/irq.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_internal.h"
+
+void sim_core_switch(uint8_t core);
+void sim_core_set_now(uint8_t core, uint64_t nowNs);
+
+/*=========================================================*/
+/*== MULTICORE MACROS =====================================*/
+/*=========================================================*/
+
+#define SIM_FIFO_DEPTH          8
+#define SIM_CORE1_STACK         (256 * 1024)
+
+/*=========================================================*/
+/*== GLOBAL VARIABLES =====================================*/
+/*=========================================================*/
+
+typedef struct SimFifo
+{
+    uint32_t data[SIM_FIFO_DEPTH];
+    uint64_t atNs[SIM_FIFO_DEPTH];
+    uint8_t head;
+    uint8_t level;
+} SimFifo;
+
+static SimFifo simFifo[SIM_CORES]; /*!< RX FIFO of each core */
+
+static ucontext_t simCore0Ctx;
+static ucontext_t simCore1Ctx;
+static uint8_t simCore1Stack[SIM_CORE1_STACK];
+static void (*simCore1Entry)(void);
+static bool simCore1Launched;
+static bool simCore1Parked; /*!< Waiting for an event in tight_loop/WFE */
+static bool simCore1Running;
+
+/*=========================================================*/
+/*== CORE 1 COROUTINE =====================================*/
+/*=========================================================*/
+
+void sim_multicore_reset(void)
+{
+    memset(simFifo, 0, sizeof(simFifo));
+    simCore1Entry = NULL;
+    simCore1Launched = false;
+    simCore1Parked = false;
+    simCore1Running = false;
+}
+
+static void sim_core1_trampoline(void)
+{
+    simCore1Entry();
+    /*!< Core 1 returned from its entry, it stays halted */
+    simCore1Launched = false;
+    simCore1Running = false;
+    sim_core_switch(0);
+    setcontext(&simCore0Ctx);
+}
+
+static void sim_core1_resume(void)
+{
+    simCore1Running = true;
+    sim_core_switch(1);
+    swapcontext(&simCore0Ctx, &simCore1Ctx);
+    sim_core_switch(0);
+}
+
+/*!
+**************************************************************
+ * @brief Let core 1 catch up with core 0's clock
+**************************************************************
+ */
+void SIM_CORE1_SYNC(void)
+{
+    if (!simCore1Launched || simCore1Parked || simCore1Running)
+    {
+        return;
+    }
+    if (SIM_CORE_NOW_NS(1) < SIM_CORE_NOW_NS(0))
+    {
+        sim_core1_resume();
+    }
+}
+
+/*!
+**************************************************************
+ * @brief Called on core 1 after it moved its clock, yields to
+ * core 0 once core 1 is ahead
+**************************************************************
+ */
+void SIM_CORE1_WAIT(void)
+{
+    if (!simCore1Running || SIM_IN_IRQ())
+    {
+        return;
+    }
+    if (SIM_CORE_NOW_NS(1) >= SIM_CORE_NOW_NS(0) || simCore1Parked)
+    {
+        simCore1Running = false;
+        swapcontext(&simCore1Ctx, &simCore0Ctx);
+    }
+}
+
+/*!< Core 1 idles until something for it happens */
+static void sim_core1_park(void)
+{
+    simCore1Parked = true;
+    if (SIM_CORE_NOW_NS(1) < SIM_CORE_NOW_NS(0))
+    {
+        sim_core_set_now(1, SIM_CORE_NOW_NS(0));
+    }
+    SIM_CORE1_WAIT();
+}
+
+/*!< Deliver SIO_IRQ_PROC1 on core 1 for a word pushed at atNs */
+static void sim_core1_fifo_irq(uint64_t atNs)
+{
+    simCore1Parked = false;
+    if (!SIM_IRQ_ENABLED(1, SIO_IRQ_PROC1))
+    {
+        return;
+    }
+
+    uint8_t previous = SIM_CORE_CURRENT();
+    if (SIM_CORE_NOW_NS(1) < atNs)
+    {
+        sim_core_set_now(1, atNs);
+    }
+    sim_core_switch(1);
+    bool wasRunning = simCore1Running;
+    simCore1Running = false; /*!< The handler runs to completion, no yielding */
+    SIM_IRQ_HANDLER(1, SIO_IRQ_PROC1)();
+    simCore1Running = wasRunning;
+    sim_core_switch(previous);
+}
+
+/*=========================================================*/
+/*== PICO MULTICORE API ===================================*/
+/*=========================================================*/
+
+void multicore_launch_core1(void (*entry)(void))
+{
+    simCore1Entry = entry;
+    simCore1Launched = true;
+    simCore1Parked = false;
+    sim_core_set_now(1, SIM_CORE_NOW_NS(0));
+
+    getcontext(&simCore1Ctx);
+    simCore1Ctx.uc_stack.ss_sp = simCore1Stack;
+    simCore1Ctx.uc_stack.ss_size = sizeof(simCore1Stack);
+    simCore1Ctx.uc_link = NULL;
+    makecontext(&simCore1Ctx, sim_core1_trampoline, 0);
+    sim_core1_resume();
+}
+
+uint get_core_num(void)
+{
+    return SIM_CORE_CURRENT();
+}
+
+void multicore_fifo_clear_irq(void)
+{
+}
+
+bool multicore_fifo_wready(void)
+{
+    return simFifo[SIM_CORE_CURRENT() ^ 1].level < SIM_FIFO_DEPTH;
+}
+
+bool multicore_fifo_rvalid(void)
+{
+    SimFifo *fifo = &simFifo[SIM_CORE_CURRENT()];
+    return fifo->level > 0 && fifo->atNs[fifo->head] <= SIM_NOW_NS();
+}
+
+void multicore_fifo_push_blocking(uint32_t data)
+{
+    uint8_t core = SIM_CORE_CURRENT();
+    SimFifo *fifo = &simFifo[core ^ 1];
+
+    while (fifo->level == SIM_FIFO_DEPTH)
+    {
+        if (core == 0 ? !SIM_WAIT_EVENT(SIM_TIME_FIFO_WAIT) : true)
+        {
+            return;
+        }
+    }
+    uint8_t slot = (uint8_t)((fifo->head + fifo->level) % SIM_FIFO_DEPTH);
+    fifo->data[slot] = data;
+    fifo->atNs[slot] = SIM_NOW_NS();
+    fifo->level++;
+    SIM_STATS_MUT()->fifoPushes++;
+
+    if (core == 0)
+    {
+        sim_core1_fifo_irq(SIM_NOW_NS());
+    }
+}
+
+uint32_t multicore_fifo_pop_blocking(void)
+{
+    uint8_t core = SIM_CORE_CURRENT();
+    SimFifo *fifo = &simFifo[core];
+
+    if (core == 1)
+    {
+        while (fifo->level == 0)
+        {
+            if (!simCore1Running)
+            {
+                return 0;
+            }
+            sim_core1_park();
+        }
+    }
+    else
+    {
+        while (fifo->level == 0)
+        {
+            if (simCore1Launched && !simCore1Parked)
+            {
+                SIM_ADVANCE_TO_NS(SIM_CORE_NOW_NS(1) + 1, SIM_TIME_FIFO_WAIT);
+            }
+            else if (!SIM_WAIT_EVENT(SIM_TIME_FIFO_WAIT))
+            {
+                fprintf(stderr, "sim: core 0 waits on an empty FIFO forever\n");
+                return 0;
+            }
+        }
+    }
+
+    if (fifo->atNs[fifo->head] > SIM_NOW_NS())
+    {
+        SIM_ADVANCE_TO_NS(fifo->atNs[fifo->head], SIM_TIME_FIFO_WAIT);
+    }
+    uint32_t data = fifo->data[fifo->head];
+    fifo->head = (uint8_t)((fifo->head + 1) % SIM_FIFO_DEPTH);
+    fifo->level--;
+    return data;
+}
+
+void multicore_fifo_drain(void)
+{
+    simFifo[SIM_CORE_CURRENT()].level = 0;
+}
+
+/*!< tight_loop_contents() on core 1 is treated as wait-for-event,
+ * on core 0 one pass of the polling loop costs a microsecond */
+void sim_tight_loop(void)
+{
+    if (SIM_CORE_CURRENT() == 1 && simCore1Running)
+    {
+        sim_core1_park();
+    }
+    else if (SIM_CORE_CURRENT() == 0)
+    {
+        SIM_ADVANCE_NS(SIM_NS_PER_US, SIM_TIME_POLL);
+    }
+}
@@ -0,0 +1,1145 @@
+/*!
+*****************************************************************
+* @file    sim_pio.c
+* @brief   RP2040 PIO model of the host simulation: instruction
+*          level state machines with side-set, delays, autopush/
+*          autopull, FIFOs with DREQ towards the DMA and pins
+*          resolved through the GPIO block
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_internal.h"
+
+/*=========================================================*/
+/*== PIO MACROS ===========================================*/
+/*=========================================================*/
+
+#define SIM_PIO_FIFO_DEPTH      4
+#define SIM_PIO_INSTR_JMP       0u
+#define SIM_PIO_INSTR_WAIT      1u
+#define SIM_PIO_INSTR_IN        2u
+#define SIM_PIO_INSTR_OUT       3u
+#define SIM_PIO_INSTR_PUSH_PULL 4u
+#define SIM_PIO_INSTR_MOV       5u
+#define SIM_PIO_INSTR_IRQ       6u
+#define SIM_PIO_INSTR_SET       7u
+
+/*=========================================================*/
+/*== GLOBAL VARIABLES =====================================*/
+/*=========================================================*/
+
+pio_hw_t sim_pio0_hw;
+pio_hw_t sim_pio1_hw;
+
+typedef struct SimPioSm
+{
+    bool claimed;
+    bool enabled;
+    pio_sm_config config;
+    uint64_t cycleNs;
+    uint8_t pc;
+    uint32_t x;
+    uint32_t y;
+    uint32_t isr;
+    uint8_t isrCount; /*!< Bits shifted in since the last push */
+    uint32_t osr;
+    uint8_t osrCount; /*!< Bits shifted out since the last pull, 32 = empty */
+    uint32_t txFifo[2 * SIM_PIO_FIFO_DEPTH];
+    uint8_t txHead;
+    uint8_t txLevel;
+    uint32_t rxFifo[2 * SIM_PIO_FIFO_DEPTH];
+    uint8_t rxHead;
+    uint8_t rxLevel;
+    bool execPending;
+    uint16_t execInstr;
+    uint64_t lastNs;  /*!< Start of the last executed instruction */
+    uint64_t nextNs;  /*!< Next instruction, SIM_NEVER while stalled on a FIFO */
+    bool irqWait;
+} SimPioSm;
+
+typedef struct SimPio
+{
+    pio_hw_t *hw;
+    uint16_t instr[PIO_INSTRUCTION_COUNT];
+    uint32_t usedMask;
+    uint8_t irqFlags;
+    uint32_t pinValues;
+    uint32_t pinDirs;
+    SimPioSm sm[NUM_PIO_STATE_MACHINES];
+} SimPio;
+
+static SimPio simPio[NUM_PIOS];
+
+static uint64_t simPioFireNs = SIM_NEVER; /*!< Time of the running event, DMA accesses happen at it */
+
+/*=========================================================*/
+/*== MODEL FUNCTIONS ======================================*/
+/*=========================================================*/
+
+static SimPio *sim_pio(PIO pio)
+{
+    return &simPio[pio == pio1 ? 1 : 0];
+}
+
+static uint64_t sim_pio_access_ns(void)
+{
+    return simPioFireNs != SIM_NEVER ? simPioFireNs : SIM_NOW_NS();
+}
+
+static uint8_t sim_pio_threshold(uint8_t threshold)
+{
+    return threshold == 0 ? 32 : threshold;
+}
+
+static uint8_t sim_pio_fifo_depth(const SimPioSm *sm, bool tx)
+{
+    enum pio_fifo_join own = tx ? PIO_FIFO_JOIN_TX : PIO_FIFO_JOIN_RX;
+    enum pio_fifo_join other = tx ? PIO_FIFO_JOIN_RX : PIO_FIFO_JOIN_TX;
+
+    if (sm->config.join == own)
+    {
+        return 2 * SIM_PIO_FIFO_DEPTH;
+    }
+    return sm->config.join == other ? 0 : SIM_PIO_FIFO_DEPTH;
+}
+
+/*!< A FIFO changed, a state machine stalled on it runs again */
+static void sim_pio_wake(SimPioSm *sm, uint64_t atNs)
+{
+    if (sm->enabled && sm->nextNs == SIM_NEVER)
+    {
+        uint64_t earliest = sm->lastNs + sm->cycleNs;
+        sm->nextNs = atNs > earliest ? atNs : earliest;
+    }
+}
+
+static bool sim_pio_tx_push(SimPioSm *sm, uint32_t value, uint64_t atNs)
+{
+    uint8_t depth = sim_pio_fifo_depth(sm, true);
+    if (sm->txLevel >= depth)
+    {
+        return false;
+    }
+    sm->txFifo[(sm->txHead + sm->txLevel) % depth] = value;
+    sm->txLevel++;
+    sim_pio_wake(sm, atNs);
+    return true;
+}
+
+static bool sim_pio_tx_pop(SimPioSm *sm, uint32_t *value)
+{
+    if (sm->txLevel == 0)
+    {
+        return false;
+    }
+    *value = sm->txFifo[sm->txHead];
+    sm->txHead = (uint8_t)((sm->txHead + 1) % sim_pio_fifo_depth(sm, true));
+    sm->txLevel--;
+    return true;
+}
+
+static bool sim_pio_rx_push(SimPioSm *sm, uint32_t value)
+{
+    uint8_t depth = sim_pio_fifo_depth(sm, false);
+    if (sm->rxLevel >= depth)
+    {
+        return false;
+    }
+    sm->rxFifo[(sm->rxHead + sm->rxLevel) % depth] = value;
+    sm->rxLevel++;
+    return true;
+}
+
+static uint32_t sim_pio_rx_pop(SimPioSm *sm, uint64_t atNs)
+{
+    if (sm->rxLevel == 0)
+    {
+        return 0;
+    }
+    uint32_t value = sm->rxFifo[sm->rxHead];
+    sm->rxHead = (uint8_t)((sm->rxHead + 1) % sim_pio_fifo_depth(sm, false));
+    sm->rxLevel--;
+    sim_pio_wake(sm, atNs);
+    return value;
+}
+
+/*!< Drive count pins from base (wrapping at 32) with the low bits of value */
+static void sim_pio_pins_write(SimPio *p, uint8_t base, uint8_t count, uint32_t value, bool dirs, uint64_t atNs)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint8_t pin = (uint8_t)((base + i) % 32);
+        uint32_t bit = 1u << pin;
+        if (dirs)
+        {
+            p->pinDirs = (value >> i) & 0x01 ? (p->pinDirs | bit) : (p->pinDirs & ~bit);
+        }
+        else
+        {
+            p->pinValues = (value >> i) & 0x01 ? (p->pinValues | bit) : (p->pinValues & ~bit);
+        }
+        if (pin < NUM_BANK0_GPIOS)
+        {
+            SIM_GPIO_PIO_DRIVE(pin, (p->pinDirs & bit) != 0, (p->pinValues & bit) != 0, atNs);
+        }
+    }
+}
+
+/*!< Input pins from base, rotated so base is bit 0 */
+static uint32_t sim_pio_pins_read(uint8_t base, uint8_t count, uint64_t atNs)
+{
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint8_t pin = (uint8_t)((base + i) % 32);
+        if (pin < NUM_BANK0_GPIOS && SIM_GPIO_LEVEL(pin, atNs))
+        {
+            value |= 1u << i;
+        }
+    }
+    return value;
+}
+
+static uint8_t sim_pio_irq_index(uint8_t smIndex, uint8_t field)
+{
+    uint8_t irq = field & 0x07;
+    if (field & 0x10)
+    {
+        irq = (uint8_t)((irq & 0x04) | ((irq + smIndex) & 0x03));
+    }
+    return irq;
+}
+
+static uint32_t sim_pio_bit_reverse(uint32_t value)
+{
+    uint32_t reversed = 0;
+    for (uint8_t i = 0; i < 32; i++)
+    {
+        reversed = (reversed << 1) | ((value >> i) & 0x01);
+    }
+    return reversed;
+}
+
+static void sim_pio_side_set(SimPio *p, const SimPioSm *sm, uint16_t instr, uint64_t atNs)
+{
+    const pio_sm_config *c = &sm->config;
+    uint8_t count = c->sidesetCount;
+    if (count == 0)
+    {
+        return;
+    }
+
+    uint8_t field = (uint8_t)((instr >> 8) & 0x1f);
+    uint8_t valueBits = c->sidesetOpt ? (uint8_t)(count - 1) : count;
+    if (c->sidesetOpt && !(field & 0x10))
+    {
+        return;
+    }
+    uint32_t value = (field >> (5 - count)) & ((1u << valueBits) - 1);
+    sim_pio_pins_write(p, c->sidesetBase, valueBits, value, c->sidesetPindirs, atNs);
+}
+
+static uint8_t sim_pio_delay(const SimPioSm *sm, uint16_t instr)
+{
+    uint8_t delayBits = (uint8_t)(5 - sm->config.sidesetCount);
+    return (uint8_t)((instr >> 8) & ((1u << delayBits) - 1));
+}
+
+static uint32_t sim_pio_status(const SimPioSm *sm)
+{
+    uint8_t level = sm->config.statusSel == STATUS_TX_LESSTHAN ? sm->txLevel : sm->rxLevel;
+    return level < sm->config.statusN ? 0xFFFFFFFFu : 0;
+}
+
+static uint32_t sim_pio_mov_source(const SimPioSm *sm, uint8_t src, uint64_t atNs)
+{
+    switch (src)
+    {
+    case 0:
+        return sim_pio_pins_read(sm->config.inBase, 32, atNs);
+    case 1:
+        return sm->x;
+    case 2:
+        return sm->y;
+    case 5:
+        return sim_pio_status(sm);
+    case 6:
+        return sm->isr;
+    case 7:
+        return sm->osr;
+    default:
+        return 0;
+    }
+}
+
+/*!
+**************************************************************
+ * @brief Execute one instruction of a state machine at atNs
+ *
+ * Side-set is asserted even if the instruction stalls. A stall
+ * on a FIFO parks the machine until the FIFO changes, a stall
+ * on WAIT/IRQ retries every cycle. Delay cycles follow a
+ * completed instruction.
+**************************************************************
+ */
+static void sim_pio_step(SimPio *p, uint8_t smIndex, uint64_t atNs)
+{
+    SimPioSm *sm = &p->sm[smIndex];
+    const pio_sm_config *c = &sm->config;
+    bool exec = sm->execPending;
+    uint16_t instr = exec ? sm->execInstr : p->instr[sm->pc];
+    uint8_t arg = (uint8_t)((instr >> 5) & 0x07);
+    uint8_t low = (uint8_t)(instr & 0x1f);
+    uint8_t count = low == 0 ? 32 : low;
+    bool fifoStall = false;
+    bool retry = false;
+    bool jumped = false;
+
+    sm->execPending = false;
+    sm->lastNs = atNs;
+    sim_pio_side_set(p, sm, instr, atNs);
+
+    switch (instr >> 13)
+    {
+    case SIM_PIO_INSTR_JMP:
+    {
+        bool take = false;
+        switch (arg)
+        {
+        case 0:
+            take = true;
+            break;
+        case 1:
+            take = sm->x == 0;
+            break;
+        case 2:
+            take = sm->x != 0;
+            sm->x--;
+            break;
+        case 3:
+            take = sm->y == 0;
+            break;
+        case 4:
+            take = sm->y != 0;
+            sm->y--;
+            break;
+        case 5:
+            take = sm->x != sm->y;
+            break;
+        case 6:
+            take = SIM_GPIO_LEVEL(c->jmpPin, atNs);
+            break;
+        default:
+            take = sm->osrCount < sim_pio_threshold(c->pullThreshold);
+            break;
+        }
+        if (take)
+        {
+            sm->pc = low;
+            jumped = true;
+        }
+        break;
+    }
+    case SIM_PIO_INSTR_WAIT:
+    {
+        bool polarity = (arg & 0x04) != 0;
+        uint8_t source = arg & 0x03;
+        bool level;
+        if (source == 0)
+        {
+            level = SIM_GPIO_LEVEL(low, atNs);
+        }
+        else if (source == 1)
+        {
+            level = SIM_GPIO_LEVEL((uint8_t)((c->inBase + low) % 32), atNs);
+        }
+        else
+        {
+            uint8_t irq = sim_pio_irq_index(smIndex, low);
+            level = (p->irqFlags >> irq) & 0x01;
+            if (level && polarity)
+            {
+                p->irqFlags &= (uint8_t)~(1u << irq);
+            }
+        }
+        retry = level != polarity;
+        break;
+    }
+    case SIM_PIO_INSTR_IN:
+    {
+        uint8_t threshold = sim_pio_threshold(c->pushThreshold);
+        if (c->autopush && sm->isrCount + count >= threshold && sm->rxLevel >= sim_pio_fifo_depth(sm, false))
+        {
+            fifoStall = true;
+            break;
+        }
+        uint32_t data;
+        switch (arg)
+        {
+        case 0:
+            data = sim_pio_pins_read(c->inBase, count, atNs);
+            break;
+        case 1:
+            data = sm->x;
+            break;
+        case 2:
+            data = sm->y;
+            break;
+        case 6:
+            data = sm->isr;
+            break;
+        case 7:
+            data = sm->osr;
+            break;
+        default:
+            data = 0;
+            break;
+        }
+        if (count < 32)
+        {
+            data &= (1u << count) - 1;
+            sm->isr = c->inShiftRight ? (sm->isr >> count) | (data << (32 - count)) : (sm->isr << count) | data;
+        }
+        else
+        {
+            sm->isr = data;
+        }
+        sm->isrCount = (uint8_t)(sm->isrCount + count > 32 ? 32 : sm->isrCount + count);
+        if (c->autopush && sm->isrCount >= threshold)
+        {
+            sim_pio_rx_push(sm, sm->isr);
+            sm->isr = 0;
+            sm->isrCount = 0;
+        }
+        break;
+    }
+    case SIM_PIO_INSTR_OUT:
+    {
+        if (c->autopull && sm->osrCount >= sim_pio_threshold(c->pullThreshold))
+        {
+            if (!sim_pio_tx_pop(sm, &sm->osr))
+            {
+                fifoStall = true;
+                break;
+            }
+            sm->osrCount = 0;
+        }
+        uint32_t data;
+        if (count < 32)
+        {
+            data = c->outShiftRight ? sm->osr & ((1u << count) - 1) : sm->osr >> (32 - count);
+            sm->osr = c->outShiftRight ? sm->osr >> count : sm->osr << count;
+        }
+        else
+        {
+            data = sm->osr;
+            sm->osr = 0;
+        }
+        sm->osrCount = (uint8_t)(sm->osrCount + count > 32 ? 32 : sm->osrCount + count);
+        switch (arg)
+        {
+        case 0:
+            sim_pio_pins_write(p, c->outBase, c->outCount < count ? c->outCount : count, data, false, atNs);
+            break;
+        case 1:
+            sm->x = data;
+            break;
+        case 2:
+            sm->y = data;
+            break;
+        case 4:
+            sim_pio_pins_write(p, c->outBase, c->outCount < count ? c->outCount : count, data, true, atNs);
+            break;
+        case 5:
+            sm->pc = (uint8_t)(data & 0x1f);
+            jumped = true;
+            break;
+        case 6:
+            sm->isr = data;
+            sm->isrCount = count;
+            break;
+        case 7:
+            sm->execInstr = (uint16_t)data;
+            sm->execPending = true;
+            break;
+        default:
+            break;
+        }
+        break;
+    }
+    case SIM_PIO_INSTR_PUSH_PULL:
+    {
+        bool conditional = (arg & 0x02) != 0;
+        bool block = (arg & 0x01) != 0;
+        if (!(arg & 0x04))
+        {
+            if (conditional && sm->isrCount < sim_pio_threshold(c->pushThreshold))
+            {
+                break;
+            }
+            if (!sim_pio_rx_push(sm, sm->isr) && block)
+            {
+                fifoStall = true;
+                break;
+            }
+            sm->isr = 0;
+            sm->isrCount = 0;
+        }
+        else
+        {
+            if (conditional && sm->osrCount < sim_pio_threshold(c->pullThreshold))
+            {
+                break;
+            }
+            if (!sim_pio_tx_pop(sm, &sm->osr))
+            {
+                if (block)
+                {
+                    fifoStall = true;
+                    break;
+                }
+                sm->osr = sm->x;
+            }
+            sm->osrCount = 0;
+        }
+        break;
+    }
+    case SIM_PIO_INSTR_MOV:
+    {
+        uint8_t op = (uint8_t)((instr >> 3) & 0x03);
+        uint32_t data = sim_pio_mov_source(sm, (uint8_t)(instr & 0x07), atNs);
+        data = op == 1 ? ~data : (op == 2 ? sim_pio_bit_reverse(data) : data);
+        switch (arg)
+        {
+        case 0:
+            sim_pio_pins_write(p, c->outBase, c->outCount, data, false, atNs);
+            break;
+        case 1:
+            sm->x = data;
+            break;
+        case 2:
+            sm->y = data;
+            break;
+        case 4:
+            sm->execInstr = (uint16_t)data;
+            sm->execPending = true;
+            break;
+        case 5:
+            sm->pc = (uint8_t)(data & 0x1f);
+            jumped = true;
+            break;
+        case 6:
+            sm->isr = data;
+            sm->isrCount = 0;
+            break;
+        case 7:
+            sm->osr = data;
+            sm->osrCount = 0;
+            break;
+        default:
+            break;
+        }
+        break;
+    }
+    case SIM_PIO_INSTR_IRQ:
+    {
+        uint8_t irq = sim_pio_irq_index(smIndex, low);
+        if (arg & 0x02)
+        {
+            p->irqFlags &= (uint8_t)~(1u << irq);
+            break;
+        }
+        if (!sm->irqWait)
+        {
+            p->irqFlags |= (uint8_t)(1u << irq);
+        }
+        /*!< IRQ WAIT raises the flag once and stalls until it is cleared */
+        sm->irqWait = (arg & 0x01) && (p->irqFlags & (1u << irq));
+        retry = sm->irqWait;
+        break;
+    }
+    default:
+    {
+        switch (arg)
+        {
+        case 0:
+            sim_pio_pins_write(p, c->setBase, c->setCount, low, false, atNs);
+            break;
+        case 1:
+            sm->x = low;
+            break;
+        case 2:
+            sm->y = low;
+            break;
+        case 4:
+            sim_pio_pins_write(p, c->setBase, c->setCount, low, true, atNs);
+            break;
+        default:
+            break;
+        }
+        break;
+    }
+    }
+
+    if (fifoStall || retry)
+    {
+        if (exec)
+        {
+            sm->execInstr = instr;
+            sm->execPending = true;
+        }
+        sm->nextNs = fifoStall ? SIM_NEVER : atNs + sm->cycleNs;
+        return;
+    }
+    if (!jumped && !exec)
+    {
+        sm->pc = (sm->pc == c->wrap) ? c->wrapTarget : (uint8_t)((sm->pc + 1) % PIO_INSTRUCTION_COUNT);
+    }
+    sm->nextNs = atNs + (1u + sim_pio_delay(sm, instr)) * sm->cycleNs;
+}
+
+/*!< DMA keeps TX FIFOs filled and RX FIFOs drained */
+static void sim_pio_service(uint8_t pioIndex, uint8_t smIndex, uint64_t atNs)
+{
+    SimPioSm *sm = &simPio[pioIndex].sm[smIndex];
+    PIO pio = simPio[pioIndex].hw;
+
+    while (sm->rxLevel > 0 && SIM_DMA_DREQ(pio_get_dreq(pio, smIndex, false), atNs))
+    {
+    }
+    while (sm->txLevel < sim_pio_fifo_depth(sm, true) && SIM_DMA_DREQ(pio_get_dreq(pio, smIndex, true), atNs))
+    {
+    }
+}
+
+static bool sim_pio_dreq_due(uint8_t pioIndex, uint8_t smIndex)
+{
+    SimPioSm *sm = &simPio[pioIndex].sm[smIndex];
+    PIO pio = simPio[pioIndex].hw;
+
+    return (sm->rxLevel > 0 && SIM_DMA_DREQ_PENDING(pio_get_dreq(pio, smIndex, false))) ||
+           (sm->txLevel < sim_pio_fifo_depth(sm, true) && SIM_DMA_DREQ_PENDING(pio_get_dreq(pio, smIndex, true)));
+}
+
+static uint64_t sim_pio_next(void)
+{
+    uint64_t next = SIM_NEVER;
+    for (uint8_t i = 0; i < NUM_PIOS; i++)
+    {
+        for (uint8_t s = 0; s < NUM_PIO_STATE_MACHINES; s++)
+        {
+            const SimPioSm *sm = &simPio[i].sm[s];
+            if (!sm->claimed)
+            {
+                continue;
+            }
+            if (sim_pio_dreq_due(i, s))
+            {
+                return SIM_NOW_NS();
+            }
+            if (sm->enabled && sm->nextNs < next)
+            {
+                next = sm->nextNs;
+            }
+        }
+    }
+    return next;
+}
+
+static void sim_pio_fire(uint64_t atNs)
+{
+    simPioFireNs = atNs;
+    for (uint8_t i = 0; i < NUM_PIOS; i++)
+    {
+        for (uint8_t s = 0; s < NUM_PIO_STATE_MACHINES; s++)
+        {
+            SimPioSm *sm = &simPio[i].sm[s];
+            if (!sm->claimed)
+            {
+                continue;
+            }
+            sim_pio_service(i, s, atNs);
+            if (sm->enabled && sm->nextNs <= atNs)
+            {
+                sim_pio_step(&simPio[i], s, atNs);
+                sim_pio_service(i, s, atNs);
+            }
+        }
+    }
+    simPioFireNs = SIM_NEVER;
+}
+
+/*!< FIFO ports as seen by the DMA, RX byte lane 3 holds right-shifted bytes */
+#define SIM_PIO_FIFO_PORTS(p, s)                                                                                   \
+    static void sim_pio##p##_txf##s##_write(uint32_t value)                                                        \
+    {                                                                                                              \
+        sim_pio_tx_push(&simPio[p].sm[s], value, sim_pio_access_ns());                                             \
+    }                                                                                                              \
+    static uint32_t sim_pio##p##_rxf##s##_read(void)                                                               \
+    {                                                                                                              \
+        return sim_pio_rx_pop(&simPio[p].sm[s], sim_pio_access_ns());                                              \
+    }                                                                                                              \
+    static uint32_t sim_pio##p##_rxb##s##_read(void)                                                               \
+    {                                                                                                              \
+        return sim_pio_rx_pop(&simPio[p].sm[s], sim_pio_access_ns()) >> 24;                                        \
+    }
+
+SIM_PIO_FIFO_PORTS(0, 0)
+SIM_PIO_FIFO_PORTS(0, 1)
+SIM_PIO_FIFO_PORTS(0, 2)
+SIM_PIO_FIFO_PORTS(0, 3)
+SIM_PIO_FIFO_PORTS(1, 0)
+SIM_PIO_FIFO_PORTS(1, 1)
+SIM_PIO_FIFO_PORTS(1, 2)
+SIM_PIO_FIFO_PORTS(1, 3)
+
+#define SIM_PIO_MAP_PORTS(p, s)                                                                                    \
+    SIM_REG_MAP(&simPio[p].hw->txf[s], NULL, sim_pio##p##_txf##s##_write);                                         \
+    SIM_REG_MAP(&simPio[p].hw->rxf[s], sim_pio##p##_rxf##s##_read, NULL);                                          \
+    SIM_REG_MAP((const volatile uint8_t *)&simPio[p].hw->rxf[s] + 3, sim_pio##p##_rxb##s##_read, NULL)
+
+void sim_pio_reset(void)
+{
+    memset(simPio, 0, sizeof(simPio));
+    memset(&sim_pio0_hw, 0, sizeof(sim_pio0_hw));
+    memset(&sim_pio1_hw, 0, sizeof(sim_pio1_hw));
+    simPio[0].hw = pio0;
+    simPio[1].hw = pio1;
+    simPioFireNs = SIM_NEVER;
+
+    SIM_EVENT_REGISTER_ANY_CORE(sim_pio_next, sim_pio_fire);
+    SIM_PIO_MAP_PORTS(0, 0);
+    SIM_PIO_MAP_PORTS(0, 1);
+    SIM_PIO_MAP_PORTS(0, 2);
+    SIM_PIO_MAP_PORTS(0, 3);
+    SIM_PIO_MAP_PORTS(1, 0);
+    SIM_PIO_MAP_PORTS(1, 1);
+    SIM_PIO_MAP_PORTS(1, 2);
+    SIM_PIO_MAP_PORTS(1, 3);
+}
+
+/*=========================================================*/
+/*== PICO PIO API =========================================*/
+/*=========================================================*/
+
+static int sim_pio_find_offset(const SimPio *p, const pio_program_t *program)
+{
+    uint32_t mask = (1u << program->length) - 1;
+    if (program->length >= 32)
+    {
+        mask = 0xFFFFFFFFu;
+    }
+    if (program->origin >= 0)
+    {
+        return (p->usedMask & (mask << program->origin)) ? -1 : program->origin;
+    }
+    for (int offset = PIO_INSTRUCTION_COUNT - program->length; offset >= 0; offset--)
+    {
+        if (!(p->usedMask & (mask << offset)))
+        {
+            return offset;
+        }
+    }
+    return -1;
+}
+
+bool pio_can_add_program(PIO pio, const pio_program_t *program)
+{
+    return sim_pio_find_offset(sim_pio(pio), program) >= 0;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t *program)
+{
+    SimPio *p = sim_pio(pio);
+    int offset = sim_pio_find_offset(p, program);
+    if (offset < 0)
+    {
+        fprintf(stderr, "sim: no PIO program space available\n");
+        return 0;
+    }
+    for (uint8_t i = 0; i < program->length; i++)
+    {
+        uint16_t instr = program->instructions[i];
+        /*!< JMP targets are relative to the program like pioasm emits them */
+        p->instr[offset + i] = _pio_major_instr_bits(instr) == pio_instr_bits_jmp ? (uint16_t)(instr + offset) : instr;
+        p->usedMask |= 1u << (offset + i);
+    }
+    return (uint)offset;
+}
+
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset)
+{
+    SimPio *p = sim_pio(pio);
+    for (uint8_t i = 0; i < program->length; i++)
+    {
+        p->usedMask &= ~(1u << (loaded_offset + i));
+    }
+}
+
+void pio_clear_instruction_memory(PIO pio)
+{
+    sim_pio(pio)->usedMask = 0;
+}
+
+pio_sm_config pio_get_default_sm_config(void)
+{
+    pio_sm_config c;
+    memset(&c, 0, sizeof(c));
+    c.clkdivInt = 1;
+    c.wrapTarget = 0;
+    c.wrap = PIO_INSTRUCTION_COUNT - 1;
+    c.inShiftRight = true;
+    c.outShiftRight = true;
+    c.outCount = 32;
+    return c;
+}
+
+void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count)
+{
+    c->outBase = (uint8_t)out_base;
+    c->outCount = (uint8_t)out_count;
+}
+
+void sm_config_set_set_pins(pio_sm_config *c, uint set_base, uint set_count)
+{
+    c->setBase = (uint8_t)set_base;
+    c->setCount = (uint8_t)set_count;
+}
+
+void sm_config_set_in_pins(pio_sm_config *c, uint in_base)
+{
+    c->inBase = (uint8_t)in_base;
+}
+
+void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base)
+{
+    c->sidesetBase = (uint8_t)sideset_base;
+}
+
+void sm_config_set_sideset(pio_sm_config *c, uint bit_count, bool optional, bool pindirs)
+{
+    c->sidesetCount = (uint8_t)bit_count;
+    c->sidesetOpt = optional;
+    c->sidesetPindirs = pindirs;
+}
+
+void sm_config_set_clkdiv_int_frac(pio_sm_config *c, uint16_t div_int, uint8_t div_frac)
+{
+    c->clkdivInt = div_int == 0 ? 65536u : div_int;
+    c->clkdivFrac = div_frac;
+}
+
+void sm_config_set_clkdiv(pio_sm_config *c, float div)
+{
+    uint16_t divInt = (uint16_t)div;
+    sm_config_set_clkdiv_int_frac(c, divInt, (uint8_t)((div - (float)divInt) * 256.0f));
+}
+
+void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap)
+{
+    c->wrapTarget = (uint8_t)wrap_target;
+    c->wrap = (uint8_t)wrap;
+}
+
+void sm_config_set_jmp_pin(pio_sm_config *c, uint pin)
+{
+    c->jmpPin = (uint8_t)pin;
+}
+
+void sm_config_set_in_shift(pio_sm_config *c, bool shift_right, bool autopush, uint push_threshold)
+{
+    c->inShiftRight = shift_right;
+    c->autopush = autopush;
+    c->pushThreshold = (uint8_t)(push_threshold & 0x1f);
+}
+
+void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold)
+{
+    c->outShiftRight = shift_right;
+    c->autopull = autopull;
+    c->pullThreshold = (uint8_t)(pull_threshold & 0x1f);
+}
+
+void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join)
+{
+    c->join = join;
+}
+
+void sm_config_set_out_special(pio_sm_config *c, bool sticky, bool has_enable_pin, uint enable_pin_index)
+{
+    (void)has_enable_pin;
+    (void)enable_pin_index;
+    c->outSticky = sticky;
+}
+
+void sm_config_set_mov_status(pio_sm_config *c, enum pio_mov_status_type status_sel, uint status_n)
+{
+    c->statusSel = status_sel;
+    c->statusN = (uint8_t)status_n;
+}
+
+void pio_sm_claim(PIO pio, uint sm)
+{
+    sim_pio(pio)->sm[sm].claimed = true;
+}
+
+int pio_claim_unused_sm(PIO pio, bool required)
+{
+    SimPio *p = sim_pio(pio);
+    for (uint8_t s = 0; s < NUM_PIO_STATE_MACHINES; s++)
+    {
+        if (!p->sm[s].claimed)
+        {
+            p->sm[s].claimed = true;
+            return s;
+        }
+    }
+    if (required)
+    {
+        fprintf(stderr, "sim: no PIO state machines available\n");
+    }
+    return -1;
+}
+
+void pio_sm_unclaim(PIO pio, uint sm)
+{
+    sim_pio(pio)->sm[sm].claimed = false;
+}
+
+bool pio_sm_is_claimed(PIO pio, uint sm)
+{
+    return sim_pio(pio)->sm[sm].claimed;
+}
+
+/*!< Applies to a running machine like the register writes of the SDK */
+void pio_sm_set_config(PIO pio, uint sm, const pio_sm_config *config)
+{
+    SimPioSm *s = &sim_pio(pio)->sm[sm];
+    s->config = *config;
+    s->cycleNs = ((uint64_t)s->config.clkdivInt * 256u + s->config.clkdivFrac) * 1000000000ull /
+                 ((uint64_t)SIM_CLK_SYS_HZ * 256u);
+    if (s->cycleNs == 0)
+    {
+        s->cycleNs = 1;
+    }
+}
+
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config)
+{
+    pio_sm_set_enabled(pio, sm, false);
+    pio_sm_set_config(pio, sm, config);
+    pio_sm_clear_fifos(pio, sm);
+    pio_sm_restart(pio, sm);
+    sim_pio(pio)->sm[sm].pc = (uint8_t)initial_pc;
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled)
+{
+    SimPioSm *s = &sim_pio(pio)->sm[sm];
+    if (enabled && !s->enabled)
+    {
+        s->nextNs = SIM_NOW_NS();
+    }
+    s->enabled = enabled;
+}
+
+void pio_sm_restart(PIO pio, uint sm)
+{
+    SimPioSm *s = &sim_pio(pio)->sm[sm];
+    s->isr = 0;
+    s->isrCount = 0;
+    s->osr = 0;
+    s->osrCount = 32;
+    s->execPending = false;
+    s->irqWait = false;
+    sim_pio_wake(s, SIM_NOW_NS()); /*!< A stalled instruction is retried */
+}
+
+void pio_sm_clkdiv_restart(PIO pio, uint sm)
+{
+    (void)pio;
+    (void)sm;
+}
+
+/*!< The instruction runs on the next cycle and replaces a stalled one */
+void pio_sm_exec(PIO pio, uint sm, uint instr)
+{
+    SimPioSm *s = &sim_pio(pio)->sm[sm];
+    uint64_t nowNs = SIM_NOW_NS();
+
+    s->execInstr = (uint16_t)instr;
+    s->execPending = true;
+    if (!s->enabled)
+    {
+        sim_pio_step(sim_pio(pio), (uint8_t)sm, nowNs);
+        return;
+    }
+    if (s->nextNs == SIM_NEVER || s->nextNs < nowNs)
+    {
+        uint64_t earliest = s->lastNs + s->cycleNs;
+        s->nextNs = nowNs > earliest ? nowNs : earliest;
+    }
+}
+
+uint8_t pio_sm_get_pc(PIO pio, uint sm)
+{
+    return sim_pio(pio)->sm[sm].pc;
+}
+
+void pio_gpio_init(PIO pio, uint pin)
+{
+    gpio_set_function(pin, pio == pio1 ? GPIO_FUNC_PIO1 : GPIO_FUNC_PIO0);
+}
+
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask)
+{
+    SimPio *p = sim_pio(pio);
+    (void)sm;
+    for (uint8_t pin = 0; pin < 32; pin++)
+    {
+        if (pin_mask & (1u << pin))
+        {
+            sim_pio_pins_write(p, pin, 1, pin_values >> pin, false, SIM_NOW_NS());
+        }
+    }
+}
+
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask)
+{
+    SimPio *p = sim_pio(pio);
+    (void)sm;
+    for (uint8_t pin = 0; pin < 32; pin++)
+    {
+        if (pin_mask & (1u << pin))
+        {
+            sim_pio_pins_write(p, pin, 1, pin_dirs >> pin, true, SIM_NOW_NS());
+        }
+    }
+}
+
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out)
+{
+    uint32_t mask = 0;
+    for (uint i = 0; i < pin_count; i++)
+    {
+        mask |= 1u << ((pin_base + i) % 32);
+    }
+    pio_sm_set_pindirs_with_mask(pio, sm, is_out ? mask : 0, mask);
+}
+
+uint pio_get_index(PIO pio)
+{
+    return pio == pio1 ? 1u : 0u;
+}
+
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx)
+{
+    return (pio == pio1 ? DREQ_PIO1_TX0 : DREQ_PIO0_TX0) + sm + (is_tx ? 0u : NUM_PIO_STATE_MACHINES);
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm)
+{
+    return sim_pio(pio)->sm[sm].rxLevel == 0;
+}
+
+bool pio_sm_is_rx_fifo_full(PIO pio, uint sm)
+{
+    const SimPioSm *s = &sim_pio(pio)->sm[sm];
+    return s->rxLevel >= sim_pio_fifo_depth(s, false);
+}
+
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm)
+{
+    return sim_pio(pio)->sm[sm].rxLevel;
+}
+
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm)
+{
+    return sim_pio(pio)->sm[sm].txLevel == 0;
+}
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm)
+{
+    const SimPioSm *s = &sim_pio(pio)->sm[sm];
+    return s->txLevel >= sim_pio_fifo_depth(s, true);
+}
+
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm)
+{
+    return sim_pio(pio)->sm[sm].txLevel;
+}
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data)
+{
+    sim_pio_tx_push(&sim_pio(pio)->sm[sm], data, SIM_NOW_NS());
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data)
+{
+    while (pio_sm_is_tx_fifo_full(pio, sm))
+    {
+        if (!SIM_WAIT_EVENT(SIM_TIME_DMA_WAIT))
+        {
+            fprintf(stderr, "sim: PIO%u SM%u TX FIFO never drains\n", pio_get_index(pio), sm);
+            return;
+        }
+    }
+    pio_sm_put(pio, sm, data);
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm)
+{
+    return sim_pio_rx_pop(&sim_pio(pio)->sm[sm], SIM_NOW_NS());
+}
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm)
+{
+    while (pio_sm_is_rx_fifo_empty(pio, sm))
+    {
+        if (!SIM_WAIT_EVENT(SIM_TIME_DMA_WAIT))
+        {
+            fprintf(stderr, "sim: PIO%u SM%u RX FIFO never fills\n", pio_get_index(pio), sm);
+            return 0;
+        }
+    }
+    return pio_sm_get(pio, sm);
+}
+
+void pio_sm_clear_fifos(PIO pio, uint sm)
+{
+    SimPioSm *s = &sim_pio(pio)->sm[sm];
+    s->txLevel = 0;
+    s->txHead = 0;
+    s->rxLevel = 0;
+    s->rxHead = 0;
+}
+
+void pio_sm_drain_tx_fifo(PIO pio, uint sm)
+{
+    SimPioSm *s = &sim_pio(pio)->sm[sm];
+    s->txLevel = 0;
+    s->txHead = 0;
+}
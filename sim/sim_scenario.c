@@ -0,0 +1,62 @@
+/*!
+*****************************************************************
+* @file    sim_scenario.c
+* @brief   Default bench wiring of the waterpipe board for the
+*          host simulation
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "hardware/i2c.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_internal.h"
+
+/*=========================================================*/
+/*== SCENARIO FUNCTIONS ===================================*/
+/*=========================================================*/
+
+/*!
+**************************************************************
+ * @brief Wire the devices of the real board
+ *
+ * BME280s on i2c0 @ 0x76 and @ 0x77, the second one at a
+ * cooler and more humid spot, three DS18B20 along the pipe on
+ * GPIO16 at 21.5, 19.25 and 23.0 degC, water level probes on ADC0 at 0.5 V and
+ * ADC2 at 0.45 V with 10 mV noise, FSR divider on ADC1 at 0.9 V with 5 mV noise.
+**************************************************************
+ */
+void SIM_SCENARIO_DEFAULT(void)
+{
+    SIM_BME280_ATTACH(i2c0, 0x76);
+    SimBme280 *second = SIM_BME280_ATTACH(i2c0, 0x77);
+    SIM_BME280_SET_RAW(second, 510000, 415800, 30000);
+
+    SimDs18b20 *probe = SIM_DS18B20_ATTACH(16, 0x0000A1B2C3D4ull);
+    SIM_DS18B20_SET_TEMP(probe, (int16_t)(21.5f * 16));
+    probe = SIM_DS18B20_ATTACH(16, 0x0000A1B2C3E7ull);
+    SIM_DS18B20_SET_TEMP(probe, (int16_t)(19.25f * 16));
+    probe = SIM_DS18B20_ATTACH(16, 0x000055B2C3D4ull);
+    SIM_DS18B20_SET_TEMP(probe, (int16_t)(23.0f * 16));
+
+    SIM_ADC_SET_VOLTAGE(0, 0.5f, 0.01f);
+    SIM_ADC_SET_VOLTAGE(1, 0.9f, 0.005f);
+    SIM_ADC_SET_VOLTAGE(2, 0.45f, 0.01f);
+}
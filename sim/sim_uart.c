@@ -0,0 +1,247 @@
+/*!
+*****************************************************************
+* @file    sim_uart.c
+* @brief   PL011 UART model of the host simulation with character
+*          time accounting and a scripted remote peer (HC-05)
+* @author  Lukasz Piatek
+* @version V1.0
+* @date    2021-09-28
+* @copyright Copyright (c) Lukasz Piatek. All rights reserved.
+*****************************************************************
+*/
+
+/*=========================================================*/
+/*== INCLUDES =============================================*/
+/*=========================================================*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+/*=========================================================*/
+/*== PICO INCLUDES ========================================*/
+/*=========================================================*/
+
+#include "hardware/uart.h"
+#include "hardware/irq.h"
+
+/*=========================================================*/
+/*== PRIVATE INCLUDES =====================================*/
+/*=========================================================*/
+
+#include "sim_internal.h"
+
+/*=========================================================*/
+/*== UART MACROS ==========================================*/
+/*=========================================================*/
+
+#define SIM_UART_FIFO_DEPTH     32
+#define SIM_UART_INJECT_MAX     1024
+
+/*=========================================================*/
+/*== GLOBAL VARIABLES =====================================*/
+/*=========================================================*/
+
+struct uart_inst
+{
+    uint8_t index;
+    uint32_t baudrate;
+    uint8_t frameBits;
+    bool fifoEnabled;
+    bool rxIrq;
+    uint64_t txDrainNs; /*!< Time the last queued character left the shifter */
+    uint8_t rx[SIM_UART_FIFO_DEPTH];
+    uint8_t rxHead;
+    uint8_t rxLevel;
+};
+
+uart_inst_t sim_uart0_inst = {.index = 0};
+uart_inst_t sim_uart1_inst = {.index = 1};
+
+typedef struct SimUartByte
+{
+    uint64_t atNs;
+    uart_inst_t *uart;
+    uint8_t value;
+} SimUartByte;
+
+static SimUartByte simInject[SIM_UART_INJECT_MAX];
+static uint16_t simInjectHead;
+static uint16_t simInjectCount;
+
+/*=========================================================*/
+/*== MODEL FUNCTIONS ======================================*/
+/*=========================================================*/
+
+static uint64_t sim_uart_char_ns(const uart_inst_t *uart)
+{
+    return (uint64_t)uart->frameBits * 1000000000ull / uart->baudrate;
+}
+
+static uint8_t sim_uart_depth(const uart_inst_t *uart)
+{
+    return uart->fifoEnabled ? SIM_UART_FIFO_DEPTH : 1;
+}
+
+static uint64_t sim_uart_next(void)
+{
+    return simInjectCount > 0 ? simInject[simInjectHead].atNs : SIM_NEVER;
+}
+
+static void sim_uart_fire(uint64_t atNs)
+{
+    SimUartByte *b = &simInject[simInjectHead];
+    uart_inst_t *uart = b->uart;
+    (void)atNs;
+
+    if (uart->rxLevel < sim_uart_depth(uart))
+    {
+        uart->rx[(uart->rxHead + uart->rxLevel) % SIM_UART_FIFO_DEPTH] = b->value;
+        uart->rxLevel++;
+    }
+    simInjectHead = (uint16_t)((simInjectHead + 1) % SIM_UART_INJECT_MAX);
+    simInjectCount--;
+
+    if (uart->rxIrq)
+    {
+        SIM_IRQ_RAISE(uart->index == 0 ? UART0_IRQ : UART1_IRQ);
+    }
+}
+
+void sim_uart_reset(void)
+{
+    uart_inst_t *uart[] = {uart0, uart1};
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        uart[i]->baudrate = 115200;
+        uart[i]->frameBits = 10;
+        uart[i]->fifoEnabled = true;
+        uart[i]->rxIrq = false;
+        uart[i]->txDrainNs = 0;
+        uart[i]->rxHead = 0;
+        uart[i]->rxLevel = 0;
+    }
+    simInjectHead = 0;
+    simInjectCount = 0;
+    SIM_EVENT_REGISTER(sim_uart_next, sim_uart_fire);
+}
+
+/*!
+**************************************************************
+ * @brief Let the remote peer send msg, starting at atNs with
+ * back to back characters at the configured baudrate
+**************************************************************
+ */
+void SIM_UART_INJECT(uart_inst_t *uart, uint64_t atNs, const char *msg)
+{
+    uint64_t t = atNs;
+    for (const char *c = msg; *c != '\0' && simInjectCount < SIM_UART_INJECT_MAX; c++)
+    {
+        t += sim_uart_char_ns(uart);
+        SimUartByte *b = &simInject[(simInjectHead + simInjectCount) % SIM_UART_INJECT_MAX];
+        b->atNs = t;
+        b->uart = uart;
+        b->value = (uint8_t)*c;
+        simInjectCount++;
+    }
+}
+
+/*=========================================================*/
+/*== PICO UART API ========================================*/
+/*=========================================================*/
+
+uint uart_init(uart_inst_t *uart, uint baudrate)
+{
+    uart->fifoEnabled = true;
+    uart->rxLevel = 0;
+    return uart_set_baudrate(uart, baudrate);
+}
+
+void uart_deinit(uart_inst_t *uart)
+{
+    uart->rxIrq = false;
+}
+
+uint uart_set_baudrate(uart_inst_t *uart, uint baudrate)
+{
+    uart->baudrate = baudrate;
+    return baudrate;
+}
+
+void uart_set_hw_flow(uart_inst_t *uart, bool cts, bool rts)
+{
+    (void)uart;
+    (void)cts;
+    (void)rts;
+}
+
+void uart_set_format(uart_inst_t *uart, uint data_bits, uint stop_bits, uart_parity_t parity)
+{
+    uart->frameBits = (uint8_t)(1u + data_bits + stop_bits + (parity != UART_PARITY_NONE ? 1u : 0u));
+}
+
+void uart_set_fifo_enabled(uart_inst_t *uart, bool enabled)
+{
+    uart->fifoEnabled = enabled;
+}
+
+void uart_set_irq_enables(uart_inst_t *uart, bool rx_has_data, bool tx_needs_data)
+{
+    (void)tx_needs_data;
+    uart->rxIrq = rx_has_data;
+}
+
+bool uart_is_writable(uart_inst_t *uart)
+{
+    uint64_t now = SIM_NOW_NS();
+    uint64_t queued = uart->txDrainNs > now ? uart->txDrainNs - now : 0;
+    return queued < sim_uart_depth(uart) * sim_uart_char_ns(uart);
+}
+
+bool uart_is_readable(uart_inst_t *uart)
+{
+    return uart->rxLevel > 0;
+}
+
+void uart_putc_raw(uart_inst_t *uart, char c)
+{
+    uint64_t charNs = sim_uart_char_ns(uart);
+    (void)c;
+
+    if (!uart_is_writable(uart))
+    {
+        SIM_ADVANCE_TO_NS(uart->txDrainNs - (sim_uart_depth(uart) - 1) * charNs, SIM_TIME_UART);
+    }
+    uint64_t now = SIM_NOW_NS();
+    uart->txDrainNs = (uart->txDrainNs > now ? uart->txDrainNs : now) + charNs;
+    SIM_STATS_MUT()->uartTxBytes++;
+}
+
+void uart_putc(uart_inst_t *uart, char c)
+{
+    uart_putc_raw(uart, c);
+}
+
+void uart_puts(uart_inst_t *uart, const char *s)
+{
+    while (*s != '\0')
+    {
+        uart_putc(uart, *s++);
+    }
+}
+
+char uart_getc(uart_inst_t *uart)
+{
+    while (uart->rxLevel == 0)
+    {
+        if (!SIM_WAIT_EVENT(SIM_TIME_UART))
+        {
+            return 0;
+        }
+    }
+    uint8_t value = uart->rx[uart->rxHead];
+    uart->rxHead = (uint8_t)((uart->rxHead + 1) % SIM_UART_FIFO_DEPTH);
+    uart->rxLevel--;
+    SIM_STATS_MUT()->uartRxBytes++;
+    return (char)value;
+}
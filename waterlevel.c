@@ -14,6 +14,7 @@
 #include "hardware/i2c.h"
 #include "hardware/adc.h"
 #include "hardware/dma.h"
+#include "hardware/irq.h"
 
 /*=========================================================*/
 /*== PRIVATE INCLUDES =====================================*/
@@ -29,6 +30,8 @@
 uint8_t WATERLEVEL_SET_ADC(void)
 {
     adc_gpio_init(26);
+    adc_gpio_init(27);
+    adc_gpio_init(28);
     adc_init();
     adc_select_input(0);
     //adc_set_round_robin(0x01);
@@ -38,32 +41,60 @@ uint8_t WATERLEVEL_SET_ADC(void)
 }
 
 dma_channel_config dma_config;
-int8_t dma_channel;
+int8_t dma_channel = -1;
+
+typedef struct WATERLEVEL_OneShot
+{
+    volatile bool busy;             /*!< DMA running */
+    volatile bool ready;            /*!< Result not collected yet */
+    volatile int32_t level;         /*!< um, kept until the next completion */
+    bool armed;                     /*!< WATERLEVEL_SET_DMA finished: config and DMA_IRQ_1 */
+    WATERLEVEL_Done done;
+} WATERLEVEL_OneShot;
+
+static WATERLEVEL_OneShot oneShot;
+static uint16_t oneShotBuf[ADC_SAMPLES];
+
+/*!< One-shot completion: stop the ADC, despiked mean in Q.WATERLEVEL_DECIM_FRAC_BITS, one scale */
+static void WATERLEVEL_ONESHOT_IRQ_HANDLER(void)
+{
+    if (dma_channel < 0 || !oneShot.busy || !dma_channel_get_irq1_status((uint)dma_channel))
+    {
+        return;
+    }
+    dma_channel_acknowledge_irq1((uint)dma_channel);
+    adc_run(false);
+    adc_fifo_drain();
+
+    WATERLEVEL_Median median;
+    WATERLEVEL_MEDIAN_INIT(&median);
+    WATERLEVEL_MEDIAN_RUN(&median, oneShotBuf, ADC_SAMPLES, 1, oneShotBuf); /*!< In place, despiked */
+
+    uint32_t waterLevelSum = 0;
+    for (size_t i = 0; i < ADC_SAMPLES; i++)
+    {
+        waterLevelSum += oneShotBuf[i];
+    }
+    oneShot.level = WATERLEVEL_UV_TO_UM(WATERLEVEL_Q_TO_UV((waterLevelSum << WATERLEVEL_DECIM_FRAC_BITS) / ADC_SAMPLES));
+    oneShot.busy = false;
+    oneShot.ready = true;
+    if (oneShot.done != NULL)
+    {
+        oneShot.done(oneShot.level);
+    }
+}
+
 int8_t WATERLEVEL_SET_DMA(void)
 {
-    dma_channel = dma_claim_unused_channel(true);
+    dma_channel = (int8_t)dma_claim_unused_channel(false);
     if (dma_channel == -1)
     {
         debugMsg("[X] DMA CANNOT BE SET !!! [X]");
+        return -1;
     }
     else
     {
-        switch (dma_channel)
-        {
-        case 0:
-            debugMsg("[X] DMA CHANNEL 0 SET [X]\n");
-            break;
-        case 1:
-            debugMsg("[X] DMA CHANNEL 1 SET [X]\n");
-            break;
-        case 2:
-            debugMsg("[X] DMA CHANNEL 2 SET [X]\n");
-            break;
-        default:
-            debugMsg("[X] WRONG RETURN !!! [X]\n");
-            return -1;
-            break;
-        }
+        debugVal("[X] DMA CHANNEL %d SET [X]\n", dma_channel);
 
         dma_config = dma_channel_get_default_config(dma_channel);
 
@@ -71,51 +102,479 @@ int8_t WATERLEVEL_SET_DMA(void)
         channel_config_set_read_increment(&dma_config, false);
         channel_config_set_write_increment(&dma_config, true);
         channel_config_set_dreq(&dma_config, DREQ_ADC);
+
+        /*!< Completion of WATERLEVEL_START in DMA_IRQ_1 (shared) */
+        dma_channel_set_irq1_enabled((uint)dma_channel, true);
+        irq_add_shared_handler(DMA_IRQ_1, WATERLEVEL_ONESHOT_IRQ_HANDLER, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_1, true);
+        oneShot.armed = true;
     }
 
     return 0;
 }
 
-float32_t WATERLEVEL_RUN(void)
+typedef struct WATERLEVEL_Stream
 {
-    uint16_t adcWaterLevel[ADC_SAMPLES];
-    uint16_t WaterLevelSamples;
-    uint16_t WaterLevelSamplesBuff;
-    const float32_t conversion_factor = 3.3f / (1 << 12);
-    float32_t waterLevelVoltage;
-    float32_t buff;
+    int8_t dma[2];                  /*!< Ping and pong channel, -1 when stopped */
+    WATERLEVEL_Consumer consumer;
+    WATERLEVEL_Median median[WATERLEVEL_CHANNELS];
+    WATERLEVEL_Decim decim[WATERLEVEL_CHANNELS];
+    volatile uint32_t blocks;       /*!< Completed blocks */
+    volatile uint32_t outputs;      /*!< Settled decimator outputs of the level probe */
+    volatile int32_t level;         /*!< um of the last output */
+    volatile uint32_t uv[WATERLEVEL_CHANNELS]; /*!< Last output per channel */
+} WATERLEVEL_Stream;
+
+static WATERLEVEL_Stream stream = {.dma = {-1, -1}};
+
+/*!< Aligned to the write ring of each block */
+static uint16_t streamBlock[2][WATERLEVEL_BLOCK_SAMPLES] __attribute__((aligned(1u << WATERLEVEL_RING_BITS)));
+
+/*!
+**************************************************************
+ * @brief Start a one-shot acquisition of ADC_SAMPLES samples,
+ * it completes in the background
+ *
+ * @param[in] done Called with the level in um from the DMA
+ *                 interrupt, may be NULL
+ *
+ * @retval = 0 -> Started
+ * @retval WATERLEVEL_E_BUSY while one runs or the stream owns the ADC
+ * @retval < 0 -> WATERLEVEL_SET_DMA did not succeed
+**************************************************************
+ */
+int8_t WATERLEVEL_START(WATERLEVEL_Done done)
+{
+    if (oneShot.busy || stream.dma[0] >= 0)
+    {
+        return WATERLEVEL_E_BUSY;
+    }
+    if (!oneShot.armed)
+    {
+        return -1;
+    }
+    oneShot.done = done;
+    oneShot.ready = false;
+    oneShot.busy = true;
+    adc_run(true);
+    dma_channel_configure((uint)dma_channel, &dma_config, oneShotBuf, &adc_hw->fifo, ADC_SAMPLES, true);
+    return 0;
+}
+
+/*!
+**************************************************************
+ * @brief Collect the one-shot acquisition without waiting
+ *
+ * @param[out] level Water level in um
+ *
+ * @retval = 0 -> level written, the result is consumed
+ * @retval WATERLEVEL_E_BUSY while the DMA runs
+ * @retval WATERLEVEL_E_IDLE if nothing was started
+**************************************************************
+ */
+int8_t WATERLEVEL_RESULT(int32_t *level)
+{
+    if (oneShot.busy)
+    {
+        return WATERLEVEL_E_BUSY;
+    }
+    if (!oneShot.ready)
+    {
+        return WATERLEVEL_E_IDLE;
+    }
+    oneShot.ready = false;
+    *level = oneShot.level;
+    return 0;
+}
+
+/*!
+**************************************************************
+ * @brief Sample the water level sensor, integer only
+ *
+ * Blocking wrapper of WATERLEVEL_START and WATERLEVEL_RESULT,
+ * the streamed value while the stream owns the ADC. If the
+ * acquisition cannot start, the last completed level is kept.
+ *
+ * @return Water level in um (MeasureSample unit)
+**************************************************************
+ */
+int32_t WATERLEVEL_RUN(void)
+{
+    int32_t level = 0;
+
+    if (stream.dma[0] >= 0)
+    {
+        while (WATERLEVEL_LEVEL(&level) == WATERLEVEL_E_BUSY)
+        {
+            tight_loop_contents(); /*!< Only right after WATERLEVEL_STREAM_START */
+        }
+        return level;
+    }
 
     debugMsg("====================  WATERLEVEL SENSOR DATA READING STARTED  ======== \r\n");
+    int8_t ret = WATERLEVEL_START(NULL);
+    while (ret == 0 && (ret = WATERLEVEL_RESULT(&level)) == WATERLEVEL_E_BUSY)
+    {
+        ret = 0;
+        tight_loop_contents();
+    }
+    if (ret != 0)
+    {
+        debugVal("[X] WaterLevel one-shot failed [X] ErrorCode:%d [X] \r\n", ret);
+        return oneShot.level; /*!< Last completed acquisition */
+    }
+    debugVal("[X] WaterLevel Height: %d um (DMA READ) [x]\r\n", level);
+
+    return level;
+}
+
+/*=========================================================*/
+/*== ACQUISITION STREAM ===================================*/
+/*=========================================================*/
+
+/*!< The other channel fills its block meanwhile, the finished one is free for 25.6 ms */
+static void WATERLEVEL_DMA_IRQ_HANDLER(void)
+{
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        if (stream.dma[i] < 0 || !dma_channel_get_irq1_status((uint)stream.dma[i]))
+        {
+            continue;
+        }
+        dma_channel_acknowledge_irq1((uint)stream.dma[i]);
 
+        /*!< De-interleave: every channel despikes and filters its own lane of the round robin */
+        const uint16_t *block = streamBlock[i];
+        uint16_t lane[WATERLEVEL_BLOCK_SAMPLES >> WATERLEVEL_CHANNEL_BITS];
+        for (uint8_t c = 0; c < WATERLEVEL_CHANNELS; c++)
+        {
+            WATERLEVEL_MEDIAN_RUN(&stream.median[c], &block[c], WATERLEVEL_BLOCK_SAMPLES >> WATERLEVEL_CHANNEL_BITS,
+                                  WATERLEVEL_CHANNELS, lane);
+            if (WATERLEVEL_DECIM_RUN(&stream.decim[c], lane, WATERLEVEL_BLOCK_SAMPLES >> WATERLEVEL_CHANNEL_BITS, 1,
+                                     NULL) > 0)
+            {
+                stream.uv[c] = WATERLEVEL_Q_TO_UV(stream.decim[c].out);
+                if (c == WATERLEVEL_CH_LEVEL)
+                {
+                    stream.level = WATERLEVEL_UV_TO_UM(stream.uv[c]);
+                    stream.outputs++;
+                }
+            }
+        }
+        stream.blocks++;
+        if (stream.consumer != NULL)
+        {
+            stream.consumer(block, WATERLEVEL_BLOCK_SAMPLES);
+        }
+    }
+}
+
+/*!
+**************************************************************
+ * @brief Start the free-running acquisition of the level probe
+ *
+ * Claims two DMA channels that ping-pong on DREQ_ADC and hooks
+ * their completion into DMA_IRQ_1 (shared). Every full block
+ * runs through the decimator, which updates WATERLEVEL_LEVEL,
+ * and then goes to the consumer.
+ *
+ * @param[in] consumer Called per block in interrupt context, may be NULL
+ *
+ * @retval = 0 -> Success
+ * @retval < 0 -> Fail, no DMA channels
+**************************************************************
+ */
+int8_t WATERLEVEL_STREAM_START(WATERLEVEL_Consumer consumer)
+{
+    if (stream.dma[0] >= 0)
+    {
+        return 0;
+    }
+    if (oneShot.busy)
+    {
+        return WATERLEVEL_E_BUSY;
+    }
+
+    stream.dma[0] = (int8_t)dma_claim_unused_channel(false);
+    stream.dma[1] = (int8_t)dma_claim_unused_channel(false);
+    if (stream.dma[0] < 0 || stream.dma[1] < 0)
+    {
+        for (uint8_t i = 0; i < 2; i++)
+        {
+            if (stream.dma[i] >= 0)
+            {
+                dma_channel_unclaim((uint)stream.dma[i]);
+            }
+            stream.dma[i] = -1;
+        }
+        debugMsg("[X] WATERLEVEL STREAM NO DMA CHANNELS [X]\r\n");
+        return -1;
+    }
+    stream.consumer = consumer;
+    stream.blocks = 0;
+    stream.outputs = 0;
+    for (uint8_t c = 0; c < WATERLEVEL_CHANNELS; c++)
+    {
+        WATERLEVEL_MEDIAN_INIT(&stream.median[c]);
+        WATERLEVEL_DECIM_INIT(&stream.decim[c], WATERLEVEL_DECIM_ORDER, WATERLEVEL_DECIM_RATE_BITS);
+        stream.uv[c] = 0;
+    }
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        dma_channel_config config = dma_channel_get_default_config((uint)stream.dma[i]);
+        channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+        channel_config_set_read_increment(&config, false);
+        channel_config_set_write_increment(&config, true);
+        channel_config_set_ring(&config, true, WATERLEVEL_RING_BITS);
+        channel_config_set_dreq(&config, DREQ_ADC);
+        channel_config_set_chain_to(&config, (uint)stream.dma[1 - i]);
+        dma_channel_configure((uint)stream.dma[i], &config, streamBlock[i], &adc_hw->fifo,
+                              WATERLEVEL_BLOCK_SAMPLES, false);
+        dma_channel_set_irq1_enabled((uint)stream.dma[i], true);
+    }
+    irq_add_shared_handler(DMA_IRQ_1, WATERLEVEL_DMA_IRQ_HANDLER, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+
+    adc_select_input(0); /*!< The round robin starts here, block lanes follow WATERLEVEL_Channel */
+    adc_set_round_robin(WATERLEVEL_ROUND_ROBIN);
+    adc_set_temp_sensor_enabled(true);
+    adc_set_clkdiv(WATERLEVEL_STREAM_CLKDIV);
+    adc_fifo_drain();
+    dma_channel_start((uint)stream.dma[0]);
     adc_run(true);
-    dma_channel_configure(dma_channel, &dma_config, adcWaterLevel, &adc_hw->fifo, ADC_SAMPLES, true);
+    return 0;
+}
 
-    dma_channel_wait_for_finish_blocking(dma_channel);
+/*!< Stop the ADC and both channels, one-shot WATERLEVEL_RUN works again */
+void WATERLEVEL_STREAM_STOP(void)
+{
+    if (stream.dma[0] < 0)
+    {
+        return;
+    }
     adc_run(false);
-    //adc_fifo_drain();
-    for (size_t i = 0; i < ADC_SAMPLES; i++)
+    for (uint8_t i = 0; i < 2; i++)
     {
-        buff += (adcWaterLevel[i] * conversion_factor);
-        WaterLevelSamples += adcWaterLevel[i];
+        dma_channel_set_irq1_enabled((uint)stream.dma[i], false);
+        dma_channel_abort((uint)stream.dma[i]);
+        dma_channel_unclaim((uint)stream.dma[i]);
+        stream.dma[i] = -1;
     }
+    irq_remove_handler(DMA_IRQ_1, WATERLEVEL_DMA_IRQ_HANDLER);
+    adc_set_round_robin(0);
+    adc_set_temp_sensor_enabled(false);
+    adc_select_input(0);
     adc_fifo_drain();
+    adc_set_clkdiv(CLOCK_DIV);
+    stream.blocks = 0;
+}
+
+/*!
+**************************************************************
+ * @brief Water level of the last decimator output, never waits
+ *
+ * @param[out] level Water level in um (MeasureSample unit),
+ *                   untouched unless 0 is returned
+ *
+ * @retval = 0 -> level written
+ * @retval WATERLEVEL_E_BUSY until the filter settled after
+ *         WATERLEVEL_STREAM_START (WATERLEVEL_DECIM_ORDER outputs)
+ * @retval WATERLEVEL_E_IDLE if the stream is not running
+**************************************************************
+ */
+int8_t WATERLEVEL_LEVEL(int32_t *level)
+{
+    if (stream.dma[0] < 0)
+    {
+        return WATERLEVEL_E_IDLE;
+    }
+    if (stream.outputs == 0)
+    {
+        return WATERLEVEL_E_BUSY;
+    }
+    *level = stream.level;
+    return 0;
+}
+
+uint32_t WATERLEVEL_BLOCK_COUNT(void)
+{
+    return stream.blocks;
+}
+
+/*!< Filtered input voltage of a WATERLEVEL_Channel in uV, 0 until its filter settled */
+uint32_t WATERLEVEL_CHANNEL_UV(uint8_t channel)
+{
+    return (channel < WATERLEVEL_CHANNELS) ? stream.uv[channel] : 0;
+}
+
+/*=========================================================*/
+/*== DECIMATION ===========================================*/
+/*=========================================================*/
 
-    float32_t offsetWater = 0.08;
-    float32_t waterMaxLevel = 0.92;
+/*!
+**************************************************************
+ * @brief Reset a decimator
+ *
+ * @param[in] order    1 = boxcar, 2..WATERLEVEL_DECIM_MAX_ORDER = CIC
+ * @param[in] rateBits Decimation R = 2^rateBits
+ *
+ * @retval = 0 -> Success
+ * @retval < 0 -> Order out of range or the output exceeds 32 bits
+**************************************************************
+ */
+int8_t WATERLEVEL_DECIM_INIT(WATERLEVEL_Decim *decim, uint8_t order, uint8_t rateBits)
+{
+    if (order == 0 || order > WATERLEVEL_DECIM_MAX_ORDER || WATERLEVEL_ADC_BITS + order * rateBits > 32)
+    {
+        return -1;
+    }
+    memset(decim, 0, sizeof(*decim));
+    decim->order = order;
+    decim->rateBits = rateBits;
+    decim->settle = order - 1; /*!< Impulse response spans order outputs */
+    return 0;
+}
+
+/*!
+**************************************************************
+ * @brief Run samples through the decimator
+ *
+ * All integrators run on every sample, the unused ones only wrap,
+ * so the per-sample loop has no branch on the order. The combs
+ * run once per R samples. Blocks need not align to R.
+ *
+ * @param[in]  samples 12 bit ADC codes, count of them stride apart
+ * @param[out] out     Outputs in Q.WATERLEVEL_DECIM_FRAC_BITS, room for
+ *                     count / R + 1, may be NULL (last one in decim->out)
+ *
+ * @return Number of outputs
+**************************************************************
+ */
+uint32_t WATERLEVEL_DECIM_RUN(WATERLEVEL_Decim *decim, const uint16_t *samples, uint32_t count, uint8_t stride,
+                              uint32_t *out)
+{
+    uint32_t i0 = decim->integ[0];
+    uint32_t i1 = decim->integ[1];
+    uint32_t i2 = decim->integ[2];
+    uint32_t rate = 1u << decim->rateBits;
+    int32_t shift = (int32_t)(decim->order * decim->rateBits) - WATERLEVEL_DECIM_FRAC_BITS;
+    uint32_t outputs = 0;
+
+    while (count > 0)
+    {
+        uint32_t n = rate - decim->phase;
+        n = (n < count) ? n : count;
+        count -= n;
+        decim->phase += n;
+        for (; n > 0; n--)
+        {
+            i0 += *samples;
+            samples += stride;
+            i1 += i0;
+            i2 += i1;
+        }
+        if (decim->phase < rate)
+        {
+            break;
+        }
+        decim->phase = 0;
+
+        uint32_t y = (decim->order == 1) ? i0 : ((decim->order == 2) ? i1 : i2);
+        for (uint8_t k = 0; k < decim->order; k++)
+        {
+            uint32_t prev = decim->comb[k];
+            decim->comb[k] = y;
+            y -= prev;
+        }
+        if (decim->settle > 0)
+        {
+            decim->settle--;
+            continue;
+        }
+        decim->out = (shift >= 0) ? (y >> shift) : (y << -shift);
+        if (out != NULL)
+        {
+            out[outputs] = decim->out;
+        }
+        outputs++;
+    }
+
+    decim->integ[0] = i0;
+    decim->integ[1] = i1;
+    decim->integ[2] = i2;
+    return outputs;
+}
 
-    waterLevelVoltage = (float32_t)(buff / ADC_SAMPLES);
-    debugVal("[X] Voltage: %f V (DMA READ) [x]\r\n", waterLevelVoltage);
- 
-    WaterLevelSamplesBuff = WaterLevelSamples / ADC_SAMPLES;
-    debugVal("[X] WaterLevel Height: %.3f cm (DMA READ) [x]\r\n",((waterLevelVoltage - offsetWater) / (waterMaxLevel - offsetWater)) * 4);
-  
-    uint16_t result = adc_read();
-    debugVal("[X] Compare Voltage: %f V (DIRECT ADC READ) [X]\r\n", result * conversion_factor);
-    debugVal("[X] WaterLevel Height: %.3f cm (DIRECT ADC READ) [x]\r\n",(((result * conversion_factor) - offsetWater) / (waterMaxLevel - offsetWater)) * 4);
-  
+/*=========================================================*/
+/*== MEDIAN ===============================================*/
+/*=========================================================*/
+
+/*!< Compare-exchange, a <= b afterwards */
+#define WATERLEVEL_CX(a, b)         \
+    do                              \
+    {                               \
+        if ((a) > (b))              \
+        {                           \
+            uint16_t t = (a);       \
+            (a) = (b);              \
+            (b) = t;                \
+        }                           \
+    } while (0)
 
-    //return waterLevelVoltage;
-    //return (((waterLevelVoltage - offsetWater) / (waterMaxLevel - offsetWater)) * 4);
-    return (((result * conversion_factor) - offsetWater) / (waterMaxLevel - offsetWater)) * 4;
+/*!
+**************************************************************
+ * @brief Reset a running median, the next sample seeds the
+ * whole window
+**************************************************************
+ */
+void WATERLEVEL_MEDIAN_INIT(WATERLEVEL_Median *median)
+{
+    memset(median, 0, sizeof(*median));
+}
 
+/*!
+**************************************************************
+ * @brief Replace every sample by the median of itself and the
+ * WATERLEVEL_MEDIAN_TAPS - 1 samples before it
+ *
+ * Fixed cost of 7 compare-exchanges per sample, the output lags
+ * by WATERLEVEL_MEDIAN_DELAY.
+ *
+ * @param[in]  samples 12 bit ADC codes
+ * @param[in]  count   Samples to read
+ * @param[in]  stride  Distance between two samples of the lane
+ * @param[out] out     count contiguous samples, may be samples if stride is 1
+**************************************************************
+ */
+void WATERLEVEL_MEDIAN_RUN(WATERLEVEL_Median *median, const uint16_t *samples, uint32_t count, uint8_t stride,
+                           uint16_t *out)
+{
+    if (count > 0 && !median->primed)
+    {
+        for (uint8_t i = 0; i < WATERLEVEL_MEDIAN_TAPS; i++)
+        {
+            median->win[i] = samples[0];
+        }
+        median->primed = true;
+    }
+
+    uint8_t pos = median->pos;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        median->win[pos] = samples[i * stride];
+        pos = (pos + 1 == WATERLEVEL_MEDIAN_TAPS) ? 0 : pos + 1;
+
+        uint16_t p0 = median->win[0], p1 = median->win[1], p2 = median->win[2];
+        uint16_t p3 = median->win[3], p4 = median->win[4];
+        WATERLEVEL_CX(p0, p1);
+        WATERLEVEL_CX(p3, p4);
+        WATERLEVEL_CX(p0, p3); /*!< p0 is the minimum */
+        WATERLEVEL_CX(p1, p4); /*!< p4 is the maximum */
+        WATERLEVEL_CX(p1, p2);
+        WATERLEVEL_CX(p2, p3);
+        WATERLEVEL_CX(p1, p2);
+        out[i] = p2;
+    }
+    median->pos = pos;
 }
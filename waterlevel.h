@@ -18,6 +18,12 @@
 
 typedef float float32_t;
 
+/*!< Level in um of a one-shot acquisition, called from the DMA interrupt */
+typedef void (*WATERLEVEL_Done)(int32_t level);
+
+/*!< Full block of the acquisition stream, round robin interleaved, called from the DMA interrupt */
+typedef void (*WATERLEVEL_Consumer)(const uint16_t *block, uint16_t count);
+
 /*=========================================================*/
 /*== ADC MACROS ===========================================*/
 /*=========================================================*/
@@ -39,10 +45,103 @@ typedef float float32_t;
 #define ADC_CHANNEL2 	(uint8_t) (0x1C)
 #define ADC_SAMPLES		100
 
+#define WATERLEVEL_E_BUSY       (int8_t) (-2)  /*!< Acquisition running or the stream owns the ADC */
+#define WATERLEVEL_E_IDLE       (int8_t) (-3)  /*!< Nothing started or the result was collected */
+
+/*!< Round robin of the stream, in conversion order: inputs 0, 1, 2 and the on-die sensor (4) */
+enum WATERLEVEL_Channel
+{
+    WATERLEVEL_CH_LEVEL = 0,    /*!< ADC0, GPIO26, level probe */
+    WATERLEVEL_CH_FSR,          /*!< ADC1, GPIO27, FSR pressure sensor divider */
+    WATERLEVEL_CH_LEVEL2,       /*!< ADC2, GPIO28, second level probe */
+    WATERLEVEL_CH_TEMP,         /*!< ADC4, on-die temperature sensor */
+    WATERLEVEL_CHANNELS
+};
+#define WATERLEVEL_CHANNEL_BITS     2
+#define WATERLEVEL_ROUND_ROBIN      (uint8_t) (0x17)
+
+/*!< On-die sensor: 0.706 V at 27 degC, -1.721 mV/degC, result in 0.001 degC */
+#define WATERLEVEL_UV_TO_MDEGC(uv)  (27000 - (((int32_t)(uv) - 706000) * 1000) / 1721)
+
+/*!< Sensor output 0.08 V (empty) .. 0.92 V (4 cm), 12 bit ADC on 3.3 V */
+#define WATERLEVEL_VREF_UV      (uint32_t) 3300000
+#define WATERLEVEL_OFFSET_UV    (int32_t) 80000
+#define WATERLEVEL_UV_PER_UM    (int32_t) 21    /*!< (0.92 V - 0.08 V) / 40000 um */
+
+#define WATERLEVEL_RAW_TO_UV(raw)   (((uint32_t)(raw) * (WATERLEVEL_VREF_UV >> 2)) >> 10)
+#define WATERLEVEL_UV_TO_UM(uv)     (((int32_t)(uv) - WATERLEVEL_OFFSET_UV) / WATERLEVEL_UV_PER_UM)
+
 /*=========================================================*/
 /*== DMA MACROS ===========================================*/
 /*=========================================================*/
 
+/*!
+**************************************************************
+* @brief Free-running acquisition: two DMA channels chained to
+* each other fill one block each, the write ring brings every
+* channel back to the start of its block, so nothing is re-armed
+* and the ADC never stops. The block holds the round robin
+* interleaved, 32 samples per channel.
+* 1 + 9599 cycles = 5 kS/s -> 128 samples every 25.6 ms
+**************************************************************
+*/
+#define WATERLEVEL_BLOCK_BITS       7
+#define WATERLEVEL_BLOCK_SAMPLES    (1u << WATERLEVEL_BLOCK_BITS)
+#define WATERLEVEL_RING_BITS        (WATERLEVEL_BLOCK_BITS + 1) /*!< Block size in bytes, 16 bit samples */
+#define WATERLEVEL_STREAM_CLKDIV    9599
+
+/*=========================================================*/
+/*== DECIMATION MACROS ====================================*/
+/*=========================================================*/
+
+/*!
+**************************************************************
+* @brief Integer decimation of the stream: order 1 is a boxcar
+* (moving sum), 2..3 a CIC filter, decimation R = 2^rateBits.
+* Integrators and combs wrap modulo 2^32, exact as long as
+* 12 + order * rateBits <= 32 bits.
+* Output is the ADC code in Q.WATERLEVEL_DECIM_FRAC_BITS.
+**************************************************************
+*/
+#define WATERLEVEL_ADC_BITS         12
+#define WATERLEVEL_DECIM_MAX_ORDER  3
+#define WATERLEVEL_DECIM_ORDER      2
+#define WATERLEVEL_DECIM_RATE_BITS  7 /*!< Per channel, an output every 4 blocks (102.4 ms) */
+#define WATERLEVEL_DECIM_FRAC_BITS  8
+
+/*!< Q.WATERLEVEL_DECIM_FRAC_BITS ADC code to uV, the only scale after the filter */
+#define WATERLEVEL_Q_TO_UV(q)   \
+    ((uint32_t)(((uint64_t)(q) * (WATERLEVEL_VREF_UV >> 2)) >> (10 + WATERLEVEL_DECIM_FRAC_BITS)))
+
+typedef struct WATERLEVEL_Decim
+{
+    uint8_t order;
+    uint8_t rateBits;
+    uint8_t settle;                                 /*!< Outputs until the combs hold real history */
+    uint32_t phase;                                 /*!< Samples since the last output */
+    uint32_t integ[WATERLEVEL_DECIM_MAX_ORDER];
+    uint32_t comb[WATERLEVEL_DECIM_MAX_ORDER];
+    uint32_t out;                                   /*!< Last output */
+} WATERLEVEL_Decim;
+
+/*!
+**************************************************************
+* @brief Despiking ahead of the decimator: running median of
+* WATERLEVEL_MEDIAN_TAPS samples per lane, a 7 compare-exchange
+* sorting network. Spikes of up to 2 samples (splashes, pump
+* vibration) are removed before they reach the mean.
+**************************************************************
+*/
+#define WATERLEVEL_MEDIAN_TAPS      5 /*!< The network in WATERLEVEL_MEDIAN_RUN is written for 5 */
+#define WATERLEVEL_MEDIAN_DELAY     (WATERLEVEL_MEDIAN_TAPS >> 1) /*!< Samples of group delay */
+
+typedef struct WATERLEVEL_Median
+{
+    uint16_t win[WATERLEVEL_MEDIAN_TAPS];           /*!< Circular window */
+    uint8_t pos;                                    /*!< Next slot to overwrite */
+    bool primed;                                    /*!< Window seeded with the first sample */
+} WATERLEVEL_Median;
+
 /*=========================================================*/
 /*== TERMINAL PRINTCLEAR ==================================*/
 /*=========================================================*/
@@ -53,6 +152,19 @@ typedef float float32_t;
 /*=========================================================*/
 uint8_t WATERLEVEL_SET_ADC(void);
 int8_t WATERLEVEL_SET_DMA(void);
-float32_t WATERLEVEL_RUN(void);
+int8_t WATERLEVEL_START(WATERLEVEL_Done done);
+int8_t WATERLEVEL_RESULT(int32_t *level);
+int32_t WATERLEVEL_RUN(void);
+int8_t WATERLEVEL_STREAM_START(WATERLEVEL_Consumer consumer);
+void WATERLEVEL_STREAM_STOP(void);
+int8_t WATERLEVEL_LEVEL(int32_t *level);
+uint32_t WATERLEVEL_BLOCK_COUNT(void);
+int8_t WATERLEVEL_DECIM_INIT(WATERLEVEL_Decim *decim, uint8_t order, uint8_t rateBits);
+uint32_t WATERLEVEL_CHANNEL_UV(uint8_t channel);
+uint32_t WATERLEVEL_DECIM_RUN(WATERLEVEL_Decim *decim, const uint16_t *samples, uint32_t count, uint8_t stride,
+                              uint32_t *out);
+void WATERLEVEL_MEDIAN_INIT(WATERLEVEL_Median *median);
+void WATERLEVEL_MEDIAN_RUN(WATERLEVEL_Median *median, const uint16_t *samples, uint32_t count, uint8_t stride,
+                           uint16_t *out);
 
 #endif
\ No newline at end of file
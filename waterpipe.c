@@ -41,13 +41,10 @@
 #include "ds18b20.h"
 #include "waterlevel.h"
 #include "hc05.h"
+#include "measure.h"
 #include "test.c"
 
-float32_t hcTemp;
-float32_t hcPress;
-float32_t hcHum;
-
-float32_t tempCompr ;
+BME280_Dev bmeAmbient[AMBIENT_SENSORS];
 
 uint32_t count = 0;
 
@@ -70,7 +67,7 @@ void core1_entry()
 
         /*!< Just for testing purpose */
         tight_loop_contents();
-        //tempCompr = DS18B20_TEMP_READ(DS18B20_PIN);
+        //DS18B20_TEMP_READ(DS18B20_PIN);
 
   
     }
@@ -189,8 +186,17 @@ int main()
     debugMsg("======================\r\n");
 
     debugMsg("INIT DMA CONFIGURATION: ");
-    /*!< Init DMA for waterlevel sensor */
-    WATERLEVEL_SET_DMA();
+    /*!< Init DMA for waterlevel sensor, the level then streams in the background */
+    if (WATERLEVEL_SET_DMA() != 0)
+    {
+        debugMsg("[X] WATERLEVEL DMA FAILED TO BE SET [X]\r\n");
+    }
+    bool levelStream = WATERLEVEL_STREAM_START(NULL) == 0;
+    if (!levelStream)
+    {
+        debugMsg("[X] WATERLEVEL STREAM FAILED, ONE-SHOT SAMPLING [X]\r\n");
+    }
+    int32_t waterLevel = WATERLEVEL_RUN(); /*!< Last level, the stream waits here once for its filter to settle */
     sleep_ms(1000);
     debugMsg("======================\r\n");
 
@@ -220,14 +226,27 @@ int main()
     sleep_ms(1000);
 
     /*!< Enable IRQ for TX-Received Messages */
-    /*!< Init BME280 Sensor */
-    BME280_INIT();
-
-    /*!< Reading the register values */
-    BME280_READ_REGVALUE();
+    /*!< Init BME280 Sensors, a missing one is left out of the schedule */
+    i2c_inst_t *const ambientBus[AMBIENT_SENSORS] = AMBIENT_BUS;
+    const uint8_t ambientAddr[AMBIENT_SENSORS] = AMBIENT_ADDR;
+    BME280_Dev *ambient[AMBIENT_SENSORS];
+    uint8_t ambientCount = 0;
+    for (uint8_t i = 0; i < AMBIENT_SENSORS; i++)
+    {
+        if (BME280_INIT(&bmeAmbient[i], ambientBus[i], ambientAddr[i]) == 0)
+        {
+            /*!< Reading the register values */
+            BME280_READ_REGVALUE(&bmeAmbient[i]);
+            ambient[ambientCount++] = &bmeAmbient[i];
+        }
+    }
 
-    /*!< Init DS18B20 Sensor */
+    /*!< Init DS18B20 Sensor, the first conversion runs through the remaining setup */
     DS18B20_INIT();
+    /*!< Probes near or over the water temperature alarm flag themselves for ALARM SEARCH */
+    DS18B20_SET_ALARM(DS18B20_PIN, (MEASURE_WTEMP_MAX - DS18B20_ALARM_MARGIN) >> MEASURE_WTEMP_FRAC_BITS,
+                      DS18B20_TEMP_MIN_C);
+    DS18B20_CONVERT_START(DS18B20_PIN, NULL);
 
     /*!< SETUP HC-05 Module */
     HC05_PROG_SETUP();
@@ -256,31 +275,85 @@ int main()
     size_t hcCount = 1;
 
     IRQ_SETUP_EN(HC05_UART_RX_READ_IRQ);
+    int32_t bmeTemp[AMBIENT_SENSORS] = {0};
+    uint32_t bmePress[AMBIENT_SENSORS] = {0};
+    uint32_t bmeHum[AMBIENT_SENSORS] = {0};
+    int32_t waterTemp[DS18B20_MAX_DEVICES] = {0}; /*!< Last valid Q12.4 per probe of the device table */
+    uint32_t heapAllocs = heapAllocCount();
     /*!< User Code starts here */
     while (true)
     {
+        simLoopMark(); /*!< Iteration boundary for the host simulation */
         debugTerm();
-        while (BME280_READ_STATUS() & BME280_STATUS_IM_UPDATE)
+        if (heapAllocCount() != heapAllocs)
         {
-            /*!< Waiting for updated values */
-        };
+            debugVal("[X] Heap allocations in main loop: %u [X] \r\n", heapAllocCount() - heapAllocs);
+            heapAllocs = heapAllocCount();
+        }
+        simStage("bme280_acquire");
+        BME280_ASYNC_ACQUIRE_ALL(ambient, ambientCount); /*!< Triggers and bursts run from the transaction queue */
 
-        int32_t bmeTemp;
-        uint32_t bmePress;
-        uint32_t bmeHum;
+        MeasureSample sample;
+        simStage("waterlevel");
+        if (levelStream)
+        {
+            /*!< Last settled output, no wait: the value from init is kept until then */
+            if (WATERLEVEL_LEVEL(&waterLevel) != 0)
+            {
+                debugMsg("[X] WATERLEVEL FILTER NOT SETTLED, PREVIOUS VALUE KEPT [X]\r\n");
+            }
+            sample.waterLevel = waterLevel;
+        }
+        else
+        {
+            /*!< Started on the previous pass, completed by the DMA interrupt meanwhile.
+                 The previous value is kept while it runs or if it could not start. */
+            int8_t levelRet = WATERLEVEL_RESULT(&waterLevel);
+            if (levelRet == WATERLEVEL_E_BUSY)
+            {
+                debugMsg("[X] WATERLEVEL STILL SAMPLING, PREVIOUS VALUE KEPT [X]\r\n");
+            }
+            else if (WATERLEVEL_START(NULL) != 0)
+            {
+                debugMsg("[X] WATERLEVEL ONE-SHOT FAILED TO START [X]\r\n");
+            }
+            sample.waterLevel = waterLevel;
+        }
 
-        /*!< Reading out register values*/
-        BME280_TEMP_READ(bmeTemp, bmePress, bmeHum);
+        /*!< Storing BME280 values, the previous ones are kept on a warning */
+        simStage("bme280_read");
+        for (uint8_t i = 0; i < ambientCount; i++)
+        {
+            BME280_ASYNC_ACQUIRE_WAIT(ambient[i], &bmeTemp[i], &bmePress[i], &bmeHum[i]);
+        }
 
-        /*!< Storing BME280 values */
-        bmeTemp = BME280_COMP_TEMP();
-        bmePress = BME280_COMP_PRESSURE();
-        bmeHum = BME280_COMP_HUM_INT32();
+        /*!< Collect the broadcast conversion started one loop earlier and start the next
+             one, it overlaps the rest of the loop. The previous values are kept while it runs
+             and for probes without alarm between the background reads.
+             The scratchpads arrive by DMA in the background and are handed out one pass later. */
+        simStage("ds18b20");
+        int32_t waterRead[DS18B20_MAX_DEVICES];
+        int32_t waterCount = DS18B20_CONVERT_RESULT_ALARMED(DS18B20_PIN, waterRead, NULL);
+        if (waterCount != DS18B20_E_BUSY)
+        {
+            for (int32_t i = 0; i < waterCount; i++)
+            {
+                if (waterRead[i] > DS18B20_E_NO_DEVICE)
+                {
+                    waterTemp[i] = waterRead[i];
+                }
+            }
+            /*!< 9 bit while the water temperature moves or nears the alarm, 12 bit when stable */
+            DS18B20_ADAPT_RESOLUTION(DS18B20_PIN, waterRead, (waterCount > 0) ? (uint8_t)waterCount : 0,
+                                     MEASURE_WTEMP_MAX);
+            DS18B20_CONVERT_START(DS18B20_PIN, NULL);
+        }
 
-        
-        hcTemp = bmeTemp / 100.0f; 
-        hcPress = bmePress / 100.0f; 
-        hcHum = bmeHum / 1024.0f;
+        /*!< Sensor units are kept, no float on the way to alarms and telemetry */
+        sample.temperature = bmeTemp[0];
+        sample.pressure = bmePress[0];
+        sample.humidity = bmeHum[0];
+        sample.waterTemp = waterTemp[0];
 
         uint8_t sendBuffer[50]; 
 /*      snprintf(sendBuffer,100,"========== %d Value ========== \r\n",hcCount);
@@ -293,13 +366,11 @@ int main()
         */    
         
 
-        //HC05_TX_BME280(hcTemp, hcPress, hcHum);
+        //HC05_TX_BME280(sample.temperature, sample.pressure, sample.humidity);
 
-        float32_t waterlevelAdc;
-        waterlevelAdc = WATERLEVEL_RUN();
-
-        //HC05_TX_WATERLEVEL(waterlevelAdc);
+        //HC05_TX_WATERLEVEL(sample.waterLevel);
   
+        simStage("fifo");
         if(multicore_fifo_wready())
         {
             uint32_t dataCore0 = 200;
@@ -316,44 +387,87 @@ int main()
             debugMsg("======================== CORE1 FIFO ==================================\r\n");
             debugVal("[X] CORE 1 SENDS %d [X]\r\n",dataCore1);  
         }
-        //HC05_TX_DS18B20(tempCompr);
+        //HC05_TX_DS18B20(sample.waterTemp);
        
      
+        simStage("alarms");
         toggleLed();
         debugMsg("======================== WARNING LEVEL ===============================\r\n");
         monitorMsg("======================== WARNING LEVEL ===============================\r\n");
 
-        debugVal("[X] TEMPERATURE TOLERANZ: %f [X]\r\n",30.0f - hcTemp);
-        monitorVal("[X] TEMPERATURE TOLERANZ: %f [X]\r\n",30.0f - hcTemp);
-        if (hcTemp >= 30.0f)
+        uint8_t alarms = MEASURE_ALARMS(&sample);
+        uint8_t tolerance[MEASURE_FORMAT_LEN + 1];
+
+        /*!< Further locations and probes are reported, alarms and telemetry stay on the first sensor */
+        for (uint8_t i = 1; i < ambientCount; i++)
+        {
+            MEASURE_FORMAT(tolerance, bmeTemp[i], 2);
+            monitor2Val("[X] AMBIENT 0x%02X TEMPERATURE: %s [X]\r\n", ambient[i]->addr, tolerance);
+            MEASURE_FORMAT(tolerance, (int32_t)bmePress[i], 2);
+            monitor2Val("[X] AMBIENT 0x%02X PRESSURE: %s [X]\r\n", ambient[i]->addr, tolerance);
+            MEASURE_FORMAT(tolerance, MEASURE_HUM_TO_MILLI(bmeHum[i]), 3);
+            monitor2Val("[X] AMBIENT 0x%02X HUMIDITY: %s [X]\r\n", ambient[i]->addr, tolerance);
+        }
+        for (uint8_t i = 1; i < DS18B20_DEVICE_COUNT(DS18B20_PIN); i++)
+        {
+            MEASURE_FORMAT(tolerance, MEASURE_WTEMP_TO_CENTI(waterTemp[i]), 2);
+            monitor2Val("[X] WATER PROBE %u TEMPERATURE: %s [X]\r\n", i, tolerance);
+        }
+
+        MEASURE_FORMAT(tolerance, MEASURE_TEMP_MAX - sample.temperature, 2);
+        debugVal("[X] TEMPERATURE TOLERANZ: %s [X]\r\n", tolerance);
+        monitorVal("[X] TEMPERATURE TOLERANZ: %s [X]\r\n", tolerance);
+        if (alarms & MEASURE_ALARM_TEMP)
         {
             gpio_put(TEMPERATURE_OK, false);
         }
 
-        debugVal("[X] PRESSURE TOLERANZ: %f [X]\r\n",1100.0f - hcPress);
-        monitorVal("[X] PRESSURE TOLERANZ: %f [X]\r\n",1100.0f - hcPress);
-        if (hcPress >= 1100.0f)
+        MEASURE_FORMAT(tolerance, (int32_t)MEASURE_PRESS_MAX - (int32_t)sample.pressure, 2);
+        debugVal("[X] PRESSURE TOLERANZ: %s [X]\r\n", tolerance);
+        monitorVal("[X] PRESSURE TOLERANZ: %s [X]\r\n", tolerance);
+        if (alarms & MEASURE_ALARM_PRESS)
         {
             gpio_put(PRESSURE_OK, false);
         }
 
-        debugVal("[X] HUMIDITY TOLERANZ: %f [X]\r\n",30.0f - hcHum);
-        monitorVal("[X] HUMIDITY TOLERANZ: %f [X]\r\n",30.0f - hcHum);
-        if (hcHum >= 30.0f)
+        MEASURE_FORMAT(tolerance, MEASURE_HUM_TO_MILLI((int32_t)MEASURE_HUM_MAX - (int32_t)sample.humidity), 3);
+        debugVal("[X] HUMIDITY TOLERANZ: %s [X]\r\n", tolerance);
+        monitorVal("[X] HUMIDITY TOLERANZ: %s [X]\r\n", tolerance);
+        if (alarms & MEASURE_ALARM_HUM)
         {
             gpio_put(HUMIDITY_OK, false);
         }
 
-        debugVal("[X] WATERELEVEL TOLERANZ: %f cm [X]\r\n",3.5f - waterlevelAdc);
-        monitorVal("[X] WATERELEVEL TOLERANZ: %f cm [X]\r\n",3.5f - waterlevelAdc);
-        if (waterlevelAdc  >= 3.5f)
+        MEASURE_FORMAT(tolerance, MEASURE_LEVEL_TO_CENTI(MEASURE_LEVEL_MAX - sample.waterLevel), 2);
+        debugVal("[X] WATERELEVEL TOLERANZ: %s cm [X]\r\n", tolerance);
+        monitorVal("[X] WATERELEVEL TOLERANZ: %s cm [X]\r\n", tolerance);
+        if (alarms & MEASURE_ALARM_LEVEL)
+        {
+            gpio_put(WATER_LEVEL_OK, false);
+        }
+
+        /*!< Round robin inputs of the level stream, filtered in the DMA interrupt */
+        int32_t waterLevel2 = WATERLEVEL_UV_TO_UM(WATERLEVEL_CHANNEL_UV(WATERLEVEL_CH_LEVEL2));
+        MEASURE_FORMAT(tolerance, MEASURE_LEVEL_TO_CENTI(MEASURE_LEVEL_MAX - waterLevel2), 2);
+        monitorVal("[X] WATERLEVEL 2 TOLERANZ: %s cm [X]\r\n", tolerance);
+        if (waterLevel2 >= MEASURE_LEVEL_MAX)
         {
             gpio_put(WATER_LEVEL_OK, false);
         }
+        uint32_t fsrUv = WATERLEVEL_CHANNEL_UV(WATERLEVEL_CH_FSR);
+        MEASURE_FORMAT(tolerance, ((int32_t)MEASURE_FSR_MAX - (int32_t)fsrUv) / 1000, 3);
+        monitorVal("[X] FSR PRESSURE TOLERANZ: %s V [X]\r\n", tolerance);
+        if (fsrUv >= MEASURE_FSR_MAX)
+        {
+            gpio_put(PRESSURE_FSR_OK, false);
+        }
+        MEASURE_FORMAT(tolerance, WATERLEVEL_UV_TO_MDEGC(WATERLEVEL_CHANNEL_UV(WATERLEVEL_CH_TEMP)), 3);
+        monitorVal("[X] CHIP TEMPERATURE: %s [X]\r\n", tolerance);
 
-        debugVal("[X] WATER TEMP TOLERANZ: %f [X]\r\n",25.0f - tempCompr );
-        monitorVal("[X] WATER TEMP TOLERANZ: %f [X]\r\n",25.0f - tempCompr );
-        if (tempCompr >= 25.0f)
+        MEASURE_FORMAT(tolerance, MEASURE_WTEMP_TO_CENTI(MEASURE_WTEMP_MAX - sample.waterTemp), 2);
+        debugVal("[X] WATER TEMP TOLERANZ: %s [X]\r\n", tolerance);
+        monitorVal("[X] WATER TEMP TOLERANZ: %s [X]\r\n", tolerance);
+        if (alarms & MEASURE_ALARM_WTEMP)
         {
             gpio_put(WATER_TEMP_OK, false);
         }
@@ -361,10 +475,10 @@ int main()
 
         monitorMsg("======================== BT RECEIVED MSG =============================\r\n");
         
-
-        HC05_TX_BME280(hcTemp, hcPress, hcHum);
-        HC05_TX_WATERLEVEL(waterlevelAdc);
-        HC05_TX_DS18B20(tempCompr);
+        simStage("hc05");
+        HC05_TX_BME280(sample.temperature, sample.pressure, sample.humidity);
+        HC05_TX_WATERLEVEL(sample.waterLevel);
+        HC05_TX_DS18B20(sample.waterTemp);
 
         HC05_RX_MSG_IRQ();
         HC_MSG_COUNT = 0;
@@ -372,6 +486,7 @@ int main()
 
 
         
+        simStage("idle");
         sleep_ms(500); /*<! For monitoring purpose */
         //clrscr();
 
@@ -507,7 +622,6 @@ void debugTerm(void)
         uint32_t blueDAta = multicore_fifo_pop_blocking();      
         blueDAta += blueDAta ; 
         multicore_fifo_push_blocking(blueDAta);
-        tempCompr = DS18B20_TEMP_READ(DS18B20_PIN);
     }
     multicore_fifo_clear_irq();// Clear IRQ
 } 
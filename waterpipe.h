@@ -38,6 +38,16 @@
 #define WATER_LEVEL_OK  14
 #define PRESSURE_FSR_OK 13
 
+/*=========================================================*/
+/*== AMBIENT SENSORS ======================================*/
+/*=========================================================*/
+
+/*!< BME280s sampled in the same loop period: SDO low and SDO high on the
+ *   default bus. A sensor on the second bus only needs i2c1 here. */
+#define AMBIENT_SENSORS     2
+#define AMBIENT_BUS         {i2c_default, i2c_default}
+#define AMBIENT_ADDR        {BME280_I2C_ADDR_PRIMARY, BME280_I2C_ADDR_SECONDARY}
+
 
 /*!< SET USER __NOP() MACRO */
 #define __NOP() __asm("NOP");
@@ -77,6 +87,30 @@
 #define monitor2Val(x, y, z)
 #endif
 
+/*=========================================================*/
+/*== HOST SIMULATION DEFINITION ===========================*/
+/*=========================================================*/
+#ifdef WATERPIPE_SIM
+#include "sim_hal.h"
+#define simLoopMark() SIM_LOOP_MARK()
+#define simStage(name) SIM_STAGE(name)
+#else
+#define simLoopMark()
+#define simStage(name)
+#endif
+
+/*=========================================================*/
+/*== HEAP TRACE DEFINITION ================================*/
+/*=========================================================*/
+#ifdef WATERPIPE_HEAP_TRACE
+#include "heaptrace.h"
+#define heapAllocCount() HEAPTRACE_ALLOCS()
+#elif defined(WATERPIPE_SIM)
+#define heapAllocCount() (SIM_STATS(0)->heapAllocs + SIM_STATS(1)->heapAllocs)
+#else
+#define heapAllocCount() 0u
+#endif
+
 
 
 